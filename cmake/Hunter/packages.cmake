@@ -16,6 +16,7 @@
 
 hunter_add_package(abseil)
 hunter_add_package(asio-grpc)
+hunter_add_package(benchmark)
 hunter_add_package(Catch)
 hunter_add_package(ethash)
 hunter_add_package(gRPC)
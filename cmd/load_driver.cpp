@@ -0,0 +1,192 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+#include <nlohmann/json.hpp>
+
+#include <silkworm/silkrpc/http/response_reader.hpp>
+
+struct LoadSettings {
+    std::string target;
+    std::string requests_file;
+    uint32_t concurrency;
+    std::chrono::seconds duration;
+};
+
+struct RecordedRequest {
+    std::string method;
+    std::string http_request;
+};
+
+//! Latency samples and failures collected for one JSON-RPC method
+struct MethodStats {
+    std::vector<std::chrono::microseconds> latencies;
+    uint64_t errors{0};
+
+    void merge(const MethodStats& other) {
+        latencies.insert(latencies.end(), other.latencies.begin(), other.latencies.end());
+        errors += other.errors;
+    }
+};
+
+using LoadStats = std::map<std::string, MethodStats>;
+
+//! Delays between reconnection attempts, doubled at each failure, so that a down target is not hammered by a busy connect loop
+constexpr std::chrono::milliseconds kMinReconnectDelay{10};
+constexpr std::chrono::milliseconds kMaxReconnectDelay{1'000};
+
+//! Load the recorded request mix, one JSON-RPC request per line, pre-formatted as HTTP/1.1 keep-alive POST requests
+static std::vector<RecordedRequest> load_requests(const std::string& requests_file, const std::string& host) {
+    std::vector<RecordedRequest> requests;
+    std::ifstream input{requests_file};
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        const auto json = nlohmann::json::parse(line, nullptr, /*allow_exceptions=*/false);
+        if (json.is_discarded() || !json.contains("method")) {
+            std::cerr << "Skipping invalid JSON-RPC request: " << line << "\n";
+            continue;
+        }
+        std::string http_request{"POST / HTTP/1.1\r\nHost: " + host + "\r\nContent-Type: application/json\r\nConnection: keep-alive\r\n"};
+        http_request.append("Content-Length: " + std::to_string(line.size()) + "\r\n\r\n").append(line);
+        requests.push_back({json["method"].get<std::string>(), std::move(http_request)});
+    }
+    return requests;
+}
+
+//! Read one HTTP response from \p socket and return true if it is a successful JSON-RPC reply
+static bool read_response(boost::asio::ip::tcp::socket& socket, boost::asio::streambuf& buffer) {
+    const auto response = silkrpc::http::read_response(socket, buffer);
+    return response.headers.starts_with("http/1.1 200") && response.content.find("\"error\"") == std::string::npos;
+}
+
+//! Replay \p requests round-robin from \p first_request over one keep-alive connection until \p deadline
+static LoadStats run_client(const LoadSettings& settings, const std::vector<RecordedRequest>& requests, std::size_t first_request,
+                            std::chrono::steady_clock::time_point deadline) {
+    LoadStats stats;
+
+    const auto separator = settings.target.find(':');
+    boost::asio::io_context io_context;
+    boost::asio::ip::tcp::resolver resolver{io_context};
+    boost::asio::ip::tcp::socket socket{io_context};
+    boost::asio::streambuf buffer;
+    bool connected{false};
+    auto reconnect_delay{kMinReconnectDelay};
+    for (std::size_t i{first_request}; std::chrono::steady_clock::now() < deadline; ++i) {
+        const auto& request = requests[i % requests.size()];
+        const auto start = std::chrono::steady_clock::now();
+        bool success{false};
+        try {
+            if (!connected) {
+                buffer.consume(buffer.size());
+                boost::asio::connect(socket, resolver.resolve(settings.target.substr(0, separator), settings.target.substr(separator + 1)));
+                connected = true;
+            }
+            boost::asio::write(socket, boost::asio::buffer(request.http_request));
+            success = read_response(socket, buffer);
+            reconnect_delay = kMinReconnectDelay;
+        } catch (const std::exception&) {
+            boost::system::error_code ignored_ec;
+            socket.close(ignored_ec);
+            connected = false;
+            std::this_thread::sleep_for(std::min(reconnect_delay, std::chrono::duration_cast<std::chrono::milliseconds>(deadline - start)));
+            reconnect_delay = std::min(2 * reconnect_delay, kMaxReconnectDelay);
+        }
+        auto& method_stats = stats[request.method];
+        if (success) {
+            method_stats.latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start));
+        } else {
+            ++method_stats.errors;
+        }
+    }
+    return stats;
+}
+
+static std::chrono::microseconds percentile(std::vector<std::chrono::microseconds>& sorted_latencies, double p) {
+    if (sorted_latencies.empty()) {
+        return std::chrono::microseconds{0};
+    }
+    const auto index = static_cast<std::size_t>(p * static_cast<double>(sorted_latencies.size() - 1));
+    return sorted_latencies[index];
+}
+
+int load_driver(const std::string& target, const std::string& requests_file, uint32_t concurrency, uint32_t duration) {
+    const LoadSettings settings{target, requests_file, concurrency, std::chrono::seconds{duration}};
+    const auto separator = settings.target.find(':');
+    if (separator == std::string::npos) {
+        std::cerr << "Invalid target, expected <address>:<port>: " << settings.target << "\n";
+        return -1;
+    }
+    const auto requests = load_requests(settings.requests_file, settings.target.substr(0, separator));
+    if (requests.empty()) {
+        std::cerr << "No valid JSON-RPC request in " << settings.requests_file << "\n";
+        return -1;
+    }
+    std::cout << "Load driver replaying " << requests.size() << " requests against " << settings.target
+              << " concurrency: " << settings.concurrency << " duration: " << settings.duration.count() << "s\n";
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto deadline = start + settings.duration;
+    std::vector<LoadStats> client_stats(settings.concurrency);
+    std::vector<std::thread> clients;
+    clients.reserve(settings.concurrency);
+    for (uint32_t i{0}; i < settings.concurrency; ++i) {
+        // Each client starts from a different offset so that the request mix is spread evenly across connections
+        clients.emplace_back([&, i]() {
+            client_stats[i] = run_client(settings, requests, i * requests.size() / settings.concurrency, deadline);
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    const auto elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    LoadStats total_stats;
+    for (const auto& stats : client_stats) {
+        for (const auto& [method, method_stats] : stats) {
+            total_stats[method].merge(method_stats);
+        }
+    }
+
+    std::cout << std::left << std::setw(40) << "method" << std::right << std::setw(10) << "requests" << std::setw(10) << "errors"
+              << std::setw(12) << "qps" << std::setw(12) << "p50[us]" << std::setw(12) << "p99[us]" << "\n";
+    for (auto& [method, method_stats] : total_stats) {
+        auto& latencies = method_stats.latencies;
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << std::left << std::setw(40) << method << std::right << std::setw(10) << latencies.size() << std::setw(10) << method_stats.errors
+                  << std::setw(12) << std::fixed << std::setprecision(1) << static_cast<double>(latencies.size()) / elapsed_seconds
+                  << std::setw(12) << percentile(latencies, 0.50).count() << std::setw(12) << percentile(latencies, 0.99).count() << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,477 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <boost/endian/conversion.hpp>
+#include <grpcpp/grpcpp.h>
+#include <silkworm/chain/config.hpp>
+#include <silkworm/common/util.hpp>
+#include <silkworm/db/mdbx.hpp>
+#include <silkworm/db/stages.hpp>
+#include <silkworm/db/util.hpp>
+#include <silkworm/rlp/encode.hpp>
+#include <silkworm/rpc/common/conversion.hpp>
+#include <silkworm/types/account.hpp>
+#include <silkworm/types/block.hpp>
+
+#include <silkworm/interfaces/remote/ethbackend.grpc.pb.h>
+#include <silkworm/interfaces/remote/kv.grpc.pb.h>
+#include <silkworm/interfaces/txpool/mining.grpc.pb.h>
+#include <silkworm/interfaces/txpool/txpool.grpc.pb.h>
+
+#include <silkworm/silkrpc/ethdb/tables.hpp>
+
+//! Protocol versions expected by the daemon at startup, see silkworm/silkrpc/protocol/version.hpp
+constexpr uint32_t kKvVersion[]{6, 0, 0};
+constexpr uint32_t kEthBackEndVersion[]{3, 1, 0};
+constexpr uint32_t kMiningVersion[]{1, 0, 0};
+constexpr uint32_t kTxPoolVersion[]{1, 0, 0};
+
+constexpr uint64_t kMockProtocolVersion{66};
+constexpr uint64_t kMockPeerCount{1};
+constexpr const char* kMockClientVersion{"silkrpc/mock_erigon"};
+
+//! Tables copied from MDBX fixtures, i.e. all the tables read by the daemon
+static const char* kFixtureTables[]{
+    silkrpc::db::table::kAccountHistory, silkrpc::db::table::kBlockBodies, silkrpc::db::table::kCanonicalHashes,
+    silkrpc::db::table::kHeaders, silkrpc::db::table::kDifficulty, silkrpc::db::table::kBlockReceipts,
+    silkrpc::db::table::kCode, silkrpc::db::table::kConfig, silkrpc::db::table::kEthTx,
+    silkrpc::db::table::kNonCanonicalTx, silkrpc::db::table::kHeadBlock, silkrpc::db::table::kHeadHeader,
+    silkrpc::db::table::kHeaderNumbers, silkrpc::db::table::kIncarnationMap, silkrpc::db::table::kLogAddressIndex,
+    silkrpc::db::table::kLogTopicIndex, silkrpc::db::table::kLogs, silkrpc::db::table::kPlainAccountChangeSet,
+    silkrpc::db::table::kPlainContractCode, silkrpc::db::table::kPlainState, silkrpc::db::table::kPlainStorageChangeSet,
+    silkrpc::db::table::kSenders, silkrpc::db::table::kStorageHistory, silkrpc::db::table::kSyncStageProgress,
+    silkrpc::db::table::kTxLookup, silkrpc::db::table::kIssuance, silkrpc::db::table::kCumulativeGasIndex,
+    silkrpc::db::table::kCallFromIndex, silkrpc::db::table::kCallToIndex, silkrpc::db::table::kLastForkchoice,
+};
+
+struct MockSettings {
+    std::string listen_address;
+    std::string fixture_path;
+    uint64_t blocks;
+    uint64_t accounts;
+    std::chrono::microseconds latency;
+    std::chrono::milliseconds new_block_interval;
+};
+
+static std::atomic_bool shutdown_requested{false};
+
+static void inject_latency(std::chrono::microseconds latency) {
+    if (latency.count() > 0) {
+        std::this_thread::sleep_for(latency);
+    }
+}
+
+static evmc::address make_address(uint64_t index) {
+    evmc::address address;
+    boost::endian::store_big_u64(address.bytes + silkworm::kAddressLength - sizeof(uint64_t), index);
+    return address;
+}
+
+//! Read-only in-memory database holding sorted (key, value) pairs per table, so that dupsort tables need no special case
+class MockDatabase {
+public:
+    using Table = std::set<std::pair<silkworm::Bytes, silkworm::Bytes>>;
+
+    //! Copy the known tables from the MDBX fixture at \p path
+    void load(const std::string& path) {
+        silkworm::db::EnvConfig db_config{.path = path, .readonly = true, .shared = true};
+        auto env = silkworm::db::open_env(db_config);
+        auto txn = env.start_read();
+        for (const auto table_name : kFixtureTables) {
+            if (!silkworm::db::has_map(txn, table_name)) {
+                continue;
+            }
+            auto& table = tables_[table_name];
+            auto cursor = txn.open_cursor(txn.open_map(table_name));
+            for (auto data = cursor.to_first(/*throw_notfound=*/false); data.done; data = cursor.to_next(/*throw_notfound=*/false)) {
+                table.emplace(silkworm::db::from_slice(data.key), silkworm::db::from_slice(data.value));
+            }
+        }
+        const auto head = tables_[silkrpc::db::table::kSyncStageProgress].lower_bound({silkworm::bytes_of_string(silkworm::db::stages::kExecutionKey), {}});
+        if (head != tables_[silkrpc::db::table::kSyncStageProgress].end() && head->second.size() == sizeof(uint64_t)) {
+            head_block_number_ = boost::endian::load_big_u64(head->second.data());
+        }
+    }
+
+    //! Generate a chain of \p blocks empty blocks on top of a state of \p accounts funded accounts
+    void generate(uint64_t blocks, uint64_t accounts) {
+        evmc::bytes32 parent_hash{};
+        intx::uint256 total_difficulty{0};
+        for (uint64_t block_number{0}; block_number < blocks; ++block_number) {
+            silkworm::BlockHeader header;
+            header.parent_hash = parent_hash;
+            header.number = block_number;
+            header.difficulty = 1;
+            header.gas_limit = 30'000'000;
+            header.timestamp = 1'600'000'000 + block_number * 12;
+            header.base_fee_per_gas = 1'000'000'000;
+            const auto block_hash{header.hash()};
+            total_difficulty += header.difficulty;
+
+            silkworm::Bytes header_rlp;
+            silkworm::rlp::encode(header_rlp, header);
+            silkworm::Bytes total_difficulty_rlp;
+            silkworm::rlp::encode(total_difficulty_rlp, total_difficulty);
+            // Erigon stores 1 system txn at the beginning and 1 at the end of each block
+            silkworm::db::detail::BlockBodyForStorage body{.base_txn_id = block_number * 2, .txn_count = 2};
+            const auto block_key{silkworm::db::block_key(block_number, block_hash.bytes)};
+
+            put(silkrpc::db::table::kCanonicalHashes, silkworm::db::block_key(block_number), silkworm::Bytes{block_hash.bytes, silkworm::kHashLength});
+            put(silkrpc::db::table::kHeaders, block_key, header_rlp);
+            put(silkrpc::db::table::kDifficulty, block_key, total_difficulty_rlp);
+            put(silkrpc::db::table::kBlockBodies, block_key, body.encode());
+            put(silkrpc::db::table::kHeaderNumbers, silkworm::Bytes{block_hash.bytes, silkworm::kHashLength}, silkworm::db::block_key(block_number));
+            if (block_number == 0) {
+                const auto config{silkworm::kMainnetConfig.to_json().dump()};
+                put(silkrpc::db::table::kConfig, silkworm::Bytes{block_hash.bytes, silkworm::kHashLength}, silkworm::bytes_of_string(config));
+            }
+            parent_hash = block_hash;
+        }
+        const auto head_block_number{blocks > 0 ? blocks - 1 : 0};
+        put(silkrpc::db::table::kHeadHeader, silkworm::bytes_of_string(silkrpc::db::table::kHeadHeader), silkworm::Bytes{parent_hash.bytes, silkworm::kHashLength});
+        put(silkrpc::db::table::kHeadBlock, silkworm::bytes_of_string(silkrpc::db::table::kHeadBlock), silkworm::Bytes{parent_hash.bytes, silkworm::kHashLength});
+        for (const auto stage_key : {silkworm::db::stages::kHeadersKey, silkworm::db::stages::kExecutionKey, silkworm::db::stages::kFinishKey}) {
+            put(silkrpc::db::table::kSyncStageProgress, silkworm::bytes_of_string(stage_key), silkworm::db::block_key(head_block_number));
+        }
+        for (uint64_t i{0}; i < accounts; ++i) {
+            silkworm::Account account{.nonce = i, .balance = intx::uint256{1'000'000'000'000'000'000} * (i + 1)};
+            const auto address{make_address(i)};
+            put(silkrpc::db::table::kPlainState, silkworm::Bytes{address.bytes, silkworm::kAddressLength}, account.encode_for_storage());
+        }
+        head_block_number_ = head_block_number;
+        accounts_ = accounts;
+    }
+
+    const Table* find_table(const std::string& name) const {
+        const auto it = tables_.find(name);
+        return it != tables_.end() ? &it->second : &empty_table_;
+    }
+
+    const Table* plain_state() const { return find_table(silkrpc::db::table::kPlainState); }
+
+    uint64_t head_block_number() const { return head_block_number_; }
+    uint64_t accounts() const { return accounts_; }
+
+private:
+    void put(const std::string& table_name, silkworm::Bytes key, silkworm::Bytes value) {
+        tables_[table_name].emplace(std::move(key), std::move(value));
+    }
+
+    std::map<std::string, Table> tables_;
+    Table empty_table_;
+    uint64_t head_block_number_{0};
+    uint64_t accounts_{0};
+};
+
+//! Remote KV service serving Tx cursor operations from MockDatabase and a synthetic StateChanges stream
+class MockKvService final : public remote::KV::Service {
+public:
+    MockKvService(const MockDatabase& database, const MockSettings& settings) : database_(database), settings_(settings) {}
+
+    grpc::Status Version(grpc::ServerContext* /*context*/, const google::protobuf::Empty* /*request*/, types::VersionReply* response) override {
+        inject_latency(settings_.latency);
+        response->set_major(kKvVersion[0]);
+        response->set_minor(kKvVersion[1]);
+        response->set_patch(kKvVersion[2]);
+        return grpc::Status::OK;
+    }
+
+    grpc::Status Tx(grpc::ServerContext* context, grpc::ServerReaderWriter<remote::Pair, remote::Cursor>* stream) override {
+        remote::Pair txid_pair;
+        txid_pair.set_txid(view_id_.load());
+        if (!stream->Write(txid_pair)) {
+            return grpc::Status::OK;
+        }
+
+        std::map<uint32_t, Cursor> cursors;
+        uint32_t next_cursor_id{1};
+        remote::Cursor request;
+        while (!context->IsCancelled() && stream->Read(&request)) {
+            inject_latency(settings_.latency);
+            remote::Pair response;
+            if (request.op() == remote::Op::OPEN || request.op() == remote::Op::OPEN_DUP_SORT) {
+                const auto table = database_.find_table(request.bucketname());
+                cursors.emplace(next_cursor_id, Cursor{table, table->end()});
+                response.set_cursorid(next_cursor_id++);
+            } else if (request.op() == remote::Op::CLOSE) {
+                cursors.erase(request.cursor());
+                response.set_cursorid(request.cursor());
+            } else {
+                const auto it = cursors.find(request.cursor());
+                if (it == cursors.end()) {
+                    return grpc::Status{grpc::StatusCode::INVALID_ARGUMENT, "unknown cursor: " + std::to_string(request.cursor())};
+                }
+                if (!move_cursor(it->second, request)) {
+                    return grpc::Status{grpc::StatusCode::UNIMPLEMENTED, "unsupported cursor op: " + remote::Op_Name(request.op())};
+                }
+                const auto& [table, position] = it->second;
+                if (position != table->end()) {
+                    response.set_k(position->first.data(), position->first.size());
+                    response.set_v(position->second.data(), position->second.size());
+                }
+                response.set_cursorid(request.cursor());
+            }
+            if (!stream->Write(response)) {
+                break;
+            }
+        }
+        return grpc::Status::OK;
+    }
+
+    grpc::Status StateChanges(grpc::ServerContext* context, const remote::StateChangeRequest* /*request*/,
+                              grpc::ServerWriter<remote::StateChangeBatch>* writer) override {
+        uint64_t next_account{0};
+        while (!context->IsCancelled() && !shutdown_requested) {
+            std::this_thread::sleep_for(settings_.new_block_interval);
+
+            // Each batch opens a new database view at the same head block, upserting the next few accounts unchanged
+            remote::StateChangeBatch batch;
+            batch.set_databaseviewid(++view_id_);
+            batch.set_pendingblockbasefee(1'000'000'000);
+            batch.set_blockgaslimit(30'000'000);
+            auto state_change = batch.add_changebatch();
+            state_change->set_blockheight(database_.head_block_number());
+            state_change->set_direction(remote::Direction::FORWARD);
+            for (auto i{0}; i < kAccountChangesPerBatch && database_.accounts() > 0; ++i, ++next_account) {
+                const auto address{make_address(next_account % database_.accounts())};
+                const auto account = database_.plain_state()->lower_bound({silkworm::Bytes{address.bytes, silkworm::kAddressLength}, {}});
+                if (account == database_.plain_state()->end()) {
+                    continue;
+                }
+                auto account_change = state_change->add_changes();
+                account_change->set_allocated_address(silkworm::rpc::H160_from_address(address).release());
+                account_change->set_action(remote::Action::UPSERT);
+                account_change->set_data(account->second.data(), account->second.size());
+            }
+            if (!writer->Write(batch)) {
+                break;
+            }
+        }
+        return grpc::Status::OK;
+    }
+
+private:
+    static constexpr int kAccountChangesPerBatch{16};
+
+    struct Cursor {
+        const MockDatabase::Table* table;
+        MockDatabase::Table::const_iterator position;
+    };
+
+    //! The smallest key greater than \p key, i.e. the lower bound skipping all the duplicates of \p key
+    static silkworm::Bytes next_key(const silkworm::Bytes& key) { return key + silkworm::Bytes(1, 0x00); }
+
+    //! Apply the cursor \p request to \p cursor using MDBX semantics: not found means positioned at table end
+    static bool move_cursor(Cursor& cursor, const remote::Cursor& request) {
+        auto& [table, position] = cursor;
+        const auto key{silkworm::byte_view_of_string(request.k())};
+        const auto value{silkworm::byte_view_of_string(request.v())};
+        const auto has_key = [&](silkworm::ByteView k) { return position != table->end() && position->first == k; };
+        switch (request.op()) {
+            case remote::Op::FIRST:
+                position = table->begin();
+                break;
+            case remote::Op::LAST:
+                position = table->empty() ? table->end() : std::prev(table->end());
+                break;
+            case remote::Op::CURRENT:
+                break;
+            case remote::Op::SEEK:
+                position = table->lower_bound({silkworm::Bytes{key}, {}});
+                break;
+            case remote::Op::SEEK_EXACT:
+                position = table->lower_bound({silkworm::Bytes{key}, {}});
+                if (!has_key(key)) position = table->end();
+                break;
+            case remote::Op::SEEK_BOTH:
+                position = table->lower_bound({silkworm::Bytes{key}, silkworm::Bytes{value}});
+                if (!has_key(key)) position = table->end();
+                break;
+            case remote::Op::SEEK_BOTH_EXACT:
+                position = table->find({silkworm::Bytes{key}, silkworm::Bytes{value}});
+                break;
+            case remote::Op::NEXT:
+                position = position == table->end() ? table->begin() : std::next(position);
+                break;
+            case remote::Op::NEXT_DUP: {
+                if (position == table->end()) break;
+                const auto current_key{position->first};
+                ++position;
+                if (!has_key(current_key)) position = table->end();
+                break;
+            }
+            case remote::Op::NEXT_NO_DUP:
+                if (position == table->end()) {
+                    position = table->begin();
+                } else {
+                    position = table->lower_bound({next_key(position->first), {}});
+                }
+                break;
+            case remote::Op::PREV:
+                if (position == table->begin()) {
+                    position = table->end();
+                } else {
+                    --position;
+                }
+                break;
+            case remote::Op::FIRST_DUP:
+                if (position != table->end()) position = table->lower_bound({position->first, {}});
+                break;
+            case remote::Op::LAST_DUP:
+                if (position != table->end()) position = std::prev(table->lower_bound({next_key(position->first), {}}));
+                break;
+            default:
+                return false;
+        }
+        return true;
+    }
+
+    const MockDatabase& database_;
+    const MockSettings& settings_;
+    std::atomic_uint64_t view_id_{1};
+};
+
+//! Remote ETHBACKEND service answering the unary calls used by the daemon with constant values
+class MockBackEndService final : public remote::ETHBACKEND::Service {
+public:
+    explicit MockBackEndService(const MockSettings& settings) : settings_(settings) {}
+
+    grpc::Status Etherbase(grpc::ServerContext* /*context*/, const remote::EtherbaseRequest* /*request*/, remote::EtherbaseReply* response) override {
+        inject_latency(settings_.latency);
+        response->set_allocated_address(silkworm::rpc::H160_from_address(make_address(0)).release());
+        return grpc::Status::OK;
+    }
+
+    grpc::Status NetVersion(grpc::ServerContext* /*context*/, const remote::NetVersionRequest* /*request*/, remote::NetVersionReply* response) override {
+        inject_latency(settings_.latency);
+        response->set_id(silkworm::kMainnetConfig.chain_id);
+        return grpc::Status::OK;
+    }
+
+    grpc::Status NetPeerCount(grpc::ServerContext* /*context*/, const remote::NetPeerCountRequest* /*request*/, remote::NetPeerCountReply* response) override {
+        inject_latency(settings_.latency);
+        response->set_count(kMockPeerCount);
+        return grpc::Status::OK;
+    }
+
+    grpc::Status Version(grpc::ServerContext* /*context*/, const google::protobuf::Empty* /*request*/, types::VersionReply* response) override {
+        inject_latency(settings_.latency);
+        response->set_major(kEthBackEndVersion[0]);
+        response->set_minor(kEthBackEndVersion[1]);
+        response->set_patch(kEthBackEndVersion[2]);
+        return grpc::Status::OK;
+    }
+
+    grpc::Status ProtocolVersion(grpc::ServerContext* /*context*/, const remote::ProtocolVersionRequest* /*request*/, remote::ProtocolVersionReply* response) override {
+        inject_latency(settings_.latency);
+        response->set_id(kMockProtocolVersion);
+        return grpc::Status::OK;
+    }
+
+    grpc::Status ClientVersion(grpc::ServerContext* /*context*/, const remote::ClientVersionRequest* /*request*/, remote::ClientVersionReply* response) override {
+        inject_latency(settings_.latency);
+        response->set_nodename(kMockClientVersion);
+        return grpc::Status::OK;
+    }
+
+private:
+    const MockSettings& settings_;
+};
+
+//! Mining and TXPOOL services just answer the protocol version check performed by the daemon at startup
+class MockMiningService final : public txpool::Mining::Service {
+public:
+    grpc::Status Version(grpc::ServerContext* /*context*/, const google::protobuf::Empty* /*request*/, types::VersionReply* response) override {
+        response->set_major(kMiningVersion[0]);
+        response->set_minor(kMiningVersion[1]);
+        response->set_patch(kMiningVersion[2]);
+        return grpc::Status::OK;
+    }
+};
+
+class MockTxPoolService final : public txpool::Txpool::Service {
+public:
+    grpc::Status Version(grpc::ServerContext* /*context*/, const google::protobuf::Empty* /*request*/, types::VersionReply* response) override {
+        response->set_major(kTxPoolVersion[0]);
+        response->set_minor(kTxPoolVersion[1]);
+        response->set_patch(kTxPoolVersion[2]);
+        return grpc::Status::OK;
+    }
+};
+
+int mock_erigon(const std::string& listen_address, const std::string& fixture_path, uint64_t blocks, uint64_t accounts, uint32_t latency, uint32_t new_block_interval) {
+    const MockSettings settings{
+        listen_address,
+        fixture_path,
+        blocks,
+        accounts,
+        std::chrono::microseconds{latency},
+        std::chrono::milliseconds{new_block_interval}
+    };
+
+    MockDatabase database;
+    if (settings.fixture_path.empty()) {
+        database.generate(settings.blocks, settings.accounts);
+        std::cout << "Mock Erigon generated " << settings.blocks << " blocks and " << settings.accounts << " accounts\n";
+    } else {
+        try {
+            database.load(settings.fixture_path);
+        } catch (const std::exception& e) {
+            std::cerr << "Mock Erigon cannot load fixture " << settings.fixture_path << ": " << e.what() << "\n";
+            return -1;
+        }
+        std::cout << "Mock Erigon loaded fixture " << settings.fixture_path << " at block " << database.head_block_number() << "\n";
+    }
+
+    MockKvService kv_service{database, settings};
+    MockBackEndService backend_service{settings};
+    MockMiningService mining_service;
+    MockTxPoolService txpool_service;
+
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort(settings.listen_address, grpc::InsecureServerCredentials());
+    builder.RegisterService(&kv_service);
+    builder.RegisterService(&backend_service);
+    builder.RegisterService(&mining_service);
+    builder.RegisterService(&txpool_service);
+    const auto server = builder.BuildAndStart();
+    if (!server) {
+        std::cerr << "Mock Erigon cannot listen on " << settings.listen_address << "\n";
+        return -1;
+    }
+    std::cout << "Mock Erigon listening on " << settings.listen_address << " latency: " << settings.latency.count() << "us\n";
+
+    std::signal(SIGINT, [](int) { shutdown_requested = true; });
+    std::signal(SIGTERM, [](int) { shutdown_requested = true; });
+    while (!shutdown_requested) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    }
+    server->Shutdown(std::chrono::system_clock::now() + std::chrono::seconds{1});
+    std::cout << "Mock Erigon stopped\n";
+
+    return 0;
+}
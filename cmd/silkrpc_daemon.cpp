@@ -43,6 +43,15 @@ ABSL_FLAG(silkrpc::LogLevel, log_verbosity, silkrpc::LogLevel::Critical, "loggin
 ABSL_FLAG(silkrpc::WaitMode, wait_mode, silkrpc::WaitMode::blocking, "scheduler wait mode");
 ABSL_FLAG(std::string, jwt_secret_file, silkrpc::kDefaultJwtFilename, "Token file to ensure safe connection between CL and EL");
 ABSL_FLAG(std::string, datadir, silkrpc::kDefaultDataDir, "DB Path");
+ABSL_FLAG(std::string, metrics_port, silkrpc::kDefaultMetricsPort, "Prometheus metrics local end-point as string <address>:<port> (empty means disabled)");
+ABSL_FLAG(silkrpc::LogFormat, log_format, silkrpc::LogFormat::Text, "logging output format (text, json)");
+ABSL_FLAG(uint32_t, slow_request_threshold, 0, "duration in milliseconds above which requests are profiled in the log (0 means disabled)");
+ABSL_FLAG(silkrpc::metrics::SlowRequestFormat, slow_request_format, silkrpc::metrics::SlowRequestFormat::Line, "slow request log format (line, trace)");
+ABSL_FLAG(silkrpc::CoreSet, context_cores, silkrpc::CoreSet{}, "CPU cores where I/O contexts run as cpulist e.g. 0-7,16-23 (empty means unpinned)");
+ABSL_FLAG(silkrpc::CoreSet, worker_cores, silkrpc::CoreSet{}, "CPU cores where worker threads run as cpulist, disjoint from context_cores (empty means unpinned)");
+ABSL_FLAG(silkrpc::AdmissionLimits, admission_limits, silkrpc::default_admission_limits(), "limits on public requests as <namespace>:<max_concurrent>/<max_queued> list (empty means unlimited)");
+ABSL_FLAG(uint32_t, engine_workers, silkrpc::kDefaultEngineWorkers, "number of worker threads reserved to Engine API, also reserving one I/O context (0 means shared)");
+ABSL_FLAG(silkrpc::RequestDeadlines, request_deadlines, silkrpc::RequestDeadlines{}, "max request durations as <method_or_namespace>:<milliseconds> list (empty means unbounded)");
 
 //! Assemble the application version using the Cable build information
 std::string get_version_from_build_info() {
@@ -109,6 +118,15 @@ silkrpc::DaemonSettings parse_args(int argc, char* argv[]) {
         absl::GetFlag(FLAGS_log_verbosity),
         absl::GetFlag(FLAGS_wait_mode),
         absl::GetFlag(FLAGS_jwt_secret_file),
+        absl::GetFlag(FLAGS_metrics_port),
+        absl::GetFlag(FLAGS_log_format),
+        absl::GetFlag(FLAGS_slow_request_threshold),
+        absl::GetFlag(FLAGS_slow_request_format),
+        absl::GetFlag(FLAGS_context_cores),
+        absl::GetFlag(FLAGS_worker_cores),
+        absl::GetFlag(FLAGS_admission_limits),
+        absl::GetFlag(FLAGS_engine_workers),
+        absl::GetFlag(FLAGS_request_deadlines),
     };
 
     return rpc_daemon_settings;
@@ -33,9 +33,21 @@ int kv_seek_async_coroutines(const std::string& target, const std::string& table
 int kv_seek_async(const std::string& target, const std::string& table_name, const silkworm::Bytes& key, uint32_t timeout);
 int kv_seek_both(const std::string& target, const std::string& table_name, const silkworm::Bytes& key, const silkworm::Bytes& subkey);
 int kv_seek(const std::string& target, const std::string& table_name, const silkworm::Bytes& key);
-
+int load_driver(const std::string& target, const std::string& requests_file, uint32_t concurrency, uint32_t duration);
+int mock_erigon(const std::string& listen_address, const std::string& fixture_path, uint64_t blocks, uint64_t accounts, uint32_t latency, uint32_t new_block_interval);
+
+ABSL_FLAG(uint64_t, accounts, 1'000, "number of synthetic accounts generated by mock_erigon as integer");
+ABSL_FLAG(uint64_t, blocks, 1'000, "number of synthetic blocks generated by mock_erigon as integer");
+ABSL_FLAG(uint32_t, concurrency, 16, "number of concurrent connections opened by load_driver as integer");
+ABSL_FLAG(uint32_t, duration, 30, "load_driver test duration in secs as integer");
+ABSL_FLAG(std::string, fixture, "", "MDBX database directory served by mock_erigon as string (empty means synthetic data)");
+ABSL_FLAG(std::string, http_target, silkrpc::kDefaultHttpPort, "Silkrpc location as string <address>:<port>");
 ABSL_FLAG(std::string, key, "", "key as hex string w/o leading 0x");
+ABSL_FLAG(uint32_t, latency, 0, "latency in usecs injected by mock_erigon into each gRPC call and KV cursor operation as integer");
+ABSL_FLAG(std::string, listen, silkrpc::kDefaultTarget, "mock_erigon listening location as string <address>:<port>");
 ABSL_FLAG(silkrpc::LogLevel, log_verbosity, silkrpc::LogLevel::Critical, "logging level as string");
+ABSL_FLAG(uint32_t, new_block_interval, 12'000, "interval in msecs between StateChanges batches sent by mock_erigon as integer");
+ABSL_FLAG(std::string, requests, "", "file containing the JSON-RPC requests replayed by load_driver, one per line, as string");
 ABSL_FLAG(std::string, seekkey, "", "seek key as hex string w/o leading 0x");
 ABSL_FLAG(std::string, subkey, "", "subkey as hex string w/o leading 0x");
 ABSL_FLAG(std::string, tool, "", "gRPC remote interface tool name as string");
@@ -235,6 +247,60 @@ int kv_seek(int argc, char* argv[]) {
     return kv_seek(target, table_name, key_bytes.value());
 }
 
+int load_driver(int argc, char* argv[]) {
+    auto http_target{absl::GetFlag(FLAGS_http_target)};
+    if (http_target.empty() || http_target.find(":") == std::string::npos) {
+        std::cerr << "Parameter http_target is invalid: [" << http_target << "]\n";
+        std::cerr << "Use --http_target flag to specify the location of Silkrpc running instance\n";
+        return -1;
+    }
+
+    auto requests_file{absl::GetFlag(FLAGS_requests)};
+    if (requests_file.empty()) {
+        std::cerr << "Parameter requests is invalid: [" << requests_file << "]\n";
+        std::cerr << "Use --requests flag to specify the file containing the JSON-RPC requests to replay\n";
+        return -1;
+    }
+
+    auto concurrency{absl::GetFlag(FLAGS_concurrency)};
+    if (concurrency == 0) {
+        std::cerr << "Parameter concurrency is invalid: [" << concurrency << "]\n";
+        std::cerr << "Use --concurrency flag to specify the number of concurrent connections\n";
+        return -1;
+    }
+
+    auto duration{absl::GetFlag(FLAGS_duration)};
+    if (duration == 0) {
+        std::cerr << "Parameter duration is invalid: [" << duration << "]\n";
+        std::cerr << "Use --duration flag to specify the test duration in secs\n";
+        return -1;
+    }
+
+    return load_driver(http_target, requests_file, concurrency, duration);
+}
+
+int mock_erigon(int argc, char* argv[]) {
+    auto listen_address{absl::GetFlag(FLAGS_listen)};
+    if (listen_address.empty() || listen_address.find(":") == std::string::npos) {
+        std::cerr << "Parameter listen is invalid: [" << listen_address << "]\n";
+        std::cerr << "Use --listen flag to specify the location where mock Erigon accepts connections\n";
+        return -1;
+    }
+
+    auto new_block_interval{absl::GetFlag(FLAGS_new_block_interval)};
+    if (new_block_interval == 0) {
+        std::cerr << "Parameter new_block_interval is invalid: [" << new_block_interval << "]\n";
+        std::cerr << "Use --new_block_interval flag to specify the interval in msecs between StateChanges batches\n";
+        return -1;
+    }
+
+    const auto fixture_path{absl::GetFlag(FLAGS_fixture)};
+    const auto blocks{absl::GetFlag(FLAGS_blocks)};
+    const auto accounts{absl::GetFlag(FLAGS_accounts)};
+    const auto latency{absl::GetFlag(FLAGS_latency)};
+    return mock_erigon(listen_address, fixture_path, blocks, accounts, latency, new_block_interval);
+}
+
 int main(int argc, char* argv[]) {
     absl::SetProgramUsageMessage("Execute specified Silkrpc tool:\n"
         "\tethbackend\t\t\tquery the Erigon/Silkworm ETHBACKEND remote interface\n"
@@ -245,6 +311,8 @@ int main(int argc, char* argv[]) {
         "\tkv_seek_async_callback\t\tquery using SEEK the Erigon/Silkworm Key-Value (KV) remote interface to database\n"
         "\tkv_seek_async_coroutines\tquery using SEEK the Erigon/Silkworm Key-Value (KV) remote interface to database\n"
         "\tkv_seek_both\t\t\tquery using SEEK_BOTH the Erigon/Silkworm Key-Value (KV) remote interface to database\n"
+        "\tload_driver\t\t\treplay a recorded JSON-RPC request mix against Silkrpc reporting latency and QPS per method\n"
+        "\tmock_erigon\t\t\tserve the Erigon KV and ETHBACKEND remote interfaces from MDBX fixture or synthetic data\n"
     );
     const auto positional_args = absl::ParseCommandLine(argc, argv);
     if (positional_args.size() < 2) {
@@ -280,6 +348,12 @@ int main(int argc, char* argv[]) {
     if (tool == "kv_seek") {
         return kv_seek(argc, argv);
     }
+    if (tool == "load_driver") {
+        return load_driver(argc, argv);
+    }
+    if (tool == "mock_erigon") {
+        return mock_erigon(argc, argv);
+    }
 
     std::cerr << "Unknown tool " << tool <<  " specified as first argument\n\n";
     std::cerr << absl::ProgramUsageMessage();
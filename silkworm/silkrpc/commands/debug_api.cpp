@@ -86,6 +86,7 @@ boost::asio::awaitable<void> DebugRpcApi::handle_debug_account_range(const nlohm
         << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         auto start = std::chrono::system_clock::now();
@@ -126,6 +127,7 @@ boost::asio::awaitable<void> DebugRpcApi::handle_debug_get_modified_accounts_by_
     SILKRPC_DEBUG << "start_block_id: " << start_block_id << " end_block_id: " << end_block_id << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -167,6 +169,7 @@ boost::asio::awaitable<void> DebugRpcApi::handle_debug_get_modified_accounts_by_
     SILKRPC_DEBUG << "start_hash: " << start_hash << " end_hash: " << end_hash << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -214,6 +217,7 @@ boost::asio::awaitable<void> DebugRpcApi::handle_debug_storage_range_at(const nl
         << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -290,6 +294,7 @@ boost::asio::awaitable<void> DebugRpcApi::handle_debug_trace_transaction(const n
     stream.write_field("jsonrpc", "2.0");
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -300,7 +305,8 @@ boost::asio::awaitable<void> DebugRpcApi::handle_debug_trace_transaction(const n
             const Error error{-32000, oss.str()};
             stream.write_field("error", error);
         } else {
-            debug::DebugExecutor executor{*context_.io_context(), tx_database, workers_, config};
+            debug::DebugExecutor executor{*context_.io_context(), tx_database, workers_, config, context_.caches()};
+            executor.set_cancellation(cancellation_);
 
             stream.write_field("result");
             stream.open_object();
@@ -353,6 +359,7 @@ boost::asio::awaitable<void> DebugRpcApi::handle_debug_trace_call(const nlohmann
     stream.write_field("jsonrpc", "2.0");
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -361,7 +368,8 @@ boost::asio::awaitable<void> DebugRpcApi::handle_debug_trace_call(const nlohmann
         const auto block_with_hash = co_await core::read_block_by_number_or_hash(*context_.block_cache(), tx_database, block_number_or_hash);
         const bool is_latest_block = co_await core::is_latest_block_number(block_with_hash.block.header.number, tx_database);
         core::rawdb::DatabaseReader& db_reader = is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database;
-        debug::DebugExecutor executor{*context_.io_context(), db_reader, workers_, config};
+        debug::DebugExecutor executor{*context_.io_context(), db_reader, workers_, config, context_.caches()};
+        executor.set_cancellation(cancellation_);
 
         stream.write_field("result");
         stream.open_object();
@@ -417,13 +425,15 @@ boost::asio::awaitable<void> DebugRpcApi::handle_debug_trace_block_by_number(con
     stream.write_field("jsonrpc", "2.0");
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
 
         const auto block_with_hash = co_await core::read_block_by_number(*context_.block_cache(), tx_database, block_number);
 
-        debug::DebugExecutor executor{*context_.io_context(), tx_database, workers_, config};
+        debug::DebugExecutor executor{*context_.io_context(), tx_database, workers_, config, context_.caches()};
+        executor.set_cancellation(cancellation_);
 
         stream.write_field("result");
         stream.open_array();
@@ -479,13 +489,15 @@ boost::asio::awaitable<void> DebugRpcApi::handle_debug_trace_block_by_hash(const
     stream.write_field("jsonrpc", "2.0");
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
 
         const auto block_with_hash = co_await core::read_block_by_hash(*context_.block_cache(), tx_database, block_hash);
 
-        debug::DebugExecutor executor{*context_.io_context(), tx_database, workers_, config};
+        debug::DebugExecutor executor{*context_.io_context(), tx_database, workers_, config, context_.caches()};
+        executor.set_cancellation(cancellation_);
 
         stream.write_field("result");
         stream.open_array();
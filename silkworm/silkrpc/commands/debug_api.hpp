@@ -26,6 +26,7 @@
 #include <boost/asio/thread_pool.hpp>
 #include <nlohmann/json.hpp>
 
+#include <silkworm/silkrpc/concurrency/cancellation.hpp>
 #include <silkworm/silkrpc/concurrency/context_pool.hpp>
 #include <silkworm/silkrpc/core/rawdb/accessors.hpp>
 #include <silkworm/silkrpc/json/stream.hpp>
@@ -65,6 +66,9 @@ private:
     std::unique_ptr<txpool::TransactionPool>& tx_pool_;
     boost::asio::thread_pool& workers_;
 
+    //! Cancellation of the request being handled, set by the request handler
+    const Cancellation* cancellation_{nullptr};
+
     friend class silkrpc::http::RequestHandler;
 };
 
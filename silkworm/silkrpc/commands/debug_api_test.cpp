@@ -202,7 +202,8 @@ TEST_CASE("DebugRpcApi") {
     ChannelFactory create_channel = []() {
         return grpc::CreateChannel("localhost", grpc::InsecureChannelCredentials());
     };
-    Context context{create_channel, std::make_shared<BlockCache>(), std::make_shared<ethdb::kv::CoherentStateCache>()};
+    Context context{create_channel, std::make_shared<BlockCache>(), std::make_shared<ethdb::kv::CoherentStateCache>(),
+                    make_execution_caches()};
     boost::asio::thread_pool workers{1};
 
     SECTION("CTOR") {
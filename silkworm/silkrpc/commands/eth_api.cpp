@@ -39,12 +39,15 @@
 #include <silkworm/silkrpc/common/constants.hpp>
 #include <silkworm/silkrpc/common/log.hpp>
 #include <silkworm/silkrpc/common/util.hpp>
+#include <silkworm/silkrpc/core/call_many.hpp>
 #include <silkworm/silkrpc/core/cached_chain.hpp>
+#include <silkworm/silkrpc/core/chain_config_cache.hpp>
 #include <silkworm/silkrpc/core/blocks.hpp>
 #include <silkworm/silkrpc/core/evm_executor.hpp>
 #include <silkworm/silkrpc/core/evm_access_list_tracer.hpp>
 #include <silkworm/silkrpc/core/estimate_gas_oracle.hpp>
 #include <silkworm/silkrpc/core/gas_price_oracle.hpp>
+#include <silkworm/silkrpc/core/prefetched_state.hpp>
 #include <silkworm/silkrpc/core/rawdb/chain.hpp>
 #include <silkworm/silkrpc/core/receipts.hpp>
 #include <silkworm/silkrpc/core/remote_state.hpp>
@@ -64,6 +67,9 @@
 
 namespace silkrpc::commands {
 
+//! The number of gas limits probed concurrently at each search round of eth_estimateGas
+constexpr std::size_t kEstimateGasConcurrentProbes{3};
+
 // https://eth.wiki/json-rpc/API#eth_blocknumber
 boost::asio::awaitable<void> EthereumRpcApi::handle_eth_block_number(const nlohmann::json& request, nlohmann::json& reply) {
     auto tx = co_await database_->begin();
@@ -840,27 +846,30 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_estimate_gas(const nlohm
     SILKRPC_DEBUG << "call: " << call << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         const BlockNumberOrHash block_number_or_hash{core::kLatestBlockId};
         ethdb::kv::CachedDatabase cached_database{block_number_or_hash, *tx, *state_cache_};
         ethdb::TransactionDatabase tx_database{*tx};
 
-        const auto chain_id = co_await core::rawdb::read_chain_id(tx_database);
-        const auto chain_config_ptr = lookup_chain_config(chain_id);
+        const auto chain_config = co_await core::get_chain_config(tx_database, context_.chain_config_cache().get());
         const auto latest_block_number = co_await core::get_block_number(core::kLatestBlockId, tx_database);
-        SILKRPC_DEBUG << "chain_id: " << chain_id << ", latest_block_number: " << latest_block_number << "\n";
+        SILKRPC_DEBUG << "chain_id: " << chain_config->chain_id << ", latest_block_number: " << latest_block_number << "\n";
 
         const auto latest_block_with_hash = co_await core::read_block_by_number(*block_cache_, tx_database, latest_block_number);
         const auto latest_block = latest_block_with_hash.block;
-        StateReader state_reader(cached_database);
-        state::RemoteState remote_state{*context_.io_context(), cached_database, latest_block.header.number};
-
-        Tracers tracers;
-        EVMExecutor evm_executor{*context_.io_context(), cached_database, *chain_config_ptr, workers_, latest_block.header.number, remote_state};
-
-        ego::Executor executor = [&latest_block, &evm_executor, &tracers](const silkworm::Transaction &transaction) {
-            return evm_executor.call(latest_block, transaction, tracers);
+        StateReader state_reader(cached_database, context_.history_cache().get());
+        // All the probes share the same state overlay at latest block, pre-loaded by the first execution at the gas cap
+        state::RemoteState remote_state{*context_.io_context(), cached_database, latest_block.header.number, latest_block_with_hash.hash,
+            context_.history_cache().get(), context_.snapshot_cache().get()};
+
+        ego::Executor executor = [&](const silkworm::Transaction &transaction) -> boost::asio::awaitable<ExecutionResult> {
+            // Each probe must start from the unmodified state, so it gets its own executor
+            EVMExecutor evm_executor{*context_.io_context(), cached_database, *chain_config->config, workers_, latest_block.header.number, remote_state,
+                chain_config->consensus_engine};
+            evm_executor.set_cancellation(cancellation_);
+            co_return co_await evm_executor.call(latest_block, transaction);
         };
 
         ego::BlockHeaderProvider block_header_provider = [&cached_database](uint64_t block_number) {
@@ -872,7 +881,7 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_estimate_gas(const nlohm
             return state_reader.read_account(address, block_number + 1);
         };
 
-        ego::EstimateGasOracle estimate_gas_oracle{block_header_provider, account_reader, executor};
+        ego::EstimateGasOracle estimate_gas_oracle{block_header_provider, account_reader, executor, kEstimateGasConcurrentProbes};
 
         auto estimated_gas = co_await estimate_gas_oracle.estimate_gas(call, latest_block_number);
 
@@ -916,7 +925,7 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_get_balance(const nlohma
         ethdb::kv::CachedDatabase cached_database{BlockNumberOrHash{block_id}, *tx, *state_cache_};
         const auto [block_number, is_latest_block] = co_await core::get_block_number(block_id, tx_database, /*latest_required=*/true);
 
-        StateReader state_reader(is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database);
+        StateReader state_reader(is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database, context_.history_cache().get());
         std::optional<silkworm::Account> account{co_await state_reader.read_account(address, block_number + 1)};
 
         reply = make_json_content(request["id"], "0x" + (account ? intx::hex(account->balance) : "0"));
@@ -951,7 +960,7 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_get_code(const nlohmann:
         ethdb::TransactionDatabase tx_database{*tx};
         ethdb::kv::CachedDatabase cached_database{BlockNumberOrHash{block_id}, *tx, *state_cache_};
         const auto [block_number, is_latest_block] = co_await core::get_block_number(block_id, tx_database, /*latest_required=*/true);
-        StateReader state_reader(is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database);
+        StateReader state_reader(is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database, context_.history_cache().get());
 
         std::optional<silkworm::Account> account{co_await state_reader.read_account(address, block_number + 1)};
 
@@ -993,7 +1002,7 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_get_transaction_count(co
         ethdb::TransactionDatabase tx_database{*tx};
         ethdb::kv::CachedDatabase cached_database{BlockNumberOrHash{block_id}, *tx, *state_cache_};
         const auto [block_number, is_latest_block] = co_await core::get_block_number(block_id, tx_database, /*latest_required=*/true);
-        StateReader state_reader(is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database);
+        StateReader state_reader(is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database, context_.history_cache().get());
 
         std::optional<silkworm::Account> account{co_await state_reader.read_account(address, block_number + 1)};
 
@@ -1035,7 +1044,7 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_get_storage_at(const nlo
         ethdb::TransactionDatabase tx_database{*tx};
         ethdb::kv::CachedDatabase cached_database{BlockNumberOrHash{block_id}, *tx, *state_cache_};
         const auto [block_number, is_latest_block] = co_await core::get_block_number(block_id, tx_database, /*latest_required=*/true);
-        StateReader state_reader(is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database);
+        StateReader state_reader(is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database, context_.history_cache().get());
         std::optional<silkworm::Account> account{co_await state_reader.read_account(address, block_number + 1)};
 
         if (account) {
@@ -1070,22 +1079,45 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_call(const nlohmann::jso
     SILKRPC_DEBUG << "call: " << call << " block_id: " << block_id << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_profile(profile_);
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
         ethdb::kv::CachedDatabase cached_database{BlockNumberOrHash{block_id}, *tx, *state_cache_};
 
-        const auto chain_id = co_await core::rawdb::read_chain_id(tx_database);
-        const auto chain_config_ptr = lookup_chain_config(chain_id);
+        const auto chain_config = co_await core::get_chain_config(tx_database, context_.chain_config_cache().get());
         const auto [block_number, is_latest_block] = co_await core::get_block_number(block_id, tx_database, /*latest_required=*/true);
 
-        state::RemoteState remote_state{*context_.io_context(),
-                                        is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database,
-                                        block_number};
-        EVMExecutor executor{*context_.io_context(), tx_database, *chain_config_ptr, workers_, block_number, remote_state};
         const auto block_with_hash = co_await core::read_block_by_number(*block_cache_, tx_database, block_number);
+
+        // Resumable execution never blocks a worker on state reads, so the number of workers does not cap the in-flight calls
+        const auto& snapshot_cache = context_.snapshot_cache();
+        auto snapshot = snapshot_cache ? snapshot_cache->get(block_number, block_with_hash.hash) : std::make_shared<state::StateSnapshot>(block_number);
+        state::PrefetchedState prefetched_state{*context_.io_context(),
+                                                is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database,
+                                                std::move(snapshot),
+                                                context_.history_cache().get()};
+        EVMExecutor executor{*context_.io_context(), tx_database, *chain_config->config, workers_, block_number, prefetched_state, chain_config->consensus_engine};
+        executor.set_profile(profile_);
+        executor.set_cancellation(cancellation_);
         silkworm::Transaction txn{call.to_transaction()};
-        const auto execution_result = co_await executor.call(block_with_hash.block, txn);
+
+        // Hint the state declared by the call and the one learned from past calls to the same contract function: it is read
+        // together with the first missing values, so a call served entirely from the snapshot never waits for it
+        const auto& footprint_cache = context_.footprint_cache();
+        prefetched_state.add_hints(call.access_list);
+        if (footprint_cache && call.to) {
+            const auto footprint = footprint_cache->find(*call.to, txn.data);
+            if (footprint) {
+                prefetched_state.add_hints(*footprint);
+            }
+        }
+        const auto execution_result = co_await executor.call_resumable(block_with_hash.block, txn, prefetched_state);
+
+        if (footprint_cache && call.to && !execution_result.pre_check_error) {
+            footprint_cache->insert(*call.to, txn.data, prefetched_state.footprint());
+        }
 
         if (execution_result.pre_check_error) {
             reply = make_json_error(request["id"], -32000, execution_result.pre_check_error.value());
@@ -1126,19 +1158,19 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_create_access_list(const
     SILKRPC_DEBUG << "call: " << call << " block_number_or_hash: " << block_number_or_hash << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
         ethdb::kv::CachedDatabase cached_database{block_number_or_hash, *tx, *state_cache_};
 
         const auto block_with_hash = co_await core::read_block_by_number_or_hash(*block_cache_, tx_database, block_number_or_hash);
-        const auto chain_id = co_await core::rawdb::read_chain_id(tx_database);
-        const auto chain_config_ptr = lookup_chain_config(chain_id);
+        const auto chain_config = co_await core::get_chain_config(tx_database, context_.chain_config_cache().get());
 
         const bool is_latest_block = co_await core::get_latest_executed_block_number(tx_database) == block_with_hash.block.header.number;
         const core::rawdb::DatabaseReader& db_reader = is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database;
-        StateReader state_reader(db_reader);
-        state::RemoteState remote_state{*context_.io_context(), db_reader, block_with_hash.block.header.number};
+        StateReader state_reader(db_reader, context_.history_cache().get());
+        state::RemoteState remote_state{*context_.io_context(), db_reader, block_with_hash.block.header.number, context_.history_cache().get()};
 
         evmc::address to{};
         if (call.to) {
@@ -1168,7 +1200,8 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_create_access_list(const
         Tracers tracers{tracer};
         bool access_lists_match{false};
         do {
-            EVMExecutor executor{*context_.io_context(), tx_database, *chain_config_ptr, workers_, block_with_hash.block.header.number, remote_state};
+            EVMExecutor executor{*context_.io_context(), tx_database, *chain_config->config, workers_, block_with_hash.block.header.number, remote_state, chain_config->consensus_engine};
+            executor.set_cancellation(cancellation_);
             const auto txn = call.to_transaction();
             tracer->reset_access_list();
             const auto execution_result = co_await executor.call(block_with_hash.block, txn, tracers, /* refund */true, /* gasBailout */false);
@@ -1227,19 +1260,25 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_call_bundle(const nlohma
     SILKRPC_DEBUG << "block_number_or_hash: " << block_number_or_hash << " timeout: " << timeout << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::kv::CachedDatabase tx_database{block_number_or_hash, *tx, *state_cache_};
         ethdb::kv::CachedDatabase cached_database{block_number_or_hash, *tx, *state_cache_};
 
         const auto block_with_hash = co_await core::read_block_by_number_or_hash(*block_cache_, tx_database, block_number_or_hash);
-        const auto chain_id = co_await core::rawdb::read_chain_id(tx_database);
-        const auto chain_config_ptr = lookup_chain_config(chain_id);
+        const auto chain_config = co_await core::get_chain_config(tx_database, context_.chain_config_cache().get());
 
         const bool is_latest_block = co_await core::get_latest_executed_block_number(tx_database) == block_with_hash.block.header.number;
         core::rawdb::DatabaseReader& db_reader = is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database;
         auto block_number = block_with_hash.block.header.number;
-        state::RemoteState remote_state{*context_.io_context(), db_reader, block_number};
+        // The state snapshot at block number is shared by all the requests on such block, so it is likely warm already
+        state::RemoteState remote_state{*context_.io_context(), db_reader, block_number, block_with_hash.hash, context_.history_cache().get(),
+            context_.snapshot_cache().get()};
+
+        // Bundle transactions are applied in sequence on the same intra-block state, each one seeing the changes of the previous ones
+        EVMExecutor executor{*context_.io_context(), tx_database, *chain_config->config, workers_, block_number, remote_state, chain_config->consensus_engine};
+        executor.set_cancellation(cancellation_);
 
         const auto start_time = clock_time::now();
 
@@ -1258,8 +1297,8 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_call_bundle(const nlohma
                 break;
             }
 
-            EVMExecutor executor{*context_.io_context(), tx_database, *chain_config_ptr, workers_, block_number, remote_state};
             const auto execution_result = co_await executor.call(block_with_hash.block, tx_with_block->transaction);
+            executor.reset();
             if (execution_result.pre_check_error) {
                 reply = make_json_error(request["id"], -32000, execution_result.pre_check_error.value());
                 error = true;
@@ -1302,6 +1341,90 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_call_bundle(const nlohma
     co_return;
 }
 
+// eth_callMany(calls, block[, sequential]): execute many calls on top of the same block, sharing one warm state snapshot
+boost::asio::awaitable<void> EthereumRpcApi::handle_eth_call_many(const nlohmann::json& request, json::Stream& stream) {
+    const auto params = request["params"];
+    if (params.size() < 2 || params.size() > 3) {
+        auto error_msg = "invalid eth_callMany params: " + params.dump();
+        SILKRPC_ERROR << error_msg << "\n";
+        const auto reply = make_json_error(request["id"], 100, error_msg);
+        stream.write_json(reply);
+        co_return;
+    }
+    const auto calls = params[0].get<std::vector<Call>>();
+    const auto block_number_or_hash = params[1].get<BlockNumberOrHash>();
+    const bool sequential = params.size() == 3 && params[2].get<bool>();
+    SILKRPC_DEBUG << "#calls: " << calls.size() << " block_number_or_hash: " << block_number_or_hash << " sequential: " << sequential << "\n";
+
+    stream.open_object();
+    stream.write_field("id", request["id"]);
+    stream.write_field("jsonrpc", "2.0");
+
+    auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
+
+    try {
+        ethdb::TransactionDatabase tx_database{*tx};
+        ethdb::kv::CachedDatabase cached_database{block_number_or_hash, *tx, *state_cache_};
+
+        const auto block_with_hash = co_await core::read_block_by_number_or_hash(*block_cache_, tx_database, block_number_or_hash);
+        const auto chain_config = co_await core::get_chain_config(tx_database, context_.chain_config_cache().get());
+
+        const bool is_latest_block = co_await core::get_latest_executed_block_number(tx_database) == block_with_hash.block.header.number;
+        core::rawdb::DatabaseReader& db_reader = is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database;
+        const auto block_number = block_with_hash.block.header.number;
+        state::RemoteState remote_state{*context_.io_context(), db_reader, block_number, block_with_hash.hash, context_.history_cache().get(),
+            context_.snapshot_cache().get()};
+
+        stream.write_field("result");
+        stream.open_array();
+
+        std::vector<silkworm::Transaction> transactions;
+        transactions.reserve(calls.size());
+        for (const auto& call : calls) {
+            transactions.push_back(call.to_transaction());
+        }
+
+        if (sequential) {
+            // Calls are applied in sequence on the same intra-block state, each one seeing the changes of the previous ones
+            EVMExecutor executor{*context_.io_context(), tx_database, *chain_config->config, workers_, block_number, remote_state, chain_config->consensus_engine};
+            executor.set_cancellation(cancellation_);
+            const CallExecutor execute_call = [&](const silkworm::Transaction& txn) -> boost::asio::awaitable<ExecutionResult> {
+                auto execution_result = co_await executor.call(block_with_hash.block, txn);
+                executor.reset();
+                co_return execution_result;
+            };
+            co_await execute_call_many(*context_.io_context(), transactions, execute_call, 1, stream);
+        } else {
+            // Independent calls run concurrently on the worker pool, each one on its own executor, and results are streamed in call order
+            const CallExecutor execute_call = [&](const silkworm::Transaction& txn) -> boost::asio::awaitable<ExecutionResult> {
+                EVMExecutor executor{*context_.io_context(), tx_database, *chain_config->config, workers_, block_number, remote_state,
+                    chain_config->consensus_engine};
+                executor.set_cancellation(cancellation_);
+                co_return co_await executor.call(block_with_hash.block, txn);
+            };
+            co_await execute_call_many(*context_.io_context(), transactions, execute_call, kCallManyWindowSize, stream);
+        }
+
+        stream.close_array();
+    } catch (const std::exception& e) {
+        SILKRPC_ERROR << "exception: " << e.what() << " processing request: " << request.dump() << "\n";
+
+        const Error error{100, e.what()};
+        stream.write_field("error", error);
+    } catch (...) {
+        SILKRPC_ERROR << "unexpected exception processing request: " << request.dump() << "\n";
+
+        const Error error{100, "unexpected exception"};
+        stream.write_field("error", error);
+    }
+
+    stream.close_object();
+
+    co_await tx->close(); // RAII not (yet) available with coroutines
+    co_return;
+}
+
 // https://eth.wiki/json-rpc/API#eth_newfilter
 boost::asio::awaitable<void> EthereumRpcApi::handle_eth_new_filter(const nlohmann::json& request, nlohmann::json& reply) {
     auto tx = co_await database_->begin();
@@ -1417,6 +1540,8 @@ boost::asio::awaitable<void> EthereumRpcApi::handle_eth_get_logs(const nlohmann:
     std::vector<Log> logs;
 
     auto tx = co_await database_->begin();
+    tx->set_profile(profile_);
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -30,12 +30,15 @@
 
 #include <silkworm/silkrpc/txpool/transaction_pool.hpp>
 #include <silkworm/types/receipt.hpp>
+#include <silkworm/silkrpc/concurrency/cancellation.hpp>
 #include <silkworm/silkrpc/concurrency/context_pool.hpp>
 #include <silkworm/silkrpc/core/rawdb/accessors.hpp>
+#include <silkworm/silkrpc/json/stream.hpp>
 #include <silkworm/silkrpc/json/types.hpp>
 #include <silkworm/silkrpc/ethbackend/backend.hpp>
 #include <silkworm/silkrpc/ethdb/database.hpp>
 #include <silkworm/silkrpc/ethdb/transaction.hpp>
+#include <silkworm/silkrpc/metrics/request_profile.hpp>
 #include <silkworm/silkrpc/types/log.hpp>
 #include <silkworm/silkrpc/types/receipt.hpp>
 
@@ -88,6 +91,7 @@ protected:
     boost::asio::awaitable<void> handle_eth_get_storage_at(const nlohmann::json& request, nlohmann::json& reply);
     boost::asio::awaitable<void> handle_eth_call(const nlohmann::json& request, nlohmann::json& reply);
     boost::asio::awaitable<void> handle_eth_call_bundle(const nlohmann::json& request, nlohmann::json& reply);
+    boost::asio::awaitable<void> handle_eth_call_many(const nlohmann::json& request, json::Stream& stream);
     boost::asio::awaitable<void> handle_eth_create_access_list(const nlohmann::json& request, nlohmann::json& reply);
     boost::asio::awaitable<void> handle_eth_new_filter(const nlohmann::json& request, nlohmann::json& reply);
     boost::asio::awaitable<void> handle_eth_new_block_filter(const nlohmann::json& request, nlohmann::json& reply);
@@ -121,6 +125,12 @@ protected:
     std::unique_ptr<txpool::TransactionPool>& tx_pool_;
     boost::asio::thread_pool& workers_;
 
+    //! Profile of the request being handled, set by the request handler when slow request logging is enabled
+    metrics::RequestProfile* profile_{nullptr};
+
+    //! Cancellation of the request being handled, set by the request handler
+    const Cancellation* cancellation_{nullptr};
+
     friend class silkrpc::http::RequestHandler;
 };
 
@@ -121,6 +121,7 @@ void RpcApiTable::add_eth_handlers() {
     method_handlers_[http::method::k_eth_getStorageAt] = &commands::RpcApi::handle_eth_get_storage_at;
     method_handlers_[http::method::k_eth_call] = &commands::RpcApi::handle_eth_call;
     method_handlers_[http::method::k_eth_callBundle] = &commands::RpcApi::handle_eth_call_bundle;
+    stream_handlers_[http::method::k_eth_callMany] = &commands::RpcApi::handle_eth_call_many;
     method_handlers_[http::method::k_eth_createAccessList] = &commands::RpcApi::handle_eth_create_access_list;
     method_handlers_[http::method::k_eth_newFilter] = &commands::RpcApi::handle_eth_new_filter;
     method_handlers_[http::method::k_eth_newBlockFilter] = &commands::RpcApi::handle_eth_new_block_filter;
@@ -17,6 +17,7 @@
 #include "trace_api.hpp"
 
 #include <algorithm>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -35,6 +36,11 @@
 
 namespace silkrpc::commands {
 
+//! Tag identifying in trace cache the traces computed by \p method using \p config
+static std::string make_trace_cache_tag(const std::string& method, const trace::TraceConfig& config) {
+    return method + ":" + (config.vm_trace ? "v" : "") + (config.trace ? "t" : "") + (config.state_diff ? "s" : "");
+}
+
 // https://eth.wiki/json-rpc/API#trace_call
 boost::asio::awaitable<void> TraceRpcApi::handle_trace_call(const nlohmann::json& request, nlohmann::json& reply) {
     const auto params = request["params"];
@@ -52,6 +58,7 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_call(const nlohmann::json
     SILKRPC_INFO << "call: " << call << " block_number_or_hash: " << block_number_or_hash << " config: " << config << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -59,7 +66,8 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_call(const nlohmann::json
         const auto block_with_hash = co_await core::read_block_by_number_or_hash(*context_.block_cache(), tx_database, block_number_or_hash);
         const bool is_latest_block = co_await core::is_latest_block_number(block_with_hash.block.header.number, tx_database);
         core::rawdb::DatabaseReader& db_reader = is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database;
-        trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), db_reader, workers_};
+        trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), db_reader, workers_, context_.caches()};
+        executor.set_cancellation(cancellation_);
         const auto result = co_await executor.trace_call(block_with_hash.block, call, config);
 
         if (result.pre_check_error) {
@@ -94,6 +102,7 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_call_many(const nlohmann:
     SILKRPC_INFO << "#trace_calls: " << trace_calls.size() << " block_number_or_hash: " << block_number_or_hash << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -102,7 +111,8 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_call_many(const nlohmann:
         const bool is_latest_block = co_await core::is_latest_block_number(block_with_hash.block.header.number, tx_database);
 
         core::rawdb::DatabaseReader& db_reader = is_latest_block ? (core::rawdb::DatabaseReader&)cached_database : (core::rawdb::DatabaseReader&)tx_database;
-        trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), db_reader, workers_};
+        trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), db_reader, workers_, context_.caches()};
+        executor.set_cancellation(cancellation_);
         const auto result = co_await executor.trace_calls(block_with_hash.block, trace_calls);
 
         if (result.pre_check_error) {
@@ -179,6 +189,7 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_raw_transaction(const nlo
     SILKRPC_INFO << "transaction: " << transaction << " config: " << config << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -186,7 +197,8 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_raw_transaction(const nlo
         const auto block_number = co_await core::get_latest_block_number(tx_database);
         const auto block_with_hash = co_await core::read_block_by_number(*context_.block_cache(), tx_database, block_number);
 
-        trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_};
+        trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_, context_.caches()};
+        executor.set_cancellation(cancellation_);
         const auto result = co_await executor.trace_transaction(block_with_hash.block, transaction, config);
 
         if (result.pre_check_error) {
@@ -221,15 +233,27 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_replay_block_transactions
     SILKRPC_INFO << " block_number_or_hash: " << block_number_or_hash << " config: " << config << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
 
         const auto block_with_hash = co_await core::read_block_by_number_or_hash(*context_.block_cache(), tx_database, block_number_or_hash);
 
-        trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_};
-        const auto result = co_await executor.trace_block_transactions(block_with_hash.block, config);
-        reply = make_json_content(request["id"], result);
+        // Block numbers are resolved to the canonical block hash, so cached traces of reorged blocks are never returned
+        const auto& trace_cache = context_.trace_cache();
+        const auto cache_tag = make_trace_cache_tag("trace_replayBlockTransactions", config);
+        auto traces = trace_cache ? trace_cache->find(block_with_hash.hash, cache_tag) : std::nullopt;
+        if (!traces) {
+            trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_, context_.caches()};
+            executor.set_cancellation(cancellation_);
+            const auto result = co_await executor.trace_block_transactions(block_with_hash.block, config);
+            traces.emplace(result);
+            if (trace_cache) {
+                trace_cache->insert(block_with_hash.hash, cache_tag, *traces);
+            }
+        }
+        reply = make_json_content(request["id"], *traces);
     } catch (const std::exception& e) {
         SILKRPC_ERROR << "exception: " << e.what() << " processing request: " << request.dump() << "\n";
         reply = make_json_error(request["id"], 100, e.what());
@@ -257,6 +281,7 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_replay_transaction(const
     SILKRPC_INFO << "transaction_hash: " << transaction_hash << " config: " << config << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -266,7 +291,8 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_replay_transaction(const
             oss << "transaction 0x" << transaction_hash << " not found";
             reply = make_json_error(request["id"], -32000, oss.str());
         } else {
-            trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_};
+            trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_, context_.caches()};
+            executor.set_cancellation(cancellation_);
             const auto result = co_await executor.trace_transaction(tx_with_block->block_with_hash.block, tx_with_block->transaction, config);
 
             if (result.pre_check_error) {
@@ -301,16 +327,27 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_block(const nlohmann::jso
     SILKRPC_INFO << " block_number_or_hash: " << block_number_or_hash << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
 
         const auto block_with_hash = co_await core::read_block_by_number_or_hash(*context_.block_cache(), tx_database, block_number_or_hash);
 
-        trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_};
-        trace::Filter filter;
-        const auto result = co_await executor.trace_block(block_with_hash, filter);
-        reply = make_json_content(request["id"], result);
+        // Block numbers are resolved to the canonical block hash, so cached traces of reorged blocks are never returned
+        const auto& trace_cache = context_.trace_cache();
+        auto traces = trace_cache ? trace_cache->find(block_with_hash.hash, "trace_block") : std::nullopt;
+        if (!traces) {
+            trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_, context_.caches()};
+            executor.set_cancellation(cancellation_);
+            trace::Filter filter;
+            const auto result = co_await executor.trace_block(block_with_hash, filter);
+            traces.emplace(result);
+            if (trace_cache) {
+                trace_cache->insert(block_with_hash.hash, "trace_block", *traces);
+            }
+        }
+        reply = make_json_content(request["id"], *traces);
     } catch (const std::exception& e) {
         SILKRPC_ERROR << "exception: " << e.what() << " processing request: " << request.dump() << "\n";
         reply = make_json_error(request["id"], 100, e.what());
@@ -343,13 +380,15 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_filter(const nlohmann::js
     stream.write_field("jsonrpc", "2.0");
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
 
-        trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_};
+        trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_, context_.caches()};
+        executor.set_cancellation(cancellation_);
 
-        co_await executor.trace_filter(trace_filter, &stream);
+        co_await executor.trace_filter(trace_filter, &stream, database_.get());
     } catch (const std::exception& e) {
         SILKRPC_ERROR << "exception: " << e.what() << " processing request: " << request.dump() << "\n";
 
@@ -393,6 +432,7 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_get(const nlohmann::json&
     }
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -401,7 +441,8 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_get(const nlohmann::json&
         if (!tx_with_block) {
             reply = make_json_content(request["id"]);
         } else {
-            trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_};
+            trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_, context_.caches()};
+            executor.set_cancellation(cancellation_);
             const auto result = co_await executor.trace_transaction(tx_with_block->block_with_hash, tx_with_block->transaction);
 
             // TODO(sixtysixter) for RPCDAEMON compatibility
@@ -437,6 +478,7 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_transaction(const nlohman
     SILKRPC_INFO << "transaction_hash: " << transaction_hash << "\n";
 
     auto tx = co_await database_->begin();
+    tx->set_cancellation(cancellation_);
 
     try {
         ethdb::TransactionDatabase tx_database{*tx};
@@ -444,7 +486,8 @@ boost::asio::awaitable<void> TraceRpcApi::handle_trace_transaction(const nlohman
         if (!tx_with_block) {
             reply = make_json_content(request["id"]);
         } else {
-            trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_};
+            trace::TraceCallExecutor executor{*context_.io_context(), *context_.block_cache(), tx_database, workers_, context_.caches()};
+            executor.set_cancellation(cancellation_);
             auto result = co_await executor.trace_transaction(tx_with_block->block_with_hash, tx_with_block->transaction);
             reply = make_json_content(request["id"], result);
         }
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <mutex>
 
@@ -40,9 +41,9 @@ public:
     boost::optional <silkworm::BlockWithHash> get(const evmc::bytes32& key) {
         if (shared_cache_) {
             const std::lock_guard<std::mutex> lock(access_);
-            return block_cache_.get(key);
+            return count(block_cache_.get(key));
         }
-        return block_cache_.get(key);
+        return count(block_cache_.get(key));
     }
 
     void insert(const evmc::bytes32 &key, const silkworm::BlockWithHash& block) {
@@ -53,10 +54,20 @@ public:
         block_cache_.insert(key, block);
     }
 
+    uint64_t hit_count() const { return hit_count_.load(std::memory_order_relaxed); }
+    uint64_t miss_count() const { return miss_count_.load(std::memory_order_relaxed); }
+
 private:
+    boost::optional<silkworm::BlockWithHash> count(boost::optional<silkworm::BlockWithHash> block) {
+        (block ? hit_count_ : miss_count_).fetch_add(1, std::memory_order_relaxed);
+        return block;
+    }
+
     mutable std::mutex access_;
     boost::compute::detail::lru_cache<evmc::bytes32, silkworm::BlockWithHash> block_cache_;
     bool shared_cache_;
+    std::atomic_uint64_t hit_count_{0};
+    std::atomic_uint64_t miss_count_{0};
 };
 
 } // namespace silkrpc
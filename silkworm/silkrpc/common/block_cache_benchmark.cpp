@@ -0,0 +1,70 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "block_cache.hpp"
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <boost/endian/conversion.hpp>
+
+namespace silkrpc {
+
+static constexpr std::size_t kBenchCacheCapacity{1'024};
+
+static evmc::bytes32 make_block_hash(uint64_t index) {
+    evmc::bytes32 hash;
+    boost::endian::store_big_u64(hash.bytes, index);
+    return hash;
+}
+
+//! Shared cache populated once and hit concurrently by all the benchmark threads, like the one shared by all contexts
+static BlockCache& shared_block_cache() {
+    static BlockCache block_cache{kBenchCacheCapacity};
+    static const bool populated = [] {
+        silkworm::BlockWithHash block_with_hash;
+        block_with_hash.block.transactions.resize(100);
+        for (uint64_t i{0}; i < kBenchCacheCapacity; ++i) {
+            block_with_hash.hash = make_block_hash(i);
+            block_with_hash.block.header.number = i;
+            block_cache.insert(block_with_hash.hash, block_with_hash);
+        }
+        return true;
+    }();
+    benchmark::DoNotOptimize(populated);
+    return block_cache;
+}
+
+static void benchmark_block_cache_get(benchmark::State& state) {
+    auto& block_cache = shared_block_cache();
+
+    std::vector<evmc::bytes32> hashes;
+    for (uint64_t i{0}; i < kBenchCacheCapacity; ++i) {
+        hashes.push_back(make_block_hash(i));
+    }
+
+    std::size_t index = static_cast<std::size_t>(state.thread_index()) * 31;
+    for (auto _ : state) {
+        const auto block_with_hash = block_cache.get(hashes[index]);
+        benchmark::DoNotOptimize(block_with_hash);
+        index = (index + 1) % hashes.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(benchmark_block_cache_get)->ThreadRange(1, 16)->UseRealTime();
+
+} // namespace silkrpc
@@ -64,5 +64,19 @@ TEST_CASE("insert entry in cache(no-lock)", "[silkrpc][commands][block_cache]")
     CHECK((*ret_block_option).hash == block1.hash);
 }
 
+TEST_CASE("count hits and misses", "[silkrpc][commands][block_cache]") {
+    evmc::bytes32 bh1{0x374f3a049e006f36f6cf91b02a3b0ee16c858af2f75858733eb0e927b5b7126c_bytes32};
+    BlockCache block_cache(1, true);
+    CHECK(block_cache.hit_count() == 0);
+    CHECK(block_cache.miss_count() == 0);
+
+    CHECK(!block_cache.get(bh1));
+    block_cache.insert(bh1, silkworm::BlockWithHash{});
+    CHECK(block_cache.get(bh1));
+    CHECK(block_cache.get(bh1));
+    CHECK(block_cache.hit_count() == 2);
+    CHECK(block_cache.miss_count() == 1);
+}
+
 } // namespace silkrpc
 
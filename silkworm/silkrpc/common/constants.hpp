@@ -18,6 +18,7 @@
 
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 
 namespace silkrpc {
 
@@ -40,8 +41,11 @@ constexpr const char* kEmptyChainData{""};
 constexpr const char* kDefaultHttpPort{"localhost:8545"};
 constexpr const char* kDefaultEnginePort{"localhost:8551"};
 constexpr const char* kDefaultTarget{"localhost:9090"};
+constexpr const char* kDefaultMetricsPort{""};
 constexpr const char* kDefaultEth1ApiSpec{"debug,eth,net,parity,erigon,trace,web3,txpool"};
 constexpr const char* kDefaultEth2ApiSpec{"engine,eth"};
+constexpr const char* kDefaultAdmissionLimits{"debug:16/64,trace:16/64"};
+constexpr const uint32_t kDefaultEngineWorkers{2};
 constexpr const char* kDefaultDataDir{""};
 constexpr const std::chrono::milliseconds kDefaultTimeout{10000};
 
@@ -52,5 +56,7 @@ constexpr const std::size_t kRequestHeadersInitialCapacity{8};
 constexpr const std::size_t kRequestMethodInitialCapacity{64};
 constexpr const std::size_t kRequestUriInitialCapacity{64};
 
+constexpr const int64_t kConnectionMigrationLoadGap{2};
+
 } // namespace silkrpc
 
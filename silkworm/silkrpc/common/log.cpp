@@ -16,9 +16,19 @@
 
 #include "log.hpp"
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <utility>
+#include <vector>
 
+#include <absl/strings/ascii.h>
 #include <absl/strings/str_cat.h>
 #include <absl/time/clock.h>
 
@@ -34,19 +44,314 @@ teestream log_streams_{std::cerr, null_stream()};
 
 LogLevel log_verbosity_{LogLevel::Info};
 bool log_thread_enabled_{false};
+LogFormat log_format_{LogFormat::Text};
 
 // Log to one or two output streams - typically the console and optional log file.
 void log_set_streams_(std::ostream& o1, std::ostream& o2) { log_streams_.set_streams(o1.rdbuf(), o2.rdbuf()); }
 
-std::mutex log_::log_mtx_;
+namespace {
 
-std::ostream& log_::header_(LogLevel level) {
-    log_streams_ << kLogTags_[static_cast<int>(level)] << "["
-                 << absl::FormatTime("%m-%d|%H:%M:%E3S", absl::Now(), absl::LocalTimeZone()) << "]";
-    if (log_thread_enabled_) {
-        log_streams_ << " " << std::this_thread::get_id();
+struct LogRecord {
+    LogLevel level{LogLevel::None};
+    absl::Time time;
+    std::thread::id thread_id;
+    std::string message;
+};
+
+// Serializes the writes on the output streams, held just for the time needed to write one formatted record
+std::mutex log_mtx_;
+
+void write_json_string(std::ostream& out, std::string_view text) {
+    static constexpr char kHexDigits[] = "0123456789abcdef";
+    out << '"';
+    for (const char c : text) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u00" << kHexDigits[(c >> 4) & 0x0F] << kHexDigits[c & 0x0F];
+                } else {
+                    out << c;
+                }
+        }
     }
-    return log_streams_;
+    out << '"';
+}
+
+void write_record(const LogRecord& record) {
+    std::scoped_lock lock{log_mtx_};
+    if (log_format_ == LogFormat::Json) {
+        // Strip the separator added by LOG macro and the trailing newlines, JSON lines are delimited by us
+        std::string_view message{record.message};
+        if (!message.empty() && message.front() == ' ') {
+            message.remove_prefix(1);
+        }
+        while (!message.empty() && (message.back() == '\n' || message.back() == '\r')) {
+            message.remove_suffix(1);
+        }
+        log_streams_ << R"({"time":")" << absl::FormatTime(absl::RFC3339_full, record.time, absl::LocalTimeZone())
+                     << R"(","level":")" << absl::StripTrailingAsciiWhitespace(kLogTags_[static_cast<int>(record.level)]) << '"';
+        if (log_thread_enabled_) {
+            log_streams_ << R"(,"thread":")" << record.thread_id << '"';
+        }
+        log_streams_ << R"(,"msg":)";
+        write_json_string(log_streams_, message);
+        log_streams_ << "}\n";
+    } else {
+        log_streams_ << kLogTags_[static_cast<int>(record.level)] << "["
+                     << absl::FormatTime("%m-%d|%H:%M:%E3S", record.time, absl::LocalTimeZone()) << "]";
+        if (log_thread_enabled_) {
+            log_streams_ << " " << record.thread_id;
+        }
+        log_streams_.write(record.message.data(), static_cast<std::streamsize>(record.message.size()));
+    }
+    if (record.level >= LogLevel::Critical) {
+        log_streams_.flush();
+    }
+}
+
+// Unbuffered stream appending to an in-memory string, whose storage is recycled between log statements
+class LogStream : public std::ostream {
+  public:
+    LogStream() : std::ostream(&buffer_), default_flags_(flags()) {}
+
+    std::string& message() { return buffer_.message; }
+
+    void reset() {
+        buffer_.message.clear();
+        clear();
+        flags(default_flags_);
+        precision(6);
+        fill(' ');
+    }
+
+  private:
+    struct Buffer : public std::streambuf {
+        int overflow(int c) override {
+            if (c != EOF) {
+                message.push_back(static_cast<char>(c));
+            }
+            return c;
+        }
+        std::streamsize xsputn(const char* s, std::streamsize count) override {
+            message.append(s, static_cast<std::size_t>(count));
+            return count;
+        }
+        std::string message;
+    } buffer_;
+    std::ios_base::fmtflags default_flags_;
+};
+
+// Thread-local streams for composing messages, one per nesting level because a log statement may call functions that log
+struct LogStreams {
+    LogStream& acquire() {
+        if (depth == streams.size()) {
+            streams.push_back(std::make_unique<LogStream>());
+        }
+        auto& stream = *streams[depth++];
+        stream.reset();
+        return stream;
+    }
+    void release() { --depth; }
+
+    std::vector<std::unique_ptr<LogStream>> streams;
+    std::size_t depth{0};
+};
+
+thread_local LogStreams log_thread_streams_;
+
+// Bounded single-producer single-consumer ring of records: the producer is the logging thread, the consumer the flush thread
+class LogQueue {
+  public:
+    static constexpr std::size_t kCapacity{1024};
+
+    bool try_push(LogRecord& record) {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == kCapacity) {
+            return false;
+        }
+        auto& slot = slots_[tail % kCapacity];
+        slot.level = record.level;
+        slot.time = record.time;
+        slot.thread_id = record.thread_id;
+        slot.message.swap(record.message); // give back the slot storage to the producer for reuse
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(LogRecord& record) {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        auto& slot = slots_[head % kCapacity];
+        record.level = slot.level;
+        record.time = slot.time;
+        record.thread_id = slot.thread_id;
+        record.message.swap(slot.message);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // set by the producer when its thread exits, the queue is dropped by the consumer once empty
+    std::atomic_bool orphaned{false};
+
+  private:
+    std::array<LogRecord, kCapacity> slots_;
+    alignas(64) std::atomic<std::size_t> head_{0};
+    alignas(64) std::atomic<std::size_t> tail_{0};
+};
+
+// Background thread draining the per-thread queues and formatting the records off the logging hot path
+class AsyncLogger {
+  public:
+    ~AsyncLogger() { stop(); }
+
+    bool running() const { return running_.load(std::memory_order_acquire); }
+
+    void start() {
+        std::scoped_lock lock{control_mtx_};
+        if (running()) {
+            return;
+        }
+        running_.store(true, std::memory_order_release);
+        flusher_ = std::thread{[&]() { run(); }};
+    }
+
+    void stop() {
+        std::scoped_lock lock{control_mtx_};
+        if (!running()) {
+            return;
+        }
+        running_.store(false, std::memory_order_release);
+        pushed_.fetch_add(1, std::memory_order_release); // wake up the flush thread
+        pushed_.notify_all();
+        flusher_.join();
+        // Producers racing with stop may still have pushed something
+        drain();
+        written_.store(pushed_.load(std::memory_order_acquire), std::memory_order_release);
+        written_.notify_all();
+    }
+
+    void push(LogRecord& record) {
+        auto& queue = thread_queue();
+        while (!queue.try_push(record)) {
+            std::this_thread::yield(); // queue full: back-pressure instead of dropping records
+        }
+        pushed_.fetch_add(1, std::memory_order_release);
+        pushed_.notify_one();
+        if (record.level >= LogLevel::Critical) {
+            flush(); // the process may be about to terminate
+        }
+    }
+
+    // Wait until all the records pushed so far have been written
+    void flush() {
+        const auto target = pushed_.load(std::memory_order_acquire);
+        for (auto written = written_.load(std::memory_order_acquire); written < target && running(); written = written_.load(std::memory_order_acquire)) {
+            written_.wait(written, std::memory_order_acquire);
+        }
+    }
+
+  private:
+    struct QueueHandle {
+        ~QueueHandle() {
+            if (queue) {
+                queue->orphaned.store(true, std::memory_order_release);
+            }
+        }
+        std::shared_ptr<LogQueue> queue;
+    };
+
+    LogQueue& thread_queue() {
+        thread_local QueueHandle handle;
+        if (!handle.queue) {
+            handle.queue = std::make_shared<LogQueue>();
+            std::scoped_lock lock{queues_mtx_};
+            queues_.push_back(handle.queue);
+        }
+        return *handle.queue;
+    }
+
+    void run() {
+        while (running()) {
+            const auto pushed = pushed_.load(std::memory_order_acquire);
+            const auto drained = drain();
+            if (drained > 0) {
+                written_.fetch_add(drained, std::memory_order_release);
+                written_.notify_all();
+            } else {
+                pushed_.wait(pushed, std::memory_order_acquire);
+            }
+        }
+    }
+
+    std::size_t drain() {
+        std::scoped_lock lock{queues_mtx_};
+        std::size_t count{0};
+        for (auto it = queues_.begin(); it != queues_.end();) {
+            const bool orphaned = (*it)->orphaned.load(std::memory_order_acquire);
+            while ((*it)->try_pop(record_)) {
+                write_record(record_);
+                ++count;
+            }
+            it = orphaned ? queues_.erase(it) : std::next(it);
+        }
+        return count;
+    }
+
+    std::mutex control_mtx_;
+    std::atomic_bool running_{false};
+    std::thread flusher_;
+    std::atomic<uint64_t> pushed_{0};
+    std::atomic<uint64_t> written_{0};
+    std::mutex queues_mtx_;
+    std::vector<std::shared_ptr<LogQueue>> queues_;
+    LogRecord record_;
+};
+
+AsyncLogger& async_logger() {
+    static AsyncLogger logger;
+    return logger;
+}
+
+} // namespace
+
+void log_set_async_(bool enabled) {
+    if (enabled) {
+        async_logger().start();
+    } else {
+        async_logger().stop();
+    }
+}
+
+void log_flush_() {
+    async_logger().flush();
+    std::scoped_lock lock{log_mtx_};
+    log_streams_.flush();
+}
+
+log_::log_(LogLevel level) : level_(level), buffer_(&log_thread_streams_.acquire()) {}
+
+log_::~log_() {
+    auto& stream = static_cast<LogStream&>(*buffer_);
+    LogRecord record{level_, absl::Now(), std::this_thread::get_id(), {}};
+    record.message.swap(stream.message());
+    if (async_logger().running()) {
+        async_logger().push(record);
+    } else {
+        write_record(record);
+    }
+    stream.message().swap(record.message);
+    log_thread_streams_.release();
+}
+
+std::ostream& log_::header_(LogLevel /*level*/) {
+    return *buffer_;
 }
 
 std::ostream& null_stream() {
@@ -92,6 +397,19 @@ bool AbslParseFlag(absl::string_view text, LogLevel* level, std::string* error)
     return false;
 }
 
+bool AbslParseFlag(absl::string_view text, LogFormat* format, std::string* error) {
+    if (text == "text") {
+        *format = LogFormat::Text;
+        return true;
+    }
+    if (text == "json") {
+        *format = LogFormat::Json;
+        return true;
+    }
+    *error = "unknown value for LogFormat";
+    return false;
+}
+
 std::string AbslUnparseFlag(LogLevel level) {
     switch (level) {
         case LogLevel::None: return "n";
@@ -105,4 +423,12 @@ std::string AbslUnparseFlag(LogLevel level) {
     }
 }
 
+std::string AbslUnparseFlag(LogFormat format) {
+    switch (format) {
+        case LogFormat::Text: return "text";
+        case LogFormat::Json: return "json";
+        default: return absl::StrCat(format);
+    }
+}
+
 } // namespace silkrpc
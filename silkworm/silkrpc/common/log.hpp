@@ -17,6 +17,7 @@
 #pragma once
 
 #include <mutex>
+#include <ostream>
 #include <string>
 
 #include <absl/strings/string_view.h>
@@ -26,6 +27,15 @@ namespace silkrpc {
 // available verbosity levels
 enum class LogLevel { Trace, Debug, Info, Warn, Error, Critical, None };
 
+// available output formats: human-readable text or one JSON object per line (for high-volume request logging)
+enum class LogFormat { Text, Json };
+
+// lowest level compiled in: statements below it are eliminated at compile time (e.g. Trace and Debug in release builds)
+#ifndef SILKRPC_LOG_MIN_LEVEL
+#define SILKRPC_LOG_MIN_LEVEL Trace
+#endif
+constexpr LogLevel kLogMinLevel{LogLevel::SILKRPC_LOG_MIN_LEVEL};
+
 // silence
 std::ostream& null_stream();
 
@@ -35,11 +45,17 @@ std::ostream& null_stream();
 //
 extern LogLevel log_verbosity_;
 extern bool log_thread_enabled_;
+extern LogFormat log_format_;
 void log_set_streams_(std::ostream& o1, std::ostream& o2);
+void log_set_async_(bool enabled);
+void log_flush_();
+
+// Each log statement is composed in a thread-local buffer without any locking: the complete record is then either
+// written at once (synchronous mode) or handed over to the background flush thread (asynchronous mode)
 class log_ {
   public:
-    explicit log_(LogLevel level) : level_(level) { log_mtx_.lock(); }
-    ~log_() { log_mtx_.unlock(); }
+    explicit log_(LogLevel level);
+    ~log_();
     std::ostream& header_(LogLevel);
     template <class T>
     std::ostream& operator<<(const T& message) {
@@ -48,7 +64,7 @@ class log_ {
 
   private:
     LogLevel level_;
-    static std::mutex log_mtx_;
+    std::ostream* buffer_;
 };
 
 using Logger = log_;
@@ -56,16 +72,21 @@ using Logger = log_;
 bool AbslParseFlag(absl::string_view text, LogLevel* level, std::string* error);
 std::string AbslUnparseFlag(LogLevel level);
 
+bool AbslParseFlag(absl::string_view text, LogFormat* format, std::string* error);
+std::string AbslUnparseFlag(LogFormat format);
+
 } // namespace silkrpc
 
 #define LOG(level_) if ((level_) < silkrpc::log_verbosity_) {} else silkrpc::log_(level_) << " " // NOLINT
 
-#define SILKRPC_TRACE LOG(silkrpc::LogLevel::Trace)
-#define SILKRPC_DEBUG LOG(silkrpc::LogLevel::Debug)
-#define SILKRPC_INFO  LOG(silkrpc::LogLevel::Info)
-#define SILKRPC_WARN  LOG(silkrpc::LogLevel::Warn)
-#define SILKRPC_ERROR LOG(silkrpc::LogLevel::Error)
-#define SILKRPC_CRIT  LOG(silkrpc::LogLevel::Critical)
+#define SILKRPC_LOG_AT_(level_) if constexpr ((level_) < silkrpc::kLogMinLevel) {} else LOG(level_) // NOLINT
+
+#define SILKRPC_TRACE SILKRPC_LOG_AT_(silkrpc::LogLevel::Trace)
+#define SILKRPC_DEBUG SILKRPC_LOG_AT_(silkrpc::LogLevel::Debug)
+#define SILKRPC_INFO  SILKRPC_LOG_AT_(silkrpc::LogLevel::Info)
+#define SILKRPC_WARN  SILKRPC_LOG_AT_(silkrpc::LogLevel::Warn)
+#define SILKRPC_ERROR SILKRPC_LOG_AT_(silkrpc::LogLevel::Error)
+#define SILKRPC_CRIT  SILKRPC_LOG_AT_(silkrpc::LogLevel::Critical)
 #define SILKRPC_LOG   LOG(silkrpc::LogLevel::None)
 
 #define SILKRPC_LOG_VERBOSITY(level_) (silkrpc::log_verbosity_ = (level_))
@@ -74,3 +95,9 @@ std::string AbslUnparseFlag(LogLevel level);
 
 #define SILKRPC_LOG_STREAMS(stream1_, stream2_) silkrpc::log_set_streams_((stream1_), (stream2_))
 
+#define SILKRPC_LOG_FORMAT(format_) (silkrpc::log_format_ = (format_))
+
+#define SILKRPC_LOG_ASYNC(async_) silkrpc::log_set_async_((async_))
+
+#define SILKRPC_LOG_FLUSH() silkrpc::log_flush_()
+
@@ -0,0 +1,250 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "admission_control.hpp"
+
+#include <chrono>
+#include <vector>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+#include <silkworm/silkrpc/common/constants.hpp>
+#include <silkworm/silkrpc/common/log.hpp>
+
+namespace silkrpc {
+
+bool AbslParseFlag(absl::string_view text, AdmissionLimits* limits, std::string* error) {
+    AdmissionLimits parsed_limits;
+    if (!text.empty()) {
+        for (const auto item : absl::StrSplit(text, ',')) {
+            const std::vector<absl::string_view> name_and_limit = absl::StrSplit(item, absl::MaxSplits(':', 1));
+            if (name_and_limit.size() != 2 || name_and_limit[0].empty()) {
+                *error = "invalid namespace in AdmissionLimits: " + std::string{item};
+                return false;
+            }
+            const std::vector<absl::string_view> bounds = absl::StrSplit(name_and_limit[1], absl::MaxSplits('/', 1));
+            AdmissionLimit limit;
+            if (bounds.size() != 2 || !absl::SimpleAtoi(bounds[0], &limit.max_concurrent) || !absl::SimpleAtoi(bounds[1], &limit.max_queued)) {
+                *error = "invalid limit in AdmissionLimits: " + std::string{item};
+                return false;
+            }
+            if (limit.max_concurrent == 0) {
+                *error = "zero max concurrent requests in AdmissionLimits: " + std::string{item};
+                return false;
+            }
+            parsed_limits.namespaces[std::string{name_and_limit[0]}] = limit;
+        }
+    }
+    *limits = std::move(parsed_limits);
+    return true;
+}
+
+std::string AbslUnparseFlag(const AdmissionLimits& limits) {
+    std::string text;
+    for (const auto& [name, limit] : limits.namespaces) {
+        if (!text.empty()) {
+            text += ",";
+        }
+        text += name + ":" + std::to_string(limit.max_concurrent) + "/" + std::to_string(limit.max_queued);
+    }
+    return text;
+}
+
+AdmissionLimits default_admission_limits() {
+    AdmissionLimits limits;
+    std::string error;
+    AbslParseFlag(kDefaultAdmissionLimits, &limits, &error);
+    return limits;
+}
+
+AdmissionControl::Ticket::~Ticket() {
+    if (lane_) {
+        lane_->release();
+    }
+}
+
+AdmissionControl::AdmissionControl(const AdmissionLimits& limits) {
+    for (const auto& [name, limit] : limits.namespaces) {
+        lanes_.emplace(name, std::make_unique<Lane>(limit));
+    }
+}
+
+boost::asio::awaitable<std::optional<AdmissionControl::Ticket>> AdmissionControl::admit(std::string_view method, const Cancellation* cancellation) {
+    auto lane = find_lane(method);
+    if (!lane) {
+        co_return Ticket{};
+    }
+    const auto admitted = co_await lane->acquire(cancellation);
+    if (!admitted) {
+        if (cancellation && cancellation->cancelled()) {
+            SILKRPC_DEBUG << "AdmissionControl::admit cancelled method: " << method << "\n";
+            co_return std::nullopt;
+        }
+        ++shed_count_;
+        SILKRPC_DEBUG << "AdmissionControl::admit shed method: " << method << "\n";
+        co_return std::nullopt;
+    }
+    co_return Ticket{lane};
+}
+
+uint32_t AdmissionControl::running_count(std::string_view method) const {
+    const auto lane = find_lane(method);
+    return lane ? lane->running_count() : 0;
+}
+
+uint32_t AdmissionControl::queued_count(std::string_view method) const {
+    const auto lane = find_lane(method);
+    return lane ? lane->queued_count() : 0;
+}
+
+AdmissionControl::Lane* AdmissionControl::find_lane(std::string_view method) const {
+    // The namespace is the method prefix before the first underscore (e.g. debug in debug_traceTransaction)
+    const auto it = lanes_.find(method.substr(0, method.find('_')));
+    return it != lanes_.end() ? it->second.get() : nullptr;
+}
+
+boost::asio::awaitable<bool> AdmissionControl::Lane::acquire(const Cancellation* cancellation) {
+    if (cancellation && cancellation->cancelled()) {
+        co_return false;
+    }
+    {
+        std::scoped_lock lock{mutex_};
+        if (running_count_ < limit_.max_concurrent) {
+            ++running_count_;
+            co_return true;
+        }
+    }
+
+    // Wait in queue: the initiation runs before suspension, so a release cannot happen between the checks and the enqueue
+    co_return co_await boost::asio::async_initiate<const boost::asio::use_awaitable_t<>&, void(bool)>(
+        [&](auto&& handler) {
+            auto shared_handler = std::make_shared<std::decay_t<decltype(handler)>>(std::move(handler));
+            auto executor = boost::asio::get_associated_executor(*shared_handler);
+            auto deadline_timer = cancellation ? std::make_shared<boost::asio::steady_timer>(executor) : nullptr;
+            auto complete = [shared_handler, executor, deadline_timer, cancellation](bool admitted) {
+                if (cancellation) {
+                    cancellation->set_on_cancel({});
+                }
+                // Resume the waiting request within its own executor, not the releasing one
+                boost::asio::post(executor, [shared_handler, deadline_timer, admitted]() {
+                    if (deadline_timer) {
+                        deadline_timer->cancel();
+                    }
+                    (*shared_handler)(admitted);
+                });
+            };
+            std::unique_lock lock{mutex_};
+            if (running_count_ < limit_.max_concurrent) {
+                ++running_count_;
+                lock.unlock();
+                complete(true);
+                return;
+            }
+            // Requests cancelled while queued must not take the room of live ones
+            const auto cancelled_waiters = waiters_.size() >= limit_.max_queued ? drop_cancelled_waiters() : std::vector<std::function<void(bool)>>{};
+            // Watching before the last check, so that any cancellation afterwards finds the waiter in queue
+            if (cancellation) {
+                watch_cancellation(*cancellation, *deadline_timer);
+            }
+            if (waiters_.size() >= limit_.max_queued || (cancellation && cancellation->cancelled())) {
+                lock.unlock();
+                complete(false);
+            } else {
+                waiters_.push_back(Waiter{cancellation, complete});
+                lock.unlock();
+            }
+            for (const auto& resume : cancelled_waiters) {
+                resume(false);
+            }
+        },
+        boost::asio::use_awaitable);
+}
+
+void AdmissionControl::Lane::watch_cancellation(const Cancellation& cancellation, boost::asio::steady_timer& deadline_timer) {
+    // Queued requests leave as soon as cancelled, without waiting for the next release that may never come
+    cancellation.set_on_cancel([this]() { wake_cancelled_waiters(); });
+    const auto deadline = cancellation.deadline();
+    if (deadline == 0) {
+        return;
+    }
+    deadline_timer.expires_at(boost::asio::steady_timer::time_point{std::chrono::nanoseconds{deadline}});
+    deadline_timer.async_wait([this](const boost::system::error_code& ec) {
+        if (ec != boost::asio::error::operation_aborted) {
+            wake_cancelled_waiters();
+        }
+    });
+}
+
+void AdmissionControl::Lane::wake_cancelled_waiters() {
+    std::unique_lock lock{mutex_};
+    const auto cancelled_waiters = drop_cancelled_waiters();
+    lock.unlock();
+    for (const auto& resume : cancelled_waiters) {
+        resume(false);
+    }
+}
+
+void AdmissionControl::Lane::release() {
+    std::unique_lock lock{mutex_};
+    // Never grant the slot to cancelled waiters, nobody is waiting for their reply anymore
+    const auto cancelled_waiters = drop_cancelled_waiters();
+    std::function<void(bool)> resume;
+    if (waiters_.empty()) {
+        --running_count_;
+    } else {
+        // Hand over the slot to the first waiter, so that running count does not change
+        resume = std::move(waiters_.front().resume);
+        waiters_.pop_front();
+    }
+    lock.unlock();
+    for (const auto& resume_cancelled : cancelled_waiters) {
+        resume_cancelled(false);
+    }
+    if (resume) {
+        resume(true);
+    }
+}
+
+std::vector<std::function<void(bool)>> AdmissionControl::Lane::drop_cancelled_waiters() {
+    std::vector<std::function<void(bool)>> cancelled_waiters;
+    for (auto it = waiters_.begin(); it != waiters_.end();) {
+        if (it->cancellation && it->cancellation->cancelled()) {
+            cancelled_waiters.push_back(std::move(it->resume));
+            it = waiters_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return cancelled_waiters;
+}
+
+uint32_t AdmissionControl::Lane::running_count() const {
+    std::scoped_lock lock{mutex_};
+    return running_count_;
+}
+
+uint32_t AdmissionControl::Lane::queued_count() const {
+    std::scoped_lock lock{mutex_};
+    return static_cast<uint32_t>(waiters_.size());
+}
+
+} // namespace silkrpc
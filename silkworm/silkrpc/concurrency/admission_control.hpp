@@ -0,0 +1,141 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <silkworm/silkrpc/config.hpp>
+
+#include <absl/strings/string_view.h>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <silkworm/silkrpc/concurrency/cancellation.hpp>
+
+namespace silkrpc {
+
+//! The bounds on the requests of one JSON RPC API namespace.
+struct AdmissionLimit {
+    //! The max number of requests running at the same time
+    uint32_t max_concurrent{0};
+    //! The max number of requests waiting for a running slot, beyond which requests are shed
+    uint32_t max_queued{0};
+
+    bool operator==(const AdmissionLimit& other) const = default;
+};
+
+//! The admission limits by namespace, written as comma-separated <namespace>:<max_concurrent>/<max_queued> (e.g. debug:8/32,trace:8/32).
+struct AdmissionLimits {
+    std::map<std::string, AdmissionLimit> namespaces;
+};
+
+bool AbslParseFlag(absl::string_view text, AdmissionLimits* limits, std::string* error);
+std::string AbslUnparseFlag(const AdmissionLimits& limits);
+
+//! The default limits, i.e. kDefaultAdmissionLimits
+AdmissionLimits default_admission_limits();
+
+//! Admission control of JSON RPC requests: a bounded number of requests run at the same time in each limited namespace,
+//! a bounded number wait in FIFO order for a slot and the others are shed. Requests in other namespaces are always admitted.
+//! Cancelled requests (e.g. whose client has disconnected) are never granted a slot and leave the queue to make room for others:
+//! queued requests are woken as soon as their client disconnects or their deadline expires, even if no slot is released.
+//! Thread-safe: one instance can be shared by all the servers running on different contexts.
+class AdmissionControl {
+    class Lane;
+
+  public:
+    //! The running slot granted to one request, released at destruction.
+    class Ticket {
+      public:
+        explicit Ticket(Lane* lane = nullptr) : lane_(lane) {}
+        ~Ticket();
+
+        Ticket(Ticket&& other) noexcept : lane_(std::exchange(other.lane_, nullptr)) {}
+        Ticket& operator=(Ticket&& other) = delete;
+
+      private:
+        Lane* lane_;
+    };
+
+    explicit AdmissionControl(const AdmissionLimits& limits);
+
+    AdmissionControl(const AdmissionControl&) = delete;
+    AdmissionControl& operator=(const AdmissionControl&) = delete;
+
+    //! Wait for a running slot in the namespace of \p method. Return no ticket if the request must be shed because the queue is full
+    //! or if \p cancellation (if any) is cancelled before the slot is granted.
+    boost::asio::awaitable<std::optional<Ticket>> admit(std::string_view method, const Cancellation* cancellation = nullptr);
+
+    //! The number of requests in the namespace of \p method running and queued now
+    uint32_t running_count(std::string_view method) const;
+    uint32_t queued_count(std::string_view method) const;
+
+    uint64_t shed_count() const { return shed_count_; }
+
+  private:
+    //! The bounded slots of one namespace.
+    class Lane {
+      public:
+        explicit Lane(const AdmissionLimit& limit) : limit_(limit) {}
+
+        //! Return true if a slot has been acquired, false if the queue is full or \p cancellation is cancelled
+        boost::asio::awaitable<bool> acquire(const Cancellation* cancellation);
+        void release();
+
+        uint32_t running_count() const;
+        uint32_t queued_count() const;
+
+      private:
+        //! One waiting request, resumed with true when the slot is handed over to it and with false when dropped as cancelled
+        struct Waiter {
+            const Cancellation* cancellation;
+            std::function<void(bool)> resume;
+        };
+
+        //! Remove the cancelled waiters from the queue and return their resumers, to be called without holding the lock
+        std::vector<std::function<void(bool)>> drop_cancelled_waiters();
+
+        //! Wake the waiter of \p cancellation as soon as it is cancelled or its deadline expires, by \p deadline_timer
+        void watch_cancellation(const Cancellation& cancellation, boost::asio::steady_timer& deadline_timer);
+
+        //! Resume the cancelled waiters with false
+        void wake_cancelled_waiters();
+
+        const AdmissionLimit limit_;
+        mutable std::mutex mutex_;
+        uint32_t running_count_{0};
+        std::deque<Waiter> waiters_;
+    };
+
+    Lane* find_lane(std::string_view method) const;
+
+    std::map<std::string, std::unique_ptr<Lane>, std::less<>> lanes_;
+    std::atomic_uint64_t shed_count_{0};
+};
+
+} // namespace silkrpc
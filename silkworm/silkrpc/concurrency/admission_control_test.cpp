@@ -0,0 +1,240 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "admission_control.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/post.hpp>
+#include <catch2/catch.hpp>
+
+#include <silkworm/silkrpc/common/clock_time.hpp>
+#include <silkworm/silkrpc/common/log.hpp>
+
+namespace silkrpc {
+
+TEST_CASE("parse admission limits", "[silkrpc][concurrency][admission_control]") {
+    SECTION("empty") {
+        AdmissionLimits limits;
+        std::string error;
+        CHECK(AbslParseFlag("", &limits, &error));
+        CHECK(limits.namespaces.empty());
+    }
+
+    SECTION("many namespaces") {
+        AdmissionLimits limits;
+        std::string error;
+        CHECK(AbslParseFlag("debug:8/32,trace:4/0", &limits, &error));
+        CHECK(error.empty());
+        CHECK(limits.namespaces.size() == 2);
+        CHECK(limits.namespaces["debug"] == AdmissionLimit{8, 32});
+        CHECK(limits.namespaces["trace"] == AdmissionLimit{4, 0});
+    }
+
+    SECTION("invalid") {
+        for (const absl::string_view text : {"debug", ":1/1", "debug:1", "debug:a/1", "debug:1/-1", "debug:0/1"}) {
+            AdmissionLimits limits;
+            std::string error;
+            CHECK(!AbslParseFlag(text, &limits, &error));
+            CHECK(!error.empty());
+        }
+    }
+}
+
+TEST_CASE("unparse admission limits", "[silkrpc][concurrency][admission_control]") {
+    CHECK(AbslUnparseFlag(AdmissionLimits{}).empty());
+    CHECK(AbslUnparseFlag(AdmissionLimits{{{"trace", {4, 0}}, {"debug", {8, 32}}}}) == "debug:8/32,trace:4/0");
+}
+
+TEST_CASE("AdmissionControl::admit", "[silkrpc][concurrency][admission_control]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    boost::asio::io_context io_context;
+    AdmissionControl admission_control{AdmissionLimits{{{"debug", {1, 1}}}}};
+    std::vector<AdmissionControl::Ticket> tickets;
+    std::vector<std::string> admitted;
+    uint32_t shed_count{0};
+
+    auto admit = [&](std::string method) -> boost::asio::awaitable<void> {
+        auto ticket = co_await admission_control.admit(method);
+        if (ticket) {
+            admitted.push_back(method);
+            tickets.push_back(std::move(*ticket));
+        } else {
+            ++shed_count;
+        }
+    };
+
+    SECTION("unlimited namespace") {
+        for (int i{0}; i < 3; ++i) {
+            boost::asio::co_spawn(io_context, admit("eth_call"), boost::asio::detached);
+        }
+        io_context.poll();
+        CHECK(admitted.size() == 3);
+        CHECK(admission_control.running_count("eth_call") == 0);
+    }
+
+    SECTION("queue then shed") {
+        boost::asio::co_spawn(io_context, admit("debug_traceTransaction"), boost::asio::detached);
+        boost::asio::co_spawn(io_context, admit("debug_traceCall"), boost::asio::detached);
+        boost::asio::co_spawn(io_context, admit("debug_traceBlockByNumber"), boost::asio::detached);
+        io_context.poll();
+        CHECK(admitted == std::vector<std::string>{"debug_traceTransaction"});
+        CHECK(shed_count == 1);
+        CHECK(admission_control.shed_count() == 1);
+        CHECK(admission_control.running_count("debug_traceCall") == 1);
+        CHECK(admission_control.queued_count("debug_traceCall") == 1);
+
+        // Releasing the running slot hands it over to the queued request
+        tickets.clear();
+        io_context.restart();
+        io_context.poll();
+        CHECK(admitted == std::vector<std::string>{"debug_traceTransaction", "debug_traceCall"});
+        CHECK(admission_control.running_count("debug_traceCall") == 1);
+        CHECK(admission_control.queued_count("debug_traceCall") == 0);
+
+        tickets.clear();
+        CHECK(admission_control.running_count("debug_traceCall") == 0);
+    }
+
+    SECTION("release from another thread") {
+        boost::asio::co_spawn(io_context, admit("debug_traceTransaction"), boost::asio::detached);
+        boost::asio::co_spawn(io_context, admit("debug_traceCall"), boost::asio::detached);
+        io_context.poll();
+        REQUIRE(tickets.size() == 1);
+
+        auto running_ticket = std::move(tickets.back());
+        tickets.clear();
+        boost::asio::thread_pool pool{1};
+        boost::asio::post(pool, [ticket = std::make_shared<AdmissionControl::Ticket>(std::move(running_ticket))]() mutable { ticket.reset(); });
+        pool.join();
+        io_context.restart();
+        io_context.poll();
+        CHECK(admitted == std::vector<std::string>{"debug_traceTransaction", "debug_traceCall"});
+    }
+}
+
+TEST_CASE("AdmissionControl::admit cancelled requests", "[silkrpc][concurrency][admission_control]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    boost::asio::io_context io_context;
+    AdmissionControl admission_control{AdmissionLimits{{{"debug", {1, 1}}}}};
+    std::vector<AdmissionControl::Ticket> tickets;
+    std::vector<std::string> admitted;
+    std::vector<std::string> not_admitted;
+
+    auto admit = [&](std::string method, const Cancellation* cancellation) -> boost::asio::awaitable<void> {
+        auto ticket = co_await admission_control.admit(method, cancellation);
+        if (ticket) {
+            admitted.push_back(method);
+            tickets.push_back(std::move(*ticket));
+        } else {
+            not_admitted.push_back(method);
+        }
+    };
+
+    SECTION("cancelled before queueing") {
+        Cancellation cancellation;
+        cancellation.cancel(CancellationReason::client_disconnected);
+        boost::asio::co_spawn(io_context, admit("debug_traceTransaction", &cancellation), boost::asio::detached);
+        io_context.poll();
+        CHECK(admitted.empty());
+        CHECK(not_admitted == std::vector<std::string>{"debug_traceTransaction"});
+        CHECK(admission_control.running_count("debug_traceTransaction") == 0);
+        CHECK(admission_control.shed_count() == 0);
+    }
+
+    SECTION("cancelled while queued is not granted the slot") {
+        Cancellation cancellation;
+        boost::asio::co_spawn(io_context, admit("debug_traceTransaction", nullptr), boost::asio::detached);
+        boost::asio::co_spawn(io_context, admit("debug_traceCall", &cancellation), boost::asio::detached);
+        io_context.poll();
+        CHECK(admission_control.queued_count("debug_traceCall") == 1);
+
+        cancellation.cancel(CancellationReason::client_disconnected);
+        tickets.clear();
+        io_context.restart();
+        io_context.poll();
+        CHECK(admitted == std::vector<std::string>{"debug_traceTransaction"});
+        CHECK(not_admitted == std::vector<std::string>{"debug_traceCall"});
+        CHECK(admission_control.running_count("debug_traceCall") == 0);
+        CHECK(admission_control.queued_count("debug_traceCall") == 0);
+        CHECK(admission_control.shed_count() == 0);
+    }
+
+    SECTION("cancelled while queued makes room in full queue") {
+        Cancellation cancellation;
+        boost::asio::co_spawn(io_context, admit("debug_traceTransaction", nullptr), boost::asio::detached);
+        boost::asio::co_spawn(io_context, admit("debug_traceCall", &cancellation), boost::asio::detached);
+        io_context.poll();
+        cancellation.cancel(CancellationReason::deadline_expired);
+        boost::asio::co_spawn(io_context, admit("debug_traceBlockByNumber", nullptr), boost::asio::detached);
+        io_context.restart();
+        io_context.poll();
+        CHECK(not_admitted == std::vector<std::string>{"debug_traceCall"});
+        CHECK(admission_control.queued_count("debug_traceCall") == 1);
+        CHECK(admission_control.shed_count() == 0);
+
+        tickets.clear();
+        io_context.restart();
+        io_context.poll();
+        CHECK(admitted == std::vector<std::string>{"debug_traceTransaction", "debug_traceBlockByNumber"});
+    }
+
+    SECTION("disconnected while queued leaves without any release") {
+        Cancellation cancellation;
+        boost::asio::co_spawn(io_context, admit("debug_traceTransaction", nullptr), boost::asio::detached);
+        boost::asio::co_spawn(io_context, admit("debug_traceCall", &cancellation), boost::asio::detached);
+        io_context.poll();
+        CHECK(admission_control.queued_count("debug_traceCall") == 1);
+
+        cancellation.cancel(CancellationReason::client_disconnected);
+        io_context.restart();
+        io_context.poll();
+        CHECK(admitted == std::vector<std::string>{"debug_traceTransaction"});
+        CHECK(not_admitted == std::vector<std::string>{"debug_traceCall"});
+        CHECK(admission_control.running_count("debug_traceCall") == 1);
+        CHECK(admission_control.queued_count("debug_traceCall") == 0);
+    }
+
+    SECTION("deadline expired while queued leaves without any release") {
+        Cancellation cancellation;
+        cancellation.set_deadline(clock_time::now() + 10'000'000);
+        boost::asio::co_spawn(io_context, admit("debug_traceTransaction", nullptr), boost::asio::detached);
+        boost::asio::co_spawn(io_context, admit("debug_traceCall", &cancellation), boost::asio::detached);
+        io_context.poll();
+        CHECK(admission_control.queued_count("debug_traceCall") == 1);
+
+        // No ticket is released, so only the deadline can wake the queued request
+        io_context.restart();
+        io_context.run();
+        CHECK(cancellation.reason() == CancellationReason::deadline_expired);
+        CHECK(admitted == std::vector<std::string>{"debug_traceTransaction"});
+        CHECK(not_admitted == std::vector<std::string>{"debug_traceCall"});
+        CHECK(admission_control.running_count("debug_traceCall") == 1);
+        CHECK(admission_control.queued_count("debug_traceCall") == 0);
+        CHECK(admission_control.shed_count() == 0);
+    }
+}
+
+} // namespace silkrpc
@@ -0,0 +1,86 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+
+#include <silkworm/silkrpc/config.hpp>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/experimental/as_tuple.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/system/system_error.hpp>
+
+namespace silkrpc {
+
+//! Mutual exclusion among coroutines, granted in FIFO order, e.g. to keep concurrent requests from overlapping on the same stream.
+//! Not thread-safe: all the coroutines locking it must run on the same single-threaded executor.
+class AsyncMutex {
+  public:
+    AsyncMutex() = default;
+
+    AsyncMutex(const AsyncMutex&) = delete;
+    AsyncMutex& operator=(const AsyncMutex&) = delete;
+
+    //! Wait for the exclusive access, throwing operation_aborted if the waiting coroutine is cancelled before getting it
+    boost::asio::awaitable<void> lock() {
+        if (!locked_) {
+            locked_ = true;
+            co_return;
+        }
+        auto waiter = std::make_shared<Waiter>(co_await boost::asio::this_coro::executor);
+        waiters_.push_back(waiter);
+        co_await waiter->timer.async_wait(boost::asio::experimental::as_tuple(boost::asio::use_awaitable));
+        if (!waiter->granted) {
+            waiters_.erase(std::find(waiters_.begin(), waiters_.end(), waiter));
+            throw boost::system::system_error{boost::asio::error::operation_aborted};
+        }
+    }
+
+    //! Release the exclusive access, handing it over to the first waiter if any
+    void unlock() {
+        if (waiters_.empty()) {
+            locked_ = false;
+            return;
+        }
+        auto waiter = std::move(waiters_.front());
+        waiters_.pop_front();
+        waiter->granted = true;
+        waiter->timer.cancel();
+    }
+
+    bool locked() const noexcept { return locked_; }
+
+  private:
+    struct Waiter {
+        explicit Waiter(const boost::asio::any_io_executor& executor) : timer{executor, boost::asio::steady_timer::time_point::max()} {}
+
+        boost::asio::steady_timer timer;
+        bool granted{false};
+    };
+
+    bool locked_{false};
+    std::deque<std::shared_ptr<Waiter>> waiters_;
+};
+
+} // namespace silkrpc
@@ -0,0 +1,88 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "async_mutex.hpp"
+
+#include <chrono>
+#include <exception>
+#include <vector>
+
+#include <boost/asio/bind_cancellation_slot.hpp>
+#include <boost/asio/cancellation_signal.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_future.hpp>
+#include <catch2/catch.hpp>
+
+namespace silkrpc {
+
+using namespace std::chrono_literals;
+
+static boost::asio::awaitable<void> hold(AsyncMutex& mutex, std::vector<int>& trace, int id, std::chrono::milliseconds duration) {
+    co_await mutex.lock();
+    trace.push_back(id);
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor, duration};
+    co_await timer.async_wait(boost::asio::use_awaitable);
+    trace.push_back(-id);
+    mutex.unlock();
+}
+
+TEST_CASE("AsyncMutex", "[silkrpc][concurrency][async_mutex]") {
+    boost::asio::io_context io_context;
+    AsyncMutex mutex;
+    std::vector<int> trace;
+
+    SECTION("lock when unlocked") {
+        auto result = boost::asio::co_spawn(io_context, mutex.lock(), boost::asio::use_future);
+        io_context.run();
+        CHECK_NOTHROW(result.get());
+        CHECK(mutex.locked());
+        mutex.unlock();
+        CHECK(!mutex.locked());
+    }
+
+    SECTION("holders never overlap and are granted in order") {
+        auto result1 = boost::asio::co_spawn(io_context, hold(mutex, trace, 1, 2ms), boost::asio::use_future);
+        auto result2 = boost::asio::co_spawn(io_context, hold(mutex, trace, 2, 1ms), boost::asio::use_future);
+        auto result3 = boost::asio::co_spawn(io_context, hold(mutex, trace, 3, 0ms), boost::asio::use_future);
+        io_context.run();
+        CHECK_NOTHROW(result1.get());
+        CHECK_NOTHROW(result2.get());
+        CHECK_NOTHROW(result3.get());
+        CHECK(trace == std::vector<int>{1, -1, 2, -2, 3, -3});
+        CHECK(!mutex.locked());
+    }
+
+    SECTION("cancelled waiter gives up its turn") {
+        boost::asio::cancellation_signal cancellation_signal;
+        auto result1 = boost::asio::co_spawn(io_context, hold(mutex, trace, 1, 20ms), boost::asio::use_future);
+        std::exception_ptr exception2;
+        boost::asio::co_spawn(io_context, hold(mutex, trace, 2, 0ms),
+            boost::asio::bind_cancellation_slot(cancellation_signal.slot(), [&](std::exception_ptr eptr) { exception2 = eptr; }));
+        auto result3 = boost::asio::co_spawn(io_context, hold(mutex, trace, 3, 0ms), boost::asio::use_future);
+        io_context.poll();
+        cancellation_signal.emit(boost::asio::cancellation_type::terminal);
+        io_context.run();
+        CHECK_NOTHROW(result1.get());
+        CHECK_THROWS_AS(std::rethrow_exception(exception2), boost::system::system_error);
+        CHECK_NOTHROW(result3.get());
+        CHECK(trace == std::vector<int>{1, -1, 3, -3});
+        CHECK(!mutex.locked());
+    }
+}
+
+} // namespace silkrpc
@@ -0,0 +1,119 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include <silkworm/silkrpc/config.hpp>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/bind_cancellation_slot.hpp>
+#include <boost/asio/cancellation_signal.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/experimental/as_tuple.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/system/system_error.hpp>
+
+namespace silkrpc {
+
+//! The outcome of one operation spawned on a single-threaded executor, e.g. one block or transaction in a concurrent window.
+//! Derive from it to keep any input of the operation alive until completion. Create it by std::make_shared, because a spawned
+//! operation holds the slot until it completes, even if the consumer has already gone.
+//! Not thread-safe: the operation must complete on the same executor where the slot is awaited.
+template <typename T>
+class AsyncSlot : public std::enable_shared_from_this<AsyncSlot<T>> {
+  public:
+    explicit AsyncSlot(const boost::asio::any_io_executor& executor)
+        : executor_{executor}, ready_timer_{executor, boost::asio::steady_timer::time_point::max()} {}
+
+    AsyncSlot(const AsyncSlot&) = delete;
+    AsyncSlot& operator=(const AsyncSlot&) = delete;
+
+    //! Start \p operation on the slot executor, completing this slot when done
+    void spawn(boost::asio::awaitable<T> operation) {
+        boost::asio::co_spawn(executor_, std::move(operation), boost::asio::bind_cancellation_slot(cancellation_signal_.slot(),
+            [self = this->shared_from_this()](std::exception_ptr eptr, T value) {
+                self->value_ = std::move(value);
+                self->exception_ = eptr;
+                self->ready_ = true;
+                self->ready_timer_.cancel();
+            }));
+    }
+
+    //! Ask the spawned operation to stop as soon as possible (i.e. at its next cancellable wait), if not yet completed
+    void cancel() {
+        if (!ready_) {
+            cancellation_signal_.emit(boost::asio::cancellation_type::terminal);
+        }
+    }
+
+    //! Wait for the spawned operation to complete: the slot may still be not ready if the waiting coroutine has been cancelled
+    boost::asio::awaitable<void> wait() {
+        if (!ready_) {
+            co_await ready_timer_.async_wait(boost::asio::experimental::as_tuple(boost::asio::use_awaitable));
+        }
+    }
+
+    //! Wait for the spawned operation to complete, then return its result or rethrow its exception
+    boost::asio::awaitable<T> get() {
+        co_await wait();
+        if (!ready_) {
+            throw boost::system::system_error{boost::asio::error::operation_aborted};
+        }
+        if (exception_) {
+            std::rethrow_exception(exception_);
+        }
+        co_return std::move(value_);
+    }
+
+    bool ready() const noexcept { return ready_; }
+    std::exception_ptr exception() const noexcept { return exception_; }
+    T& value() noexcept { return value_; }
+
+  private:
+    boost::asio::any_io_executor executor_;
+    T value_{};
+    std::exception_ptr exception_;
+    bool ready_{false};
+    boost::asio::steady_timer ready_timer_;
+    boost::asio::cancellation_signal cancellation_signal_;
+};
+
+//! Wait for all the spawned operations of \p slots to complete, e.g. before leaving the scope owning the state they use.
+//! The waiting coroutine must not be cancelled (e.g. reset its cancellation state first), otherwise it may stop waiting early.
+template <typename Slots>
+boost::asio::awaitable<void> wait_all(const Slots& slots) {
+    for (const auto& slot : slots) {
+        co_await slot->wait();
+    }
+}
+
+//! Cancel all the spawned operations of \p slots and wait for them to complete.
+template <typename Slots>
+boost::asio::awaitable<void> cancel_and_wait_all(const Slots& slots) {
+    for (const auto& slot : slots) {
+        slot->cancel();
+    }
+    co_await wait_all(slots);
+}
+
+} // namespace silkrpc
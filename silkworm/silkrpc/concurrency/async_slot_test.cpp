@@ -0,0 +1,125 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "async_slot.hpp"
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_future.hpp>
+#include <catch2/catch.hpp>
+
+namespace silkrpc {
+
+using namespace std::chrono_literals;
+
+static boost::asio::awaitable<int> delayed_value(int value, std::chrono::milliseconds delay) {
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor, delay};
+    co_await timer.async_wait(boost::asio::use_awaitable);
+    co_return value;
+}
+
+static boost::asio::awaitable<int> delayed_error(std::chrono::milliseconds delay) {
+    co_await delayed_value(0, delay);
+    throw std::runtime_error{"error"};
+}
+
+TEST_CASE("AsyncSlot::get", "[silkrpc][concurrency][async_slot]") {
+    boost::asio::io_context io_context;
+
+    SECTION("value") {
+        auto slot = std::make_shared<AsyncSlot<int>>(io_context.get_executor());
+        CHECK(!slot->ready());
+        slot->spawn(delayed_value(42, 1ms));
+        auto result = boost::asio::co_spawn(io_context, slot->get(), boost::asio::use_future);
+        io_context.run();
+        CHECK(result.get() == 42);
+        CHECK(slot->ready());
+        CHECK(!slot->exception());
+    }
+
+    SECTION("exception") {
+        auto slot = std::make_shared<AsyncSlot<int>>(io_context.get_executor());
+        slot->spawn(delayed_error(1ms));
+        auto result = boost::asio::co_spawn(io_context, slot->get(), boost::asio::use_future);
+        io_context.run();
+        CHECK_THROWS_AS(result.get(), std::runtime_error);
+        CHECK(slot->ready());
+        CHECK(slot->exception());
+    }
+
+    SECTION("already completed") {
+        auto slot = std::make_shared<AsyncSlot<int>>(io_context.get_executor());
+        slot->spawn(delayed_value(42, 0ms));
+        io_context.run();
+        CHECK(slot->ready());
+        io_context.restart();
+        auto result = boost::asio::co_spawn(io_context, slot->get(), boost::asio::use_future);
+        io_context.run();
+        CHECK(result.get() == 42);
+    }
+}
+
+TEST_CASE("AsyncSlot outlives its owner", "[silkrpc][concurrency][async_slot]") {
+    boost::asio::io_context io_context;
+    std::weak_ptr<AsyncSlot<int>> weak_slot;
+    {
+        auto slot = std::make_shared<AsyncSlot<int>>(io_context.get_executor());
+        slot->spawn(delayed_value(42, 1ms));
+        weak_slot = slot;
+    }
+    CHECK(!weak_slot.expired());
+    io_context.run();
+    CHECK(weak_slot.expired());
+}
+
+TEST_CASE("wait_all", "[silkrpc][concurrency][async_slot]") {
+    boost::asio::io_context io_context;
+    std::vector<std::shared_ptr<AsyncSlot<int>>> slots;
+    for (int i{0}; i < 3; ++i) {
+        auto slot = std::make_shared<AsyncSlot<int>>(io_context.get_executor());
+        slot->spawn(delayed_value(i, std::chrono::milliseconds{3 - i}));
+        slots.push_back(std::move(slot));
+    }
+
+    SECTION("completion in any order") {
+        auto result = boost::asio::co_spawn(io_context, wait_all(slots), boost::asio::use_future);
+        io_context.run();
+        CHECK_NOTHROW(result.get());
+        for (int i{0}; i < 3; ++i) {
+            CHECK(slots[i]->ready());
+            CHECK(slots[i]->value() == i);
+        }
+    }
+
+    SECTION("cancelled operations") {
+        auto result = boost::asio::co_spawn(io_context, cancel_and_wait_all(slots), boost::asio::use_future);
+        io_context.run();
+        CHECK_NOTHROW(result.get());
+        for (const auto& slot : slots) {
+            CHECK(slot->ready());
+            CHECK(slot->exception());
+        }
+    }
+}
+
+} // namespace silkrpc
@@ -0,0 +1,138 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "cancellation.hpp"
+
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+
+#include <silkworm/silkrpc/common/clock_time.hpp>
+
+namespace silkrpc {
+
+static RequestDeadlines request_deadlines_;
+
+std::ostream& operator<<(std::ostream& out, CancellationReason reason) {
+    switch (reason) {
+        case CancellationReason::none: out << "none"; break;
+        case CancellationReason::client_disconnected: out << "client disconnected"; break;
+        case CancellationReason::deadline_expired: out << "deadline expired"; break;
+    }
+    return out;
+}
+
+void Cancellation::cancel(CancellationReason reason) {
+    auto expected{CancellationReason::none};
+    if (!reason_.compare_exchange_strong(expected, reason, std::memory_order_relaxed)) {
+        return;
+    }
+    std::function<void()> on_cancel;
+    {
+        std::scoped_lock lock{on_cancel_mutex_};
+        on_cancel = std::exchange(on_cancel_, nullptr);
+    }
+    // Called without holding the lock, so that the callback itself can replace or remove the callback
+    if (on_cancel) {
+        on_cancel();
+    }
+}
+
+void Cancellation::set_on_cancel(std::function<void()> on_cancel) const {
+    std::scoped_lock lock{on_cancel_mutex_};
+    on_cancel_ = std::move(on_cancel);
+}
+
+CancellationReason Cancellation::reason() const {
+    const auto reason{reason_.load(std::memory_order_relaxed)};
+    if (reason != CancellationReason::none) {
+        return reason;
+    }
+    // The deadline expiration is not recorded, so that the deadline can be moved (e.g. for each request in a batch)
+    const auto deadline{deadline_.load(std::memory_order_relaxed)};
+    if (deadline == 0 || clock_time::now() < deadline) {
+        return CancellationReason::none;
+    }
+    return CancellationReason::deadline_expired;
+}
+
+void Cancellation::throw_if_cancelled() const {
+    const auto cancellation_reason{reason()};
+    if (cancellation_reason != CancellationReason::none) {
+        throw RequestCancelled{cancellation_reason};
+    }
+}
+
+static std::string make_cancelled_message(CancellationReason reason) {
+    std::ostringstream oss;
+    oss << "request cancelled: " << reason;
+    return oss.str();
+}
+
+RequestCancelled::RequestCancelled(CancellationReason reason) : std::runtime_error{make_cancelled_message(reason)}, reason_(reason) {}
+
+std::chrono::milliseconds RequestDeadlines::timeout(std::string_view method) const {
+    auto it = timeouts.find(method);
+    if (it == timeouts.end()) {
+        it = timeouts.find(method.substr(0, method.find('_')));
+    }
+    return std::chrono::milliseconds{it != timeouts.end() ? it->second : 0};
+}
+
+bool AbslParseFlag(absl::string_view text, RequestDeadlines* deadlines, std::string* error) {
+    RequestDeadlines parsed_deadlines;
+    if (!text.empty()) {
+        for (const auto item : absl::StrSplit(text, ',')) {
+            const std::vector<absl::string_view> name_and_timeout = absl::StrSplit(item, absl::MaxSplits(':', 1));
+            if (name_and_timeout.size() != 2 || name_and_timeout[0].empty()) {
+                *error = "invalid method or namespace in RequestDeadlines: " + std::string{item};
+                return false;
+            }
+            uint32_t timeout{0};
+            if (!absl::SimpleAtoi(name_and_timeout[1], &timeout) || timeout == 0) {
+                *error = "invalid timeout in RequestDeadlines: " + std::string{item};
+                return false;
+            }
+            parsed_deadlines.timeouts[std::string{name_and_timeout[0]}] = timeout;
+        }
+    }
+    *deadlines = std::move(parsed_deadlines);
+    return true;
+}
+
+std::string AbslUnparseFlag(const RequestDeadlines& deadlines) {
+    std::string text;
+    for (const auto& [name, timeout] : deadlines.timeouts) {
+        if (!text.empty()) {
+            text += ",";
+        }
+        text += name + ":" + std::to_string(timeout);
+    }
+    return text;
+}
+
+void set_request_deadlines(const RequestDeadlines& deadlines) {
+    request_deadlines_ = deadlines;
+}
+
+const RequestDeadlines& request_deadlines() {
+    return request_deadlines_;
+}
+
+} // namespace silkrpc
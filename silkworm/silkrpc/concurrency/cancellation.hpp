@@ -0,0 +1,114 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <absl/strings/string_view.h>
+
+namespace silkrpc {
+
+enum class CancellationReason : uint8_t {
+    none,
+    client_disconnected,
+    deadline_expired,
+};
+
+std::ostream& operator<<(std::ostream& out, CancellationReason reason);
+
+//! The cancellation state of one request, shared by all the operations working on behalf of it.
+//! Cancellation is cooperative: long-running operations check it at safe points (e.g. before each remote cursor op, before
+//! each EVM call, at each block) and stop by throwing \ref RequestCancelled, so that their resources are released by the
+//! usual error paths. Thread-safe: it can be cancelled on the I/O context and checked on the worker threads.
+class Cancellation {
+public:
+    Cancellation() = default;
+
+    Cancellation(const Cancellation&) = delete;
+    Cancellation& operator=(const Cancellation&) = delete;
+
+    //! Cancel for \p reason, unless already cancelled (the first reason wins)
+    void cancel(CancellationReason reason);
+
+    //! Consider cancelled while \ref clock_time::now is past \p deadline (in nanoseconds, zero means no deadline)
+    void set_deadline(uint64_t deadline) { deadline_.store(deadline, std::memory_order_relaxed); }
+    uint64_t deadline() const { return deadline_.load(std::memory_order_relaxed); }
+
+    //! Call \p on_cancel once on the thread calling \ref cancel, e.g. to wake a waiting operation, replacing any previous callback.
+    //! The deadline expiration is no event, so waiters must watch \ref deadline by themselves. An empty callback removes it.
+    //! Registering a callback does not change the cancellation state, so observers can do it on a const cancellation.
+    void set_on_cancel(std::function<void()> on_cancel) const;
+
+    //! The reason of the cancellation, if any, including the expiration of the deadline
+    CancellationReason reason() const;
+
+    bool cancelled() const { return reason() != CancellationReason::none; }
+
+    //! Throw \ref RequestCancelled if cancelled
+    void throw_if_cancelled() const;
+
+private:
+    std::atomic<CancellationReason> reason_{CancellationReason::none};
+    std::atomic_uint64_t deadline_{0};
+    mutable std::mutex on_cancel_mutex_;
+    mutable std::function<void()> on_cancel_;
+};
+
+//! The exception stopping the operations of a cancelled request.
+class RequestCancelled : public std::runtime_error {
+public:
+    explicit RequestCancelled(CancellationReason reason);
+
+    CancellationReason reason() const { return reason_; }
+
+private:
+    CancellationReason reason_;
+};
+
+//! Throw \ref RequestCancelled if \p cancellation is cancelled (optional, nothing to check if null)
+inline void throw_if_cancelled(const Cancellation* cancellation) {
+    if (cancellation) {
+        cancellation->throw_if_cancelled();
+    }
+}
+
+//! The max duration of requests by method or namespace, written as comma-separated <method_or_namespace>:<milliseconds>
+//! (e.g. debug:30000,trace_filter:60000). The method entry wins over the namespace entry.
+struct RequestDeadlines {
+    std::map<std::string, uint32_t, std::less<>> timeouts;
+
+    //! The max duration of requests of \p method (zero means unbounded)
+    std::chrono::milliseconds timeout(std::string_view method) const;
+};
+
+bool AbslParseFlag(absl::string_view text, RequestDeadlines* deadlines, std::string* error);
+std::string AbslUnparseFlag(const RequestDeadlines& deadlines);
+
+//! Set the request deadlines once at startup, before serving any request
+void set_request_deadlines(const RequestDeadlines& deadlines);
+const RequestDeadlines& request_deadlines();
+
+} // namespace silkrpc
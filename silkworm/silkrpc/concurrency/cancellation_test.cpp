@@ -0,0 +1,152 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "cancellation.hpp"
+
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <silkworm/silkrpc/common/clock_time.hpp>
+
+namespace silkrpc {
+
+using Catch::Matchers::Message;
+
+TEST_CASE("Cancellation::cancel", "[silkrpc][concurrency][cancellation]") {
+    SECTION("not cancelled") {
+        Cancellation cancellation;
+        CHECK(cancellation.reason() == CancellationReason::none);
+        CHECK(!cancellation.cancelled());
+        CHECK_NOTHROW(cancellation.throw_if_cancelled());
+    }
+
+    SECTION("cancelled") {
+        Cancellation cancellation;
+        cancellation.cancel(CancellationReason::client_disconnected);
+        CHECK(cancellation.reason() == CancellationReason::client_disconnected);
+        CHECK(cancellation.cancelled());
+        CHECK_THROWS_MATCHES(cancellation.throw_if_cancelled(), RequestCancelled, Message("request cancelled: client disconnected"));
+    }
+
+    SECTION("first reason wins") {
+        Cancellation cancellation;
+        cancellation.cancel(CancellationReason::deadline_expired);
+        cancellation.cancel(CancellationReason::client_disconnected);
+        CHECK(cancellation.reason() == CancellationReason::deadline_expired);
+    }
+
+    SECTION("null cancellation") {
+        CHECK_NOTHROW(throw_if_cancelled(nullptr));
+    }
+}
+
+TEST_CASE("Cancellation::set_on_cancel", "[silkrpc][concurrency][cancellation]") {
+    SECTION("called once when cancelled") {
+        Cancellation cancellation;
+        int calls{0};
+        cancellation.set_on_cancel([&]() { ++calls; });
+        CHECK(calls == 0);
+        cancellation.cancel(CancellationReason::client_disconnected);
+        cancellation.cancel(CancellationReason::deadline_expired);
+        CHECK(calls == 1);
+    }
+
+    SECTION("removed") {
+        Cancellation cancellation;
+        int calls{0};
+        cancellation.set_on_cancel([&]() { ++calls; });
+        cancellation.set_on_cancel({});
+        cancellation.cancel(CancellationReason::client_disconnected);
+        CHECK(calls == 0);
+    }
+
+    SECTION("not called on deadline expiration") {
+        Cancellation cancellation;
+        int calls{0};
+        cancellation.set_on_cancel([&]() { ++calls; });
+        cancellation.set_deadline(clock_time::now() - 1);
+        CHECK(cancellation.cancelled());
+        CHECK(calls == 0);
+    }
+}
+
+TEST_CASE("Cancellation::set_deadline", "[silkrpc][concurrency][cancellation]") {
+    SECTION("future deadline") {
+        Cancellation cancellation;
+        cancellation.set_deadline(clock_time::now() + 60'000'000'000);
+        CHECK(!cancellation.cancelled());
+    }
+
+    SECTION("past deadline") {
+        Cancellation cancellation;
+        cancellation.set_deadline(clock_time::now() - 1);
+        CHECK(cancellation.reason() == CancellationReason::deadline_expired);
+        CHECK_THROWS_AS(throw_if_cancelled(&cancellation), RequestCancelled);
+    }
+
+    SECTION("deadline moved") {
+        Cancellation cancellation;
+        cancellation.set_deadline(clock_time::now() - 1);
+        CHECK(cancellation.cancelled());
+        cancellation.set_deadline(0);
+        CHECK(!cancellation.cancelled());
+    }
+
+    SECTION("disconnection before deadline") {
+        Cancellation cancellation;
+        cancellation.cancel(CancellationReason::client_disconnected);
+        cancellation.set_deadline(clock_time::now() - 1);
+        CHECK(cancellation.reason() == CancellationReason::client_disconnected);
+    }
+}
+
+TEST_CASE("parse request deadlines", "[silkrpc][concurrency][cancellation]") {
+    SECTION("empty") {
+        RequestDeadlines deadlines;
+        std::string error;
+        CHECK(AbslParseFlag("", &deadlines, &error));
+        CHECK(deadlines.timeouts.empty());
+        CHECK(deadlines.timeout("debug_traceBlockByNumber").count() == 0);
+    }
+
+    SECTION("methods and namespaces") {
+        RequestDeadlines deadlines;
+        std::string error;
+        CHECK(AbslParseFlag("debug:30000,trace_filter:60000,trace:10000", &deadlines, &error));
+        CHECK(error.empty());
+        CHECK(deadlines.timeout("debug_traceBlockByNumber").count() == 30'000);
+        CHECK(deadlines.timeout("trace_filter").count() == 60'000);
+        CHECK(deadlines.timeout("trace_block").count() == 10'000);
+        CHECK(deadlines.timeout("eth_getLogs").count() == 0);
+    }
+
+    SECTION("invalid") {
+        for (const absl::string_view text : {"debug", ":1000", "debug:", "debug:a", "debug:-1", "debug:0"}) {
+            RequestDeadlines deadlines;
+            std::string error;
+            CHECK(!AbslParseFlag(text, &deadlines, &error));
+            CHECK(!error.empty());
+        }
+    }
+}
+
+TEST_CASE("unparse request deadlines", "[silkrpc][concurrency][cancellation]") {
+    CHECK(AbslUnparseFlag(RequestDeadlines{}).empty());
+    CHECK(AbslUnparseFlag(RequestDeadlines{{{"trace_filter", 60'000}, {"debug", 30'000}}}) == "debug:30000,trace_filter:60000");
+}
+
+} // namespace silkrpc
@@ -39,16 +39,21 @@ Context::Context(
     ChannelFactory create_channel,
     std::shared_ptr<BlockCache> block_cache,
     std::shared_ptr<ethdb::kv::StateCache> state_cache,
+    ExecutionCaches caches,
     std::shared_ptr<mdbx::env_managed> chaindata_env,
-    WaitMode wait_mode)
+    WaitMode wait_mode,
+    CoreSet core_set)
     : io_context_{std::make_shared<boost::asio::io_context>()},
       io_context_work_{boost::asio::make_work_guard(*io_context_)},
       grpc_context_{std::make_unique<agrpc::GrpcContext>(std::make_unique<grpc::CompletionQueue>())},
       grpc_context_work_{boost::asio::make_work_guard(grpc_context_->get_executor())},
       block_cache_(block_cache),
       state_cache_(state_cache),
+      caches_(std::move(caches)),
       chaindata_env_(chaindata_env),
-      wait_mode_(wait_mode) {
+      wait_mode_(wait_mode),
+      load_{std::make_unique<ContextLoad>()},
+      core_set_{std::move(core_set)} {
     std::shared_ptr<grpc::Channel> channel = create_channel();
     if (chaindata_env) {
         database_ = std::make_unique<ethdb::file::LocalDatabase>(chaindata_env);
@@ -80,6 +85,7 @@ void Context::execute_loop_single_threaded(WaitStrategy&& wait_strategy) {
 void Context::execute_loop_multi_threaded() {
     SILKRPC_DEBUG << "Multi-thread execution loop start [" << this << "]\n";
     std::thread grpc_context_thread{[&]() {
+        pin_current_thread(core_set_);
         grpc_context_->run_completion_queue();
     }};
     io_context_->run();
@@ -118,7 +124,8 @@ void Context::stop() {
     SILKRPC_DEBUG << "Context::stop io_context " << io_context_ << " [" << this << "]\n";
 }
 
-ContextPool::ContextPool(std::size_t pool_size, ChannelFactory create_channel, std::optional<std::string> datadir, WaitMode wait_mode) : next_index_{0} {
+ContextPool::ContextPool(std::size_t pool_size, ChannelFactory create_channel, std::optional<std::string> datadir, WaitMode wait_mode,
+    const CoreSet& context_cores) : next_index_{0} {
     if (pool_size == 0) {
         throw std::logic_error("ContextPool::ContextPool pool_size is 0");
     }
@@ -144,10 +151,24 @@ ContextPool::ContextPool(std::size_t pool_size, ChannelFactory create_channel, s
     // Create the unique state cache to be shared among the execution contexts
     auto state_cache = std::make_shared<ethdb::kv::CoherentStateCache>();
 
+    // Create the unique execution caches to be shared among the execution contexts
+    const auto caches = make_execution_caches();
+
+    // Split the context cores (if any) into adjacent subsets, one for each context
+    const auto context_core_sets = context_cores.split(pool_size);
+    if (!context_core_sets.empty()) {
+        // Create one channel before pinning, so that the gRPC library threads started on first use keep the process affinity
+        create_channel();
+    }
+
     // Create as many execution contexts as required by the pool size
+    contexts_.reserve(pool_size);
     for (std::size_t i{0}; i < pool_size; ++i) {
-        contexts_.emplace_back(Context{create_channel, block_cache, state_cache, chain_env, wait_mode});
-        SILKRPC_DEBUG << "ContextPool::ContextPool context[" << i << "] " << contexts_[i] << "\n";
+        const auto core_set = context_core_sets.empty() ? CoreSet{} : context_core_sets[i];
+        // Build each context on its own cores, so that its memory is first touched (i.e. allocated) on the local NUMA node
+        ScopedCpuAffinity affinity{core_set};
+        contexts_.emplace_back(Context{create_channel, block_cache, state_cache, caches, chain_env, wait_mode, core_set});
+        SILKRPC_DEBUG << "ContextPool::ContextPool context[" << i << "] " << contexts_[i] << " cores: " << core_set << "\n";
     }
 }
 
@@ -168,6 +189,7 @@ void ContextPool::start() {
     for (std::size_t i{0}; i < contexts_.size(); ++i) {
         auto& context = contexts_[i];
         context_threads_.create_thread([&, i = i]() {
+            pin_current_thread(context.core_set());
             SILKRPC_DEBUG << "Thread start context[" << i << "] thread_id: " << std::this_thread::get_id() << "\n";
             context.execute_loop();
             SILKRPC_DEBUG << "Thread end context[" << i << "] thread_id: " << std::this_thread::get_id() << "\n";
@@ -209,7 +231,7 @@ void ContextPool::run() {
 Context& ContextPool::next_context() {
     // Use a round-robin scheme to choose the next context to use
     auto& context = contexts_[next_index_];
-    next_index_ = ++next_index_ % contexts_.size();
+    next_index_ = ++next_index_ % num_shared_contexts();
     return context;
 }
 
@@ -218,4 +240,29 @@ boost::asio::io_context& ContextPool::next_io_context() {
     return *client_context.io_context();
 }
 
+Context& ContextPool::least_loaded_context() {
+    // Rotate the starting point, otherwise the first context would win every tie
+    const auto num_contexts = num_shared_contexts();
+    const auto start_index = next_least_loaded_index_.fetch_add(1, std::memory_order_relaxed) % num_contexts;
+    std::size_t least_loaded_index = start_index;
+    for (std::size_t i{1}; i < num_contexts; ++i) {
+        const auto index = (start_index + i) % num_contexts;
+        if (contexts_[index].load() < contexts_[least_loaded_index].load()) {
+            least_loaded_index = index;
+        }
+    }
+    return contexts_[least_loaded_index];
+}
+
+Context& ContextPool::reserve_context() {
+    if (num_shared_contexts() < 2) {
+        throw std::logic_error("ContextPool::reserve_context cannot reserve the last shared context");
+    }
+    ++num_reserved_contexts_;
+    next_index_ %= num_shared_contexts();
+    auto& context = contexts_[num_shared_contexts()];
+    SILKRPC_DEBUG << "ContextPool::reserve_context context[" << num_shared_contexts() << "] " << context << "\n";
+    return context;
+}
+
 } // namespace silkrpc
@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <list>
@@ -31,7 +33,9 @@
 
 #include <silkworm/silkrpc/common/block_cache.hpp>
 #include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/concurrency/cpu_affinity.hpp>
 #include <silkworm/silkrpc/concurrency/wait_strategy.hpp>
+#include <silkworm/silkrpc/core/execution_caches.hpp>
 #include <silkworm/silkrpc/ethbackend/backend.hpp>
 #include <silkworm/silkrpc/ethdb/database.hpp>
 #include <silkworm/silkrpc/ethdb/kv/state_cache.hpp>
@@ -42,6 +46,35 @@ namespace silkrpc {
 
 using ChannelFactory = std::function<std::shared_ptr<grpc::Channel>()>;
 
+//! Load of one execution context, i.e. the client connections bound to it and the requests they are running.
+struct ContextLoad {
+    std::atomic_int64_t connections{0};
+    std::atomic_int64_t requests{0};
+
+    //! Compare loads by in-flight requests first, because idle keep-alive connections cost nothing
+    bool operator<(const ContextLoad& other) const noexcept {
+        const auto lhs_requests{requests.load(std::memory_order_relaxed)};
+        const auto rhs_requests{other.requests.load(std::memory_order_relaxed)};
+        if (lhs_requests != rhs_requests) {
+            return lhs_requests < rhs_requests;
+        }
+        return connections.load(std::memory_order_relaxed) < other.connections.load(std::memory_order_relaxed);
+    }
+};
+
+//! Scoped increment of one ContextLoad counter.
+class ContextLoadScope {
+  public:
+    explicit ContextLoadScope(std::atomic_int64_t& counter) noexcept : counter_(counter) { counter_.fetch_add(1, std::memory_order_relaxed); }
+    ~ContextLoadScope() { counter_.fetch_sub(1, std::memory_order_relaxed); }
+
+    ContextLoadScope(const ContextLoadScope&) = delete;
+    ContextLoadScope& operator=(const ContextLoadScope&) = delete;
+
+  private:
+    std::atomic_int64_t& counter_;
+};
+
 //! Asynchronous client scheduler running an execution loop.
 class Context {
   public:
@@ -49,8 +82,10 @@ class Context {
         ChannelFactory create_channel,
         std::shared_ptr<BlockCache> block_cache,
         std::shared_ptr<ethdb::kv::StateCache> state_cache,
+        ExecutionCaches caches,
         std::shared_ptr<mdbx::env_managed> chaindata_env = {},
-        WaitMode wait_mode = WaitMode::blocking);
+        WaitMode wait_mode = WaitMode::blocking,
+        CoreSet core_set = {});
 
     boost::asio::io_context* io_context() const noexcept { return io_context_.get(); }
     grpc::CompletionQueue* grpc_queue() const noexcept { return grpc_context_->get_completion_queue(); }
@@ -61,6 +96,15 @@ class Context {
     std::unique_ptr<txpool::TransactionPool>& tx_pool() noexcept { return tx_pool_; }
     std::shared_ptr<BlockCache>& block_cache() noexcept { return block_cache_; }
     std::shared_ptr<ethdb::kv::StateCache>& state_cache() noexcept { return state_cache_; }
+    const ExecutionCaches& caches() const noexcept { return caches_; }
+    std::shared_ptr<ethdb::HistoryCache>& history_cache() noexcept { return caches_.history; }
+    std::shared_ptr<state::StateSnapshotCache>& snapshot_cache() noexcept { return caches_.snapshot; }
+    std::shared_ptr<state::StateCheckpointCache>& checkpoint_cache() noexcept { return caches_.checkpoint; }
+    std::shared_ptr<core::ChainConfigCache>& chain_config_cache() noexcept { return caches_.chain_config; }
+    std::shared_ptr<state::CallFootprintCache>& footprint_cache() noexcept { return caches_.footprint; }
+    std::shared_ptr<trace::TraceCache>& trace_cache() noexcept { return caches_.trace; }
+    ContextLoad& load() const noexcept { return *load_; }
+    const CoreSet& core_set() const noexcept { return core_set_; }
 
     //! Execute the scheduler loop until stopped.
     void execute_loop();
@@ -95,8 +139,12 @@ class Context {
     std::unique_ptr<txpool::TransactionPool> tx_pool_;
     std::shared_ptr<BlockCache> block_cache_;
     std::shared_ptr<ethdb::kv::StateCache> state_cache_;
+    ExecutionCaches caches_;
     std::shared_ptr<mdbx::env_managed> chaindata_env_;
     WaitMode wait_mode_;
+    std::unique_ptr<ContextLoad> load_;
+    //! The cores where the execution loop threads run (empty means unpinned)
+    CoreSet core_set_;
 };
 
 std::ostream& operator<<(std::ostream& out, Context& c);
@@ -105,7 +153,9 @@ std::ostream& operator<<(std::ostream& out, Context& c);
 // [currently cannot start/stop more than once because grpc::CompletionQueue cannot be used after shutdown]
 class ContextPool {
 public:
-    explicit ContextPool(std::size_t pool_size, ChannelFactory create_channel, std::optional<std::string> datadir = {}, WaitMode wait_mode = WaitMode::blocking);
+    //! Create \p pool_size contexts, each one pinned to a subset of \p context_cores if not empty
+    explicit ContextPool(std::size_t pool_size, ChannelFactory create_channel, std::optional<std::string> datadir = {}, WaitMode wait_mode = WaitMode::blocking,
+        const CoreSet& context_cores = {});
     ~ContextPool();
 
     ContextPool(const ContextPool&) = delete;
@@ -119,10 +169,24 @@ public:
 
     void run();
 
+    //! Return the next context in round-robin order, skipping reserved contexts.
     Context& next_context();
 
     boost::asio::io_context& next_io_context();
 
+    //! Return the context at \p index without affecting the round-robin order, reserved contexts being the last ones
+    Context& context(std::size_t index) { return contexts_.at(index); }
+
+    //! Return the context having the lowest load, ties broken round-robin and reserved contexts excluded. Safe to call from any thread.
+    Context& least_loaded_context();
+
+    //! Reserve the last unreserved context for exclusive use (e.g. a high-priority lane) and return it. Call before start.
+    //! At least one context always stays unreserved.
+    Context& reserve_context();
+
+    //! The number of contexts available for shared use, i.e. not reserved
+    std::size_t num_shared_contexts() const noexcept { return contexts_.size() - num_reserved_contexts_; }
+
 private:
     // The pool of contexts
     std::vector<Context> contexts_;
@@ -133,6 +197,12 @@ private:
     // The next index to use for a context
     std::size_t next_index_;
 
+    // The first index to check when looking for the least loaded context
+    std::atomic_size_t next_least_loaded_index_{0};
+
+    // The number of contexts reserved for exclusive use, taken from the end of the pool
+    std::size_t num_reserved_contexts_{0};
+
     //! Flag indicating if pool has been stopped.
     bool stopped_{false};
 };
@@ -39,22 +39,29 @@ TEST_CASE("Context", "[silkrpc][context_pool]") {
 
     auto block_cache = std::make_shared<BlockCache>();
     auto state_cache = std::make_shared<ethdb::kv::CoherentStateCache>();
+    auto caches = make_execution_caches();
 
     WaitMode all_wait_modes[] = {
         WaitMode::backoff, WaitMode::blocking, WaitMode::sleeping, WaitMode::yielding, WaitMode::spin_wait, WaitMode::busy_spin
     };
     for (auto wait_mode : all_wait_modes) {
         SECTION(std::string("Context::Context wait_mode=") + std::to_string(static_cast<int>(wait_mode))) {
-            Context context{create_channel, block_cache, state_cache, {}, wait_mode};
+            Context context{create_channel, block_cache, state_cache, caches, {}, wait_mode};
             CHECK_NOTHROW(context.io_context() != nullptr);
             CHECK_NOTHROW(context.grpc_context() != nullptr);
             CHECK_NOTHROW(context.backend() != nullptr);
             CHECK_NOTHROW(context.miner() != nullptr);
             CHECK_NOTHROW(context.block_cache() != nullptr);
+            CHECK_NOTHROW(context.history_cache() != nullptr);
+            CHECK_NOTHROW(context.snapshot_cache() != nullptr);
+            CHECK_NOTHROW(context.checkpoint_cache() != nullptr);
+            CHECK_NOTHROW(context.chain_config_cache() != nullptr);
+            CHECK_NOTHROW(context.footprint_cache() != nullptr);
+            CHECK_NOTHROW(context.trace_cache() != nullptr);
         }
 
         SECTION(std::string("Context::execute_loop wait_mode=") + std::to_string(static_cast<int>(wait_mode))) {
-            Context context{create_channel, block_cache, state_cache,  /* env */{}, wait_mode};
+            Context context{create_channel, block_cache, state_cache, caches, /* env */{}, wait_mode};
             std::atomic_bool processed{false};
             auto* io_context = context.io_context();
             boost::asio::post(*io_context, [&]() {
@@ -67,7 +74,7 @@ TEST_CASE("Context", "[silkrpc][context_pool]") {
         }
 
         SECTION(std::string("Context::stop wait_mode=") + std::to_string(static_cast<int>(wait_mode))) {
-            Context context{create_channel, block_cache, state_cache, /* env */{}, wait_mode};
+            Context context{create_channel, block_cache, state_cache, caches, /* env */{}, wait_mode};
             std::atomic_bool processed{false};
             auto* io_context = context.io_context();
             boost::asio::post(*io_context, [&]() {
@@ -84,7 +91,8 @@ TEST_CASE("Context with chain_env", "[silkrpc][context_pool]") {
       std::shared_ptr<mdbx::env_managed> chain_env = std::make_shared<mdbx::env_managed>();
       auto block_cache = std::make_shared<BlockCache>();
       auto state_cache = std::make_shared<ethdb::kv::CoherentStateCache>();
-      Context context{create_channel, block_cache, state_cache, chain_env};
+      auto caches = make_execution_caches();
+      Context context{create_channel, block_cache, state_cache, caches, chain_env};
       std::atomic_bool processed{false};
       auto* io_context = context.io_context();
       boost::asio::post(*io_context, [&]() {
@@ -137,6 +145,86 @@ TEST_CASE("create context pool", "[silkrpc][context_pool]") {
     }
 }
 
+TEST_CASE("reserve context", "[silkrpc][context_pool]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    SECTION("cannot reserve the only context") {
+        ContextPool cp{1, create_channel};
+        CHECK_THROWS_AS(cp.reserve_context(), std::logic_error);
+    }
+
+    SECTION("reserved context excluded from placement") {
+        ContextPool cp{3, create_channel};
+        auto& reserved = cp.reserve_context();
+        CHECK(cp.num_shared_contexts() == 2);
+        for (int i{0}; i < 4; ++i) {
+            CHECK(&cp.next_context() != &reserved);
+            CHECK(&cp.least_loaded_context() != &reserved);
+        }
+        CHECK(&cp.reserve_context() != &reserved);
+        CHECK_THROWS_AS(cp.reserve_context(), std::logic_error);
+    }
+}
+
+TEST_CASE("pinned context pool", "[silkrpc][context_pool]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    SECTION("unpinned by default") {
+        ContextPool cp{2, create_channel};
+        CHECK(cp.next_context().core_set().empty());
+        CHECK(cp.next_context().core_set().empty());
+    }
+
+    SECTION("one core subset per context") {
+        ContextPool cp{2, create_channel, {}, WaitMode::blocking, CoreSet{{0, 1, 2, 3}}};
+        CHECK(cp.next_context().core_set() == CoreSet{{0, 1}});
+        CHECK(cp.next_context().core_set() == CoreSet{{2, 3}});
+    }
+}
+
+TEST_CASE("least loaded context", "[silkrpc][context_pool]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    ContextPool cp{3, create_channel};
+    auto& context1 = cp.next_context();
+    auto& context2 = cp.next_context();
+    auto& context3 = cp.next_context();
+
+    SECTION("ties broken round-robin") {
+        const auto& least_loaded1 = cp.least_loaded_context();
+        const auto& least_loaded2 = cp.least_loaded_context();
+        const auto& least_loaded3 = cp.least_loaded_context();
+        CHECK(&least_loaded1 != &least_loaded2);
+        CHECK(&least_loaded2 != &least_loaded3);
+        CHECK(&least_loaded1 != &least_loaded3);
+    }
+
+    SECTION("fewest in-flight requests") {
+        ContextLoadScope request1{context1.load().requests};
+        ContextLoadScope request3{context3.load().requests};
+        ContextLoadScope connection2{context2.load().connections};
+        CHECK(&cp.least_loaded_context() == &context2);
+        CHECK(&cp.least_loaded_context() == &context2);
+        CHECK(&cp.least_loaded_context() == &context2);
+    }
+
+    SECTION("fewest connections on same requests") {
+        ContextLoadScope connection1{context1.load().connections};
+        ContextLoadScope connection2{context2.load().connections};
+        CHECK(&cp.least_loaded_context() == &context3);
+        CHECK(&cp.least_loaded_context() == &context3);
+        CHECK(&cp.least_loaded_context() == &context3);
+    }
+
+    SECTION("load released at scope end") {
+        {
+            ContextLoadScope request1{context1.load().requests};
+            CHECK(context1.load().requests == 1);
+        }
+        CHECK(context1.load().requests == 0);
+    }
+}
+
 TEST_CASE("start context pool", "[silkrpc][context_pool]") {
     SILKRPC_LOG_VERBOSITY(LogLevel::None);
 
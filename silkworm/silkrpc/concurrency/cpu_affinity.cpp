@@ -0,0 +1,190 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "cpu_affinity.hpp"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <latch>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+#include <boost/asio/post.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+
+namespace silkrpc {
+
+//! The max number of logical cores that can be named in a core set
+constexpr uint32_t kMaxCpuCores{1024};
+
+CoreSet::CoreSet(std::vector<uint32_t> cores) : cores_(std::move(cores)) {
+    std::sort(cores_.begin(), cores_.end());
+    cores_.erase(std::unique(cores_.begin(), cores_.end()), cores_.end());
+}
+
+bool CoreSet::overlaps(const CoreSet& other) const {
+    return std::any_of(cores_.cbegin(), cores_.cend(), [&](auto core) {
+        return std::binary_search(other.cores_.cbegin(), other.cores_.cend(), core);
+    });
+}
+
+std::vector<CoreSet> CoreSet::split(std::size_t count) const {
+    std::vector<CoreSet> core_sets;
+    if (cores_.empty() || count == 0) {
+        return core_sets;
+    }
+    core_sets.reserve(count);
+    for (std::size_t i{0}; i < count; ++i) {
+        if (cores_.size() < count) {
+            core_sets.emplace_back(std::vector<uint32_t>{cores_[i % cores_.size()]});
+        } else {
+            const auto begin = cores_.cbegin() + static_cast<std::ptrdiff_t>(i * cores_.size() / count);
+            const auto end = cores_.cbegin() + static_cast<std::ptrdiff_t>((i + 1) * cores_.size() / count);
+            core_sets.emplace_back(std::vector<uint32_t>{begin, end});
+        }
+    }
+    return core_sets;
+}
+
+std::ostream& operator<<(std::ostream& out, const CoreSet& core_set) {
+    out << AbslUnparseFlag(core_set);
+    return out;
+}
+
+bool AbslParseFlag(absl::string_view text, CoreSet* core_set, std::string* error) {
+    std::vector<uint32_t> cores;
+    if (!text.empty()) {
+        for (const auto range : absl::StrSplit(text, ',')) {
+            const std::vector<absl::string_view> bounds = absl::StrSplit(range, absl::MaxSplits('-', 1));
+            uint32_t first{0}, last{0};
+            if (!absl::SimpleAtoi(bounds[0], &first) || !absl::SimpleAtoi(bounds.size() > 1 ? bounds[1] : bounds[0], &last)) {
+                *error = "invalid core range in CoreSet: " + std::string{range};
+                return false;
+            }
+            if (first > last || last >= kMaxCpuCores) {
+                *error = "out of order or too high core range in CoreSet: " + std::string{range};
+                return false;
+            }
+            for (auto core{first}; core <= last; ++core) {
+                cores.push_back(core);
+            }
+        }
+    }
+    *core_set = CoreSet{std::move(cores)};
+    return true;
+}
+
+std::string AbslUnparseFlag(const CoreSet& core_set) {
+    std::ostringstream text;
+    const auto& cores = core_set.cores();
+    for (std::size_t i{0}; i < cores.size();) {
+        // Collapse each run of consecutive cores into one range
+        std::size_t j{i};
+        while (j + 1 < cores.size() && cores[j + 1] == cores[j] + 1) {
+            ++j;
+        }
+        text << (i > 0 ? "," : "") << cores[i];
+        if (j > i) {
+            text << "-" << cores[j];
+        }
+        i = j + 1;
+    }
+    return text.str();
+}
+
+#ifdef __linux__
+bool pin_current_thread(const CoreSet& core_set) {
+    if (core_set.empty()) {
+        return false;
+    }
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (const auto core : core_set.cores()) {
+        if (core >= CPU_SETSIZE) {
+            return false;
+        }
+        CPU_SET(core, &cpu_set);
+    }
+    const auto result = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+    if (result != 0) {
+        SILKRPC_WARN << "pin_current_thread cannot pin to cores " << core_set << " error: " << result << "\n";
+        return false;
+    }
+    return true;
+}
+
+CoreSet current_thread_affinity() {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0) {
+        return {};
+    }
+    std::vector<uint32_t> cores;
+    for (uint32_t core{0}; core < CPU_SETSIZE; ++core) {
+        if (CPU_ISSET(core, &cpu_set)) {
+            cores.push_back(core);
+        }
+    }
+    return CoreSet{std::move(cores)};
+}
+#else
+bool pin_current_thread(const CoreSet& /*core_set*/) {
+    return false;
+}
+
+CoreSet current_thread_affinity() {
+    return {};
+}
+#endif
+
+ScopedCpuAffinity::ScopedCpuAffinity(const CoreSet& core_set) {
+    if (!core_set.empty()) {
+        previous_core_set_ = current_thread_affinity();
+        pin_current_thread(core_set);
+    }
+}
+
+ScopedCpuAffinity::~ScopedCpuAffinity() {
+    if (!previous_core_set_.empty()) {
+        pin_current_thread(previous_core_set_);
+    }
+}
+
+void pin_thread_pool(boost::asio::thread_pool& pool, std::size_t num_threads, const CoreSet& core_set) {
+    if (core_set.empty() || num_threads == 0) {
+        return;
+    }
+    // Each task holds its thread until all tasks have started, so every pool thread runs exactly one of them
+    auto all_pinned = std::make_shared<std::latch>(static_cast<std::ptrdiff_t>(num_threads + 1));
+    for (std::size_t i{0}; i < num_threads; ++i) {
+        boost::asio::post(pool, [all_pinned, core_set]() {
+            pin_current_thread(core_set);
+            all_pinned->arrive_and_wait();
+        });
+    }
+    all_pinned->arrive_and_wait();
+    SILKRPC_DEBUG << "pin_thread_pool pinned " << num_threads << " threads to cores " << core_set << "\n";
+}
+
+} // namespace silkrpc
@@ -0,0 +1,80 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <absl/strings/string_view.h>
+#include <boost/asio/thread_pool.hpp>
+
+namespace silkrpc {
+
+//! Set of logical CPU cores, written as a Linux cpulist (e.g. 0-7,16-23). Empty means no placement constraint.
+class CoreSet {
+  public:
+    CoreSet() = default;
+    explicit CoreSet(std::vector<uint32_t> cores);
+
+    const std::vector<uint32_t>& cores() const noexcept { return cores_; }
+    bool empty() const noexcept { return cores_.empty(); }
+    std::size_t size() const noexcept { return cores_.size(); }
+
+    bool overlaps(const CoreSet& other) const;
+
+    //! Split into \p count sets of adjacent cores (i.e. one per context), sharing cores round-robin if there are not enough
+    std::vector<CoreSet> split(std::size_t count) const;
+
+    bool operator==(const CoreSet& other) const = default;
+
+  private:
+    //! The sorted unique core indexes
+    std::vector<uint32_t> cores_;
+};
+
+std::ostream& operator<<(std::ostream& out, const CoreSet& core_set);
+
+bool AbslParseFlag(absl::string_view text, CoreSet* core_set, std::string* error);
+std::string AbslUnparseFlag(const CoreSet& core_set);
+
+//! Restrict the calling thread to \p core_set. Return false if unsupported on this platform or if the cores are not available
+bool pin_current_thread(const CoreSet& core_set);
+
+//! Return the cores the calling thread is allowed to run on, empty if unsupported on this platform
+CoreSet current_thread_affinity();
+
+//! Pin the calling thread to the given cores until the end of scope, then restore its previous affinity.
+//! Pages first touched within the scope are allocated on the NUMA node local to the cores (Linux default memory policy).
+class ScopedCpuAffinity {
+  public:
+    explicit ScopedCpuAffinity(const CoreSet& core_set);
+    ~ScopedCpuAffinity();
+
+    ScopedCpuAffinity(const ScopedCpuAffinity&) = delete;
+    ScopedCpuAffinity& operator=(const ScopedCpuAffinity&) = delete;
+
+  private:
+    CoreSet previous_core_set_;
+};
+
+//! Pin each of the \p num_threads threads in \p pool to \p core_set, blocking until all of them are pinned
+void pin_thread_pool(boost::asio::thread_pool& pool, std::size_t num_threads, const CoreSet& core_set);
+
+} // namespace silkrpc
@@ -0,0 +1,128 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "cpu_affinity.hpp"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <catch2/catch.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+
+namespace silkrpc {
+
+TEST_CASE("parse core set", "[silkrpc][concurrency][cpu_affinity]") {
+    SECTION("empty") {
+        CoreSet core_set{std::vector<uint32_t>{1}};
+        std::string error;
+        CHECK(AbslParseFlag("", &core_set, &error));
+        CHECK(core_set.empty());
+    }
+
+    SECTION("single cores and ranges") {
+        CoreSet core_set;
+        std::string error;
+        CHECK(AbslParseFlag("16-18,2,0-1,17", &core_set, &error));
+        CHECK(error.empty());
+        CHECK(core_set.cores() == std::vector<uint32_t>{0, 1, 2, 16, 17, 18});
+    }
+
+    SECTION("invalid") {
+        for (const absl::string_view text : {"a", "1-", "-1", "3-1", "1,,2", "0-100000"}) {
+            CoreSet core_set;
+            std::string error;
+            CHECK(!AbslParseFlag(text, &core_set, &error));
+            CHECK(!error.empty());
+        }
+    }
+}
+
+TEST_CASE("unparse core set", "[silkrpc][concurrency][cpu_affinity]") {
+    CHECK(AbslUnparseFlag(CoreSet{}).empty());
+    CHECK(AbslUnparseFlag(CoreSet{{5}}) == "5");
+    CHECK(AbslUnparseFlag(CoreSet{{0, 1, 2, 3, 8, 10, 11}}) == "0-3,8,10-11");
+}
+
+TEST_CASE("CoreSet::overlaps", "[silkrpc][concurrency][cpu_affinity]") {
+    const CoreSet core_set{{0, 1, 2, 3}};
+    CHECK(core_set.overlaps(CoreSet{{3, 4}}));
+    CHECK(!core_set.overlaps(CoreSet{{4, 5}}));
+    CHECK(!core_set.overlaps(CoreSet{}));
+}
+
+TEST_CASE("CoreSet::split", "[silkrpc][concurrency][cpu_affinity]") {
+    SECTION("empty") {
+        CHECK(CoreSet{}.split(4).empty());
+    }
+
+    SECTION("adjacent cores") {
+        const auto core_sets = CoreSet{{0, 1, 2, 3, 4, 5, 6}}.split(3);
+        REQUIRE(core_sets.size() == 3);
+        CHECK(core_sets[0] == CoreSet{{0, 1}});
+        CHECK(core_sets[1] == CoreSet{{2, 3}});
+        CHECK(core_sets[2] == CoreSet{{4, 5, 6}});
+    }
+
+    SECTION("not enough cores") {
+        const auto core_sets = CoreSet{{8, 9}}.split(3);
+        REQUIRE(core_sets.size() == 3);
+        CHECK(core_sets[0] == CoreSet{{8}});
+        CHECK(core_sets[1] == CoreSet{{9}});
+        CHECK(core_sets[2] == CoreSet{{8}});
+    }
+}
+
+#ifdef __linux__
+TEST_CASE("ScopedCpuAffinity", "[silkrpc][concurrency][cpu_affinity]") {
+    const auto initial_core_set = current_thread_affinity();
+    REQUIRE(!initial_core_set.empty());
+    const CoreSet first_core_set{{initial_core_set.cores().front()}};
+    {
+        ScopedCpuAffinity affinity{first_core_set};
+        CHECK(current_thread_affinity() == first_core_set);
+    }
+    CHECK(current_thread_affinity() == initial_core_set);
+}
+
+TEST_CASE("pin thread pool", "[silkrpc][concurrency][cpu_affinity]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    const auto initial_core_set = current_thread_affinity();
+    REQUIRE(!initial_core_set.empty());
+    const CoreSet first_core_set{{initial_core_set.cores().front()}};
+    constexpr std::size_t kNumThreads{4};
+    boost::asio::thread_pool pool{kNumThreads};
+    pin_thread_pool(pool, kNumThreads, first_core_set);
+
+    std::atomic_int pinned_count{0};
+    for (std::size_t i{0}; i < 2 * kNumThreads; ++i) {
+        boost::asio::post(pool, [&]() {
+            if (current_thread_affinity() == first_core_set) {
+                ++pinned_count;
+            }
+        });
+    }
+    pool.join();
+    CHECK(pinned_count == 2 * kNumThreads);
+    CHECK(current_thread_affinity() == initial_core_set);
+}
+#endif
+
+} // namespace silkrpc
@@ -63,4 +63,12 @@ std::string AbslUnparseFlag(WaitMode wait_mode) {
     }
 }
 
+std::ostream& operator<<(std::ostream& out, IoBackend io_backend) {
+    switch (io_backend) {
+        case IoBackend::reactor: out << "reactor"; break;
+        case IoBackend::io_uring: out << "io_uring"; break;
+    }
+    return out;
+}
+
 } // namespace silkrpc
@@ -39,6 +39,7 @@
 #include <chrono>
 #include <limits>
 #include <memory>
+#include <ostream>
 #include <string>
 #include <thread>
 
@@ -159,5 +160,20 @@ enum class WaitMode {
 bool AbslParseFlag(absl::string_view text, WaitMode* wait_mode, std::string* error);
 std::string AbslUnparseFlag(WaitMode wait_mode);
 
+//! The backend performing the socket I/O of all the contexts. Asio selects it at build time for the whole binary, so it is
+//! orthogonal to the wait mode: e.g. blocking contexts wait for io_uring completions instead of epoll readiness.
+enum class IoBackend {
+    reactor,    /* Readiness notification (epoll, kqueue) followed by one syscall for each read or write */
+    io_uring    /* Operations submitted and completed in batches through the io_uring rings (SILKRPC_USE_IO_URING builds) */
+};
+
+#if defined(BOOST_ASIO_HAS_IO_URING) && defined(BOOST_ASIO_DISABLE_EPOLL)
+constexpr IoBackend kIoBackend{IoBackend::io_uring};
+#else
+constexpr IoBackend kIoBackend{IoBackend::reactor};
+#endif
+
+std::ostream& operator<<(std::ostream& out, IoBackend io_backend);
+
 } // namespace silkrpc
 
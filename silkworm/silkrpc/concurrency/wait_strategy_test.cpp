@@ -17,6 +17,7 @@
 #include "wait_strategy.hpp"
 
 #include <atomic>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -81,6 +82,14 @@ TEST_CASE("unparse wait mode", "[silkrpc][common][log]") {
     }
 }
 
+TEST_CASE("print io backend", "[silkrpc][concurrency][wait_strategy]") {
+    std::ostringstream reactor_out, io_uring_out;
+    reactor_out << IoBackend::reactor;
+    io_uring_out << IoBackend::io_uring;
+    CHECK(reactor_out.str() == "reactor");
+    CHECK(io_uring_out.str() == "io_uring");
+}
+
 template<typename W, typename R, typename P>
 inline void sleep_then_check_wait(W& w, const std::chrono::duration<R, P>& t, uint32_t executed_count) {
     std::this_thread::sleep_for(t);
@@ -0,0 +1,127 @@
+/*
+    Copyright 2022 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "call_footprint_cache.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace silkrpc::state {
+
+//! The size of function selector in call input data
+constexpr std::size_t kSelectorSize{4};
+
+CallFootprintCache::CallFootprintCache(std::size_t capacity) : capacity_(capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument{"unexpected zero capacity"};
+    }
+}
+
+std::shared_ptr<const AccessList> CallFootprintCache::find(const evmc::address& contract, silkworm::ByteView input) {
+    const auto key{make_key(contract, input)};
+
+    std::scoped_lock lock{access_};
+
+    const auto it = entries_.find(key);
+    if (it == entries_.end() || !it->second.footprint) {
+        miss_count_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    lru_keys_.splice(lru_keys_.begin(), lru_keys_, it->second.lru_position);
+    hit_count_.fetch_add(1, std::memory_order_relaxed);
+    return it->second.footprint;
+}
+
+void CallFootprintCache::insert(const evmc::address& contract, silkworm::ByteView input, AccessList footprint) {
+    if (footprint.empty()) {
+        return;
+    }
+    std::size_t storage_key_count{0};
+    for (auto& entry : footprint) {
+        const auto kept_count{std::min(entry.storage_keys.size(), kMaxCallFootprintStorageKeys - storage_key_count)};
+        entry.storage_keys.resize(kept_count);
+        storage_key_count += kept_count;
+    }
+    const auto arguments{input.substr(std::min(input.size(), kSelectorSize))};
+    const auto arguments_hash{std::hash<std::string_view>{}({reinterpret_cast<const char*>(arguments.data()), arguments.size()})};
+    auto key{make_key(contract, input)};
+
+    std::scoped_lock lock{access_};
+
+    auto [it, inserted] = entries_.try_emplace(std::move(key));
+    auto& entry = it->second;
+    if (arguments.empty()) {
+        entry.footprint = std::make_shared<const AccessList>(std::move(footprint));
+    } else {
+        if (!inserted && arguments_hash != entry.last_arguments_hash) {
+            // Keep just what is read whatever the arguments are, i.e. drop accounts and storage keys derived from call data
+            entry.footprint = std::make_shared<const AccessList>(intersect(entry.last_footprint, footprint));
+        }
+        entry.last_footprint = std::move(footprint);
+        entry.last_arguments_hash = arguments_hash;
+    }
+    if (inserted) {
+        entry.lru_position = lru_keys_.insert(lru_keys_.begin(), it->first);
+    } else {
+        lru_keys_.splice(lru_keys_.begin(), lru_keys_, entry.lru_position);
+    }
+
+    while (entries_.size() > capacity_) {
+        const auto lru_it = entries_.find(lru_keys_.back());
+        lru_keys_.pop_back();
+        entries_.erase(lru_it);
+        eviction_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::size_t CallFootprintCache::size() const {
+    std::scoped_lock lock{access_};
+    return entries_.size();
+}
+
+silkworm::Bytes CallFootprintCache::make_key(const evmc::address& contract, silkworm::ByteView input) {
+    silkworm::Bytes key{contract.bytes, sizeof(contract.bytes)};
+    key.append(input.substr(0, kSelectorSize));
+    return key;
+}
+
+AccessList CallFootprintCache::intersect(const AccessList& footprint1, const AccessList& footprint2) {
+    std::map<evmc::address, const std::vector<evmc::bytes32>*> storage_keys_by_account;
+    for (const auto& entry : footprint1) {
+        storage_keys_by_account.emplace(entry.account, &entry.storage_keys);
+    }
+    AccessList intersection;
+    for (const auto& entry : footprint2) {
+        const auto it = storage_keys_by_account.find(entry.account);
+        if (it == storage_keys_by_account.end()) {
+            continue;
+        }
+        const auto& storage_keys1{*it->second};
+        auto& shared_entry = intersection.emplace_back(silkworm::AccessListEntry{entry.account, {}});
+        std::copy_if(entry.storage_keys.cbegin(), entry.storage_keys.cend(), std::back_inserter(shared_entry.storage_keys), [&](const auto& location) {
+            return std::find(storage_keys1.cbegin(), storage_keys1.cend(), location) != storage_keys1.cend();
+        });
+    }
+    return intersection;
+}
+
+} // namespace silkrpc::state
@@ -0,0 +1,90 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <silkworm/silkrpc/config.hpp> // NOLINT(build/include_order)
+
+#include <evmc/evmc.hpp>
+#include <silkworm/common/base.hpp>
+
+#include <silkworm/silkrpc/types/transaction.hpp>
+
+namespace silkrpc::state {
+
+constexpr auto kDefaultCallFootprintCacheCapacity{4'096u};
+
+//! Max number of storage keys kept for each footprint, so that a single call cannot bloat the cache nor the reads of next calls
+constexpr std::size_t kMaxCallFootprintStorageKeys{64};
+
+//! Bounded cache of state footprints (i.e. accounts and storage keys read) learned from past calls shared by all contexts.
+//! Each footprint is keyed by called contract and function selector (i.e. first 4 bytes of input data), so that repeated
+//! read-only calls to the same view functions can prefetch their state in advance. Values depending on call arguments (e.g.
+//! balanceOf mapping slots) would be wrong for other arguments, so a footprint is learned just from calls without arguments
+//! or as the part shared by the last two calls with different arguments. Footprints are just hints: stale ones only cost some
+//! useless reads, hence they are not invalidated at new blocks but simply replaced by newer executions.
+class CallFootprintCache {
+public:
+    explicit CallFootprintCache(std::size_t capacity = kDefaultCallFootprintCacheCapacity);
+
+    CallFootprintCache(const CallFootprintCache&) = delete;
+    CallFootprintCache& operator=(const CallFootprintCache&) = delete;
+
+    //! Return the footprint learned from past calls to \p contract having same selector as \p input, if any is stable enough
+    std::shared_ptr<const AccessList> find(const evmc::address& contract, silkworm::ByteView input);
+
+    //! Insert the footprint learned from a call to \p contract with \p input, possibly evicting the least recently used one
+    void insert(const evmc::address& contract, silkworm::ByteView input, AccessList footprint);
+
+    std::size_t size() const;
+
+    uint64_t hit_count() const { return hit_count_.load(std::memory_order_relaxed); }
+    uint64_t miss_count() const { return miss_count_.load(std::memory_order_relaxed); }
+    uint64_t eviction_count() const { return eviction_count_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        //! The footprint not depending on call arguments, null until learned
+        std::shared_ptr<const AccessList> footprint;
+        //! The footprint of the last call with arguments and their hash, intersected with the next call having other ones
+        AccessList last_footprint;
+        std::size_t last_arguments_hash{0};
+        std::list<silkworm::Bytes>::iterator lru_position;
+    };
+
+    using EntryMap = std::map<silkworm::Bytes, Entry>;
+
+    static silkworm::Bytes make_key(const evmc::address& contract, silkworm::ByteView input);
+    static AccessList intersect(const AccessList& footprint1, const AccessList& footprint2);
+
+    std::size_t capacity_;
+    mutable std::mutex access_;
+    EntryMap entries_;
+    std::list<silkworm::Bytes> lru_keys_;
+
+    std::atomic_uint64_t hit_count_{0};
+    std::atomic_uint64_t miss_count_{0};
+    std::atomic_uint64_t eviction_count_{0};
+};
+
+} // namespace silkrpc::state
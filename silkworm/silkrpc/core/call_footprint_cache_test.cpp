@@ -0,0 +1,169 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "call_footprint_cache.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+#include <evmc/evmc.hpp>
+#include <silkworm/common/util.hpp>
+
+namespace silkrpc::state {
+
+using evmc::literals::operator""_address;
+using evmc::literals::operator""_bytes32;
+using Catch::Matchers::Message;
+
+static constexpr auto kTestContract1{0x0f572e5295c57f15886f9b263e2f6d2d6c7b5ec6_address};
+static constexpr auto kTestContract2{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+static constexpr auto kTestLocation{0x0000000000000000000000000000000000000000000000000000000000000001_bytes32};
+static constexpr auto kBalanceLocation1{0x5ef4bd4d4a4e8b4ce2c0bd8f5c7a8e3a7a9b6dc1b0e8e1a8f3c4d5e6f7a8b9c0_bytes32};
+static constexpr auto kBalanceLocation2{0x9b2f8c3a1d4e5f60718293a4b5c6d7e8f90a1b2c3d4e5f60718293a4b5c6d7e8_bytes32};
+static const silkworm::Bytes kBalanceOfInput1{*silkworm::from_hex("0x70a082310000000000000000000000000715a7794a1dc8e42615f059dd6e406a6594651a")};
+static const silkworm::Bytes kBalanceOfInput2{*silkworm::from_hex("0x70a082310000000000000000000000000f572e5295c57f15886f9b263e2f6d2d6c7b5ec6")};
+static const silkworm::Bytes kTotalSupplyInput{*silkworm::from_hex("0x18160ddd")};
+static const silkworm::Bytes kDecimalsInput{*silkworm::from_hex("0x313ce567")};
+
+TEST_CASE("CallFootprintCache::CallFootprintCache", "[silkrpc][core][call_footprint_cache]") {
+    SECTION("reject zero capacity") {
+        CHECK_THROWS_MATCHES(CallFootprintCache{0}, std::invalid_argument, Message("unexpected zero capacity"));
+    }
+
+    SECTION("empty cache") {
+        CallFootprintCache cache;
+        CHECK(cache.size() == 0);
+        CHECK(cache.hit_count() == 0);
+        CHECK(cache.miss_count() == 0);
+        CHECK(cache.eviction_count() == 0);
+    }
+}
+
+TEST_CASE("CallFootprintCache::find", "[silkrpc][core][call_footprint_cache]") {
+    CallFootprintCache cache;
+    cache.insert(kTestContract1, kTotalSupplyInput, AccessList{{kTestContract1, {kTestLocation}}});
+
+    SECTION("hit: same selector without arguments") {
+        const auto footprint{cache.find(kTestContract1, kTotalSupplyInput)};
+        REQUIRE(footprint != nullptr);
+        REQUIRE(footprint->size() == 1);
+        CHECK(footprint->at(0).account == kTestContract1);
+        CHECK(footprint->at(0).storage_keys == std::vector<evmc::bytes32>{kTestLocation});
+        CHECK(cache.hit_count() == 1);
+    }
+
+    SECTION("miss: different selector") {
+        CHECK(cache.find(kTestContract1, kDecimalsInput) == nullptr);
+        CHECK(cache.miss_count() == 1);
+    }
+
+    SECTION("miss: different contract") {
+        CHECK(cache.find(kTestContract2, kTotalSupplyInput) == nullptr);
+        CHECK(cache.miss_count() == 1);
+    }
+
+    SECTION("miss: empty input") {
+        CHECK(cache.find(kTestContract1, silkworm::ByteView{}) == nullptr);
+    }
+}
+
+TEST_CASE("CallFootprintCache::find with arguments", "[silkrpc][core][call_footprint_cache]") {
+    CallFootprintCache cache;
+    cache.insert(kTestContract1, kBalanceOfInput1, AccessList{{kTestContract1, {kTestLocation, kBalanceLocation1}}});
+
+    SECTION("miss: footprint learned from one call only") {
+        CHECK(cache.find(kTestContract1, kBalanceOfInput2) == nullptr);
+        CHECK(cache.miss_count() == 1);
+    }
+
+    SECTION("miss: footprint learned from calls with same arguments") {
+        cache.insert(kTestContract1, kBalanceOfInput1, AccessList{{kTestContract1, {kTestLocation, kBalanceLocation1}}});
+        CHECK(cache.find(kTestContract1, kBalanceOfInput1) == nullptr);
+    }
+
+    SECTION("hit: storage keys derived from arguments are dropped") {
+        cache.insert(kTestContract1, kBalanceOfInput2, AccessList{{kTestContract1, {kBalanceLocation2, kTestLocation}}});
+        const auto footprint{cache.find(kTestContract1, kBalanceOfInput1)};
+        REQUIRE(footprint != nullptr);
+        REQUIRE(footprint->size() == 1);
+        CHECK(footprint->at(0).account == kTestContract1);
+        CHECK(footprint->at(0).storage_keys == std::vector<evmc::bytes32>{kTestLocation});
+    }
+
+    SECTION("hit: accounts derived from arguments are dropped") {
+        cache.insert(kTestContract1, kBalanceOfInput2, AccessList{{kTestContract1, {kTestLocation}}, {kTestContract2, {}}});
+        const auto footprint{cache.find(kTestContract1, kBalanceOfInput2)};
+        REQUIRE(footprint != nullptr);
+        REQUIRE(footprint->size() == 1);
+        CHECK(footprint->at(0).account == kTestContract1);
+    }
+
+    SECTION("hit: footprint shared by last two calls") {
+        cache.insert(kTestContract1, kBalanceOfInput2, AccessList{{kTestContract1, {kTestLocation}}});
+        cache.insert(kTestContract1, kBalanceOfInput1, AccessList{{kTestContract1, {kTestLocation}}, {kTestContract2, {}}});
+        const auto footprint{cache.find(kTestContract1, kBalanceOfInput1)};
+        REQUIRE(footprint != nullptr);
+        REQUIRE(footprint->size() == 1);
+        CHECK(footprint->at(0).account == kTestContract1);
+        CHECK(footprint->at(0).storage_keys == std::vector<evmc::bytes32>{kTestLocation});
+    }
+}
+
+TEST_CASE("CallFootprintCache::insert", "[silkrpc][core][call_footprint_cache]") {
+    SECTION("empty footprint is skipped") {
+        CallFootprintCache cache;
+        cache.insert(kTestContract1, kTotalSupplyInput, AccessList{});
+        CHECK(cache.size() == 0);
+    }
+
+    SECTION("replace existing footprint") {
+        CallFootprintCache cache;
+        cache.insert(kTestContract1, kTotalSupplyInput, AccessList{{kTestContract1, {}}});
+        cache.insert(kTestContract1, kTotalSupplyInput, AccessList{{kTestContract2, {}}});
+        CHECK(cache.size() == 1);
+        const auto footprint{cache.find(kTestContract1, kTotalSupplyInput)};
+        REQUIRE(footprint != nullptr);
+        REQUIRE(footprint->size() == 1);
+        CHECK(footprint->at(0).account == kTestContract2);
+    }
+
+    SECTION("storage keys are truncated") {
+        CallFootprintCache cache;
+        AccessList footprint{{kTestContract1, std::vector<evmc::bytes32>(kMaxCallFootprintStorageKeys)}, {kTestContract2, {kTestLocation}}};
+        cache.insert(kTestContract1, kTotalSupplyInput, std::move(footprint));
+        const auto cached_footprint{cache.find(kTestContract1, kTotalSupplyInput)};
+        REQUIRE(cached_footprint != nullptr);
+        REQUIRE(cached_footprint->size() == 2);
+        CHECK(cached_footprint->at(0).storage_keys.size() == kMaxCallFootprintStorageKeys);
+        CHECK(cached_footprint->at(1).storage_keys.empty());
+    }
+
+    SECTION("evict least recently used footprint") {
+        CallFootprintCache cache{2};
+        cache.insert(kTestContract1, kTotalSupplyInput, AccessList{{kTestContract1, {}}});
+        cache.insert(kTestContract2, kTotalSupplyInput, AccessList{{kTestContract2, {}}});
+        CHECK(cache.find(kTestContract1, kTotalSupplyInput) != nullptr);
+        cache.insert(kTestContract1, kDecimalsInput, AccessList{{kTestContract1, {}}});
+        CHECK(cache.size() == 2);
+        CHECK(cache.eviction_count() == 1);
+        CHECK(cache.find(kTestContract1, kTotalSupplyInput) != nullptr);
+        CHECK(cache.find(kTestContract2, kTotalSupplyInput) == nullptr);
+        CHECK(cache.find(kTestContract1, kDecimalsInput) != nullptr);
+    }
+}
+
+} // namespace silkrpc::state
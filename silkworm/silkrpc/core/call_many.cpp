@@ -0,0 +1,99 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "call_many.hpp"
+
+#include <deque>
+#include <exception>
+#include <memory>
+#include <string>
+
+#include <boost/asio/error.hpp>
+#include <boost/system/system_error.hpp>
+#include <silkworm/common/util.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/concurrency/async_slot.hpp>
+#include <silkworm/silkrpc/json/types.hpp>
+#include <silkworm/silkrpc/types/error.hpp>
+
+namespace silkrpc {
+
+nlohmann::json make_call_many_result(const ExecutionResult& execution_result) {
+    nlohmann::json result = nlohmann::json::object();
+    if (execution_result.pre_check_error) {
+        result["error"] = Error{-32000, execution_result.pre_check_error.value()};
+    } else if (execution_result.error_code == evmc_status_code::EVMC_SUCCESS) {
+        result["value"] = "0x" + silkworm::to_hex(execution_result.data);
+    } else {
+        const auto error_message = EVMExecutor<>::get_error_message(execution_result.error_code, execution_result.data);
+        if (execution_result.data.empty()) {
+            result["error"] = Error{-32000, error_message};
+        } else {
+            result["error"] = RevertError{{3, error_message}, execution_result.data};
+        }
+    }
+    return result;
+}
+
+boost::asio::awaitable<void> execute_call_many(boost::asio::io_context& io_context, const std::vector<silkworm::Transaction>& transactions,
+    const CallExecutor& executor, std::size_t window_size, json::Stream& stream) {
+    using CallSlot = AsyncSlot<ExecutionResult>;
+
+    std::deque<std::shared_ptr<CallSlot>> window;
+    auto next_transaction = transactions.cbegin();
+    std::size_t call_index{0};
+    std::exception_ptr exception;
+    try {
+        while (!window.empty() || next_transaction != transactions.cend()) {
+            while (window.size() < window_size && next_transaction != transactions.cend()) {
+                auto slot = std::make_shared<CallSlot>(io_context.get_executor());
+                slot->spawn(executor(*next_transaction));
+                window.push_back(std::move(slot));
+                ++next_transaction;
+            }
+
+            auto slot = window.front();
+            window.pop_front();
+            co_await slot->wait();
+            if (!slot->ready()) {
+                throw boost::system::system_error{boost::asio::error::operation_aborted};
+            }
+            if (slot->exception()) {
+                try {
+                    std::rethrow_exception(slot->exception());
+                } catch (const std::exception& e) {
+                    SILKRPC_ERROR << "exception: " << e.what() << " processing call #" << call_index << "\n";
+                    const nlohmann::json error_result{{"error", Error{100, e.what()}}};
+                    stream.write_json(error_result);
+                }
+            } else {
+                stream.write_json(make_call_many_result(slot->value()));
+            }
+            ++call_index;
+        }
+    } catch (...) {
+        exception = std::current_exception();
+    }
+
+    // Never leave before all the spawned calls are done, because they use the state owned by the caller
+    co_await wait_all(window);
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+} // namespace silkrpc
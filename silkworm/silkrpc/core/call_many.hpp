@@ -0,0 +1,49 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <silkworm/silkrpc/config.hpp> // NOLINT(build/include_order)
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/io_context.hpp>
+#include <nlohmann/json.hpp>
+#include <silkworm/types/transaction.hpp>
+
+#include <silkworm/silkrpc/core/evm_executor.hpp>
+#include <silkworm/silkrpc/json/stream.hpp>
+
+namespace silkrpc {
+
+//! The max number of independent calls executed concurrently by eth_callMany
+constexpr std::size_t kCallManyWindowSize{16};
+
+using CallExecutor = std::function<boost::asio::awaitable<ExecutionResult>(const silkworm::Transaction&)>;
+
+//! Build the result of a single call in eth_callMany, i.e. either the returned value or the same error as eth_call
+nlohmann::json make_call_many_result(const ExecutionResult& execution_result);
+
+//! Execute \p transactions by \p executor and stream their results in call order into the array currently open in \p stream.
+//! Up to \p window_size calls are in flight at the same time, so \p executor must support concurrent calls unless it is one.
+//! An exception thrown by one call becomes its error result; this never returns before all the spawned calls are done.
+boost::asio::awaitable<void> execute_call_many(boost::asio::io_context& io_context, const std::vector<silkworm::Transaction>& transactions,
+    const CallExecutor& executor, std::size_t window_size, json::Stream& stream);
+
+} // namespace silkrpc
@@ -0,0 +1,180 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "call_many.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/use_future.hpp>
+#include <catch2/catch.hpp>
+#include <evmc/evmc.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/types/writer.hpp>
+
+namespace silkrpc {
+
+using namespace std::chrono_literals;
+
+//! Writer failing after a given number of writes, e.g. as a connection closed by the client
+class FailingWriter : public Writer {
+  public:
+    explicit FailingWriter(std::size_t max_writes) : max_writes_{max_writes} {}
+
+    void write(const std::string& content) override {
+        if (writes_++ == max_writes_) {
+            throw std::runtime_error{"write failed"};
+        }
+    }
+
+  private:
+    std::size_t max_writes_;
+    std::size_t writes_{0};
+};
+
+TEST_CASE("make_call_many_result", "[silkrpc][core][call_many]") {
+    SECTION("success") {
+        const ExecutionResult execution_result{evmc_status_code::EVMC_SUCCESS, 0, silkworm::Bytes{0x01, 0x02}};
+        CHECK(make_call_many_result(execution_result) == R"({"value":"0x0102"})"_json);
+    }
+
+    SECTION("pre-check error") {
+        const ExecutionResult execution_result{evmc_status_code::EVMC_SUCCESS, 0, {}, "insufficient funds"};
+        CHECK(make_call_many_result(execution_result) == R"({"error":{"code":-32000,"message":"insufficient funds"}})"_json);
+    }
+
+    SECTION("failure without data") {
+        const ExecutionResult execution_result{evmc_status_code::EVMC_OUT_OF_GAS, 0, {}};
+        CHECK(make_call_many_result(execution_result) == R"({"error":{"code":-32000,"message":"out of gas"}})"_json);
+    }
+
+    SECTION("revert with data") {
+        const ExecutionResult execution_result{evmc_status_code::EVMC_REVERT, 0, silkworm::Bytes{0x01}};
+        const auto result = make_call_many_result(execution_result);
+        CHECK(result["error"]["code"] == 3);
+        CHECK(result["error"]["data"] == "0x01");
+    }
+}
+
+TEST_CASE("execute_call_many", "[silkrpc][core][call_many]") {
+    SILKRPC_LOG_STREAMS(null_stream(), null_stream());
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    boost::asio::io_context io_context;
+
+    // Each call returns its nonce after a delay decreasing with it (unless later calls are slower), so later calls complete first
+    // if executed concurrently
+    constexpr uint64_t kCallCount{5};
+    std::vector<silkworm::Transaction> transactions(kCallCount);
+    for (uint64_t i{0}; i < kCallCount; ++i) {
+        transactions[i].nonce = i;
+    }
+    std::vector<uint64_t> completion_order;
+    std::size_t in_flight{0};
+    std::size_t max_in_flight{0};
+    uint64_t failing_nonce{kCallCount};
+    bool later_calls_slower{false};
+    bool returned{false};
+    std::size_t completions_after_return{0};
+    const CallExecutor executor = [&](const silkworm::Transaction& txn) -> boost::asio::awaitable<ExecutionResult> {
+        max_in_flight = std::max(max_in_flight, ++in_flight);
+        const auto delay{later_calls_slower ? txn.nonce + 1 : kCallCount - txn.nonce};
+        boost::asio::steady_timer timer{io_context, std::chrono::milliseconds{static_cast<int64_t>(delay)}};
+        co_await timer.async_wait(boost::asio::use_awaitable);
+        --in_flight;
+        if (returned) {
+            ++completions_after_return;
+        }
+        completion_order.push_back(txn.nonce);
+        if (txn.nonce == failing_nonce) {
+            throw std::runtime_error{"call failed"};
+        }
+        co_return ExecutionResult{evmc_status_code::EVMC_SUCCESS, 0, silkworm::Bytes{static_cast<uint8_t>(txn.nonce)}};
+    };
+
+    auto run = [&](std::size_t window_size, Writer& writer) {
+        json::Stream stream{writer};
+        stream.open_array();
+        auto result = boost::asio::co_spawn(io_context, execute_call_many(io_context, transactions, executor, window_size, stream), boost::asio::use_future);
+        io_context.run();
+        result.get();
+        stream.close_array();
+    };
+
+    SECTION("sequential") {
+        StringWriter writer;
+        run(1, writer);
+        CHECK(max_in_flight == 1);
+        CHECK(completion_order == std::vector<uint64_t>{0, 1, 2, 3, 4});
+        CHECK(nlohmann::json::parse(writer.get_content()) ==
+            R"([{"value":"0x00"},{"value":"0x01"},{"value":"0x02"},{"value":"0x03"},{"value":"0x04"}])"_json);
+    }
+
+    SECTION("concurrent results in call order") {
+        StringWriter writer;
+        run(kCallManyWindowSize, writer);
+        CHECK(max_in_flight == kCallCount);
+        CHECK(completion_order == std::vector<uint64_t>{4, 3, 2, 1, 0});
+        CHECK(nlohmann::json::parse(writer.get_content()) ==
+            R"([{"value":"0x00"},{"value":"0x01"},{"value":"0x02"},{"value":"0x03"},{"value":"0x04"}])"_json);
+    }
+
+    SECTION("concurrent bounded by window") {
+        StringWriter writer;
+        run(2, writer);
+        CHECK(max_in_flight == 2);
+        CHECK(nlohmann::json::parse(writer.get_content()).size() == kCallCount);
+    }
+
+    SECTION("error of one call") {
+        failing_nonce = 2;
+        StringWriter writer;
+        run(kCallManyWindowSize, writer);
+        CHECK(nlohmann::json::parse(writer.get_content()) ==
+            R"([{"value":"0x00"},{"value":"0x01"},{"error":{"code":100,"message":"call failed"}},{"value":"0x03"},{"value":"0x04"}])"_json);
+    }
+
+    SECTION("drain window on stream failure") {
+        later_calls_slower = true;
+        FailingWriter writer{1}; // the opening bracket is written, the first result is not
+        json::Stream stream{writer};
+        stream.open_array();
+        auto execute_and_mark = [&]() -> boost::asio::awaitable<void> {
+            try {
+                co_await execute_call_many(io_context, transactions, executor, kCallManyWindowSize, stream);
+            } catch (...) {
+                returned = true;
+                throw;
+            }
+            returned = true;
+        };
+        auto result = boost::asio::co_spawn(io_context, execute_and_mark(), boost::asio::use_future);
+        io_context.run();
+        CHECK_THROWS_MATCHES(result.get(), std::runtime_error, Catch::Matchers::Message("write failed"));
+        CHECK(completion_order.size() == kCallCount);
+        CHECK(completions_after_return == 0);
+    }
+}
+
+} // namespace silkrpc
@@ -0,0 +1,86 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "chain_config_cache.hpp"
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <silkworm/common/assert.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/common/util.hpp>
+#include <silkworm/silkrpc/core/rawdb/chain.hpp>
+
+namespace silkrpc::core {
+
+boost::asio::awaitable<std::shared_ptr<const ResolvedChainConfig>> resolve_chain_config(const rawdb::DatabaseReader& reader) {
+    auto resolved = std::make_shared<ResolvedChainConfig>();
+    resolved->chain_config = co_await rawdb::read_chain_config(reader);
+    if (resolved->chain_config.config.count("chainId") == 0) {
+        throw std::runtime_error{"missing chainId in chain config"};
+    }
+    resolved->chain_id = resolved->chain_config.config["chainId"].get<uint64_t>();
+    resolved->config = lookup_chain_config(resolved->chain_id);
+    resolved->consensus_engine = silkworm::consensus::engine_factory(*resolved->config);
+    SILKWORM_ASSERT(resolved->consensus_engine != nullptr);
+    co_return resolved;
+}
+
+boost::asio::awaitable<std::shared_ptr<const ResolvedChainConfig>> ChainConfigCache::get(const rawdb::DatabaseReader& reader) {
+    std::shared_ptr<const ResolvedChainConfig> cached;
+    uint64_t generation{0};
+    {
+        std::scoped_lock lock{access_};
+        cached = resolved_;
+        generation = generation_;
+        if (cached) {
+            hit_count_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            miss_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    if (cached) {
+        co_return cached;
+    }
+
+    auto resolved = co_await resolve_chain_config(reader);
+    {
+        std::scoped_lock lock{access_};
+        // Do not cache anything read before the latest invalidation, it could be stale
+        if (generation == generation_ && !resolved_) {
+            resolved_ = resolved;
+        }
+    }
+    SILKRPC_DEBUG << "ChainConfigCache::get chain_id: " << resolved->chain_id << " resolved\n";
+    co_return resolved;
+}
+
+void ChainConfigCache::invalidate() {
+    std::scoped_lock lock{access_};
+    resolved_.reset();
+    ++generation_;
+}
+
+boost::asio::awaitable<std::shared_ptr<const ResolvedChainConfig>> get_chain_config(const rawdb::DatabaseReader& reader, ChainConfigCache* cache) {
+    if (cache != nullptr) {
+        co_return co_await cache->get(reader);
+    }
+    co_return co_await resolve_chain_config(reader);
+}
+
+} // namespace silkrpc::core
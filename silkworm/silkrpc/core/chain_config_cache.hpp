@@ -0,0 +1,76 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include <silkworm/silkrpc/config.hpp>
+
+#include <boost/asio/awaitable.hpp>
+#include <silkworm/chain/config.hpp>
+#include <silkworm/consensus/engine.hpp>
+
+#include <silkworm/silkrpc/core/rawdb/accessors.hpp>
+#include <silkworm/silkrpc/types/chain_config.hpp>
+
+namespace silkrpc::core {
+
+//! Chain configuration read from database together with its resolved fork schedule and consensus engine
+struct ResolvedChainConfig {
+    ChainConfig chain_config;
+    uint64_t chain_id{0};
+    const silkworm::ChainConfig* config{nullptr};
+    std::shared_ptr<silkworm::consensus::IEngine> consensus_engine;
+};
+
+//! Resolve the chain configuration stored in database, reading it through \p reader
+boost::asio::awaitable<std::shared_ptr<const ResolvedChainConfig>> resolve_chain_config(const rawdb::DatabaseReader& reader);
+
+//! Cache of the resolved chain configuration shared immutably by all the execution contexts. The chain configuration is
+//! written in database by the node at startup, so it is resolved once and then again only after \ref invalidate.
+class ChainConfigCache {
+public:
+    ChainConfigCache() = default;
+
+    ChainConfigCache(const ChainConfigCache&) = delete;
+    ChainConfigCache& operator=(const ChainConfigCache&) = delete;
+
+    //! Return the cached chain configuration, resolving it through \p reader if missing
+    boost::asio::awaitable<std::shared_ptr<const ResolvedChainConfig>> get(const rawdb::DatabaseReader& reader);
+
+    //! Drop the cached chain configuration, e.g. because the node could have been restarted with a different one
+    void invalidate();
+
+    uint64_t hit_count() const { return hit_count_.load(std::memory_order_relaxed); }
+    uint64_t miss_count() const { return miss_count_.load(std::memory_order_relaxed); }
+
+private:
+    mutable std::mutex access_;
+    std::shared_ptr<const ResolvedChainConfig> resolved_;
+    uint64_t generation_{0};
+
+    std::atomic_uint64_t hit_count_{0};
+    std::atomic_uint64_t miss_count_{0};
+};
+
+//! Read the resolved chain configuration through \p cache if any, otherwise directly through \p reader
+boost::asio::awaitable<std::shared_ptr<const ResolvedChainConfig>> get_chain_config(const rawdb::DatabaseReader& reader, ChainConfigCache* cache);
+
+} // namespace silkrpc::core
@@ -0,0 +1,127 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "chain_config_cache.hpp"
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_future.hpp>
+#include <catch2/catch.hpp>
+#include <gmock/gmock.h>
+
+#include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/common/util.hpp>
+#include <silkworm/silkrpc/ethdb/tables.hpp>
+#include <silkworm/silkrpc/test/mock_database_reader.hpp>
+
+namespace silkrpc::core {
+
+using testing::InvokeWithoutArgs;
+
+static silkworm::Bytes kZeroKey{*silkworm::from_hex("0000000000000000")};
+static silkworm::Bytes kZeroHeader{*silkworm::from_hex("bf7e331f7f7c1dd2e05159666b3bf8bc7a8a3a9eb1d518969eab529dd9b88c1a")};
+
+static silkworm::Bytes kConfigKey{
+    *silkworm::from_hex("bf7e331f7f7c1dd2e05159666b3bf8bc7a8a3a9eb1d518969eab529dd9b88c1a")};
+static silkworm::Bytes kConfigValue{*silkworm::from_hex(
+    "7b22436861696e4e616d65223a22676f65726c69222c22636861696e4964223a352c22636f6e73656e737573223a22636c69717565222c2268"
+    "6f6d657374656164426c6f636b223a302c2264616f466f726b537570706f7274223a747275652c22656970313530426c6f636b223a302c2265"
+    "697031353048617368223a22307830303030303030303030303030303030303030303030303030303030303030303030303030303030303030"
+    "303030303030303030303030303030303030303030222c22656970313535426c6f636b223a302c22656970313538426c6f636b223a302c2262"
+    "797a616e7469756d426c6f636b223a302c22636f6e7374616e74696e6f706c65426c6f636b223a302c2270657465727362757267426c6f636b"
+    "223a302c22697374616e62756c426c6f636b223a313536313635312c226265726c696e426c6f636b223a343436303634342c226c6f6e646f6e"
+    "426c6f636b223a353036323630352c22636c69717565223a7b22706572696f64223a31352c2265706f6368223a33303030307d7d")};
+
+static void expect_chain_config_reads(test::MockDatabaseReader& db_reader, int times) {
+    EXPECT_CALL(db_reader, get_one(db::table::kCanonicalHashes, silkworm::ByteView{kZeroKey}))
+        .Times(times)
+        .WillRepeatedly(InvokeWithoutArgs([]() -> boost::asio::awaitable<silkworm::Bytes> {
+            co_return kZeroHeader;
+        }));
+    EXPECT_CALL(db_reader, get_one(db::table::kConfig, silkworm::ByteView{kConfigKey}))
+        .Times(times)
+        .WillRepeatedly(InvokeWithoutArgs([]() -> boost::asio::awaitable<silkworm::Bytes> {
+            co_return kConfigValue;
+        }));
+}
+
+TEST_CASE("resolve_chain_config", "[silkrpc][core][chain_config_cache]") {
+    SILKRPC_LOG_STREAMS(null_stream(), null_stream());
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    boost::asio::thread_pool pool{1};
+    test::MockDatabaseReader db_reader;
+    expect_chain_config_reads(db_reader, 1);
+
+    auto result = boost::asio::co_spawn(pool, resolve_chain_config(db_reader), boost::asio::use_future);
+    const auto resolved = result.get();
+    CHECK(resolved->chain_id == 5);
+    CHECK(resolved->chain_config.genesis_hash == silkworm::to_bytes32(kZeroHeader));
+    CHECK(resolved->config == lookup_chain_config(5));
+    CHECK(resolved->consensus_engine != nullptr);
+}
+
+TEST_CASE("ChainConfigCache::get", "[silkrpc][core][chain_config_cache]") {
+    SILKRPC_LOG_STREAMS(null_stream(), null_stream());
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    boost::asio::thread_pool pool{1};
+    test::MockDatabaseReader db_reader;
+    ChainConfigCache cache;
+
+    SECTION("resolved just once") {
+        expect_chain_config_reads(db_reader, 1);
+        const auto resolved1 = boost::asio::co_spawn(pool, cache.get(db_reader), boost::asio::use_future).get();
+        const auto resolved2 = boost::asio::co_spawn(pool, cache.get(db_reader), boost::asio::use_future).get();
+        CHECK(resolved1 == resolved2);
+        CHECK(cache.hit_count() == 1);
+        CHECK(cache.miss_count() == 1);
+    }
+
+    SECTION("resolved again after invalidation") {
+        expect_chain_config_reads(db_reader, 2);
+        const auto resolved1 = boost::asio::co_spawn(pool, cache.get(db_reader), boost::asio::use_future).get();
+        cache.invalidate();
+        const auto resolved2 = boost::asio::co_spawn(pool, cache.get(db_reader), boost::asio::use_future).get();
+        CHECK(resolved1 != resolved2);
+        CHECK(resolved2->chain_id == 5);
+        CHECK(cache.miss_count() == 2);
+    }
+}
+
+TEST_CASE("get_chain_config", "[silkrpc][core][chain_config_cache]") {
+    SILKRPC_LOG_STREAMS(null_stream(), null_stream());
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    boost::asio::thread_pool pool{1};
+    test::MockDatabaseReader db_reader;
+
+    SECTION("without cache") {
+        expect_chain_config_reads(db_reader, 2);
+        CHECK(boost::asio::co_spawn(pool, get_chain_config(db_reader, nullptr), boost::asio::use_future).get()->chain_id == 5);
+        CHECK(boost::asio::co_spawn(pool, get_chain_config(db_reader, nullptr), boost::asio::use_future).get()->chain_id == 5);
+    }
+
+    SECTION("with cache") {
+        ChainConfigCache cache;
+        expect_chain_config_reads(db_reader, 1);
+        CHECK(boost::asio::co_spawn(pool, get_chain_config(db_reader, &cache), boost::asio::use_future).get()->chain_id == 5);
+        CHECK(boost::asio::co_spawn(pool, get_chain_config(db_reader, &cache), boost::asio::use_future).get()->chain_id == 5);
+        CHECK(cache.hit_count() == 1);
+    }
+}
+
+} // namespace silkrpc::core
@@ -17,12 +17,16 @@
 #include "estimate_gas_oracle.hpp"
 
 #include <algorithm>
+#include <exception>
+#include <memory>
 #include <string>
 #include <utility>
 
 #include <boost/asio/compose.hpp>
 #include <boost/asio/post.hpp>
+#include <boost/asio/this_coro.hpp>
 #include <boost/asio/use_awaitable.hpp>
+#include <silkworm/silkrpc/concurrency/async_slot.hpp>
 #include <silkworm/silkrpc/core/blocks.hpp>
 #include <silkworm/silkrpc/core/rawdb/chain.hpp>
 
@@ -80,26 +84,71 @@ boost::asio::awaitable<intx::uint256> EstimateGasOracle::estimate_gas(const Call
     SILKRPC_DEBUG << "hi: " << hi << ", lo: " << lo << ", cap: " << cap << "\n";
 
     silkworm::Transaction transaction{call.to_transaction()};
-    while (lo + 1 < hi) {
-        auto mid = (hi + lo) / 2;
-        transaction.gas_limit = mid;
 
-        auto failed = co_await try_execution(transaction);
+    // Execute at the cap first: if it fails, no lower gas limit can succeed
+    transaction.gas_limit = hi;
+    const auto cap_result = co_await executor_(transaction);
+    if (is_failed(cap_result)) {
+        SILKRPC_DEBUG << "HI == cap tested with failure\n";
+        throw EstimateGasException{-1, "gas required exceeds allowance (" + std::to_string(cap) + ")"};
+    }
 
-        if (failed) {
-            lo = mid;
+    // The gas used at the cap (net of refunds) is a lower bound for any successful gas limit
+    const auto gas_used = hi - cap_result.gas_left;
+    if (gas_used > lo + 1) {
+        lo = gas_used - 1;
+    }
+    SILKRPC_DEBUG << "gas used at cap: " << gas_used << ", refund: " << cap_result.gas_refund << ", lo: " << lo << "\n";
+
+    // Most calls succeed with the gas consumed before refunds or, if they make nested calls, with the stipend and the 1/64
+    // retained by each call frame on top of it: probe these limits before searching, to narrow the search interval
+    const auto consumed_gas = gas_used + cap_result.gas_refund;
+    const auto optimistic_gas_limit = (consumed_gas + kCallStipend) * 64 / 63;
+    for (const auto gas_limit : {consumed_gas, optimistic_gas_limit}) {
+        if (gas_limit <= lo || gas_limit >= hi) {
+            continue;
+        }
+        transaction.gas_limit = gas_limit;
+        if (co_await try_execution(transaction)) {
+            lo = gas_limit;
         } else {
-            hi = mid;
+            hi = gas_limit;
+            break;
         }
     }
 
-    if (hi == cap) {
-        transaction.gas_limit = hi;
-        auto failed = co_await try_execution(transaction);
-        SILKRPC_DEBUG << "HI == cap tested again with " << (failed ? "failure" : "succeed") << "\n";
+    while (lo + 1 < hi) {
+        if (concurrent_probes_ == 1 || hi - lo <= 2) {
+            auto mid = (hi + lo) / 2;
+            transaction.gas_limit = mid;
+
+            auto failed = co_await try_execution(transaction);
+
+            if (failed) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+            continue;
+        }
 
-        if (failed) {
-            throw EstimateGasException{-1, "gas required exceeds allowance (" + std::to_string(cap) + ")"};
+        // Split the search interval evenly among concurrent probes, then narrow it around the first succeeding probe
+        std::vector<uint64_t> gas_limits;
+        gas_limits.reserve(concurrent_probes_);
+        for (std::size_t i{1}; i <= concurrent_probes_; ++i) {
+            const auto gas_limit = lo + (hi - lo) * i / (concurrent_probes_ + 1);
+            if (gas_limit > lo && gas_limit < hi && (gas_limits.empty() || gas_limit > gas_limits.back())) {
+                gas_limits.push_back(gas_limit);
+            }
+        }
+        const auto results = co_await execute_concurrently(transaction, gas_limits);
+        for (std::size_t i{0}; i < gas_limits.size(); ++i) {
+            if (is_failed(results[i])) {
+                lo = gas_limits[i];
+            } else {
+                hi = gas_limits[i];
+                break;
+            }
         }
     }
 
@@ -109,7 +158,39 @@ boost::asio::awaitable<intx::uint256> EstimateGasOracle::estimate_gas(const Call
 
 boost::asio::awaitable<bool> EstimateGasOracle::try_execution(const silkworm::Transaction& transaction) {
     const auto result = co_await executor_(transaction);
+    co_return is_failed(result);
+}
+
+boost::asio::awaitable<std::vector<ExecutionResult>> EstimateGasOracle::execute_concurrently(const silkworm::Transaction& transaction,
+    const std::vector<uint64_t>& gas_limits) {
+    // Each probe holds its own transaction, so that it outlives this coroutine if destroyed before all probes complete
+    struct ProbeSlot : AsyncSlot<ExecutionResult> {
+        ProbeSlot(const boost::asio::any_io_executor& executor, const silkworm::Transaction& txn) : AsyncSlot{executor}, transaction{txn} {}
+
+        silkworm::Transaction transaction;
+    };
+
+    // Probes complete on the same (single-threaded) executor as this coroutine, so no synchronization is needed
+    const auto executor = co_await boost::asio::this_coro::executor;
+    std::vector<std::shared_ptr<ProbeSlot>> probes;
+    probes.reserve(gas_limits.size());
+    for (const auto gas_limit : gas_limits) {
+        auto probe = std::make_shared<ProbeSlot>(executor, transaction);
+        probe->transaction.gas_limit = gas_limit;
+        probe->spawn(executor_(probe->transaction));
+        probes.push_back(std::move(probe));
+    }
+    co_await wait_all(probes);
+
+    std::vector<ExecutionResult> results;
+    results.reserve(probes.size());
+    for (const auto& probe : probes) {
+        results.push_back(co_await probe->get());
+    }
+    co_return results;
+}
 
+bool EstimateGasOracle::is_failed(const ExecutionResult& result) {
     bool failed = true;
     if (result.pre_check_error) {
         SILKRPC_DEBUG << "result error " << result.pre_check_error.value() << "\n";
@@ -118,6 +199,8 @@ boost::asio::awaitable<bool> EstimateGasOracle::try_execution(const silkworm::Tr
         failed = false;
     } else if (result.error_code == evmc_status_code::EVMC_INSUFFICIENT_BALANCE) {
         SILKRPC_DEBUG << "result INSUFFICIENTE BALANCE\n";
+    } else if (result.error_code == evmc_status_code::EVMC_OUT_OF_GAS) {
+        SILKRPC_DEBUG << "result OUT OF GAS\n";
     } else {
         const auto error_message = EVMExecutor<>::get_error_message(result.error_code, result.data);
         SILKRPC_DEBUG << "result message " << error_message << ", code " << result.error_code << "\n";
@@ -128,7 +211,7 @@ boost::asio::awaitable<bool> EstimateGasOracle::try_execution(const silkworm::Tr
         }
     }
 
-    co_return failed;
+    return failed;
 }
 
 } // namespace silkrpc::ego
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <functional>
 #include <optional>
 #include <string>
@@ -38,6 +39,7 @@ namespace silkrpc::ego {
 
 const std::uint64_t kTxGas = 21'000;
 const std::uint64_t kGasCap = 25'000'000;
+const std::uint64_t kCallStipend = 2'300;
 
 using BlockHeaderProvider = std::function<boost::asio::awaitable<silkworm::BlockHeader>(uint64_t)>;
 using AccountReader = std::function<boost::asio::awaitable<std::optional<silkworm::Account>>(const evmc::address&, uint64_t)>;
@@ -75,10 +77,15 @@ private:
     silkworm::Bytes data_;
 };
 
+//! Estimate the gas needed by a call, executing it first at the gas cap and then searching from the gas used there.
+//! When \p concurrent_probes is greater than one, each search round executes such many probes concurrently, so the
+//! \ref Executor must be able to run several executions at the same time (e.g. sharing a read-only state overlay).
 class EstimateGasOracle {
 public:
-    explicit EstimateGasOracle(const BlockHeaderProvider& block_header_provider, const AccountReader& account_reader, const Executor& executor)
-        : block_header_provider_(block_header_provider), account_reader_{account_reader}, executor_(executor) {}
+    explicit EstimateGasOracle(const BlockHeaderProvider& block_header_provider, const AccountReader& account_reader, const Executor& executor,
+        std::size_t concurrent_probes = 1)
+        : block_header_provider_(block_header_provider), account_reader_{account_reader}, executor_(executor),
+          concurrent_probes_{concurrent_probes > 0 ? concurrent_probes : 1} {}
     virtual ~EstimateGasOracle() {}
 
     EstimateGasOracle(const EstimateGasOracle&) = delete;
@@ -89,9 +96,16 @@ public:
 private:
     boost::asio::awaitable<bool> try_execution(const silkworm::Transaction& transaction);
 
+    //! Execute \p transaction once for each gas limit in \p gas_limits, all executions running concurrently
+    boost::asio::awaitable<std::vector<ExecutionResult>> execute_concurrently(const silkworm::Transaction& transaction, const std::vector<uint64_t>& gas_limits);
+
+    //! Check if the execution failed for lack of gas (or balance), throwing on any other error
+    static bool is_failed(const ExecutionResult& result);
+
     const BlockHeaderProvider& block_header_provider_;
     const AccountReader& account_reader_;
     const Executor& executor_;
+    std::size_t concurrent_probes_;
 };
 
 } // namespace silkrpc::ego
@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <stdexcept>
 
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/thread_pool.hpp>
@@ -58,21 +59,22 @@ TEST_CASE("estimate gas") {
     boost::asio::thread_pool pool{1};
 
     uint64_t count{0};
-    std::vector<bool> steps;
+    uint64_t required_gas{kTxGas};
+    uint64_t gas_used{kTxGas};
+    uint64_t gas_refund{0};
     intx::uint256 kBalance{1'000'000'000};
 
-    silkrpc::ExecutionResult kSuccessResult{evmc_status_code::EVMC_SUCCESS};
-    silkrpc::ExecutionResult kFailureResult{evmc_status_code::EVMC_INSUFFICIENT_BALANCE};
-
     silkworm::BlockHeader kBlockHeader;
     kBlockHeader.gas_limit = kTxGas * 2;
 
     silkworm::Account kAccount{0, kBalance};
 
-    Executor executor = [&steps, &count](const silkworm::Transaction& transaction) -> boost::asio::awaitable<silkrpc::ExecutionResult> {
-        bool success = steps[count++];
-        silkrpc::ExecutionResult result{success ? evmc_status_code::EVMC_SUCCESS : evmc_status_code::EVMC_INSUFFICIENT_BALANCE};
-        co_return result;
+    Executor executor = [&](const silkworm::Transaction& transaction) -> boost::asio::awaitable<silkrpc::ExecutionResult> {
+        ++count;
+        if (transaction.gas_limit < required_gas) {
+            co_return silkrpc::ExecutionResult{evmc_status_code::EVMC_OUT_OF_GAS, 0};
+        }
+        co_return silkrpc::ExecutionResult{evmc_status_code::EVMC_SUCCESS, transaction.gas_limit - gas_used, {}, std::nullopt, gas_refund};
     };
 
     BlockHeaderProvider block_header_provider = [&kBlockHeader](uint64_t block_number) -> boost::asio::awaitable<silkworm::BlockHeader> {
@@ -86,81 +88,84 @@ TEST_CASE("estimate gas") {
     Call call;
     EstimateGasOracle estimate_gas_oracle{block_header_provider, account_reader, executor};
 
-    SECTION("Call empty, always fails but last step") {
-        steps.resize(16);
-        std::fill_n(steps.begin(), steps.size(), false);
-        steps[15] = true;
+    SECTION("Call empty, fails at cap") {
+        required_gas = kTxGas * 2 + 1;
+        auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
+        CHECK_THROWS_MATCHES(result.get(), EstimateGasException, Message("gas required exceeds allowance (42000)"));
+        CHECK(count == 1);
+    }
+
+    SECTION("Call empty, succeeds only at cap") {
+        required_gas = kTxGas * 2;
+        gas_used = kTxGas * 2;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
         CHECK(estimate_gas == kTxGas * 2);
+        CHECK(count == 1);
     }
 
     SECTION("Call empty, always succeeds") {
-        steps.resize(16);
-        std::fill_n(steps.begin(), steps.size(), true);
-
+        required_gas = 0;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
         CHECK(estimate_gas == kTxGas);
     }
 
-    SECTION("Call empty, alternatively fails and succeeds") {
-        int current = false;
-        auto generate = [&current]() -> bool {
-            return ++current % 2 == 0;;
-        };
-        steps.resize(16);
-        std::generate_n(steps.begin(), steps.size(), generate);
-
+    SECTION("Call empty, required gas equal to gas used") {
+        required_gas = 30'000;
+        gas_used = 30'000;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
-        CHECK(estimate_gas == 0x88b6);
+        CHECK(estimate_gas == 30'000);
+        CHECK(count == 2); // cap and gas used
     }
 
-    SECTION("Call empty, alternatively succeeds and fails") {
-        int current = false;
-        auto generate = [&current]() -> bool {
-            return current++ % 2 == 0;;
-        };
-        steps.resize(16);
-        std::generate_n(steps.begin(), steps.size(), generate);
-
+    SECTION("Call empty, required gas above gas used because of refund") {
+        required_gas = 35'000;
+        gas_used = 30'000;
+        gas_refund = 5'000;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
-        CHECK(estimate_gas == 0x6d5e);
+        CHECK(estimate_gas == 35'000);
     }
 
-    SECTION("Call with gas, always fails but last step") {
-        call.gas = kTxGas * 4;
-        steps.resize(17);
-        std::fill_n(steps.begin(), steps.size(), false);
-        steps[16] = true;
+    SECTION("Call empty, required gas above optimistic limit") {
+        required_gas = 40'000;
+        gas_used = 25'000;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
-        CHECK(estimate_gas == kTxGas * 4);
+        CHECK(estimate_gas == 40'000);
     }
 
     SECTION("Call with gas, always succeeds") {
         call.gas = kTxGas * 4;
-        steps.resize(17);
-        std::fill_n(steps.begin(), steps.size(), true);
+        required_gas = 0;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
         CHECK(estimate_gas == kTxGas);
     }
 
+    SECTION("Call with gas, succeeds only at cap") {
+        call.gas = kTxGas * 4;
+        required_gas = kTxGas * 4;
+        gas_used = kTxGas * 3;
+        auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
+        const intx::uint256 &estimate_gas = result.get();
+
+        CHECK(estimate_gas == kTxGas * 4);
+    }
+
     SECTION("Call with gas_price, gas not capped") {
         call.gas = kTxGas * 2;
         call.gas_price = intx::uint256{10'000};
-        steps.resize(16);
-        std::fill_n(steps.begin(), steps.size(), false);
-        steps[15] = true;
+        required_gas = kTxGas * 2;
+        gas_used = kTxGas * 2;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
@@ -170,22 +175,28 @@ TEST_CASE("estimate gas") {
     SECTION("Call with gas_price, gas capped") {
         call.gas = kTxGas * 2;
         call.gas_price = intx::uint256{40'000};
-        steps.resize(13);
-        std::fill_n(steps.begin(), steps.size(), false);
-        steps[12] = true;
+        required_gas = 0x61a8;
+        gas_used = kTxGas;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
         CHECK(estimate_gas == 0x61a8);
     }
 
+    SECTION("Call with gas_price, gas capped below required") {
+        call.gas = kTxGas * 2;
+        call.gas_price = intx::uint256{40'000};
+        required_gas = 0x61a8 + 1;
+        auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
+        CHECK_THROWS_MATCHES(result.get(), EstimateGasException, Message("gas required exceeds allowance (25000)"));
+    }
+
     SECTION("Call with gas_price and value, gas not capped") {
         call.gas = kTxGas * 2;
         call.gas_price = intx::uint256{10'000};
         call.value = intx::uint256{500'000'000};
-        steps.resize(16);
-        std::fill_n(steps.begin(), steps.size(), false);
-        steps[15] = true;
+        required_gas = kTxGas * 2;
+        gas_used = kTxGas * 2;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
@@ -196,9 +207,8 @@ TEST_CASE("estimate gas") {
         call.gas = kTxGas * 2;
         call.gas_price = intx::uint256{20'000};
         call.value = intx::uint256{500'000'000};
-        steps.resize(13);
-        std::fill_n(steps.begin(), steps.size(), false);
-        steps[12] = true;
+        required_gas = 0x61a8;
+        gas_used = 0x61a8;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
@@ -207,19 +217,17 @@ TEST_CASE("estimate gas") {
 
     SECTION("Call gas above allowance, always succeeds, gas capped") {
         call.gas = kGasCap * 2;
-        steps.resize(26);
-        std::fill_n(steps.begin(), steps.size(), true);
+        required_gas = 0;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
         CHECK(estimate_gas == kTxGas);
+        CHECK(count == 2); // cap and gas used
     }
 
     SECTION("Call gas below minimum, always succeeds") {
         call.gas = kTxGas / 2;
-
-        steps.resize(26);
-        std::fill_n(steps.begin(), steps.size(), true);
+        required_gas = 0;
         auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
         const intx::uint256 &estimate_gas = result.get();
 
@@ -228,8 +236,6 @@ TEST_CASE("estimate gas") {
 
     SECTION("Call with too high value, exception") {
         call.value = intx::uint256{2'000'000'000};
-        steps.resize(16);
-        std::fill_n(steps.begin(), steps.size(), false);
 
         try {
             auto result = boost::asio::co_spawn(pool, estimate_gas_oracle.estimate_gas(call, 0), boost::asio::use_future);
@@ -239,6 +245,88 @@ TEST_CASE("estimate gas") {
             CHECK(true);
         }
     }
+
+    SECTION("Call reverted at cap, exception") {
+        const silkworm::Bytes kRevertData{*silkworm::from_hex("0x08c379a0")};
+        Executor reverting_executor = [&](const silkworm::Transaction& transaction) -> boost::asio::awaitable<silkrpc::ExecutionResult> {
+            ++count;
+            co_return silkrpc::ExecutionResult{evmc_status_code::EVMC_REVERT, 0, kRevertData};
+        };
+        EstimateGasOracle reverting_oracle{block_header_provider, account_reader, reverting_executor};
+        auto result = boost::asio::co_spawn(pool, reverting_oracle.estimate_gas(call, 0), boost::asio::use_future);
+        CHECK_THROWS_AS(result.get(), EstimateGasException);
+        CHECK(count == 1);
+    }
+}
+
+TEST_CASE("estimate gas with concurrent probes") {
+    boost::asio::thread_pool pool{1};
+
+    uint64_t count{0};
+    uint64_t required_gas{kTxGas};
+    uint64_t gas_used{kTxGas};
+
+    silkworm::BlockHeader kBlockHeader;
+    kBlockHeader.gas_limit = kGasCap;
+
+    Executor executor = [&](const silkworm::Transaction& transaction) -> boost::asio::awaitable<silkrpc::ExecutionResult> {
+        ++count;
+        if (transaction.gas_limit < required_gas) {
+            co_return silkrpc::ExecutionResult{evmc_status_code::EVMC_OUT_OF_GAS, 0};
+        }
+        co_return silkrpc::ExecutionResult{evmc_status_code::EVMC_SUCCESS, transaction.gas_limit - gas_used};
+    };
+
+    BlockHeaderProvider block_header_provider = [&kBlockHeader](uint64_t block_number) -> boost::asio::awaitable<silkworm::BlockHeader> {
+        co_return kBlockHeader;
+    };
+
+    AccountReader account_reader = [](const evmc::address& address, uint64_t block_number) -> boost::asio::awaitable<std::optional<silkworm::Account>> {
+        co_return std::nullopt;
+    };
+
+    Call call;
+
+    SECTION("same estimate as sequential search") {
+        for (const auto required : {kTxGas, uint64_t{100'000}, uint64_t{1'234'567}, kGasCap}) {
+            required_gas = required;
+            gas_used = kTxGas;
+
+            EstimateGasOracle sequential_oracle{block_header_provider, account_reader, executor};
+            const auto sequential_estimate = boost::asio::co_spawn(pool, sequential_oracle.estimate_gas(call, 0), boost::asio::use_future).get();
+
+            EstimateGasOracle concurrent_oracle{block_header_provider, account_reader, executor, 4};
+            const auto concurrent_estimate = boost::asio::co_spawn(pool, concurrent_oracle.estimate_gas(call, 0), boost::asio::use_future).get();
+
+            CHECK(sequential_estimate == required);
+            CHECK(concurrent_estimate == required);
+        }
+    }
+
+    SECTION("zero probes means sequential search") {
+        required_gas = 50'000;
+        gas_used = 40'000;
+        EstimateGasOracle oracle{block_header_provider, account_reader, executor, 0};
+        const auto estimate = boost::asio::co_spawn(pool, oracle.estimate_gas(call, 0), boost::asio::use_future).get();
+        CHECK(estimate == 50'000);
+    }
+
+    SECTION("probe exception") {
+        // Succeed at cap, fail at gas used and optimistic limit, then throw in concurrent probes
+        Executor throwing_executor = [&](const silkworm::Transaction& transaction) -> boost::asio::awaitable<silkrpc::ExecutionResult> {
+            ++count;
+            if (count > 3) {
+                throw std::runtime_error{"probe failure"};
+            }
+            if (transaction.gas_limit < kGasCap) {
+                co_return silkrpc::ExecutionResult{evmc_status_code::EVMC_OUT_OF_GAS, 0};
+            }
+            co_return silkrpc::ExecutionResult{evmc_status_code::EVMC_SUCCESS, kGasCap - kTxGas};
+        };
+        EstimateGasOracle oracle{block_header_provider, account_reader, throwing_executor, 4};
+        auto result = boost::asio::co_spawn(pool, oracle.estimate_gas(call, 0), boost::asio::use_future);
+        CHECK_THROWS_MATCHES(result.get(), std::runtime_error, Message("probe failure"));
+    }
 }
 
 } // namespace silkrpc::ego
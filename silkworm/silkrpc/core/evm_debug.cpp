@@ -16,9 +16,14 @@
 
 #include "evm_debug.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <optional>
 #include <stack>
+#include <stdexcept>
 #include <string>
+#include <utility>
 
 #include <evmc/hex.hpp>
 #include <evmc/instructions.h>
@@ -39,12 +44,23 @@ void from_json(const nlohmann::json& json, DebugConfig& tc) {
     json.at("disableStorage").get_to(tc.disableStorage);
     json.at("disableMemory").get_to(tc.disableMemory);
     json.at("disableStack").get_to(tc.disableStack);
+    if (json.contains("compact")) {
+        json.at("compact").get_to(tc.compact);
+    }
+    if (json.contains("snapshotInterval")) {
+        json.at("snapshotInterval").get_to(tc.snapshotInterval);
+        if (tc.snapshotInterval == 0) {
+            throw std::invalid_argument{"invalid snapshotInterval: 0"};
+        }
+    }
 }
 
 std::ostream& operator<<(std::ostream& out, const DebugConfig& tc) {
     out << "disableStorage: " << std::boolalpha << tc.disableStorage;
     out << " disableMemory: " << std::boolalpha << tc.disableMemory;
     out << " disableStack: " << std::boolalpha << tc.disableStack;
+    out << " compact: " << std::boolalpha << tc.compact;
+    out << " snapshotInterval: " << std::dec << tc.snapshotInterval;
 
     return out;
 }
@@ -68,10 +84,18 @@ void to_json(nlohmann::json& json, const DebugTrace& debug_trace) {
             entry["stack"] = log.stack;
         }
         if (!config.disableMemory) {
-            entry["memory"] = log.memory;
+            if (log.snapshot) {
+                entry["memory"] = log.memory;
+            } else {
+                entry["memoryDiff"] = nlohmann::json::object();
+                for (const auto& [index, word] : log.memory_diff) {
+                    entry["memoryDiff"][std::to_string(index)] = word;
+                }
+                entry["memorySize"] = log.memory_size;
+            }
         }
         if (!config.disableStorage && !log.storage.empty()) {
-            entry["storage"] = log.storage;
+            entry[log.snapshot ? "storage" : "storageDiff"] = log.storage;
         }
         if (log.error) {
             entry["error"] = nlohmann::json::object();
@@ -94,8 +118,10 @@ void output_stack(std::vector<std::string>& vect, const evmone::uint256* stack,
     }
 }
 
+static constexpr std::size_t kMemoryWordSize{32};
+
 void output_memory(std::vector<std::string>& vect, const evmone::Memory& memory) {
-    std::size_t len = 32;
+    std::size_t len = kMemoryWordSize;
     vect.reserve(memory.size() / len);
 
     const auto data = memory.data();
@@ -105,6 +131,19 @@ void output_memory(std::vector<std::string>& vect, const evmone::Memory& memory)
     }
 }
 
+//! Output the memory words changed w.r.t. \p last_memory, where any word beyond its size is considered zero
+void output_memory_diff(std::map<std::size_t, std::string>& diff, const evmone::Memory& memory, silkworm::ByteView last_memory) {
+    static const std::uint8_t kZeroWord[kMemoryWordSize]{};
+
+    const auto data = memory.data();
+    for (std::size_t start = 0; start < memory.size(); start += kMemoryWordSize) {
+        const auto last_word = start < last_memory.size() ? &last_memory[start] : kZeroWord;
+        if (std::memcmp(data + start, last_word, kMemoryWordSize) != 0) {
+            diff.emplace(start / kMemoryWordSize, evmc::hex({data + start, kMemoryWordSize}));
+        }
+    }
+}
+
 void insert_error(DebugLog& log, evmc_status_code status_code) {
     switch(status_code) {
     case evmc_status_code::EVMC_FAILURE:
@@ -140,12 +179,11 @@ void DebugTracer::on_instruction_start(uint32_t pc , const intx::uint256 *stack_
     evmc::address sender(execution_state.msg->sender);
 
     const auto opcode = execution_state.original_code[pc];
-    auto opcode_name = get_opcode_name(opcode_names_, opcode);
 
     SILKRPC_DEBUG << "on_instruction_start:"
         << " pc: " << std::dec << pc
         << " opcode: 0x" << std::hex << evmc::hex(opcode)
-        << " opcode_name: " << opcode_name
+        << " opcode_name: " << get_opcode_name(opcode_names_, opcode)
         << " recipient: " << recipient
         << " sender: " << sender
         << " execution_state: {"
@@ -155,24 +193,47 @@ void DebugTracer::on_instruction_start(uint32_t pc , const intx::uint256 *stack_
         << "   msg.depth: " << std::dec << execution_state.msg->depth
         << "}\n";
 
+    // In compact mode only changes are reported, except for a full snapshot every configured number of steps
+    const bool snapshot{!config_.compact || step_count_ % config_.snapshotInterval == 0};
+    ++step_count_;
+
     bool output_storage = false;
+    std::optional<evmc::bytes32> changed_location;
     if (!config_.disableStorage) {
-        if (opcode_name == "SLOAD" && stack_height >= 1) {
-            const auto address = silkworm::bytes32_from_hex(intx::hex(stack_top[0]));
-            const auto value = intra_block_state.get_current_storage(recipient, address);
-            storage_[recipient][silkworm::to_hex(address)] = silkworm::to_hex(value);
-            output_storage = true;
-        } else if (opcode_name == "SSTORE" && stack_height >= 2) {
-            const auto address = silkworm::bytes32_from_hex(intx::hex(stack_top[0]));
-            const auto value = silkworm::bytes32_from_hex(intx::hex(stack_top[-1]));
-            storage_[recipient][silkworm::to_hex(address)] = silkworm::to_hex(value);
-            output_storage = true;
+        switch (opcode) {
+        case evmc_opcode::OP_SLOAD:
+            if (stack_height >= 1) {
+                const auto location = intx::be::store<evmc::bytes32>(stack_top[0]);
+                storage_[recipient][location] = intra_block_state.get_current_storage(recipient, location);
+                changed_location = location;
+                output_storage = true;
+            }
+            break;
+        case evmc_opcode::OP_SSTORE:
+            if (stack_height >= 2) {
+                const auto location = intx::be::store<evmc::bytes32>(stack_top[0]);
+                storage_[recipient][location] = intx::be::store<evmc::bytes32>(stack_top[-1]);
+                changed_location = location;
+                output_storage = true;
+            }
+            break;
+        default:
+            break;
         }
     }
 
     std::vector<std::string> current_memory;
+    std::map<std::size_t, std::string> memory_diff;
+    const auto memory_size{execution_state.memory.size() / kMemoryWordSize};
     if (!config_.disableMemory) {
-        output_memory(current_memory, execution_state.memory);
+        if (snapshot) {
+            output_memory(current_memory, execution_state.memory);
+        } else {
+            output_memory_diff(memory_diff, execution_state.memory, last_memory_);
+        }
+        if (config_.compact) {
+            last_memory_.assign(execution_state.memory.data(), execution_state.memory.size());
+        }
     }
 
     if (logs_.size() > 0) {
@@ -187,40 +248,45 @@ void DebugTracer::on_instruction_start(uint32_t pc , const intx::uint256 *stack_
             }
             if (!config_.disableMemory) {
                 auto& memory = log.memory;
-                for (int idx = memory.size(); idx < current_memory.size(); idx++) {
-                    memory.push_back(EMPTY_MEMORY);
+                if (log.snapshot) {
+                    for (auto idx = memory.size(); idx < memory_size; idx++) {
+                        memory.push_back(EMPTY_MEMORY);
+                    }
                 }
+                log.memory_size = std::max(log.memory_size, memory_size);
             }
         } else if (depth == execution_state.msg->depth) {
             log.gas_cost = log.gas - execution_state.gas_left;
         }
     }
-    if (stream_ != nullptr && logs_.size() > 1) {
-        auto& log = logs_.front();
-        write_log(log);
-        logs_.erase(logs_.begin());
-    }
+    // Only the last log can still be amended, all previous ones are final
+    write_final_logs();
 
     DebugLog log;
     log.pc = pc;
-    log.op = opcode_name;
+    log.op = get_opcode_name(opcode_names_, opcode);
     log.gas = execution_state.gas_left;
     log.depth = execution_state.msg->depth + 1;
 
     if (!config_.disableStack) {
         output_stack(log.stack, stack_top, stack_height);
     }
+    log.snapshot = snapshot;
+    log.memory_size = memory_size;
     if (!config_.disableMemory) {
-        log.memory = current_memory;
+        log.memory = std::move(current_memory);
+        log.memory_diff = std::move(memory_diff);
     }
-    if (output_storage) {
-        for (const auto &entry : storage_[recipient]) {
-            log.storage[entry.first] = entry.second;
+    if (snapshot && (output_storage || config_.compact)) {
+        for (const auto& [location, value] : storage_[recipient]) {
+            log.storage[silkworm::to_hex(location)] = silkworm::to_hex(value);
         }
+    } else if (changed_location) {
+        log.storage[silkworm::to_hex(*changed_location)] = silkworm::to_hex(storage_[recipient][*changed_location]);
     }
     insert_error(log, execution_state.status);
 
-    logs_.push_back(log);
+    logs_.push_back(std::move(log));
 }
 
 void DebugTracer::on_precompiled_run(const evmc_result& result, int64_t gas, const silkworm::IntraBlockState& intra_block_state) noexcept {
@@ -251,11 +317,7 @@ void DebugTracer::on_execution_end(const evmc_result& result, const silkworm::In
         }
     }
 
-    if (stream_ != nullptr && logs_.size() > 1) {
-        auto& log = logs_.front();
-        write_log(log);
-        logs_.erase(logs_.begin());
-    }
+    write_final_logs();
 
     SILKRPC_DEBUG << "on_execution_end:"
         << " result.status_code: " << result.status_code
@@ -268,30 +330,50 @@ void DebugTracer::flush_logs() {
     for (const auto& log : logs_) {
         write_log(log);
     }
+    logs_.clear();
 }
 
-void DebugTracer::write_log(const DebugLog& log) {
-    nlohmann::json json;
+void DebugTracer::write_final_logs() {
+    if (stream_ == nullptr || logs_.size() < 2) {
+        return;
+    }
+    for (auto it = logs_.begin(); it != logs_.end() - 1; ++it) {
+        write_log(*it);
+    }
+    logs_.erase(logs_.begin(), logs_.end() - 1);
+}
 
-    json["depth"] = log.depth;
-    json["gas"] = log.gas;
-    json["gasCost"] = log.gas_cost;
-    json["op"] = log.op;
-    json["pc"] = log.pc;
-    if (!config_.disableStack) {
-        json["stack"] = log.stack;
+void DebugTracer::write_log(const DebugLog& log) {
+    // Fields written directly in the same (i.e. alphabetical) order as the JSON serialization
+    stream_->open_object();
+    stream_->write_field("depth", log.depth);
+    if (log.error) {
+        stream_->write_field("error", json::EMPTY_OBJECT);
     }
+    stream_->write_field("gas", log.gas);
+    stream_->write_field("gasCost", log.gas_cost);
     if (!config_.disableMemory) {
-        json["memory"] = log.memory;
+        if (log.snapshot) {
+            stream_->write_field("memory", log.memory);
+        } else {
+            stream_->write_field("memoryDiff");
+            stream_->open_object();
+            for (const auto& [index, word] : log.memory_diff) {
+                stream_->write_field(std::to_string(index), word);
+            }
+            stream_->close_object();
+            stream_->write_field("memorySize", log.memory_size);
+        }
     }
-    if (!config_.disableStorage && !log.storage.empty()) {
-        json["storage"] = log.storage;
+    stream_->write_field("op", log.op);
+    stream_->write_field("pc", log.pc);
+    if (!config_.disableStack) {
+        stream_->write_field("stack", log.stack);
     }
-    if (log.error) {
-        json["error"] = nlohmann::json::object();
+    if (!config_.disableStorage && !log.storage.empty()) {
+        stream_->write_field(log.snapshot ? "storage" : "storageDiff", log.storage);
     }
-
-    stream_->write_json(json);
+    stream_->close_object();
 }
 
 template<typename WorldState, typename VM>
@@ -301,10 +383,10 @@ boost::asio::awaitable<std::vector<DebugTrace>> DebugExecutor<WorldState, VM>::e
 
     SILKRPC_DEBUG << "execute: block_number: " << block_number << " #txns: " << transactions.size() << " config: " << config_ << "\n";
 
-    const auto chain_id = co_await core::rawdb::read_chain_id(database_reader_);
-    const auto chain_config_ptr = lookup_chain_config(chain_id);
-    state::RemoteState remote_state{io_context_, database_reader_, block_number-1};
-    EVMExecutor<WorldState, VM> executor{io_context_, database_reader_, *chain_config_ptr, workers_, block_number-1, remote_state};
+    const auto chain_config{co_await core::get_chain_config(database_reader_, caches_.chain_config.get())};
+    state::RemoteState remote_state{io_context_, database_reader_, block_number-1, block.header.parent_hash, caches_.history.get(), caches_.snapshot.get()};
+    EVMExecutor<WorldState, VM> executor{io_context_, database_reader_, *chain_config->config, workers_, block_number-1, remote_state, chain_config->consensus_engine};
+    executor.set_cancellation(cancellation_);
 
     std::vector<DebugTrace> debug_traces(transactions.size());
     for (std::uint64_t idx = 0; idx < transactions.size(); idx++) {
@@ -378,18 +460,35 @@ boost::asio::awaitable<DebugExecutorResult> DebugExecutor<WorldState, VM>::execu
         << " config: " << config_
         << "\n";
 
-    const auto chain_id = co_await core::rawdb::read_chain_id(database_reader_);
-    const auto chain_config_ptr = lookup_chain_config(chain_id);
-    state::RemoteState remote_state{io_context_, database_reader_, block_number};
-    EVMExecutor<WorldState, VM> executor{io_context_, database_reader_, *chain_config_ptr, workers_, block_number, remote_state};
+    const auto chain_config{co_await core::get_chain_config(database_reader_, caches_.chain_config.get())};
+
+    // Replaying the previous transactions on top of the parent state can resume from the nearest checkpoint of the block
+    const bool use_checkpoints{caches_.checkpoint != nullptr && block_number + 1 == block.header.number && index > 0};
+    const auto block_hash{use_checkpoints ? block.header.hash() : evmc::bytes32{}};
+    const auto checkpoint{use_checkpoints ? caches_.checkpoint->find(block_hash, static_cast<std::size_t>(index)) : nullptr};
+
+    // The state is read either at the end of the parent block or at the end of the block itself
+    const auto state_block_hash{block_number + 1 == block.header.number ? block.header.parent_hash : block.header.hash()};
+    state::RemoteState remote_state{io_context_, database_reader_, block_number, state_block_hash, caches_.history.get(), caches_.snapshot.get()};
+    state::CheckpointState curr_state{remote_state, checkpoint};
+    EVMExecutor<WorldState, VM> executor{io_context_, database_reader_, *chain_config->config, workers_, block_number, curr_state, chain_config->consensus_engine};
+    executor.set_cancellation(cancellation_);
 
-    for (auto idx = 0; idx < index; idx++) {
+    for (std::int32_t idx = checkpoint ? static_cast<std::int32_t>(checkpoint->transaction_count()) : 0; idx < index; idx++) {
         silkrpc::Transaction txn{block.transactions[idx]};
 
         if (!txn.from) {
             txn.recover_sender();
         }
         const auto execution_result = co_await executor.call(block, txn);
+
+        const auto transaction_count{static_cast<std::size_t>(idx + 1)};
+        if (use_checkpoints && (transaction_count % state::kCheckpointInterval == 0 || idx + 1 == index)) {
+            auto new_checkpoint = curr_state.start_recording(transaction_count);
+            executor.write_state(block.header.number);
+            curr_state.stop_recording();
+            caches_.checkpoint->insert(block_hash, std::move(new_checkpoint));
+        }
     }
     executor.reset();
 
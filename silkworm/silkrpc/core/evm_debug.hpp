@@ -32,8 +32,12 @@
 #pragma GCC diagnostic pop
 #include <silkworm/state/intra_block_state.hpp>
 
+#include <silkworm/silkrpc/concurrency/cancellation.hpp>
 #include <silkworm/silkrpc/concurrency/context_pool.hpp>
+#include <silkworm/silkrpc/core/chain_config_cache.hpp>
+#include <silkworm/silkrpc/core/execution_caches.hpp>
 #include <silkworm/silkrpc/core/rawdb/accessors.hpp>
+#include <silkworm/silkrpc/core/state_checkpoint_cache.hpp>
 #include <silkworm/silkrpc/json/stream.hpp>
 #include <silkworm/silkrpc/types/block.hpp>
 #include <silkworm/silkrpc/types/call.hpp>
@@ -41,10 +45,16 @@
 
 namespace silkrpc::debug {
 
+//! Default number of steps between two full memory and storage snapshots in compact mode
+constexpr std::uint32_t kDefaultSnapshotInterval{1'000};
+
 struct DebugConfig {
     bool disableStorage{false};
     bool disableMemory{false};
     bool disableStack{false};
+    //! Emit just the memory words and storage slots changed at each step, plus a full snapshot every \ref snapshotInterval steps
+    bool compact{false};
+    std::uint32_t snapshotInterval{kDefaultSnapshotInterval};
 };
 
 static const DebugConfig DEFAULT_DEBUG_CONFIG{false, false, false};
@@ -64,6 +74,10 @@ struct DebugLog {
     std::vector<std::string> memory;
     std::vector<std::string> stack;
     Storage storage;
+    //! Always true unless in compact mode, where memory and storage of all other steps just contain the changes
+    bool snapshot{true};
+    std::size_t memory_size{0};
+    std::map<std::size_t, std::string> memory_diff;
 };
 
 class DebugTracer : public silkworm::EvmTracer {
@@ -83,15 +97,20 @@ public:
     void on_reward_granted(const silkworm::CallResult& result, const silkworm::IntraBlockState& intra_block_state) noexcept override {};
     void on_creation_completed(const evmc_result& result, const silkworm::IntraBlockState& intra_block_state) noexcept override {};
 
+    //! Write all the pending logs to the stream, if any
     void flush_logs();
 
 private:
+    //! Write to the stream (if any) all the logs that cannot change anymore, so that just the last one is kept in memory
+    void write_final_logs();
     void write_log(const DebugLog& log);
 
     std::vector<DebugLog>& logs_;
     const DebugConfig& config_;
     json::Stream* stream_ = nullptr;
-    std::map<evmc::address, Storage> storage_;
+    std::map<evmc::address, std::map<evmc::bytes32, evmc::bytes32>> storage_;
+    silkworm::Bytes last_memory_;
+    std::uint64_t step_count_{0};
     const char* const* opcode_names_ = nullptr;
     std::int64_t start_gas_{0};
     std::int64_t gas_on_precompiled_{0};
@@ -138,8 +157,9 @@ public:
         boost::asio::io_context& io_context,
         const core::rawdb::DatabaseReader& database_reader,
         boost::asio::thread_pool& workers,
-        const DebugConfig& config = DEFAULT_DEBUG_CONFIG)
-        : io_context_(io_context), database_reader_(database_reader), workers_{workers}, config_{config} {}
+        const DebugConfig& config = DEFAULT_DEBUG_CONFIG,
+        const ExecutionCaches& caches = {})
+        : io_context_(io_context), database_reader_(database_reader), workers_{workers}, config_{config}, caches_{caches} {}
     virtual ~DebugExecutor() {}
 
     DebugExecutor(const DebugExecutor&) = delete;
@@ -152,6 +172,9 @@ public:
         return execute(block.header.number-1, block, transaction, transaction.transaction_index, stream);
     }
 
+    //! Stop tracing at the next EVM call when \p cancellation is cancelled (optional, never stopped if null)
+    void set_cancellation(const Cancellation* cancellation) { cancellation_ = cancellation; }
+
 private:
     boost::asio::awaitable<DebugExecutorResult> execute(std::uint64_t block_number, const silkworm::Block& block,
         const silkrpc::Transaction& transaction, std::int32_t = -1, json::Stream* stream = nullptr);
@@ -160,6 +183,8 @@ private:
     const core::rawdb::DatabaseReader& database_reader_;
     boost::asio::thread_pool& workers_;
     const DebugConfig& config_;
+    ExecutionCaches caches_;
+    const Cancellation* cancellation_{nullptr};
 };
 } // namespace silkrpc::debug
 
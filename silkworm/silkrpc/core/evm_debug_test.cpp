@@ -16,7 +16,10 @@
 
 #include "evm_debug.hpp"
 
+#include <cstddef>
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/thread_pool.hpp>
@@ -27,8 +30,10 @@
 
 #include <silkworm/silkrpc/common/log.hpp>
 #include <silkworm/silkrpc/common/util.hpp>
+#include <silkworm/silkrpc/core/evm_executor.hpp>
 #include <silkworm/silkrpc/core/rawdb/accessors.hpp>
 #include <silkworm/silkrpc/core/rawdb/chain.hpp>
+#include <silkworm/silkrpc/core/remote_state.hpp>
 #include <silkworm/silkrpc/ethdb/tables.hpp>
 #include <silkworm/silkrpc/test/mock_database_reader.hpp>
 #include <silkworm/silkrpc/types/transaction.hpp>
@@ -56,6 +61,25 @@ static silkworm::Bytes kConfigValue{*silkworm::from_hex(
     "223a302c22697374616e62756c426c6f636b223a313536313635312c226265726c696e426c6f636b223a343436303634342c226c6f6e646f6e"
     "426c6f636b223a353036323630352c22636c69717565223a7b22706572696f64223a31352c2265706f6368223a33303030307d7d")};
 
+//! Tracer recording at each step, when run after \ref DebugTracer, the logs still pending and the size of the trace already written
+class StreamProbe : public NullTracer {
+public:
+    StreamProbe(const std::vector<DebugLog>& logs, StringWriter& writer) : logs_(logs), writer_(writer) {}
+
+    void on_instruction_start(uint32_t pc, const intx::uint256* stack_top, const int stack_size,
+         const evmone::ExecutionState& execution_state, const silkworm::IntraBlockState& intra_block_state) noexcept override {
+        pending_log_counts.push_back(logs_.size());
+        written_sizes.push_back(writer_.get_content().size());
+    }
+
+    std::vector<std::size_t> pending_log_counts;
+    std::vector<std::size_t> written_sizes;
+
+private:
+    const std::vector<DebugLog>& logs_;
+    StringWriter& writer_;
+};
+
 TEST_CASE("DebugExecutor::execute precompiled") {
     SILKRPC_LOG_STREAMS(null_stream(), null_stream());
     SILKRPC_LOG_VERBOSITY(LogLevel::None);
@@ -899,6 +923,416 @@ TEST_CASE("DebugExecutor::execute call 1") {
             ]
         })"_json);
     }
+
+    SECTION("Call: compact") {
+        EXPECT_CALL(db_reader, get_one(db::table::kCanonicalHashes, silkworm::ByteView{kZeroKey}))
+            .WillRepeatedly(InvokeWithoutArgs([]() -> boost::asio::awaitable<silkworm::Bytes> {
+                co_return kZeroHeader;
+            }));
+        EXPECT_CALL(db_reader, get_one(db::table::kConfig, silkworm::ByteView{kConfigKey}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<silkworm::Bytes> {
+                co_return kConfigValue;
+            }));
+        EXPECT_CALL(db_reader, get(db::table::kAccountHistory, silkworm::ByteView{kAccountHistoryKey1}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<KeyValue> {
+                co_return KeyValue{kAccountHistoryKey1, kAccountHistoryValue1};
+            }));
+        EXPECT_CALL(db_reader, get(db::table::kAccountHistory, silkworm::ByteView{kAccountHistoryKey3}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<KeyValue> {
+                co_return KeyValue{kAccountHistoryKey3, kAccountHistoryValue3};
+            }));
+        EXPECT_CALL(db_reader, get_both_range(db::table::kPlainAccountChangeSet, silkworm::ByteView{kAccountChangeSetKey1}, silkworm::ByteView{kAccountChangeSetSubkey1}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<std::optional<silkworm::Bytes>> {
+                co_return kAccountChangeSetValue1;
+            }));
+        EXPECT_CALL(db_reader, get_both_range(db::table::kPlainAccountChangeSet, silkworm::ByteView{kAccountChangeSetKey2}, silkworm::ByteView{kAccountChangeSetSubKey2}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<std::optional<silkworm::Bytes>> {
+                co_return kAccountChangeSetValue2;
+            }));
+        EXPECT_CALL(db_reader, get(db::table::kAccountHistory, silkworm::ByteView{kAccountHistoryKey2}))
+            .WillRepeatedly(InvokeWithoutArgs([]() -> boost::asio::awaitable<KeyValue> {
+                co_return KeyValue{kAccountHistoryKey2, kAccountHistoryValue2};
+            }));
+        EXPECT_CALL(db_reader, get_one(db::table::kPlainState, silkworm::ByteView{kPlainStateKey2}))
+            .WillRepeatedly(InvokeWithoutArgs([]() -> boost::asio::awaitable<silkworm::Bytes> {
+                co_return silkworm::Bytes{};
+            }));
+
+        const auto block_number = 5'405'095; // 0x5279A7
+        silkrpc::Call call;
+        call.from = 0xe0a2Bd4258D2768837BAa26A28fE71Dc079f84c7_address;
+        call.gas = 118'936;
+        call.gas_price = 7;
+        // PUSH1 0x2a PUSH1 0 MSTORE PUSH1 0x2b PUSH1 0 SSTORE PUSH1 0 SLOAD STOP
+        call.data = *silkworm::from_hex("602a600052602b60005560005400");
+
+        silkworm::Block block{};
+        block.header.number = block_number;
+
+        // A full snapshot every 4 steps: the memory and storage changed in the steps in between are only reported as diffs
+        DebugConfig config{false, false, true, true, 4};
+        DebugExecutor executor{context_pool.next_io_context(), db_reader, workers, config};
+        boost::asio::io_context& io_context = context_pool.next_io_context();
+        auto execution_result = boost::asio::co_spawn(io_context.get_executor(), executor.execute(block, call), boost::asio::use_future);
+        auto result = execution_result.get();
+
+        context_pool.stop();
+        io_context.stop();
+        context_pool.join();
+
+        CHECK(result.pre_check_error.has_value() == false);
+        CHECK(result.debug_trace == R"({
+            "failed": false,
+            "gas": 75397,
+            "returnValue": "",
+            "structLogs": [
+                {
+                    "depth": 1,
+                    "gas": 65760,
+                    "gasCost": 3,
+                    "memory": [],
+                    "op": "PUSH1",
+                    "pc": 0
+                },
+                {
+                    "depth": 1,
+                    "gas": 65757,
+                    "gasCost": 3,
+                    "memoryDiff": {},
+                    "memorySize": 0,
+                    "op": "PUSH1",
+                    "pc": 2
+                },
+                {
+                    "depth": 1,
+                    "gas": 65754,
+                    "gasCost": 6,
+                    "memoryDiff": {},
+                    "memorySize": 0,
+                    "op": "MSTORE",
+                    "pc": 4
+                },
+                {
+                    "depth": 1,
+                    "gas": 65748,
+                    "gasCost": 3,
+                    "memoryDiff": {
+                        "0": "000000000000000000000000000000000000000000000000000000000000002a"
+                    },
+                    "memorySize": 1,
+                    "op": "PUSH1",
+                    "pc": 5
+                },
+                {
+                    "depth": 1,
+                    "gas": 65745,
+                    "gasCost": 3,
+                    "memory": [
+                        "000000000000000000000000000000000000000000000000000000000000002a"
+                    ],
+                    "op": "PUSH1",
+                    "pc": 7
+                },
+                {
+                    "depth": 1,
+                    "gas": 65742,
+                    "gasCost": 22100,
+                    "memoryDiff": {},
+                    "memorySize": 1,
+                    "op": "SSTORE",
+                    "pc": 9,
+                    "storageDiff": {
+                        "0000000000000000000000000000000000000000000000000000000000000000": "000000000000000000000000000000000000000000000000000000000000002b"
+                    }
+                },
+                {
+                    "depth": 1,
+                    "gas": 43642,
+                    "gasCost": 3,
+                    "memoryDiff": {},
+                    "memorySize": 1,
+                    "op": "PUSH1",
+                    "pc": 10
+                },
+                {
+                    "depth": 1,
+                    "gas": 43639,
+                    "gasCost": 100,
+                    "memoryDiff": {},
+                    "memorySize": 1,
+                    "op": "SLOAD",
+                    "pc": 12,
+                    "storageDiff": {
+                        "0000000000000000000000000000000000000000000000000000000000000000": "000000000000000000000000000000000000000000000000000000000000002b"
+                    }
+                },
+                {
+                    "depth": 1,
+                    "gas": 43539,
+                    "gasCost": 0,
+                    "memory": [
+                        "000000000000000000000000000000000000000000000000000000000000002a"
+                    ],
+                    "op": "STOP",
+                    "pc": 13,
+                    "storage": {
+                        "0000000000000000000000000000000000000000000000000000000000000000": "000000000000000000000000000000000000000000000000000000000000002b"
+                    }
+                }
+            ]
+        })"_json);
+    }
+
+    SECTION("Call with stream: compact") {
+        EXPECT_CALL(db_reader, get_one(db::table::kCanonicalHashes, silkworm::ByteView{kZeroKey}))
+            .WillRepeatedly(InvokeWithoutArgs([]() -> boost::asio::awaitable<silkworm::Bytes> {
+                co_return kZeroHeader;
+            }));
+        EXPECT_CALL(db_reader, get_one(db::table::kConfig, silkworm::ByteView{kConfigKey}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<silkworm::Bytes> {
+                co_return kConfigValue;
+            }));
+        EXPECT_CALL(db_reader, get(db::table::kAccountHistory, silkworm::ByteView{kAccountHistoryKey1}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<KeyValue> {
+                co_return KeyValue{kAccountHistoryKey1, kAccountHistoryValue1};
+            }));
+        EXPECT_CALL(db_reader, get(db::table::kAccountHistory, silkworm::ByteView{kAccountHistoryKey3}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<KeyValue> {
+                co_return KeyValue{kAccountHistoryKey3, kAccountHistoryValue3};
+            }));
+        EXPECT_CALL(db_reader, get_both_range(db::table::kPlainAccountChangeSet, silkworm::ByteView{kAccountChangeSetKey1}, silkworm::ByteView{kAccountChangeSetSubkey1}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<std::optional<silkworm::Bytes>> {
+                co_return kAccountChangeSetValue1;
+            }));
+        EXPECT_CALL(db_reader, get_both_range(db::table::kPlainAccountChangeSet, silkworm::ByteView{kAccountChangeSetKey2}, silkworm::ByteView{kAccountChangeSetSubKey2}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<std::optional<silkworm::Bytes>> {
+                co_return kAccountChangeSetValue2;
+            }));
+        EXPECT_CALL(db_reader, get(db::table::kAccountHistory, silkworm::ByteView{kAccountHistoryKey2}))
+            .WillRepeatedly(InvokeWithoutArgs([]() -> boost::asio::awaitable<KeyValue> {
+                co_return KeyValue{kAccountHistoryKey2, kAccountHistoryValue2};
+            }));
+        EXPECT_CALL(db_reader, get_one(db::table::kPlainState, silkworm::ByteView{kPlainStateKey2}))
+            .WillRepeatedly(InvokeWithoutArgs([]() -> boost::asio::awaitable<silkworm::Bytes> {
+                co_return silkworm::Bytes{};
+            }));
+
+        const auto block_number = 5'405'095; // 0x5279A7
+        silkrpc::Call call;
+        call.from = 0xe0a2Bd4258D2768837BAa26A28fE71Dc079f84c7_address;
+        call.gas = 118'936;
+        call.gas_price = 7;
+        // PUSH1 0x2a PUSH1 0 MSTORE PUSH1 0x2b PUSH1 0 SSTORE PUSH1 0 SLOAD STOP
+        call.data = *silkworm::from_hex("602a600052602b60005560005400");
+
+        silkworm::Block block{};
+        block.header.number = block_number;
+
+        StringWriter writer(4096);
+        json::Stream stream(writer);
+
+        DebugConfig config{false, false, true, true, 4};
+        DebugExecutor executor{context_pool.next_io_context(), db_reader, workers, config};
+        boost::asio::io_context& io_context = context_pool.next_io_context();
+
+        stream.open_object();
+        auto execution_result = boost::asio::co_spawn(io_context.get_executor(), executor.execute(block, call, &stream), boost::asio::use_future);
+        auto result = execution_result.get();
+
+        context_pool.stop();
+        context_pool.join();
+
+        stream.close_object();
+        stream.close();
+
+        nlohmann::json json = nlohmann::json::parse(writer.get_content());
+
+        CHECK(result.pre_check_error.has_value() == false);
+        CHECK(json == R"({
+            "failed": false,
+            "gas": 75397,
+            "returnValue": "",
+            "structLogs": [
+                {
+                    "depth": 1,
+                    "gas": 65760,
+                    "gasCost": 3,
+                    "memory": [],
+                    "op": "PUSH1",
+                    "pc": 0
+                },
+                {
+                    "depth": 1,
+                    "gas": 65757,
+                    "gasCost": 3,
+                    "memoryDiff": {},
+                    "memorySize": 0,
+                    "op": "PUSH1",
+                    "pc": 2
+                },
+                {
+                    "depth": 1,
+                    "gas": 65754,
+                    "gasCost": 6,
+                    "memoryDiff": {},
+                    "memorySize": 0,
+                    "op": "MSTORE",
+                    "pc": 4
+                },
+                {
+                    "depth": 1,
+                    "gas": 65748,
+                    "gasCost": 3,
+                    "memoryDiff": {
+                        "0": "000000000000000000000000000000000000000000000000000000000000002a"
+                    },
+                    "memorySize": 1,
+                    "op": "PUSH1",
+                    "pc": 5
+                },
+                {
+                    "depth": 1,
+                    "gas": 65745,
+                    "gasCost": 3,
+                    "memory": [
+                        "000000000000000000000000000000000000000000000000000000000000002a"
+                    ],
+                    "op": "PUSH1",
+                    "pc": 7
+                },
+                {
+                    "depth": 1,
+                    "gas": 65742,
+                    "gasCost": 22100,
+                    "memoryDiff": {},
+                    "memorySize": 1,
+                    "op": "SSTORE",
+                    "pc": 9,
+                    "storageDiff": {
+                        "0000000000000000000000000000000000000000000000000000000000000000": "000000000000000000000000000000000000000000000000000000000000002b"
+                    }
+                },
+                {
+                    "depth": 1,
+                    "gas": 43642,
+                    "gasCost": 3,
+                    "memoryDiff": {},
+                    "memorySize": 1,
+                    "op": "PUSH1",
+                    "pc": 10
+                },
+                {
+                    "depth": 1,
+                    "gas": 43639,
+                    "gasCost": 100,
+                    "memoryDiff": {},
+                    "memorySize": 1,
+                    "op": "SLOAD",
+                    "pc": 12,
+                    "storageDiff": {
+                        "0000000000000000000000000000000000000000000000000000000000000000": "000000000000000000000000000000000000000000000000000000000000002b"
+                    }
+                },
+                {
+                    "depth": 1,
+                    "gas": 43539,
+                    "gasCost": 0,
+                    "memory": [
+                        "000000000000000000000000000000000000000000000000000000000000002a"
+                    ],
+                    "op": "STOP",
+                    "pc": 13,
+                    "storage": {
+                        "0000000000000000000000000000000000000000000000000000000000000000": "000000000000000000000000000000000000000000000000000000000000002b"
+                    }
+                }
+            ]
+        })"_json);
+    }
+
+    SECTION("Call with stream: logs written as produced") {
+        EXPECT_CALL(db_reader, get(db::table::kAccountHistory, silkworm::ByteView{kAccountHistoryKey1}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<KeyValue> {
+                co_return KeyValue{kAccountHistoryKey1, kAccountHistoryValue1};
+            }));
+        EXPECT_CALL(db_reader, get(db::table::kAccountHistory, silkworm::ByteView{kAccountHistoryKey3}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<KeyValue> {
+                co_return KeyValue{kAccountHistoryKey3, kAccountHistoryValue3};
+            }));
+        EXPECT_CALL(db_reader, get_both_range(db::table::kPlainAccountChangeSet, silkworm::ByteView{kAccountChangeSetKey1}, silkworm::ByteView{kAccountChangeSetSubkey1}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<std::optional<silkworm::Bytes>> {
+                co_return kAccountChangeSetValue1;
+            }));
+        EXPECT_CALL(db_reader, get_both_range(db::table::kPlainAccountChangeSet, silkworm::ByteView{kAccountChangeSetKey2}, silkworm::ByteView{kAccountChangeSetSubKey2}))
+            .WillOnce(InvokeWithoutArgs([]() -> boost::asio::awaitable<std::optional<silkworm::Bytes>> {
+                co_return kAccountChangeSetValue2;
+            }));
+        EXPECT_CALL(db_reader, get(db::table::kAccountHistory, silkworm::ByteView{kAccountHistoryKey2}))
+            .WillRepeatedly(InvokeWithoutArgs([]() -> boost::asio::awaitable<KeyValue> {
+                co_return KeyValue{kAccountHistoryKey2, kAccountHistoryValue2};
+            }));
+        EXPECT_CALL(db_reader, get_one(db::table::kPlainState, silkworm::ByteView{kPlainStateKey2}))
+            .WillRepeatedly(InvokeWithoutArgs([]() -> boost::asio::awaitable<silkworm::Bytes> {
+                co_return silkworm::Bytes{};
+            }));
+
+        const auto block_number = 5'405'095; // 0x5279A7
+        silkrpc::Call call;
+        call.from = 0xe0a2Bd4258D2768837BAa26A28fE71Dc079f84c7_address;
+        call.gas = 118'936;
+        call.gas_price = 7;
+        // PUSH1 0x2a PUSH1 0 MSTORE PUSH1 0x2b PUSH1 0 SSTORE PUSH1 0 SLOAD STOP
+        call.data = *silkworm::from_hex("602a600052602b60005560005400");
+        const silkworm::Transaction txn{call.to_transaction()};
+
+        silkworm::Block block{};
+        block.header.number = block_number;
+
+        StringWriter writer(4096);
+        json::Stream stream(writer);
+
+        DebugConfig config;
+        std::vector<DebugLog> logs;
+        auto debug_tracer = std::make_shared<DebugTracer>(logs, config, &stream);
+        auto stream_probe = std::make_shared<StreamProbe>(logs, writer);
+        silkrpc::Tracers tracers{debug_tracer, stream_probe};
+
+        boost::asio::io_context& io_context = context_pool.next_io_context();
+        const auto chain_config_ptr = lookup_chain_config(5);
+        state::RemoteState remote_state{io_context, db_reader, block_number};
+        EVMExecutor executor{io_context, db_reader, *chain_config_ptr, workers, block_number, remote_state};
+
+        stream.open_array();
+        auto execution_result = boost::asio::co_spawn(io_context.get_executor(), executor.call(block, txn, tracers), boost::asio::use_future);
+        auto result = execution_result.get();
+        debug_tracer->flush_logs();
+        stream.close_array();
+        stream.close();
+
+        context_pool.stop();
+        context_pool.join();
+
+        CHECK(result.pre_check_error.has_value() == false);
+
+        // Just the log of the current step is kept in memory, each previous one has already been written
+        CHECK(stream_probe->pending_log_counts == std::vector<std::size_t>(9, 1));
+        REQUIRE(stream_probe->written_sizes.size() == 9);
+        for (std::size_t i{1}; i < stream_probe->written_sizes.size(); ++i) {
+            CHECK(stream_probe->written_sizes[i] > stream_probe->written_sizes[i - 1]);
+        }
+
+        // Storage is reported just by the SSTORE and SLOAD opcodes
+        nlohmann::json json = nlohmann::json::parse(writer.get_content());
+        REQUIRE(json.size() == 9);
+        std::vector<std::string> ops;
+        for (const auto& log : json) {
+            ops.push_back(log["op"]);
+            CHECK(log.contains("storage") == (log["op"] == "SSTORE" || log["op"] == "SLOAD"));
+        }
+        CHECK(ops == std::vector<std::string>{"PUSH1", "PUSH1", "MSTORE", "PUSH1", "PUSH1", "SSTORE", "PUSH1", "SLOAD", "STOP"});
+        CHECK(json[5]["storage"] == R"({"0000000000000000000000000000000000000000000000000000000000000000": "000000000000000000000000000000000000000000000000000000000000002b"})"_json);
+        CHECK(json[7]["storage"] == R"({"0000000000000000000000000000000000000000000000000000000000000000": "000000000000000000000000000000000000000000000000000000000000002b"})"_json);
+    }
 }
 
 TEST_CASE("DebugExecutor::execute call 2") {
@@ -1499,6 +1933,45 @@ TEST_CASE("DebugTrace json serialization") {
         })"_json);
     }
 
+    SECTION("DebugTrace: compact step") {
+        DebugLog diff_log{log};
+        diff_log.snapshot = false;
+        diff_log.memory.clear();
+        diff_log.memory_size = 3;
+        diff_log.memory_diff[2] = "00000000000000000000000000000000000000000000000000000000000000ff";
+
+        DebugTrace debug_trace;
+        debug_trace.failed = false;
+        debug_trace.gas = 20;
+        debug_trace.return_value = "deadbeaf";
+        debug_trace.debug_logs.push_back(diff_log);
+
+        debug_trace.debug_config.disableStorage = false;
+        debug_trace.debug_config.disableMemory = false;
+        debug_trace.debug_config.disableStack = true;
+        debug_trace.debug_config.compact = true;
+
+        CHECK(debug_trace == R"({
+            "failed": false,
+            "gas": 20,
+            "returnValue": "deadbeaf",
+            "structLogs": [{
+                "depth": 1,
+                "gas": 3,
+                "gasCost": 4,
+                "op": "PUSH1",
+                "pc": 1,
+                "memoryDiff": {
+                    "2": "00000000000000000000000000000000000000000000000000000000000000ff"
+                },
+                "memorySize": 3,
+                "storageDiff": {
+                    "804292fe56769f4b9f0e91cf85875f67487cd9e85a084cbba2188be4466c4f23": "0000000000000000000000000000000000000000000000000000000000000008"
+                }
+            }]
+        })"_json);
+    }
+
     SECTION("DebugTrace vector") {
         DebugTrace debug_trace;
         debug_trace.failed = false;
@@ -1581,13 +2054,42 @@ TEST_CASE("DebugConfig") {
         CHECK(config.disableStorage == true);
         CHECK(config.disableMemory == false);
         CHECK(config.disableStack == true);
+        CHECK(config.compact == false);
+        CHECK(config.snapshotInterval == kDefaultSnapshotInterval);
+    }
+    SECTION("json deserialization: compact") {
+        nlohmann::json json = R"({
+            "disableStorage": false,
+            "disableMemory": false,
+            "disableStack": true,
+            "compact": true,
+            "snapshotInterval": 100
+            })"_json;
+
+        DebugConfig config;
+        from_json(json, config);
+
+        CHECK(config.compact == true);
+        CHECK(config.snapshotInterval == 100);
+    }
+    SECTION("json deserialization: zero snapshot interval") {
+        nlohmann::json json = R"({
+            "disableStorage": false,
+            "disableMemory": false,
+            "disableStack": true,
+            "compact": true,
+            "snapshotInterval": 0
+            })"_json;
+
+        DebugConfig config;
+        CHECK_THROWS_AS(from_json(json, config), std::invalid_argument);
     }
     SECTION("dump on stream") {
         DebugConfig config{true, false, true};
 
         std::ostringstream os;
         os << config;
-        CHECK(os.str() == "disableStorage: true disableMemory: false disableStack: true");
+        CHECK(os.str() == "disableStorage: true disableMemory: false disableStack: true compact: false snapshotInterval: 1000");
     }
 }
 }  // namespace silkrpc::debug
@@ -17,6 +17,7 @@
 #include "evm_executor.hpp"
 
 #include <array>
+#include <exception>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -31,8 +32,10 @@
 #include <silkworm/chain/protocol_param.hpp>
 #include <silkworm/common/util.hpp>
 
+#include <silkworm/silkrpc/common/clock_time.hpp>
 #include <silkworm/silkrpc/common/log.hpp>
 #include <silkworm/silkrpc/common/util.hpp>
+#include <silkworm/silkrpc/metrics/metrics.hpp>
 #include <silkworm/silkrpc/types/transaction.hpp>
 
 namespace silkrpc {
@@ -155,7 +158,7 @@ std::string EVMExecutor<WorldState, VM>::get_error_message(int64_t error_code, c
 }
 
 template<typename WorldState, typename VM>
-uint64_t EVMExecutor<WorldState, VM>::refund_gas(const VM& evm, const silkworm::Transaction& txn, uint64_t gas_left, uint64_t gas_refund) {
+uint64_t EVMExecutor<WorldState, VM>::refund_gas(WorldState& state, const VM& evm, const silkworm::Transaction& txn, uint64_t gas_left, uint64_t gas_refund) {
     const evmc_revision rev{evm.revision()};
     const uint64_t max_refund_quotient{rev >= EVMC_LONDON ? silkworm::param::kMaxRefundQuotientLondon
                                                           : silkworm::param::kMaxRefundQuotientFrontier};
@@ -168,7 +171,7 @@ uint64_t EVMExecutor<WorldState, VM>::refund_gas(const VM& evm, const silkworm::
     const intx::uint256 effective_gas_price{txn.max_fee_per_gas >= base_fee_per_gas ? txn.effective_gas_price(base_fee_per_gas)
                                                                                     : txn.max_priority_fee_per_gas};
     SILKRPC_DEBUG << "EVMExecutor::refund_gas effective_gas_price: " << effective_gas_price << "\n";
-    state_.add_to_balance(*txn.from, gas_left * effective_gas_price);
+    state.add_to_balance(*txn.from, gas_left * effective_gas_price);
     return gas_left;
 }
 
@@ -176,6 +179,12 @@ template<typename WorldState, typename VM>
 void EVMExecutor<WorldState, VM>::reset() {
     state_.clear_journal_and_substate();
 }
+
+template<typename WorldState, typename VM>
+void EVMExecutor<WorldState, VM>::write_state(uint64_t block_number) {
+    state_.write_to_db(block_number);
+}
+
 template<typename WorldState, typename VM>
 std::optional<std::string> EVMExecutor<WorldState, VM>::pre_check(const VM& evm, const silkworm::Transaction& txn, const intx::uint256 base_fee_per_gas, const intx::uint128 g0) {
     const evmc_revision rev{evm.revision()};
@@ -205,6 +214,87 @@ std::optional<std::string> EVMExecutor<WorldState, VM>::pre_check(const VM& evm,
     return std::nullopt;
 }
 
+template<typename WorldState, typename VM>
+ExecutionResult EVMExecutor<WorldState, VM>::execute(WorldState& state, const silkworm::Block& block, const silkworm::Transaction& txn, const Tracers& tracers,
+    bool refund, bool gas_bailout) {
+    VM evm{block, state, config_};
+    evm.beneficiary = consensus_engine_->get_beneficiary(block.header);
+
+    for (auto& tracer : tracers) {
+        evm.add_tracer(*tracer);
+    }
+
+    assert(txn.from.has_value());
+    state.access_account(*txn.from);
+
+    const evmc_revision rev{evm.revision()};
+    const intx::uint256 base_fee_per_gas{evm.block().header.base_fee_per_gas.value_or(0)};
+    const intx::uint128 g0{silkworm::intrinsic_gas(txn, rev)};
+    assert(g0 <= UINT64_MAX); // true due to the precondition (transaction must be valid)
+
+    const auto error = pre_check(evm, txn, base_fee_per_gas, g0);
+    if (error) {
+        silkworm::Bytes data{};
+        return ExecutionResult{1000, txn.gas_limit, data, *error};
+    }
+
+    intx::uint256 want;
+    if (txn.max_fee_per_gas > 0 || txn.max_priority_fee_per_gas > 0) {
+        // This method should be called after check (max_fee and base_fee) present in pre_check() method
+        const intx::uint256 effective_gas_price{txn.effective_gas_price(base_fee_per_gas)};
+        want = txn.gas_limit * effective_gas_price;
+    } else {
+        want = 0;
+    }
+    const auto have = state.get_balance(*txn.from);
+    if (have < want + txn.value) {
+        if (!gas_bailout) {
+            silkworm::Bytes data{};
+            std::string from = silkworm::to_hex(*txn.from);
+            std::string error = "insufficient funds for gas * price + value: address 0x" + from + " have " + intx::to_string(have) + " want " + intx::to_string(want+txn.value);
+            return ExecutionResult{1000, txn.gas_limit, data, error};
+        }
+    } else {
+        state.subtract_from_balance(*txn.from, want);
+    }
+
+    if (txn.to.has_value()) {
+        state.access_account(*txn.to);
+        // EVM itself increments the nonce for contract creation
+        state.set_nonce(*txn.from, state.get_nonce(*txn.from) + 1);
+    }
+    for (const silkworm::AccessListEntry& ae : txn.access_list) {
+        state.access_account(ae.account);
+        for (const evmc::bytes32& key : ae.storage_keys) {
+            state.access_storage(ae.account, key);
+        }
+    }
+
+    SILKRPC_DEBUG << "EVMExecutor::call execute on EVM txn: " << &txn << " g0: " << static_cast<uint64_t>(g0) << " start\n";
+    const auto result{evm.execute(txn, txn.gas_limit - static_cast<uint64_t>(g0))};
+    SILKRPC_DEBUG << "EVMExecutor::call execute on EVM txn: " << &txn << " gas_left: " << result.gas_left << " end\n";
+
+    uint64_t gas_left = result.gas_left;
+    const uint64_t refunded_gas_left{refund_gas(state, evm, txn, result.gas_left, result.gas_refund)};
+    const uint64_t gas_used{txn.gas_limit - refunded_gas_left};
+    if (refund) {
+        gas_left = txn.gas_limit - gas_used;
+    }
+
+    // Reward the fee recipient
+    const intx::uint256 priority_fee_per_gas{txn.max_fee_per_gas >= base_fee_per_gas ? txn.priority_fee_per_gas(base_fee_per_gas)
+                                                                                     : txn.max_priority_fee_per_gas};
+    SILKRPC_DEBUG << "EVMExecutor::call evm.beneficiary: " << evm.beneficiary << " balance: " << priority_fee_per_gas * gas_used << "\n";
+    state.add_to_balance(evm.beneficiary, priority_fee_per_gas * gas_used);
+
+    for (auto tracer : evm.tracers()) {
+        tracer.get().on_reward_granted(result, evm.state());
+    }
+    state.finalize_transaction();
+
+    return ExecutionResult{result.status, gas_left, result.data, std::nullopt, refunded_gas_left - result.gas_left};
+}
+
 template<typename WorldState, typename VM>
 boost::asio::awaitable<ExecutionResult> EVMExecutor<WorldState, VM>::call(
     const silkworm::Block& block,
@@ -215,95 +305,32 @@ boost::asio::awaitable<ExecutionResult> EVMExecutor<WorldState, VM>::call(
     SILKRPC_DEBUG << "EVMExecutor::call: " << block.header.number << " gasLimit: " << txn.gas_limit << " refund: " << refund << " gasBailout: " << gas_bailout << "\n";
     SILKRPC_DEBUG << "EVMExecutor::call:Transaction: " << &txn << "Txn: " << txn << "\n";
 
-    const auto exec_result = co_await boost::asio::async_compose<decltype(boost::asio::use_awaitable), void(ExecutionResult)>(
+    throw_if_cancelled(cancellation_);
+
+    const auto exec_result = co_await boost::asio::async_compose<decltype(boost::asio::use_awaitable), void(std::exception_ptr, ExecutionResult)>(
         [this, &block, &txn, &tracers, &refund, &gas_bailout](auto&& self) {
             SILKRPC_TRACE << "EVMExecutor::call post block: " << block.header.number << " txn: " << &txn << "\n";
-            boost::asio::post(workers_, [this, &block, &txn, &tracers, &refund, &gas_bailout, self = std::move(self)]() mutable {
-                VM evm{block, state_, config_};
-                evm.beneficiary = consensus_engine_->get_beneficiary(block.header);
-
-                for (auto& tracer : tracers) {
-                    evm.add_tracer(*tracer);
+            metrics::registry().worker_queue_depth().increment();
+            const auto post_time = clock_time::now();
+            boost::asio::post(workers_, [this, &block, &txn, &tracers, &refund, &gas_bailout, post_time, self = std::move(self)]() mutable {
+                metrics::registry().worker_queue_depth().decrement();
+                const auto start_time = clock_time::now();
+                ExecutionResult exec_result{};
+                std::exception_ptr exec_error;
+                try {
+                    // The request could have been cancelled while waiting for a worker
+                    throw_if_cancelled(cancellation_);
+                    exec_result = execute(state_, block, txn, tracers, refund, gas_bailout);
+                } catch (...) {
+                    // Any state read could fail (e.g. because cancelled), so the error must be thrown back to the caller instead of the worker
+                    exec_error = std::current_exception();
                 }
-
-                assert(txn.from.has_value());
-                state_.access_account(*txn.from);
-
-                const evmc_revision rev{evm.revision()};
-                const intx::uint256 base_fee_per_gas{evm.block().header.base_fee_per_gas.value_or(0)};
-                const intx::uint128 g0{silkworm::intrinsic_gas(txn, rev)};
-                assert(g0 <= UINT64_MAX); // true due to the precondition (transaction must be valid)
-
-                const auto error = pre_check(evm, txn, base_fee_per_gas, g0);
-                if (error) {
-                    silkworm::Bytes data{};
-                    ExecutionResult exec_result{1000, txn.gas_limit, data, *error};
-                    boost::asio::post(io_context_, [exec_result, self = std::move(self)]() mutable {
-                        self.complete(exec_result);
-                    });
-                    return;
+                if (profile_) {
+                    profile_->add_worker_wait(post_time, start_time);
+                    profile_->add_evm(start_time, clock_time::now());
                 }
-
-                intx::uint256 want;
-                if (txn.max_fee_per_gas > 0 || txn.max_priority_fee_per_gas > 0) {
-                    // This method should be called after check (max_fee and base_fee) present in pre_check() method
-                    const intx::uint256 effective_gas_price{txn.effective_gas_price(base_fee_per_gas)};
-                    want = txn.gas_limit * effective_gas_price;
-                } else {
-                    want = 0;
-                }
-                const auto have = state_.get_balance(*txn.from);
-                if (have < want + txn.value) {
-                    if (!gas_bailout) {
-                        silkworm::Bytes data{};
-                        std::string from = silkworm::to_hex(*txn.from);
-                        std::string error = "insufficient funds for gas * price + value: address 0x" + from + " have " + intx::to_string(have) + " want " + intx::to_string(want+txn.value);
-                        ExecutionResult exec_result{1000, txn.gas_limit, data, error};
-                        boost::asio::post(io_context_, [exec_result, self = std::move(self)]() mutable {
-                            self.complete(exec_result);
-                        });
-                        return;
-                    }
-                } else {
-                    state_.subtract_from_balance(*txn.from, want);
-                }
-
-                if (txn.to.has_value()) {
-                    state_.access_account(*txn.to);
-                    // EVM itself increments the nonce for contract creation
-                    state_.set_nonce(*txn.from, state_.get_nonce(*txn.from) + 1);
-                }
-                for (const silkworm::AccessListEntry& ae : txn.access_list) {
-                    state_.access_account(ae.account);
-                    for (const evmc::bytes32& key : ae.storage_keys) {
-                        state_.access_storage(ae.account, key);
-                    }
-                }
-
-                SILKRPC_DEBUG << "EVMExecutor::call execute on EVM txn: " << &txn << " g0: " << static_cast<uint64_t>(g0) << " start\n";
-                const auto result{evm.execute(txn, txn.gas_limit - static_cast<uint64_t>(g0))};
-                SILKRPC_DEBUG << "EVMExecutor::call execute on EVM txn: " << &txn << " gas_left: " << result.gas_left << " end\n";
-
-                uint64_t gas_left = result.gas_left;
-                const uint64_t gas_used{txn.gas_limit - refund_gas(evm, txn, result.gas_left, result.gas_refund)};
-                if (refund) {
-                    gas_left = txn.gas_limit - gas_used;
-                }
-
-                // Reward the fee recipient
-                const intx::uint256 priority_fee_per_gas{txn.max_fee_per_gas >= base_fee_per_gas ? txn.priority_fee_per_gas(base_fee_per_gas)
-                                                                                                 : txn.max_priority_fee_per_gas};
-                SILKRPC_DEBUG << "EVMExecutor::call evm.beneficiary: " << evm.beneficiary << " balance: " << priority_fee_per_gas * gas_used << "\n";
-                state_.add_to_balance(evm.beneficiary, priority_fee_per_gas * gas_used);
-
-                for (auto tracer : evm.tracers()) {
-                    tracer.get().on_reward_granted(result, evm.state());
-                }
-                state_.finalize_transaction();
-
-                ExecutionResult exec_result{result.status, gas_left, result.data};
-                boost::asio::post(io_context_, [exec_result, self = std::move(self)]() mutable {
-                    self.complete(exec_result);
+                boost::asio::post(io_context_, [exec_error, exec_result, self = std::move(self)]() mutable {
+                    self.complete(exec_error, exec_result);
                 });
             });
         },
@@ -314,6 +341,57 @@ boost::asio::awaitable<ExecutionResult> EVMExecutor<WorldState, VM>::call(
     co_return exec_result;
 }
 
+template<typename WorldState, typename VM>
+boost::asio::awaitable<ExecutionResult> EVMExecutor<WorldState, VM>::call_resumable(
+    const silkworm::Block& block,
+    const silkworm::Transaction& txn,
+    state::PrefetchedState& prefetched_state,
+    bool refund,
+    bool gas_bailout) {
+    SILKRPC_DEBUG << "EVMExecutor::call_resumable: " << block.header.number << " gasLimit: " << txn.gas_limit << " refund: " << refund << " gasBailout: " << gas_bailout << "\n";
+
+    for (std::size_t round{1};; ++round) {
+        if (round == kMaxResumableCallRounds) {
+            prefetched_state.set_blocking(true);
+        }
+        throw_if_cancelled(cancellation_);
+        const auto exec_result = co_await boost::asio::async_compose<decltype(boost::asio::use_awaitable), void(std::exception_ptr, ExecutionResult)>(
+            [this, &block, &txn, &prefetched_state, &refund, &gas_bailout](auto&& self) {
+                metrics::registry().worker_queue_depth().increment();
+                const auto post_time = clock_time::now();
+                boost::asio::post(workers_, [this, &block, &txn, &prefetched_state, &refund, &gas_bailout, post_time, self = std::move(self)]() mutable {
+                    metrics::registry().worker_queue_depth().decrement();
+                    const auto start_time = clock_time::now();
+                    ExecutionResult exec_result{};
+                    std::exception_ptr exec_error;
+                    try {
+                        throw_if_cancelled(cancellation_);
+                        // Each round starts from the unmodified state, because the previous one could have run on missing values
+                        WorldState state{prefetched_state};
+                        exec_result = execute(state, block, txn, /*tracers=*/{}, refund, gas_bailout);
+                    } catch (...) {
+                        exec_error = std::current_exception();
+                    }
+                    if (profile_) {
+                        profile_->add_worker_wait(post_time, start_time);
+                        profile_->add_evm(start_time, clock_time::now());
+                    }
+                    boost::asio::post(io_context_, [exec_error, exec_result, self = std::move(self)]() mutable {
+                        self.complete(exec_error, exec_result);
+                    });
+                });
+            },
+            boost::asio::use_awaitable);
+
+        if (!prefetched_state.has_missing()) {
+            SILKRPC_DEBUG << "EVMExecutor::call_resumable exec_result: " << exec_result.error_code << " rounds: " << round << " end\n";
+            co_return exec_result;
+        }
+        SILKRPC_DEBUG << "EVMExecutor::call_resumable round: " << round << " #missing: " << prefetched_state.missing_count() << "\n";
+        co_await prefetched_state.fetch_missing();
+    }
+}
+
 template class EVMExecutor<silkworm::IntraBlockState, silkworm::EVM>;
 
 } // namespace silkrpc
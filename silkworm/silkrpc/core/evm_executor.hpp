@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -36,9 +37,12 @@
 #include <silkworm/types/block.hpp>
 #include <silkworm/types/transaction.hpp>
 
+#include <silkworm/silkrpc/concurrency/cancellation.hpp>
 #include <silkworm/silkrpc/concurrency/context_pool.hpp>
+#include <silkworm/silkrpc/core/prefetched_state.hpp>
 #include <silkworm/silkrpc/core/remote_state.hpp>
 #include <silkworm/silkrpc/core/rawdb/accessors.hpp>
+#include <silkworm/silkrpc/metrics/request_profile.hpp>
 
 namespace silkrpc {
 
@@ -47,10 +51,15 @@ struct ExecutionResult {
     uint64_t gas_left;
     silkworm::Bytes data;
     std::optional<std::string> pre_check_error{std::nullopt};
+    //! The gas refunded at the end of the execution, already included in gas_left if refund is requested
+    uint64_t gas_refund{0};
 };
 
 using Tracers = std::vector<std::shared_ptr<silkworm::EvmTracer>>;
 
+//! The max number of executions of a resumable call before reading the missing state values blocking the worker
+constexpr std::size_t kMaxResumableCallRounds{8};
+
 template<typename WorldState = silkworm::IntraBlockState, typename VM = silkworm::EVM>
 class EVMExecutor {
 public:
@@ -62,9 +71,13 @@ public:
         const silkworm::ChainConfig& config,
         boost::asio::thread_pool& workers,
         uint64_t block_number,
-        state::RemoteState& remote_state)
-        : io_context_(io_context), db_reader_(db_reader), config_(config), workers_{workers}, remote_state_{remote_state}, state_{remote_state_} {
-             consensus_engine_ = silkworm::consensus::engine_factory(config);
+        silkworm::State& remote_state,
+        std::shared_ptr<silkworm::consensus::IEngine> consensus_engine = nullptr)
+        : io_context_(io_context), db_reader_(db_reader), config_(config), workers_{workers}, remote_state_{remote_state}, state_{remote_state_},
+          consensus_engine_{std::move(consensus_engine)} {
+             if (!consensus_engine_) {
+                 consensus_engine_ = silkworm::consensus::engine_factory(config);
+             }
              SILKWORM_ASSERT(consensus_engine_ != NULL);
     }
     virtual ~EVMExecutor() {}
@@ -73,19 +86,37 @@ public:
     EVMExecutor& operator=(const EVMExecutor&) = delete;
 
     boost::asio::awaitable<ExecutionResult> call(const silkworm::Block& block, const silkworm::Transaction& txn, const Tracers& tracers = {}, bool refund = true, bool gas_bailout = false);
+
+    //! Execute \p txn from scratch on \p prefetched_state, so that workers never wait for remote state reads: if the execution
+    //! misses any state value, such values are fetched asynchronously and the execution is restarted (the state of this executor is not used)
+    boost::asio::awaitable<ExecutionResult> call_resumable(const silkworm::Block& block, const silkworm::Transaction& txn, state::PrefetchedState& prefetched_state,
+        bool refund = true, bool gas_bailout = false);
     void reset();
 
+    //! Flush all the state changes applied so far into the underlying state
+    void write_state(uint64_t block_number);
+
+    //! Record the queueing on workers and the execution time of each call into \p profile (optional, no recording if null)
+    void set_profile(metrics::RequestProfile* profile) { profile_ = profile; }
+
+    //! Skip the calls not yet started when \p cancellation is cancelled, throwing \ref RequestCancelled (optional, never skipped if null)
+    void set_cancellation(const Cancellation* cancellation) { cancellation_ = cancellation; }
+
 private:
+    //! Execute \p txn on \p state synchronously, i.e. on the calling worker thread
+    ExecutionResult execute(WorldState& state, const silkworm::Block& block, const silkworm::Transaction& txn, const Tracers& tracers, bool refund, bool gas_bailout);
     std::optional<std::string> pre_check(const VM& evm, const silkworm::Transaction& txn, const intx::uint256 base_fee_per_gas, const intx::uint128 g0);
-    uint64_t refund_gas(const VM& evm, const silkworm::Transaction& txn, uint64_t gas_left, uint64_t gas_refund);
+    uint64_t refund_gas(WorldState& state, const VM& evm, const silkworm::Transaction& txn, uint64_t gas_left, uint64_t gas_refund);
 
     boost::asio::io_context& io_context_;
     const core::rawdb::DatabaseReader& db_reader_;
     const silkworm::ChainConfig& config_;
     boost::asio::thread_pool& workers_;
-    state::RemoteState& remote_state_;
+    silkworm::State& remote_state_;
     WorldState state_;
-    std::unique_ptr<silkworm::consensus::IEngine> consensus_engine_;
+    std::shared_ptr<silkworm::consensus::IEngine> consensus_engine_;
+    metrics::RequestProfile* profile_{nullptr};
+    const Cancellation* cancellation_{nullptr};
 };
 
 } // namespace silkrpc
@@ -16,6 +16,9 @@
 
 #include "evm_executor.hpp"
 
+#include <atomic>
+#include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -28,6 +31,9 @@
 #include <intx/intx.hpp>
 
 #include <silkworm/silkrpc/common/util.hpp>
+#include <silkworm/silkrpc/core/prefetched_state.hpp>
+#include <silkworm/silkrpc/core/state_snapshot_cache.hpp>
+#include <silkworm/silkrpc/metrics/request_profile.hpp>
 #include <silkworm/silkrpc/types/transaction.hpp>
 
 namespace silkrpc {
@@ -83,6 +89,34 @@ TEST_CASE("EVMexecutor") {
         CHECK(result.pre_check_error.value() == "intrinsic gas too low: have 0, want 53000");
     }
 
+    SECTION("failed if request cancelled") {
+        StubDatabase tx_database;
+        const uint64_t chain_id = 5;
+        const auto chain_config_ptr = lookup_chain_config(chain_id);
+
+        ChannelFactory my_channel = []() { return grpc::CreateChannel("localhost", grpc::InsecureChannelCredentials()); };
+        ContextPool my_pool{1, my_channel};
+        boost::asio::thread_pool workers{1};
+        my_pool.start();
+
+        const auto block_number = 10000;
+        silkworm::Transaction txn{};
+        txn.from = 0xa872626373628737383927236382161739290870_address;
+        silkworm::Block block{};
+        block.header.number = block_number;
+        boost::asio::io_context& io_context = my_pool.next_io_context();
+
+        Cancellation cancellation;
+        cancellation.cancel(CancellationReason::client_disconnected);
+        state::RemoteState remote_state{io_context, tx_database, block_number};
+        EVMExecutor executor{io_context, tx_database, *chain_config_ptr, workers, block_number, remote_state};
+        executor.set_cancellation(&cancellation);
+        auto execution_result = boost::asio::co_spawn(my_pool.next_io_context().get_executor(), executor.call(block, txn, {}), boost::asio::use_future);
+        CHECK_THROWS_MATCHES(execution_result.get(), RequestCancelled, Message("request cancelled: client disconnected"));
+        my_pool.stop();
+        my_pool.join();
+    }
+
     SECTION("failed if base_fee_per_gas > max_fee_per_gas ") {
         StubDatabase tx_database;
         const uint64_t chain_id = 5;
@@ -837,4 +871,144 @@ TEST_CASE("EVMexecutor") {
     }
 }
 
+TEST_CASE("EVMExecutor::call_resumable") {
+    SILKRPC_LOG_STREAMS(null_stream(), null_stream());
+
+    //! Storage of one contract where the value of each slot is the location of the next one, counting the remote reads of each slot
+    class ChainedStorageDatabase : public core::rawdb::DatabaseReader {
+      public:
+        explicit ChainedStorageDatabase(uint8_t slot_count) : slot_count_{slot_count} {}
+
+        int reads(uint8_t slot) const { return reads_[slot]; }
+        int total_reads() const {
+            int total{0};
+            for (const auto& reads : reads_) {
+                total += reads;
+            }
+            return total;
+        }
+
+        boost::asio::awaitable<KeyValue> get(const std::string& table, const silkworm::ByteView& key) const override {
+            co_return KeyValue{};
+        }
+        boost::asio::awaitable<silkworm::Bytes> get_one(const std::string& table, const silkworm::ByteView& key) const override {
+            co_return silkworm::Bytes{};
+        }
+        boost::asio::awaitable<std::optional<silkworm::Bytes>> get_both_range(const std::string& table, const silkworm::ByteView& key, const silkworm::ByteView& subkey) const override {
+            const uint8_t slot{subkey.back()};
+            if (slot >= slot_count_) {
+                co_return std::nullopt;
+            }
+            ++reads_[slot];
+            co_return silkworm::Bytes{static_cast<uint8_t>(slot + 1)};
+        }
+        boost::asio::awaitable<void> walk(const std::string& table, const silkworm::ByteView& start_key, uint32_t fixed_bits, core::rawdb::Walker w) const override {
+            co_return;
+        }
+        boost::asio::awaitable<void> for_prefix(const std::string& table, const silkworm::ByteView& prefix, core::rawdb::Walker w) const override {
+            co_return;
+        }
+
+      private:
+        uint8_t slot_count_;
+        mutable std::atomic<int> reads_[256]{};
+    };
+
+    //! Contract code following the storage chain from slot 0 for the given number of hops and returning the last value read
+    auto make_chasing_code = [](uint8_t hops) {
+        silkworm::Bytes code{0x60, 0x00}; // PUSH1 0
+        code.append(hops, 0x54); // SLOAD
+        code += silkworm::Bytes{0x60, 0x00, 0x52, 0x60, 0x20, 0x60, 0x00, 0xf3}; // PUSH1 0 MSTORE PUSH1 32 PUSH1 0 RETURN
+        return code;
+    };
+
+    const auto chain_config_ptr = lookup_chain_config(5);
+    const auto block_number = 6000000;
+    silkworm::Block block{};
+    block.header.number = block_number;
+    const auto contract_address{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+    const auto code_hash{0xef722d9baf50b9983c2fce6329c5a43a15b8d5ba79cd792e7199d615be88284d_bytes32};
+    silkworm::Transaction txn{};
+    txn.gas_limit = 600000;
+    txn.from = 0xa872626373628737383927236382161739290870_address;
+    txn.to = contract_address;
+
+    ChannelFactory my_channel = []() { return grpc::CreateChannel("localhost", grpc::InsecureChannelCredentials()); };
+    ContextPool my_pool{1, my_channel};
+    boost::asio::thread_pool workers{1};
+    my_pool.start();
+    boost::asio::io_context& io_context = my_pool.next_io_context();
+
+    // Accounts and code are already in the snapshot, so just the storage slots can be missing
+    auto make_snapshot = [&](uint8_t hops) {
+        auto snapshot{std::make_shared<state::StateSnapshot>(block_number)};
+        snapshot->insert_account(*txn.from, std::nullopt);
+        snapshot->insert_account(block.header.beneficiary, std::nullopt);
+        silkworm::Account contract{};
+        contract.code_hash = code_hash;
+        contract.incarnation = 1;
+        snapshot->insert_account(contract_address, contract);
+        snapshot->insert_code(code_hash, make_chasing_code(hops));
+        return snapshot;
+    };
+
+    auto call_resumable = [&](const core::rawdb::DatabaseReader& db_reader, state::PrefetchedState& prefetched_state, metrics::RequestProfile& profile) {
+        state::RemoteState remote_state{io_context, db_reader, block_number};
+        EVMExecutor executor{io_context, db_reader, *chain_config_ptr, workers, block_number, remote_state};
+        executor.set_profile(&profile);
+        auto execution_result = boost::asio::co_spawn(io_context, executor.call_resumable(block, txn, prefetched_state), boost::asio::use_future);
+        return execution_result.get();
+    };
+
+    SECTION("restart after fetching values missed by each round") {
+        constexpr uint8_t kHops{3};
+        ChainedStorageDatabase db_reader{kHops};
+        state::PrefetchedState prefetched_state{io_context, db_reader, make_snapshot(kHops)};
+        metrics::RequestProfile profile{0};
+        const auto result = call_resumable(db_reader, prefetched_state, profile);
+        CHECK(result.error_code == evmc_status_code::EVMC_SUCCESS);
+        CHECK(result.data == silkworm::Bytes{evmc::bytes32{kHops}.bytes, 32});
+        CHECK(profile.evm_stats().count == kHops + 1);
+        CHECK_FALSE(prefetched_state.has_missing());
+        // Each missing slot is fetched just once, i.e. a value already fetched is never read again in later rounds
+        for (uint8_t slot{0}; slot < kHops; ++slot) {
+            CHECK(db_reader.reads(slot) == 1);
+        }
+    }
+
+    SECTION("no restart when nothing is missing") {
+        constexpr uint8_t kHops{3};
+        ChainedStorageDatabase db_reader{kHops};
+        auto snapshot{make_snapshot(kHops)};
+        state::PrefetchedState warming_state{io_context, db_reader, snapshot};
+        metrics::RequestProfile warming_profile{0};
+        call_resumable(db_reader, warming_state, warming_profile);
+
+        state::PrefetchedState prefetched_state{io_context, db_reader, snapshot};
+        metrics::RequestProfile profile{0};
+        const auto result = call_resumable(db_reader, prefetched_state, profile);
+        CHECK(result.error_code == evmc_status_code::EVMC_SUCCESS);
+        CHECK(profile.evm_stats().count == 1);
+        CHECK(db_reader.total_reads() == kHops);
+    }
+
+    SECTION("read blocking in last round") {
+        constexpr uint8_t kHops{kMaxResumableCallRounds + 4};
+        ChainedStorageDatabase db_reader{kHops};
+        state::PrefetchedState prefetched_state{io_context, db_reader, make_snapshot(kHops)};
+        metrics::RequestProfile profile{0};
+        const auto result = call_resumable(db_reader, prefetched_state, profile);
+        CHECK(result.error_code == evmc_status_code::EVMC_SUCCESS);
+        CHECK(result.data == silkworm::Bytes{evmc::bytes32{kHops}.bytes, 32});
+        CHECK(profile.evm_stats().count == kMaxResumableCallRounds);
+        CHECK_FALSE(prefetched_state.has_missing());
+        for (uint8_t slot{0}; slot < kHops; ++slot) {
+            CHECK(db_reader.reads(slot) == 1);
+        }
+    }
+
+    my_pool.stop();
+    my_pool.join();
+}
+
 } // namespace silkrpc
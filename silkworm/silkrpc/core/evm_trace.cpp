@@ -17,10 +17,18 @@
 #include "evm_trace.hpp"
 
 #include <algorithm>
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <stack>
 #include <string>
+#include <utility>
+
+#include <boost/asio/error.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/system/system_error.hpp>
 
 #include <evmc/hex.hpp>
 #include <evmc/instructions.h>
@@ -33,10 +41,15 @@
 
 #include <silkworm/silkrpc/common/log.hpp>
 #include <silkworm/silkrpc/common/util.hpp>
+#include <silkworm/silkrpc/concurrency/async_slot.hpp>
 #include <silkworm/silkrpc/consensus/ethash.hpp>
 #include <silkworm/silkrpc/core/cached_chain.hpp>
 #include <silkworm/silkrpc/core/evm_executor.hpp>
 #include <silkworm/silkrpc/core/rawdb/chain.hpp>
+#include <silkworm/silkrpc/core/remote_state.hpp>
+#include <silkworm/silkrpc/ethdb/bitmap.hpp>
+#include <silkworm/silkrpc/ethdb/tables.hpp>
+#include <silkworm/silkrpc/ethdb/transaction_database.hpp>
 #include <silkworm/silkrpc/json/types.hpp>
 
 namespace silkrpc::trace {
@@ -114,53 +127,119 @@ void from_json(const nlohmann::json& json, TraceFilter& tf) {
     }
 }
 
-void to_json(nlohmann::json& json, const VmTrace& vm_trace) {
-    json["code"] = vm_trace.code;
-    json["ops"] = vm_trace.ops;
+void VmTrace::reserve(std::size_t op_count) {
+    ops.reserve(op_count);
+    stack.reserve(op_count);
+    memory.reserve(op_count / 8);
+    storage.reserve(op_count / 32);
+    memory_data.reserve(op_count * 8);
 }
 
-void to_json(nlohmann::json& json, const TraceOp& trace_op) {
-    json["cost"] = trace_op.gas_cost;
-    json["ex"] = trace_op.trace_ex;
-    json["idx"] = trace_op.idx;
-    json["op"] = trace_op.op_name;
-    json["pc"] = trace_op.pc;
-    if (trace_op.sub) {
-        json["sub"] = *trace_op.sub;
-    } else {
-        json["sub"] = nlohmann::json::value_t::null;
-    }
+std::int32_t VmTrace::add_frame(silkworm::ByteView code) {
+    TraceFrame frame;
+    frame.code_offset = code_data.size();
+    frame.code_size = code.size();
+    code_data.append(code);
+    frames.push_back(frame);
+    return static_cast<std::int32_t>(frames.size() - 1);
 }
 
-void to_json(nlohmann::json& json, const TraceEx& trace_ex) {
-    if (trace_ex.memory) {
-        const auto& memory = trace_ex.memory.value();
-        json["mem"] = memory;
+std::int32_t VmTrace::add_op(std::int32_t frame, const TraceOp& op) {
+    const auto index = static_cast<std::int32_t>(ops.size());
+    ops.push_back(op);
+    auto& trace_frame = frames[static_cast<std::size_t>(frame)];
+    if (trace_frame.last_op == kNoTraceIndex) {
+        trace_frame.first_op = index;
     } else {
-        json["mem"] = nlohmann::json::value_t::null;
+        ops[static_cast<std::size_t>(trace_frame.last_op)].next = index;
     }
+    trace_frame.last_op = index;
+    ++trace_frame.op_count;
+    return index;
+}
 
-    json["push"] = trace_ex.stack;
-    if (trace_ex.storage) {
-        const auto& storage = trace_ex.storage.value();
-        json["store"] = storage;
-    } else {
-        json["store"] = nlohmann::json::value_t::null;
+void VmTrace::clear_ops(std::int32_t frame) {
+    auto& trace_frame = frames[static_cast<std::size_t>(frame)];
+    if (trace_frame.first_op != kNoTraceIndex) {
+        ops.resize(static_cast<std::size_t>(trace_frame.first_op));
     }
-    json["used"] = trace_ex.used;
+    trace_frame = TraceFrame{trace_frame.code_offset, trace_frame.code_size};
 }
 
-void to_json(nlohmann::json& json, const TraceMemory& trace_memory) {
-    json = {
-        {"data", trace_memory.data},
-        {"off", trace_memory.offset}
+static nlohmann::json frame_to_json(const VmTrace& vm_trace, std::int32_t frame_index, const std::string& index_prefix, const char* const* opcode_names) {
+    const auto& frame = vm_trace.frames[static_cast<std::size_t>(frame_index)];
+
+    nlohmann::json ops = nlohmann::json::array();
+    std::uint32_t position{0};
+    for (auto op_index = frame.first_op; op_index != kNoTraceIndex; ++position) {
+        const auto& op = vm_trace.ops[static_cast<std::size_t>(op_index)];
+
+        nlohmann::json push = nlohmann::json::array();
+        for (std::uint32_t i = op.stack_offset; i < op.stack_offset + op.stack_count; ++i) {
+            push.push_back("0x" + intx::to_string(vm_trace.stack[i], 16));
+        }
+
+        nlohmann::json mem = nlohmann::json::value_t::null;
+        if (op.memory != kNoTraceIndex) {
+            const auto& memory = vm_trace.memory[static_cast<std::size_t>(op.memory)];
+            std::string data;
+            if (memory.data_offset) {
+                data = "0x" + silkworm::to_hex(silkworm::ByteView{vm_trace.memory_data}.substr(*memory.data_offset, memory.len));
+            }
+            mem = {
+                {"data", data},
+                {"off", memory.offset}
+            };
+        }
+
+        nlohmann::json store = nlohmann::json::value_t::null;
+        if (op.storage != kNoTraceIndex) {
+            store = vm_trace.storage[static_cast<std::size_t>(op.storage)];
+        }
+
+        const auto idx = index_prefix + std::to_string(position);
+        nlohmann::json sub = nlohmann::json::value_t::null;
+        if (op.sub != kNoTraceIndex) {
+            sub = frame_to_json(vm_trace, op.sub, idx + "-", opcode_names);
+        }
+
+        ops.push_back({
+            {"cost", op.gas_cost},
+            {"ex", {
+                {"mem", std::move(mem)},
+                {"push", std::move(push)},
+                {"store", std::move(store)},
+                {"used", op.used}
+            }},
+            {"idx", idx},
+            {"op", get_op_name(opcode_names, op.op_code)},
+            {"pc", op.pc},
+            {"sub", std::move(sub)}
+        });
+        op_index = op.next;
+    }
+
+    return {
+        {"code", "0x" + silkworm::to_hex(silkworm::ByteView{vm_trace.code_data}.substr(frame.code_offset, frame.code_size))},
+        {"ops", std::move(ops)}
     };
 }
 
+void to_json(nlohmann::json& json, const VmTrace& vm_trace) {
+    if (vm_trace.frames.empty()) {
+        json["code"] = "0x";
+        json["ops"] = nlohmann::json::array();
+        return;
+    }
+    const auto opcode_names = vm_trace.opcode_names ? vm_trace.opcode_names : evmc_get_instruction_names_table(EVMC_MAX_REVISION);
+    const auto index_prefix = vm_trace.transaction_index == -1 ? std::string{} : std::to_string(vm_trace.transaction_index) + "-";
+    json = frame_to_json(vm_trace, 0, index_prefix, opcode_names);
+}
+
 void to_json(nlohmann::json& json, const TraceStorage& trace_storage) {
     json = {
-        {"key", trace_storage.key},
-        {"val", trace_storage.value}
+        {"key", "0x" + intx::to_string(trace_storage.key, 16)},
+        {"val", "0x" + intx::to_string(trace_storage.value, 16)}
     };
 }
 
@@ -429,35 +508,25 @@ int get_stack_count(std::uint8_t op_code) {
     return count;
 }
 
-void copy_stack(std::uint8_t op_code, const evmone::uint256* stack, std::vector<std::string>& trace_stack) {
+void copy_stack(std::uint8_t op_code, const evmone::uint256* stack, std::vector<intx::uint256>& trace_stack) {
     int top = get_stack_count(op_code);
-    trace_stack.reserve(top);
     for (int i = top - 1; i >= 0; i--) {
-        const auto str = intx::to_string(stack[-i], 16);
-        trace_stack.push_back("0x" + intx::to_string(stack[-i], 16));
+        trace_stack.push_back(stack[-i]);
     }
 }
 
-void copy_memory(const evmone::Memory& memory, std::optional<TraceMemory>& trace_memory) {
-    if (trace_memory) {
-        TraceMemory& tm = trace_memory.value();
-        if (tm.len == 0) {
-            trace_memory.reset();
-            return;
-        }
-        tm.data = "0x";
-        const auto data = memory.data();
-        auto start = tm.offset;
-        for (int idx = 0; idx < tm.len; idx++) {
-            std::string entry{evmc::hex({data + start + idx, 1})};
-            tm.data.append(entry);
-        }
+bool copy_memory(const evmone::Memory& memory, TraceMemory& trace_memory, silkworm::Bytes& memory_data) {
+    if (trace_memory.len == 0) {
+        return false;
     }
+    trace_memory.data_offset = memory_data.size();
+    memory_data.append(memory.data() + trace_memory.offset, trace_memory.len);
+    return true;
 }
 
 void copy_store(std::uint8_t op_code, const evmone::uint256* stack, std::optional<TraceStorage>& trace_storage) {
     if (op_code == evmc_opcode::OP_SSTORE) {
-        trace_storage = TraceStorage{"0x" + intx::to_string(stack[0], 16), "0x" + intx::to_string(stack[-1], 16)};
+        trace_storage = TraceStorage{stack[0], stack[-1]};
     }
 }
 
@@ -531,41 +600,34 @@ std::string to_string(intx::uint256 value) {
 }
 
 void VmTraceTracer::on_execution_start(evmc_revision rev, const evmc_message& msg, evmone::bytes_view code) noexcept {
-    if (opcode_names_ == nullptr) {
-        opcode_names_ = evmc_get_instruction_names_table(rev);
+    if (vm_trace_.opcode_names == nullptr) {
+        vm_trace_.opcode_names = evmc_get_instruction_names_table(rev);
     }
 
     start_gas_.push(msg.gas);
 
     if (msg.depth == 0) {
-        vm_trace_.code = "0x" + silkworm::to_hex(code);
-        traces_stack_.push(vm_trace_);
-        if (transaction_index_ == -1) {
-            index_prefix_.push("");
-        } else {
-            index_prefix_.push(std::to_string(transaction_index_) + "-");
+        if (vm_trace_.frames.empty()) {
+            // Size the buffers lazily, so that plain transfers allocate nothing and small contracts do not pay for the largest ones
+            if (!code.empty()) {
+                vm_trace_.reserve(std::min({kVmTraceReservedOps, code.size(), static_cast<std::size_t>(msg.gas)}));
+            }
+            vm_trace_.add_frame(code);
         }
-    } else if (vm_trace_.ops.size() > 0) {
-        auto& vm_trace = traces_stack_.top().get();
-
-        auto index_prefix = index_prefix_.top();
-        index_prefix = index_prefix + std::to_string(vm_trace.ops.size() - 1) + "-";
-        index_prefix_.push(index_prefix);
+        frames_stack_.push(0);
+    } else if (!vm_trace_.frames.empty() && vm_trace_.frames[0].op_count > 0) {
+        const auto parent_frame = frames_stack_.top();
+        const auto frame = vm_trace_.add_frame(code);
+        frames_stack_.push(frame);
 
-        auto& op = vm_trace.ops[vm_trace.ops.size() - 1];
+        auto& op = vm_trace_.ops[static_cast<std::size_t>(vm_trace_.frames[static_cast<std::size_t>(parent_frame)].last_op)];
         if (op.op_code == evmc_opcode::OP_STATICCALL || op.op_code == evmc_opcode::OP_DELEGATECALL || op.op_code == evmc_opcode::OP_CALL) {
-            auto& op_1 = vm_trace.ops[vm_trace.ops.size() - 2];
-            auto cap = op_1.trace_ex.used - msg.gas;
             op.depth = msg.depth;
             op.gas_cost = op.gas_cost-msg.gas;
-            op.call_gas_cap = cap;
         }
-        op.sub = std::make_shared<VmTrace>();
-        traces_stack_.push(*op.sub);
-        op.sub->code = "0x" + silkworm::to_hex(code);
+        op.sub = frame;
     }
 
-    auto& index_prefix = index_prefix_.top();
     SILKRPC_DEBUG << "VmTraceTracer::on_execution_start:"
         << " depth: " << msg.depth
         << ", gas: " << std::dec << msg.gas
@@ -574,48 +636,61 @@ void VmTraceTracer::on_execution_start(evmc_revision rev, const evmc_message& ms
         << ", code: " << silkworm::to_hex(code)
         << ", code_address: " << evmc::address{msg.code_address}
         << ", input_size: " << msg.input_size
-        << ", index_prefix: " << index_prefix
+        << ", frames: " << vm_trace_.frames.size()
         << "\n";
 }
 
 void VmTraceTracer::on_instruction_start(uint32_t pc , const intx::uint256 *stack_top, const int stack_height,
               const evmone::ExecutionState& execution_state, const silkworm::IntraBlockState& intra_block_state) noexcept {
     const auto op_code = execution_state.original_code[pc];
-    auto op_name = get_op_name(opcode_names_, op_code);
+    const auto frame = frames_stack_.top();
 
-    auto& vm_trace = traces_stack_.top().get();
-    if (vm_trace.ops.size() > 0) {
-        auto& op = vm_trace.ops[vm_trace.ops.size() - 1];
+    const auto last_op = vm_trace_.frames[static_cast<std::size_t>(frame)].last_op;
+    if (last_op != kNoTraceIndex) {
+        auto& op = vm_trace_.ops[static_cast<std::size_t>(last_op)];
         if (op.precompiled_call_gas) {
             op.gas_cost = op.gas_cost - op.precompiled_call_gas.value();
         } else if (op.depth == execution_state.msg->depth) {
             op.gas_cost = op.gas_cost - execution_state.gas_left;
         }
-        op.trace_ex.used = execution_state.gas_left;
+        op.used = execution_state.gas_left;
 
-        copy_memory(execution_state.memory, op.trace_ex.memory);
-        copy_stack(op.op_code, stack_top, op.trace_ex.stack);
+        if (op.memory != kNoTraceIndex) {
+            auto& trace_memory = vm_trace_.memory[static_cast<std::size_t>(op.memory)];
+            if (!copy_memory(execution_state.memory, trace_memory, vm_trace_.memory_data)) {
+                op.memory = kNoTraceIndex;
+            }
+        }
+        op.stack_offset = static_cast<std::uint32_t>(vm_trace_.stack.size());
+        copy_stack(op.op_code, stack_top, vm_trace_.stack);
+        op.stack_count = static_cast<std::uint8_t>(vm_trace_.stack.size() - op.stack_offset);
     }
 
-    auto index_prefix = index_prefix_.top() + std::to_string(vm_trace.ops.size());
-
     TraceOp trace_op;
     trace_op.gas_cost = execution_state.gas_left;
-    trace_op.idx = index_prefix;
     trace_op.depth = execution_state.msg->depth;
     trace_op.op_code = op_code;
-    trace_op.op_name = op_name;
     trace_op.pc = pc;
 
-    copy_memory_offset_len(op_code, stack_top, trace_op.trace_ex.memory);
-    copy_store(op_code, stack_top, trace_op.trace_ex.storage);
+    std::optional<TraceMemory> trace_memory;
+    copy_memory_offset_len(op_code, stack_top, trace_memory);
+    if (trace_memory) {
+        trace_op.memory = static_cast<std::int32_t>(vm_trace_.memory.size());
+        vm_trace_.memory.push_back(*trace_memory);
+    }
+    std::optional<TraceStorage> trace_storage;
+    copy_store(op_code, stack_top, trace_storage);
+    if (trace_storage) {
+        trace_op.storage = static_cast<std::int32_t>(vm_trace_.storage.size());
+        vm_trace_.storage.push_back(*trace_storage);
+    }
 
-    vm_trace.ops.push_back(trace_op);
+    vm_trace_.add_op(frame, trace_op);
     SILKRPC_DEBUG << "VmTraceTracer::on_instruction_start:"
         << " pc: " << std::dec << pc
         << ", opcode: 0x" << std::hex << evmc::hex(op_code)
-        << ", opcode_name: " << op_name
-        << ", index_prefix: " << index_prefix
+        << ", opcode_name: " << get_op_name(vm_trace_.opcode_names, op_code)
+        << ", frame: " << std::dec << frame
         << ", execution_state: {"
         << "   gas_left: " << std::dec << execution_state.gas_left
         << ",   status: " << execution_state.status
@@ -627,55 +702,54 @@ void VmTraceTracer::on_instruction_start(uint32_t pc , const intx::uint256 *stac
 void VmTraceTracer::on_precompiled_run(const evmc_result& result, int64_t gas, const silkworm::IntraBlockState& intra_block_state) noexcept {
     SILKRPC_DEBUG << "VmTraceTracer::on_precompiled_run:" << " status: " << result.status_code << ", gas: " << std::dec << gas << "\n";
 
-    if (vm_trace_.ops.size() > 0) {
-        auto& op = vm_trace_.ops[vm_trace_.ops.size() - 1];
+    if (!vm_trace_.frames.empty() && vm_trace_.frames[0].op_count > 0) {
+        const auto frame = vm_trace_.add_frame({});
+        auto& op = vm_trace_.ops[static_cast<std::size_t>(vm_trace_.frames[0].last_op)];
         op.precompiled_call_gas = gas;
-        op.sub = std::make_shared<VmTrace>();
-        op.sub->code = "0x";
+        op.sub = frame;
     }
 }
 
 void VmTraceTracer::on_execution_end(const evmc_result& result, const silkworm::IntraBlockState& intra_block_state) noexcept {
-    auto& vm_trace = traces_stack_.top().get();
-    traces_stack_.pop();
+    const auto frame = frames_stack_.top();
+    frames_stack_.pop();
 
     std::uint64_t start_gas = start_gas_.top();
     start_gas_.pop();
 
-    index_prefix_.pop();
-
     SILKRPC_DEBUG << "VmTraceTracer::on_execution_end:"
         << " result.status_code: " << result.status_code
         << ", start_gas: " << std::dec << start_gas
         << ", gas_left: " << std::dec << result.gas_left
         << "\n";
 
-    if (vm_trace.ops.size() == 0) {
+    const auto& trace_frame = vm_trace_.frames[static_cast<std::size_t>(frame)];
+    if (trace_frame.op_count == 0) {
         return;
     }
-    auto& op = vm_trace.ops[vm_trace.ops.size() - 1];
+    auto& op = vm_trace_.ops[static_cast<std::size_t>(trace_frame.last_op)];
 
-    if (op.op_code == evmc_opcode::OP_STOP && vm_trace.ops.size() == 1) {
-        vm_trace.ops.clear();
+    if (op.op_code == evmc_opcode::OP_STOP && trace_frame.op_count == 1) {
+        vm_trace_.clear_ops(frame);
         return;
     }
 
     switch (result.status_code) {
     case evmc_status_code::EVMC_OUT_OF_GAS:
-        op.trace_ex.used = result.gas_left;
+        op.used = result.gas_left;
         op.gas_cost -= result.gas_left;
         break;
 
     case evmc_status_code::EVMC_UNDEFINED_INSTRUCTION:
-        op.trace_ex.used = op.gas_cost;
+        op.used = op.gas_cost;
         op.gas_cost = start_gas - op.gas_cost;
-        op.trace_ex.used -= op.gas_cost;
+        op.used -= op.gas_cost;
         break;
 
     case evmc_status_code::EVMC_REVERT:
     default:
         op.gas_cost = op.gas_cost - result.gas_left;
-        op.trace_ex.used = result.gas_left;
+        op.used = result.gas_left;
         break;
     }
 }
@@ -1128,9 +1202,15 @@ void IntraBlockStateTracer::on_reward_granted(const silkworm::CallResult& result
 
 template<typename WorldState, typename VM>
 boost::asio::awaitable<std::vector<Trace>> TraceCallExecutor<WorldState, VM>::trace_block(const silkworm::BlockWithHash& block_with_hash, Filter& filter, json::Stream* stream) {
+    const auto trace_call_results = co_await trace_block_transactions(block_with_hash.block, {false, true, false});
+    co_return co_await filter_block_traces(block_with_hash, trace_call_results, filter, stream);
+}
+
+template<typename WorldState, typename VM>
+boost::asio::awaitable<std::vector<Trace>> TraceCallExecutor<WorldState, VM>::filter_block_traces(const silkworm::BlockWithHash& block_with_hash,
+    const std::vector<TraceCallResult>& trace_call_results, Filter& filter, json::Stream* stream) {
     std::vector<Trace> traces;
 
-    const auto trace_call_results = co_await trace_block_transactions(block_with_hash.block, {false, true, false});
     for (std::uint64_t pos = 0; pos < trace_call_results.size(); pos++) {
         silkrpc::Transaction transaction{block_with_hash.block.transactions[pos]};
         if (!transaction.from) {
@@ -1190,8 +1270,8 @@ boost::asio::awaitable<std::vector<Trace>> TraceCallExecutor<WorldState, VM>::tr
     }
 
     if (filter.count > 0 && filter.after == 0) {
-        const auto chain_config{co_await silkrpc::core::rawdb::read_chain_config(database_reader_)};
-        const auto block_rewards = ethash::compute_reward(chain_config, block_with_hash.block);
+        const auto chain_config{co_await core::get_chain_config(database_reader_, caches_.chain_config.get())};
+        const auto block_rewards = ethash::compute_reward(chain_config->chain_config, block_with_hash.block);
 
         RewardAction action;
         action.author = block_with_hash.block.header.beneficiary;
@@ -1224,17 +1304,24 @@ boost::asio::awaitable<std::vector<TraceCallResult>> TraceCallExecutor<WorldStat
 
     SILKRPC_INFO << "execute: block_number: " << std::dec << block_number << " #txns: " << transactions.size() << " config: " << config << "\n";
 
-    const auto chain_id = co_await core::rawdb::read_chain_id(database_reader_);
-    const auto chain_config_ptr = lookup_chain_config(chain_id);
+    const auto chain_config{co_await core::get_chain_config(database_reader_, caches_.chain_config.get())};
+
+    // State diff accumulates the changes of all the previous transactions, so it requires the sequential replay
+    if (!config.state_diff && transactions.size() > 1) {
+        co_return co_await trace_block_transactions_speculatively(block, config, *chain_config);
+    }
 
-    state::RemoteState remote_state{io_context_, database_reader_, block_number-1};
+    state::RemoteState remote_state{io_context_, database_reader_, block_number-1, block.header.parent_hash, caches_.history.get(),
+        caches_.snapshot.get()};
     silkworm::IntraBlockState initial_ibs{remote_state};
 
     StateAddresses state_addresses(initial_ibs);
     std::shared_ptr<silkworm::EvmTracer> ibsTracer = std::make_shared<trace::IntraBlockStateTracer>(state_addresses);
 
-    state::RemoteState curr_remote_state{io_context_, database_reader_, block_number-1};
-    EVMExecutor<WorldState, VM> executor{io_context_, database_reader_, *chain_config_ptr, workers_, block_number-1, curr_remote_state};
+    state::RemoteState curr_remote_state{io_context_, database_reader_, block_number-1, block.header.parent_hash, caches_.history.get(),
+        caches_.snapshot.get()};
+    EVMExecutor<WorldState, VM> executor{io_context_, database_reader_, *chain_config->config, workers_, block_number-1, curr_remote_state, chain_config->consensus_engine};
+    executor.set_cancellation(cancellation_);
 
     std::vector<TraceCallResult> trace_call_result(transactions.size());
     for (std::uint64_t index = 0; index < transactions.size(); index++) {
@@ -1278,6 +1365,137 @@ boost::asio::awaitable<std::vector<TraceCallResult>> TraceCallExecutor<WorldStat
     co_return trace_call_result;
 }
 
+//! The speculative replay of one transaction in the concurrent block replay window
+struct ReplaySlot : AsyncSlot<TraceCallResult> {
+    explicit ReplaySlot(boost::asio::io_context& io_context, const silkworm::Transaction& txn)
+        : AsyncSlot{io_context.get_executor()}, transaction{txn} {}
+
+    silkrpc::Transaction transaction;
+    std::unique_ptr<state::RemoteState> parent_state;
+    std::unique_ptr<state::SpeculativeState> state;
+};
+
+template<typename WorldState, typename VM>
+boost::asio::awaitable<std::vector<TraceCallResult>> TraceCallExecutor<WorldState, VM>::trace_block_transactions_speculatively(
+    const silkworm::Block& block, const TraceConfig& config, const core::ResolvedChainConfig& chain_config) {
+    const auto& transactions = block.transactions;
+    const auto fee_recipient{chain_config.consensus_engine->get_beneficiary(block.header)};
+
+    // Each replay reads the parent state by its own reader: all readers share the same snapshot (a block-local one if no cache),
+    // so that hits are served in parallel, and the same mutex, so that misses never overlap on the database transaction
+    const auto parent_block_number{block.header.number - 1};
+    auto snapshot{caches_.snapshot ? caches_.snapshot->get(parent_block_number, block.header.parent_hash)
+                                   : std::make_shared<state::StateSnapshot>(parent_block_number)};
+    std::mutex remote_access;
+    state::RemoteState parent_state{io_context_, database_reader_, snapshot, caches_.history.get(), &remote_access};
+
+    // Changes applied by the transactions validated so far on top of the parent state together with their keys
+    auto block_changes = std::make_shared<state::StateCheckpoint>(0);
+    state::StateKeys written_keys;
+    std::size_t reexecution_count{0};
+
+    std::vector<TraceCallResult> trace_call_results(transactions.size());
+    std::deque<std::shared_ptr<ReplaySlot>> window;
+    std::size_t next_index{0};
+    std::exception_ptr exception;
+    try {
+        for (std::size_t index{0}; index < transactions.size(); ++index) {
+            // Keep the window full by starting the replay of next transactions on top of the parent state, each one running on the worker pool
+            while (window.size() < kReplayWindowSize && next_index < transactions.size()) {
+                auto slot = std::make_shared<ReplaySlot>(io_context_, transactions[next_index]);
+                if (!slot->transaction.from) {
+                    slot->transaction.recover_sender();
+                }
+                // Fee payment commutes with other transactions unless fee recipient is also sender, recipient or created contract
+                const auto& txn = slot->transaction;
+                const bool fee_delta{txn.to && *txn.to != fee_recipient && txn.from != fee_recipient};
+                slot->parent_state = std::make_unique<state::RemoteState>(io_context_, database_reader_, snapshot, caches_.history.get(), &remote_access);
+                slot->state = std::make_unique<state::SpeculativeState>(*slot->parent_state, fee_delta ? std::make_optional(fee_recipient) : std::nullopt);
+                slot->spawn(replay_transaction(block, txn, static_cast<std::int32_t>(next_index), config, chain_config, *slot->parent_state, *slot->state));
+                window.push_back(std::move(slot));
+                ++next_index;
+            }
+
+            // Validate the oldest replay as soon as ready, so that transaction order is preserved
+            auto slot = window.front();
+            window.pop_front();
+            co_await slot->wait();
+            if (!slot->ready()) {
+                throw boost::system::system_error{boost::asio::error::operation_aborted};
+            }
+
+            if (slot->exception() || slot->state->read_keys().intersects(written_keys)) {
+                // Some previous transaction has changed the state read by this one, so replay it on top of the block changes
+                state::CheckpointState block_state{parent_state, block_changes};
+                state::SpeculativeState reexecution_state{block_state};
+                trace_call_results[index] = co_await replay_transaction(block, slot->transaction, static_cast<std::int32_t>(index), config,
+                    chain_config, parent_state, reexecution_state);
+                reexecution_state.apply_changes(*block_changes);
+                written_keys.merge(reexecution_state.written_keys());
+                ++reexecution_count;
+            } else {
+                trace_call_results[index] = std::move(slot->value());
+                slot->state->apply_changes(*block_changes);
+                written_keys.merge(slot->state->written_keys());
+            }
+        }
+        SILKRPC_DEBUG << "trace_block_transactions_speculatively: block_number: " << block.header.number << " #txns: " << transactions.size()
+            << " #reexecuted: " << reexecution_count << "\n";
+    } catch (...) {
+        exception = std::current_exception();
+    }
+
+    // Replays still in progress (e.g. error or cancellation) refer to the parent state, so wait for them to stop before leaving
+    co_await boost::asio::this_coro::reset_cancellation_state();
+    co_await wait_all(window);
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+    co_return trace_call_results;
+}
+
+template<typename WorldState, typename VM>
+boost::asio::awaitable<TraceCallResult> TraceCallExecutor<WorldState, VM>::replay_transaction(const silkworm::Block& block,
+    const silkrpc::Transaction& transaction, std::int32_t index, const TraceConfig& config, const core::ResolvedChainConfig& chain_config,
+    silkworm::State& parent_state, state::SpeculativeState& state) {
+    // Tracers look up the initial values in the parent state as in sequential replay, so such reads are not recorded
+    silkworm::IntraBlockState initial_ibs{parent_state};
+
+    TraceCallResult result;
+    TraceCallTraces& traces = result.traces;
+    auto hash{hash_of_transaction(transaction)};
+    traces.transaction_hash = silkworm::to_bytes32({hash.bytes, silkworm::kHashLength});
+
+    Tracers tracers;
+    std::shared_ptr<silkworm::EvmTracer> state_tracer = std::make_shared<state::SpeculativeStateTracer>(state);
+    tracers.push_back(state_tracer);
+    if (config.vm_trace) {
+        traces.vm_trace.emplace();
+        std::shared_ptr<silkworm::EvmTracer> tracer = std::make_shared<trace::VmTraceTracer>(traces.vm_trace.value(), index);
+        tracers.push_back(tracer);
+    }
+    if (config.trace) {
+        std::shared_ptr<silkworm::EvmTracer> tracer = std::make_shared<trace::TraceTracer>(traces.trace, initial_ibs);
+        tracers.push_back(tracer);
+    }
+
+    EVMExecutor<WorldState, VM> executor{io_context_, database_reader_, *chain_config.config, workers_, block.header.number-1, state,
+        chain_config.consensus_engine};
+    executor.set_cancellation(cancellation_);
+    const auto execution_result = co_await executor.call(block, transaction, tracers, /*refund=*/true, /*gas_bailout=*/true);
+    if (execution_result.pre_check_error) {
+        result.pre_check_error = execution_result.pre_check_error.value();
+    } else {
+        traces.output = "0x" + silkworm::to_hex(execution_result.data);
+    }
+
+    // Flush the transaction changes into the speculative state to be validated
+    executor.write_state(block.header.number);
+
+    co_return result;
+}
+
 template<typename WorldState, typename VM>
 boost::asio::awaitable<TraceCallResult> TraceCallExecutor<WorldState, VM>::trace_call(const silkworm::Block& block, const silkrpc::Call& call, const TraceConfig& config) {
     silkrpc::Transaction transaction{call.to_transaction()};
@@ -1293,15 +1511,16 @@ boost::asio::awaitable<TraceManyCallResult> TraceCallExecutor<WorldState, VM>::t
         << " #trace_calls: " << calls.size()
         << "\n";
 
-    const auto chain_id = co_await core::rawdb::read_chain_id(database_reader_);
-    const auto chain_config_ptr = lookup_chain_config(chain_id);
+    const auto chain_config{co_await core::get_chain_config(database_reader_, caches_.chain_config.get())};
 
-    state::RemoteState remote_state{io_context_, database_reader_, block_number};
+    const auto block_hash{block.header.hash()};
+    state::RemoteState remote_state{io_context_, database_reader_, block_number, block_hash, caches_.history.get(), caches_.snapshot.get()};
     silkworm::IntraBlockState initial_ibs{remote_state};
     StateAddresses state_addresses(initial_ibs);
 
-    state::RemoteState curr_remote_state{io_context_, database_reader_, block_number};
-    EVMExecutor<WorldState, VM> executor{io_context_, database_reader_, *chain_config_ptr, workers_, block_number, remote_state};
+    state::RemoteState curr_remote_state{io_context_, database_reader_, block_number, block_hash, caches_.history.get(), caches_.snapshot.get()};
+    EVMExecutor<WorldState, VM> executor{io_context_, database_reader_, *chain_config->config, workers_, block_number, remote_state, chain_config->consensus_engine};
+    executor.set_cancellation(cancellation_);
 
     std::shared_ptr<silkworm::EvmTracer> ibsTracer = std::make_shared<trace::IntraBlockStateTracer>(state_addresses);
 
@@ -1371,7 +1590,7 @@ boost::asio::awaitable<std::vector<Trace>> TraceCallExecutor<WorldState, VM>::tr
 }
 
 template<typename WorldState, typename VM>
-boost::asio::awaitable<void> TraceCallExecutor<WorldState, VM>::trace_filter(const TraceFilter& trace_filter, json::Stream* stream) {
+boost::asio::awaitable<void> TraceCallExecutor<WorldState, VM>::trace_filter(const TraceFilter& trace_filter, json::Stream* stream, ethdb::Database* database) {
     SILKRPC_INFO << "TraceCallExecutor::trace_filter: filter " << trace_filter << "\n";
 
     const auto from_block_with_hash = co_await core::read_block_by_number_or_hash(block_cache_, database_reader_, trace_filter.from_block);
@@ -1392,25 +1611,59 @@ boost::asio::awaitable<void> TraceCallExecutor<WorldState, VM>::trace_filter(con
     filter.after = trace_filter.after;
     filter.count = trace_filter.count;
 
-    auto block_number = from_block_with_hash.block.header.number;
-    auto block_with_hash = from_block_with_hash;
-    while (block_number++ <= to_block_with_hash.block.header.number) {
-        const Block block{block_with_hash, {}, false};
-        SILKRPC_INFO << "TraceCallExecutor::trace_filter: processing "
-            << " block_number: " << block_number-1
-            << " block: " << block
-            << "\n";
-
-        co_await trace_block(block_with_hash, filter, stream);
-
-        if (filter.count == 0) {
-            break;
+    const auto from_block_number = from_block_with_hash.block.header.number;
+    const auto to_block_number = to_block_with_hash.block.header.number;
+    const bool has_address_filter = !filter.from_addresses.empty() || !filter.to_addresses.empty();
+    if (has_address_filter || database != nullptr) {
+        roaring::Roaring block_numbers;
+        if (has_address_filter) {
+            // Only blocks where any filtered address is caller or callee can contain matching traces
+            block_numbers = co_await get_addresses_bitmap(filter, from_block_number, to_block_number);
+        } else {
+            block_numbers.addRange(from_block_number, to_block_number + 1);
         }
+        SILKRPC_DEBUG << "TraceCallExecutor::trace_filter: #blocks to trace: " << block_numbers.cardinality() << "\n";
 
-        if (block_number == to_block_with_hash.block.header.number) {
-            block_with_hash = to_block_with_hash;
+        if (database != nullptr) {
+            co_await trace_filter_concurrently(block_numbers, from_block_with_hash, to_block_with_hash, filter, stream, *database);
         } else {
-            block_with_hash = co_await core::read_block_by_number(block_cache_, database_reader_, block_number);
+            for (const auto block_number : block_numbers) {
+                throw_if_cancelled(cancellation_);
+                const auto block_with_hash = co_await read_block_in_range(block_number, from_block_with_hash, to_block_with_hash);
+                SILKRPC_INFO << "TraceCallExecutor::trace_filter: processing "
+                    << " block_number: " << block_number
+                    << " #txns: " << block_with_hash.block.transactions.size()
+                    << "\n";
+
+                co_await trace_block(block_with_hash, filter, stream);
+
+                if (filter.count == 0) {
+                    break;
+                }
+            }
+        }
+    } else {
+        auto block_number = from_block_with_hash.block.header.number;
+        auto block_with_hash = from_block_with_hash;
+        while (block_number++ <= to_block_with_hash.block.header.number) {
+            throw_if_cancelled(cancellation_);
+            const Block block{block_with_hash, {}, false};
+            SILKRPC_INFO << "TraceCallExecutor::trace_filter: processing "
+                << " block_number: " << block_number-1
+                << " block: " << block
+                << "\n";
+
+            co_await trace_block(block_with_hash, filter, stream);
+
+            if (filter.count == 0) {
+                break;
+            }
+
+            if (block_number == to_block_with_hash.block.header.number) {
+                block_with_hash = to_block_with_hash;
+            } else {
+                block_with_hash = co_await core::read_block_by_number(block_cache_, database_reader_, block_number);
+            }
         }
     }
 
@@ -1421,6 +1674,117 @@ boost::asio::awaitable<void> TraceCallExecutor<WorldState, VM>::trace_filter(con
     co_return;
 }
 
+template<typename WorldState, typename VM>
+boost::asio::awaitable<roaring::Roaring> TraceCallExecutor<WorldState, VM>::get_addresses_bitmap(const Filter& filter, std::uint64_t from_block,
+    std::uint64_t to_block) {
+    roaring::Roaring result_bitmap;
+    for (const auto& address : filter.from_addresses) {
+        silkworm::Bytes address_key{std::begin(address.bytes), std::end(address.bytes)};
+        result_bitmap |= co_await ethdb::bitmap::get(database_reader_, db::table::kCallFromIndex, address_key, from_block, to_block);
+    }
+    for (const auto& address : filter.to_addresses) {
+        silkworm::Bytes address_key{std::begin(address.bytes), std::end(address.bytes)};
+        result_bitmap |= co_await ethdb::bitmap::get(database_reader_, db::table::kCallToIndex, address_key, from_block, to_block);
+    }
+
+    // Index chunks may contain blocks outside the requested range
+    roaring::Roaring range_bitmap;
+    range_bitmap.addRange(from_block, to_block + 1);
+    result_bitmap &= range_bitmap;
+    SILKRPC_TRACE << "TraceCallExecutor::get_addresses_bitmap: " << result_bitmap.toString() << "\n";
+    co_return result_bitmap;
+}
+
+template<typename WorldState, typename VM>
+boost::asio::awaitable<silkworm::BlockWithHash> TraceCallExecutor<WorldState, VM>::read_block_in_range(std::uint64_t block_number,
+    const silkworm::BlockWithHash& from_block_with_hash, const silkworm::BlockWithHash& to_block_with_hash) {
+    if (block_number == from_block_with_hash.block.header.number) {
+        co_return from_block_with_hash;
+    }
+    if (block_number == to_block_with_hash.block.header.number) {
+        co_return to_block_with_hash;
+    }
+    co_return co_await core::read_block_by_number(block_cache_, database_reader_, block_number);
+}
+
+//! The traces of one block in the concurrent trace_filter window
+struct BlockTracesSlot : AsyncSlot<std::vector<TraceCallResult>> {
+    explicit BlockTracesSlot(boost::asio::io_context& io_context, silkworm::BlockWithHash block)
+        : AsyncSlot{io_context.get_executor()}, block_with_hash{std::move(block)} {}
+
+    silkworm::BlockWithHash block_with_hash;
+};
+
+template<typename WorldState, typename VM>
+boost::asio::awaitable<std::vector<TraceCallResult>> TraceCallExecutor<WorldState, VM>::trace_block_transactions(ethdb::Database& database,
+    const silkworm::Block& block) {
+    auto tx = co_await database.begin();
+    tx->set_cancellation(cancellation_);
+
+    std::vector<TraceCallResult> trace_call_results;
+    std::exception_ptr exception;
+    try {
+        ethdb::TransactionDatabase tx_database{*tx};
+        TraceCallExecutor executor{io_context_, block_cache_, tx_database, workers_, caches_};
+        executor.set_cancellation(cancellation_);
+        trace_call_results = co_await executor.trace_block_transactions(block, {false, true, false});
+    } catch (...) {
+        exception = std::current_exception();
+    }
+
+    // Transaction must be closed even if tracing has been cancelled
+    co_await boost::asio::this_coro::reset_cancellation_state();
+    co_await tx->close(); // RAII not (yet) available with coroutines
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+    co_return trace_call_results;
+}
+
+template<typename WorldState, typename VM>
+boost::asio::awaitable<void> TraceCallExecutor<WorldState, VM>::trace_filter_concurrently(const roaring::Roaring& block_numbers,
+    const silkworm::BlockWithHash& from_block_with_hash, const silkworm::BlockWithHash& to_block_with_hash, Filter& filter, json::Stream* stream,
+    ethdb::Database& database) {
+    std::deque<std::shared_ptr<BlockTracesSlot>> window;
+
+    auto next_block_number = block_numbers.begin();
+    std::exception_ptr exception;
+    try {
+        while (filter.count > 0 && (!window.empty() || next_block_number != block_numbers.end())) {
+            throw_if_cancelled(cancellation_);
+            // Keep the window full by starting the tracing of next blocks, each one running on the worker pool
+            while (window.size() < kTraceFilterWindowSize && next_block_number != block_numbers.end()) {
+                auto block_with_hash = co_await read_block_in_range(*next_block_number, from_block_with_hash, to_block_with_hash);
+                auto slot = std::make_shared<BlockTracesSlot>(io_context_, std::move(block_with_hash));
+                slot->spawn(trace_block_transactions(database, slot->block_with_hash.block));
+                window.push_back(std::move(slot));
+                ++next_block_number;
+            }
+
+            // Filter the traces of the oldest block as soon as ready, so that block order is preserved
+            auto slot = window.front();
+            window.pop_front();
+            const auto trace_call_results = co_await slot->get();
+
+            SILKRPC_INFO << "TraceCallExecutor::trace_filter: processing "
+                << " block_number: " << slot->block_with_hash.block.header.number
+                << " #txns: " << slot->block_with_hash.block.transactions.size()
+                << "\n";
+            co_await filter_block_traces(slot->block_with_hash, trace_call_results, filter, stream);
+        }
+    } catch (...) {
+        exception = std::current_exception();
+    }
+
+    // Cancel any tracing still in progress (e.g. count reached or error) and wait for it to stop before leaving
+    co_await cancel_and_wait_all(window);
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
 template<typename WorldState, typename VM>
 boost::asio::awaitable<TraceCallResult> TraceCallExecutor<WorldState, VM>::execute(std::uint64_t block_number, const silkworm::Block& block,
     const silkrpc::Transaction& transaction, std::int32_t index, const TraceConfig& config) {
@@ -1431,20 +1795,29 @@ boost::asio::awaitable<TraceCallResult> TraceCallExecutor<WorldState, VM>::execu
         << " config: " << config
         << "\n";
 
-    const auto chain_id = co_await core::rawdb::read_chain_id(database_reader_);
-    const auto chain_config_ptr = lookup_chain_config(chain_id);
+    const auto chain_config{co_await core::get_chain_config(database_reader_, caches_.chain_config.get())};
 
-    state::RemoteState remote_state{io_context_, database_reader_, block_number};
-    silkworm::IntraBlockState initial_ibs{remote_state};
+    // Replaying the previous transactions on top of the parent state can resume from the nearest checkpoint of the block
+    const bool use_checkpoints{caches_.checkpoint != nullptr && block_number + 1 == block.header.number && transaction.transaction_index > 0};
+    const auto block_hash{use_checkpoints ? block.header.hash() : evmc::bytes32{}};
+    const auto checkpoint{use_checkpoints ? caches_.checkpoint->find(block_hash, transaction.transaction_index) : nullptr};
+
+    // The state is read either at the end of the parent block or at the end of the block itself
+    const auto state_block_hash{block_number + 1 == block.header.number ? block.header.parent_hash : block.header.hash()};
+    state::RemoteState remote_state{io_context_, database_reader_, block_number, state_block_hash, caches_.history.get(), caches_.snapshot.get()};
+    state::CheckpointState initial_state{remote_state, checkpoint};
+    silkworm::IntraBlockState initial_ibs{initial_state};
 
     Tracers tracers;
     StateAddresses state_addresses(initial_ibs);
     std::shared_ptr<silkworm::EvmTracer> tracer = std::make_shared<trace::IntraBlockStateTracer>(state_addresses);
     tracers.push_back(tracer);
 
-    state::RemoteState curr_remote_state{io_context_, database_reader_, block_number};
-    EVMExecutor<WorldState, VM> executor{io_context_, database_reader_, *chain_config_ptr, workers_, block_number, curr_remote_state};
-    for (auto idx = 0; idx < transaction.transaction_index; idx++) {
+    state::RemoteState curr_remote_state{io_context_, database_reader_, block_number, state_block_hash, caches_.history.get(), caches_.snapshot.get()};
+    state::CheckpointState curr_state{curr_remote_state, checkpoint};
+    EVMExecutor<WorldState, VM> executor{io_context_, database_reader_, *chain_config->config, workers_, block_number, curr_state, chain_config->consensus_engine};
+    executor.set_cancellation(cancellation_);
+    for (auto idx = checkpoint ? checkpoint->transaction_count() : 0; idx < transaction.transaction_index; idx++) {
         silkrpc::Transaction txn{block.transactions[idx]};
 
         if (!txn.from) {
@@ -1452,6 +1825,14 @@ boost::asio::awaitable<TraceCallResult> TraceCallExecutor<WorldState, VM>::execu
         }
         const auto execution_result = co_await executor.call(block, txn, tracers, /*refund=*/true, /*gas_bailout=*/true);
         executor.reset();
+
+        const auto transaction_count{idx + 1};
+        if (use_checkpoints && (transaction_count % state::kCheckpointInterval == 0 || transaction_count == transaction.transaction_index)) {
+            auto new_checkpoint = curr_state.start_recording(transaction_count);
+            executor.write_state(block.header.number);
+            curr_state.stop_recording();
+            caches_.checkpoint->insert(block_hash, std::move(new_checkpoint));
+        }
     }
 
     tracers.clear();
@@ -29,6 +29,7 @@
 
 #include <boost/asio/awaitable.hpp>
 #include <boost/asio/thread_pool.hpp>
+#include <croaring/roaring.hh>
 #include <nlohmann/json.hpp>
 
 #pragma GCC diagnostic push
@@ -38,8 +39,14 @@
 #include <silkworm/state/intra_block_state.hpp>
 
 #include <silkworm/silkrpc/common/block_cache.hpp>
+#include <silkworm/silkrpc/concurrency/cancellation.hpp>
 #include <silkworm/silkrpc/concurrency/context_pool.hpp>
+#include <silkworm/silkrpc/core/chain_config_cache.hpp>
+#include <silkworm/silkrpc/core/execution_caches.hpp>
 #include <silkworm/silkrpc/core/rawdb/accessors.hpp>
+#include <silkworm/silkrpc/core/speculative_state.hpp>
+#include <silkworm/silkrpc/core/state_checkpoint_cache.hpp>
+#include <silkworm/silkrpc/ethdb/database.hpp>
 #include <silkworm/silkrpc/json/stream.hpp>
 #include <silkworm/silkrpc/types/block.hpp>
 #include <silkworm/silkrpc/types/call.hpp>
@@ -80,58 +87,86 @@ std::ostream& operator<<(std::ostream& out, const TraceConfig& tc);
 std::ostream& operator<<(std::ostream& out, const TraceFilter& tf);
 
 struct TraceStorage {
-    std::string key;
-    std::string value;
+    intx::uint256 key;
+    intx::uint256 value;
 };
 
 struct TraceMemory {
     std::uint64_t offset{0};
     std::uint64_t len{0};
-    std::string data;
+    std::optional<std::size_t> data_offset;  // position of the captured data in VmTrace::memory_data, if any
 };
 
-struct TraceEx {
-    std::optional<TraceMemory> memory;
-    std::vector<std::string> stack;
-    std::optional<TraceStorage> storage;
-    std::uint64_t used{0};
-};
+//! Null index into the VmTrace buffers
+constexpr std::int32_t kNoTraceIndex{-1};
 
-struct VmTrace;
+//! Max number of ops the VmTrace buffers are initially sized for, the actual number depends on the top-level code size
+constexpr std::size_t kVmTraceReservedOps{4'096};
 
+//! Single op in the flat VmTrace buffer: stack pushes, memory and storage live in the VmTrace pools and are referenced by index
 struct TraceOp {
     std::uint64_t gas_cost{0};
+    std::uint64_t used{0};
     std::optional<std::uint64_t> precompiled_call_gas;
-    std::optional<std::uint64_t> call_gas_cap;
-    TraceEx trace_ex;
-    std::string idx;
     std::uint32_t depth{0};
-    std::uint8_t op_code;
-    std::string op_name;
-    std::uint32_t pc;
-    std::shared_ptr<VmTrace> sub;
+    std::uint32_t pc{0};
+    std::uint32_t stack_offset{0};
+    std::uint8_t stack_count{0};
+    std::uint8_t op_code{0};
+    std::int32_t memory{kNoTraceIndex};
+    std::int32_t storage{kNoTraceIndex};
+    std::int32_t sub{kNoTraceIndex};
+    std::int32_t next{kNoTraceIndex};
 };
 
+//! Call frame in the flat VmTrace buffer, whose ops are linked through TraceOp::next
+struct TraceFrame {
+    std::size_t code_offset{0};
+    std::size_t code_size{0};
+    std::int32_t first_op{kNoTraceIndex};
+    std::int32_t last_op{kNoTraceIndex};
+    std::uint32_t op_count{0};
+};
+
+//! The vmTrace tree flattened into a few pre-sized buffers shared by all the call frames: frames and ops are linked by index
+//! and values are kept in binary form, so that no allocation happens per op and strings are built only during serialization
 struct VmTrace {
-    std::string code{"0x"};
+    std::int32_t transaction_index{-1};
+    const char* const* opcode_names{nullptr};
+    std::vector<TraceFrame> frames;  // the first one (if any) is the top-level frame
     std::vector<TraceOp> ops;
+    std::vector<intx::uint256> stack;
+    std::vector<TraceMemory> memory;
+    std::vector<TraceStorage> storage;
+    silkworm::Bytes memory_data;
+    silkworm::Bytes code_data;
+
+    void reserve(std::size_t op_count);
+
+    //! Append a new frame executing \p code and return its index
+    std::int32_t add_frame(silkworm::ByteView code);
+
+    //! Append \p op as the last one of \p frame and return its index
+    std::int32_t add_op(std::int32_t frame, const TraceOp& op);
+
+    //! Remove all the ops of \p frame, provided they are the last ones in the buffer
+    void clear_ops(std::int32_t frame);
 };
 
 void to_json(nlohmann::json& json, const VmTrace& vm_trace);
-void to_json(nlohmann::json& json, const TraceOp& trace_op);
-void to_json(nlohmann::json& json, const TraceEx& trace_ex);
-void to_json(nlohmann::json& json, const TraceMemory& trace_memory);
 void to_json(nlohmann::json& json, const TraceStorage& trace_storage);
 
-void copy_stack(std::uint8_t op_code, const evmone::uint256* stack, std::vector<std::string>& trace_stack);
-void copy_memory(const evmone::Memory& memory, std::optional<TraceMemory>& trace_memory);
+void copy_stack(std::uint8_t op_code, const evmone::uint256* stack, std::vector<intx::uint256>& trace_stack);
+bool copy_memory(const evmone::Memory& memory, TraceMemory& trace_memory, silkworm::Bytes& memory_data);
 void copy_store(std::uint8_t op_code, const evmone::uint256* stack, std::optional<TraceStorage>& trace_storage);
 void copy_memory_offset_len(std::uint8_t op_code, const evmone::uint256* stack, std::optional<TraceMemory>& trace_memory);
 void push_memory_offset_len(std::uint8_t op_code, const evmone::uint256* stack, std::stack<TraceMemory>& tms);
 
 class VmTraceTracer : public silkworm::EvmTracer {
 public:
-    explicit VmTraceTracer(VmTrace& vm_trace, std::int32_t index = -1) : vm_trace_(vm_trace), transaction_index_{index} {}
+    explicit VmTraceTracer(VmTrace& vm_trace, std::int32_t index = -1) : vm_trace_(vm_trace) {
+        vm_trace_.transaction_index = index;
+    }
 
     VmTraceTracer(const VmTraceTracer&) = delete;
     VmTraceTracer& operator=(const VmTraceTracer&) = delete;
@@ -146,12 +181,8 @@ public:
 
 private:
     VmTrace& vm_trace_;
-    std::int32_t transaction_index_;
-    std::stack<std::string> index_prefix_;
-    std::stack<std::reference_wrapper<VmTrace>> traces_stack_;
-    const char* const* opcode_names_ = nullptr;
+    std::stack<std::int32_t> frames_stack_;
     std::stack<std::uint64_t> start_gas_;
-    std::stack<TraceMemory> trace_memory_stack_;
 };
 
 struct TraceAction {
@@ -363,14 +394,21 @@ struct Filter {
     std::uint32_t count{std::numeric_limits<uint32_t>::max()};
 };
 
+//! Maximum number of blocks concurrently traced by trace_filter
+constexpr std::size_t kTraceFilterWindowSize{16};
+
+//! Maximum number of transactions of the same block speculatively replayed in parallel by trace_block_transactions
+constexpr std::size_t kReplayWindowSize{32};
+
 template<typename WorldState = silkworm::IntraBlockState, typename VM = silkworm::EVM>
 class TraceCallExecutor {
 public:
     explicit TraceCallExecutor(boost::asio::io_context& io_context,
         silkrpc::BlockCache& block_cache,
         const core::rawdb::DatabaseReader& database_reader,
-        boost::asio::thread_pool& workers)
-    : io_context_(io_context), block_cache_(block_cache), database_reader_(database_reader), workers_{workers} {}
+        boost::asio::thread_pool& workers,
+        const ExecutionCaches& caches = {})
+    : io_context_(io_context), block_cache_(block_cache), database_reader_(database_reader), workers_{workers}, caches_{caches} {}
     virtual ~TraceCallExecutor() {}
 
     TraceCallExecutor(const TraceCallExecutor&) = delete;
@@ -384,16 +422,48 @@ public:
         return execute(block.header.number-1, block, transaction, transaction.transaction_index, config);
     }
     boost::asio::awaitable<std::vector<Trace>> trace_transaction(const silkworm::BlockWithHash& block, const silkrpc::Transaction& transaction);
-    boost::asio::awaitable<void> trace_filter(const TraceFilter& trace_filter, json::Stream* stream);
+    //! Blocks are traced one by one unless \p database is provided: in such case, up to \ref kTraceFilterWindowSize blocks are
+    //! traced concurrently each one within its own database transaction, but traces are still written in block order
+    boost::asio::awaitable<void> trace_filter(const TraceFilter& trace_filter, json::Stream* stream, ethdb::Database* database = nullptr);
+
+    //! Stop tracing at the next block or EVM call when \p cancellation is cancelled (optional, never stopped if null)
+    void set_cancellation(const Cancellation* cancellation) { cancellation_ = cancellation; }
 
 private:
     boost::asio::awaitable<TraceCallResult> execute(std::uint64_t block_number, const silkworm::Block& block,
         const silkrpc::Transaction& transaction, std::int32_t index, const TraceConfig& config);
 
+    boost::asio::awaitable<std::vector<Trace>> filter_block_traces(const silkworm::BlockWithHash& block_with_hash,
+        const std::vector<TraceCallResult>& trace_call_results, Filter& filter, json::Stream* stream);
+
+    boost::asio::awaitable<std::vector<TraceCallResult>> trace_block_transactions(ethdb::Database& database, const silkworm::Block& block);
+
+    //! Replay the block transactions in parallel on top of the parent state recording their state accesses, then validate them in
+    //! order: transactions which have read any state value written by some previous transaction are replayed again on top of the
+    //! changes applied so far
+    boost::asio::awaitable<std::vector<TraceCallResult>> trace_block_transactions_speculatively(const silkworm::Block& block,
+        const TraceConfig& config, const core::ResolvedChainConfig& chain_config);
+
+    boost::asio::awaitable<TraceCallResult> replay_transaction(const silkworm::Block& block, const silkrpc::Transaction& transaction,
+        std::int32_t index, const TraceConfig& config, const core::ResolvedChainConfig& chain_config, silkworm::State& parent_state,
+        state::SpeculativeState& state);
+
+    //! Get the blocks in [\p from_block, \p to_block] where any filtered address is caller or callee, using the call indices
+    boost::asio::awaitable<roaring::Roaring> get_addresses_bitmap(const Filter& filter, std::uint64_t from_block, std::uint64_t to_block);
+
+    boost::asio::awaitable<silkworm::BlockWithHash> read_block_in_range(std::uint64_t block_number,
+        const silkworm::BlockWithHash& from_block_with_hash, const silkworm::BlockWithHash& to_block_with_hash);
+
+    boost::asio::awaitable<void> trace_filter_concurrently(const roaring::Roaring& block_numbers,
+        const silkworm::BlockWithHash& from_block_with_hash, const silkworm::BlockWithHash& to_block_with_hash, Filter& filter,
+        json::Stream* stream, ethdb::Database& database);
+
     boost::asio::io_context& io_context_;
     silkrpc::BlockCache& block_cache_;
     const core::rawdb::DatabaseReader& database_reader_;
     boost::asio::thread_pool& workers_;
+    ExecutionCaches caches_;
+    const Cancellation* cancellation_{nullptr};
 };
 } // namespace silkrpc::trace
 
@@ -0,0 +1,132 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "evm_trace.hpp"
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <evmc/evmc.hpp>
+#include <silkworm/chain/config.hpp>
+#include <silkworm/common/util.hpp>
+#include <silkworm/execution/evm.hpp>
+#include <silkworm/state/in_memory_state.hpp>
+
+#include <silkworm/silkrpc/core/evm_debug.hpp>
+
+namespace silkrpc::trace {
+
+using namespace evmc::literals;  // NOLINT(build/namespaces_literals)
+
+static constexpr auto kBenchSender{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+static constexpr auto kBenchContract{0x0f572e5295c57f15886f9b263e2f6d2d6c7b5ec6_address};
+
+//! Loop of 1024 iterations storing the decreasing counter in memory: PUSH2 0x0400 JUMPDEST PUSH1 1 SWAP1 SUB DUP1 PUSH1 0 MSTORE DUP1 PUSH1 3 JUMPI STOP
+static const silkworm::Bytes kBenchCode{*silkworm::from_hex("6104005b600190038060005280600357" "00")};
+static constexpr int64_t kBenchIterations{1'024};
+static constexpr int64_t kBenchOpsPerIteration{9};
+static constexpr int64_t kBenchOps{kBenchIterations * kBenchOpsPerIteration + 2};
+
+using Tracers = std::vector<std::shared_ptr<silkworm::EvmTracer>>;
+
+//! Call to the synthetic contract deployed on in-memory state
+class BenchExecution {
+public:
+    BenchExecution() : ibs_{state_} {
+        ibs_.set_code(kBenchContract, kBenchCode);
+        block_.header.number = 15'000'000;
+        txn_.from = kBenchSender;
+        txn_.to = kBenchContract;
+        txn_.gas_limit = 1'000'000;
+    }
+
+    silkworm::IntraBlockState& ibs() { return ibs_; }
+
+    uint64_t execute(const Tracers& tracers) {
+        silkworm::EVM evm{block_, ibs_, silkworm::kMainnetConfig};
+        for (const auto& tracer : tracers) {
+            evm.add_tracer(*tracer);
+        }
+        return evm.execute(txn_, txn_.gas_limit).gas_left;
+    }
+
+private:
+    silkworm::InMemoryState state_;
+    silkworm::IntraBlockState ibs_;
+    silkworm::Block block_;
+    silkworm::Transaction txn_;
+};
+
+static void benchmark_no_tracer(benchmark::State& state) {
+    BenchExecution execution;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(execution.execute({}));
+    }
+    state.SetItemsProcessed(state.iterations() * kBenchOps);
+}
+
+BENCHMARK(benchmark_no_tracer);
+
+static void benchmark_debug_tracer(benchmark::State& state) {
+    debug::DebugConfig config;
+    config.compact = state.range(0) != 0;
+    BenchExecution execution;
+    for (auto _ : state) {
+        std::vector<debug::DebugLog> logs;
+        benchmark::DoNotOptimize(execution.execute({std::make_shared<debug::DebugTracer>(logs, config)}));
+    }
+    state.SetItemsProcessed(state.iterations() * kBenchOps);
+}
+
+BENCHMARK(benchmark_debug_tracer)->Arg(0)->Arg(1);
+
+static void benchmark_trace_tracer(benchmark::State& state) {
+    BenchExecution execution;
+    for (auto _ : state) {
+        std::vector<Trace> traces;
+        benchmark::DoNotOptimize(execution.execute({std::make_shared<TraceTracer>(traces, execution.ibs())}));
+    }
+    state.SetItemsProcessed(state.iterations() * kBenchOps);
+}
+
+BENCHMARK(benchmark_trace_tracer);
+
+static void benchmark_vm_trace_tracer(benchmark::State& state) {
+    BenchExecution execution;
+    for (auto _ : state) {
+        VmTrace vm_trace;
+        benchmark::DoNotOptimize(execution.execute({std::make_shared<VmTraceTracer>(vm_trace)}));
+    }
+    state.SetItemsProcessed(state.iterations() * kBenchOps);
+}
+
+BENCHMARK(benchmark_vm_trace_tracer);
+
+static void benchmark_vm_trace_to_json(benchmark::State& state) {
+    BenchExecution execution;
+    VmTrace vm_trace;
+    execution.execute({std::make_shared<VmTraceTracer>(vm_trace)});
+    for (auto _ : state) {
+        const nlohmann::json json = vm_trace;
+        benchmark::DoNotOptimize(json.dump());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(vm_trace.ops.size()));
+}
+
+BENCHMARK(benchmark_vm_trace_to_json);
+
+} // namespace silkrpc::trace
@@ -0,0 +1,53 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <memory>
+
+#include <silkworm/silkrpc/core/call_footprint_cache.hpp>
+#include <silkworm/silkrpc/core/chain_config_cache.hpp>
+#include <silkworm/silkrpc/core/state_checkpoint_cache.hpp>
+#include <silkworm/silkrpc/core/state_snapshot_cache.hpp>
+#include <silkworm/silkrpc/core/trace_cache.hpp>
+#include <silkworm/silkrpc/ethdb/history_cache.hpp>
+
+namespace silkrpc {
+
+//! The caches used by historical execution and tracing, shared among the execution contexts.
+//! Any of them can be null, in which case the corresponding cache is not used.
+struct ExecutionCaches {
+    std::shared_ptr<ethdb::HistoryCache> history;
+    std::shared_ptr<state::StateSnapshotCache> snapshot;
+    std::shared_ptr<state::StateCheckpointCache> checkpoint;
+    std::shared_ptr<core::ChainConfigCache> chain_config;
+    std::shared_ptr<state::CallFootprintCache> footprint;
+    std::shared_ptr<trace::TraceCache> trace;
+};
+
+//! Create all the execution caches with their default limits
+inline ExecutionCaches make_execution_caches() {
+    return ExecutionCaches{
+        .history = std::make_shared<ethdb::HistoryCache>(),
+        .snapshot = std::make_shared<state::StateSnapshotCache>(),
+        .checkpoint = std::make_shared<state::StateCheckpointCache>(),
+        .chain_config = std::make_shared<core::ChainConfigCache>(),
+        .footprint = std::make_shared<state::CallFootprintCache>(),
+        .trace = std::make_shared<trace::TraceCache>(),
+    };
+}
+
+} // namespace silkrpc
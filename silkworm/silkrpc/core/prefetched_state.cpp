@@ -0,0 +1,214 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "prefetched_state.hpp"
+
+#include <deque>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/this_coro.hpp>
+#include <silkworm/common/base.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/concurrency/async_slot.hpp>
+
+namespace silkrpc::state {
+
+//! Run \p fetches with up to \ref kFetchWindowSize of them in flight at the same time, returning when all are done
+static boost::asio::awaitable<void> fetch_concurrently(std::vector<boost::asio::awaitable<bool>> fetches) {
+    const auto executor{co_await boost::asio::this_coro::executor};
+    std::deque<std::shared_ptr<AsyncSlot<bool>>> window;
+    std::exception_ptr exception;
+    try {
+        for (auto& fetch : fetches) {
+            if (window.size() == kFetchWindowSize) {
+                co_await window.front()->get();
+                window.pop_front();
+            }
+            auto slot = std::make_shared<AsyncSlot<bool>>(executor);
+            slot->spawn(std::move(fetch));
+            window.push_back(std::move(slot));
+        }
+        while (!window.empty()) {
+            co_await window.front()->get();
+            window.pop_front();
+        }
+    } catch (...) {
+        exception = std::current_exception();
+    }
+
+    // The fetches still in flight use this state, so they must be done before leaving
+    co_await cancel_and_wait_all(window);
+
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+boost::asio::awaitable<void> PrefetchedState::fetch_missing() {
+    SILKRPC_DEBUG << "PrefetchedState::fetch_missing #accounts: " << missing_accounts_.size() << " #storage: " << missing_storage_.size()
+        << " #codes: " << missing_codes_.size() << " #hints: " << hints_.size() << "\n";
+
+    // Hinted accounts go first with the missing ones, because code hash and incarnation are needed to read code and storage
+    const auto hints{std::move(hints_)};
+    hints_.clear();
+    for (const auto& entry : hints) {
+        if (!cached_account(entry.account)) {
+            missing_accounts_.insert(entry.account);
+        }
+    }
+
+    // AsyncRemoteState fills the snapshot with any value read, including the empty ones, unless the snapshot is full
+    const auto missing_accounts{std::move(missing_accounts_)};
+    missing_accounts_.clear();
+    std::vector<boost::asio::awaitable<bool>> account_fetches;
+    account_fetches.reserve(missing_accounts.size());
+    for (const auto& address : missing_accounts) {
+        account_fetches.push_back(fetch_account(address));
+    }
+    co_await fetch_concurrently(std::move(account_fetches));
+
+    add_hinted_code_and_storage(hints);
+    const auto missing_storage{std::move(missing_storage_)};
+    missing_storage_.clear();
+    const auto missing_codes{std::move(missing_codes_)};
+    missing_codes_.clear();
+    std::vector<boost::asio::awaitable<bool>> storage_and_code_fetches;
+    storage_and_code_fetches.reserve(missing_storage.size() + missing_codes.size());
+    for (const auto& [address, incarnation, location] : missing_storage) {
+        storage_and_code_fetches.push_back(fetch_storage(address, incarnation, location));
+    }
+    for (const auto& code_hash : missing_codes) {
+        storage_and_code_fetches.push_back(fetch_code(code_hash));
+    }
+    co_await fetch_concurrently(std::move(storage_and_code_fetches));
+}
+
+boost::asio::awaitable<bool> PrefetchedState::fetch_account(evmc::address address) {
+    const auto account{co_await async_state_.read_account(address)};
+    if (!snapshot_->read_account(address)) {
+        overflow_.insert_account(address, account);
+    }
+    co_return true;
+}
+
+boost::asio::awaitable<bool> PrefetchedState::fetch_storage(evmc::address address, uint64_t incarnation, evmc::bytes32 location) {
+    const auto value{co_await async_state_.read_storage(address, incarnation, location)};
+    if (!snapshot_->read_storage(address, incarnation, location)) {
+        overflow_.insert_storage(address, incarnation, location, value);
+    }
+    co_return true;
+}
+
+boost::asio::awaitable<bool> PrefetchedState::fetch_code(evmc::bytes32 code_hash) {
+    const auto code{co_await async_state_.read_code(code_hash)};
+    if (!snapshot_->read_code(code_hash) && !snapshot_->insert_code(code_hash, silkworm::Bytes{code})) {
+        overflow_.insert_code(code_hash, silkworm::Bytes{code});
+    }
+    co_return true;
+}
+
+void PrefetchedState::add_hints(const AccessList& access_list) {
+    hints_.insert(hints_.end(), access_list.cbegin(), access_list.cend());
+}
+
+void PrefetchedState::add_hinted_code_and_storage(const AccessList& hints) {
+    for (const auto& entry : hints) {
+        const auto account{cached_account(entry.account)};
+        if (!account || !*account) {
+            continue;
+        }
+        const auto& hinted_account{**account};
+        if (hinted_account.code_hash != silkworm::kEmptyHash && !cached_code(hinted_account.code_hash)) {
+            missing_codes_.insert(hinted_account.code_hash);
+        }
+        for (const auto& location : entry.storage_keys) {
+            if (!cached_storage(entry.account, hinted_account.incarnation, location)) {
+                missing_storage_.emplace(entry.account, hinted_account.incarnation, location);
+            }
+        }
+    }
+}
+
+AccessList PrefetchedState::footprint() const {
+    AccessList access_list;
+    access_list.reserve(touched_.size());
+    for (const auto& [address, locations] : touched_) {
+        access_list.push_back({address, std::vector<evmc::bytes32>{locations.cbegin(), locations.cend()}});
+    }
+    return access_list;
+}
+
+std::optional<silkworm::Account> PrefetchedState::read_account(const evmc::address& address) const noexcept {
+    touched_.try_emplace(address);
+    const auto account{cached_account(address)};
+    if (account) {
+        return *account;
+    }
+    if (blocking_) {
+        return remote_state_.read_account(address);
+    }
+    missing_accounts_.insert(address);
+    return std::nullopt;
+}
+
+silkworm::ByteView PrefetchedState::read_code(const evmc::bytes32& code_hash) const noexcept {
+    if (code_hash == silkworm::kEmptyHash) {
+        return silkworm::ByteView{};
+    }
+    const auto code{cached_code(code_hash)};
+    if (code) {
+        return *code;
+    }
+    if (blocking_) {
+        return remote_state_.read_code(code_hash);
+    }
+    missing_codes_.insert(code_hash);
+    return silkworm::ByteView{};
+}
+
+evmc::bytes32 PrefetchedState::read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const noexcept {
+    touched_[address].insert(location);
+    const auto value{cached_storage(address, incarnation, location)};
+    if (value) {
+        return *value;
+    }
+    if (blocking_) {
+        return remote_state_.read_storage(address, incarnation, location);
+    }
+    missing_storage_.emplace(address, incarnation, location);
+    return evmc::bytes32{};
+}
+
+std::optional<std::optional<silkworm::Account>> PrefetchedState::cached_account(const evmc::address& address) const {
+    const auto account{snapshot_->read_account(address)};
+    return account ? account : overflow_.read_account(address);
+}
+
+std::optional<silkworm::ByteView> PrefetchedState::cached_code(const evmc::bytes32& code_hash) const {
+    const auto code{snapshot_->read_code(code_hash)};
+    return code ? code : overflow_.read_code(code_hash);
+}
+
+std::optional<evmc::bytes32> PrefetchedState::cached_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const {
+    const auto value{snapshot_->read_storage(address, incarnation, location)};
+    return value ? value : overflow_.read_storage(address, incarnation, location);
+}
+
+} // namespace silkrpc::state
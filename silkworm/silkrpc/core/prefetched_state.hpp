@@ -0,0 +1,166 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include <silkworm/silkrpc/config.hpp> // NOLINT(build/include_order)
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/io_context.hpp>
+#include <evmc/evmc.hpp>
+#include <silkworm/state/state.hpp>
+
+#include <silkworm/silkrpc/core/rawdb/accessors.hpp>
+#include <silkworm/silkrpc/core/remote_state.hpp>
+#include <silkworm/silkrpc/core/state_snapshot_cache.hpp>
+#include <silkworm/silkrpc/ethdb/history_cache.hpp>
+#include <silkworm/silkrpc/types/transaction.hpp>
+
+namespace silkrpc::state {
+
+//! The max number of remote reads in flight at the same time within each phase of \ref PrefetchedState::fetch_missing
+constexpr std::size_t kFetchWindowSize{16};
+
+//! State for resumable EVM executions, which never blocks the executing thread waiting for remote reads. Accounts, storage
+//! and code are read just from the state snapshot: any missing value is recorded and reported as empty, so the execution goes
+//! on speculatively. Then \ref fetch_missing reads asynchronously the missing values into the snapshot and the execution
+//! can be restarted, until it completes without misses. Block data (e.g. headers for BLOCKHASH) is always read remotely.
+//! Values likely read (e.g. declared in the access list) can be hinted: they are fetched together with the first missing ones,
+//! so that an execution not missing anything never waits for them. It must be used by one execution at a time.
+class PrefetchedState : public silkworm::State {
+public:
+    explicit PrefetchedState(boost::asio::io_context& io_context, const core::rawdb::DatabaseReader& db_reader, std::shared_ptr<StateSnapshot> snapshot,
+        ethdb::HistoryCache* history_cache = nullptr)
+    : snapshot_{snapshot}, overflow_{snapshot->block_number(), std::numeric_limits<std::size_t>::max()},
+      async_state_{io_context, db_reader, snapshot, history_cache}, remote_state_{io_context, db_reader, snapshot, history_cache} {}
+
+    PrefetchedState(const PrefetchedState&) = delete;
+    PrefetchedState& operator=(const PrefetchedState&) = delete;
+
+    //! Check if any value has been missing since last fetch
+    bool has_missing() const { return missing_count() > 0; }
+
+    std::size_t missing_count() const { return missing_accounts_.size() + missing_storage_.size() + missing_codes_.size(); }
+
+    //! Read the missing values into the snapshot, without blocking any thread, together with the hinted ones not yet read.
+    //! Reads are issued concurrently within each phase: first the accounts, then the storage and code depending on them.
+    boost::asio::awaitable<void> fetch_missing();
+
+    //! Hint the listed accounts together with their code and storage keys to be read at next \ref fetch_missing
+    void add_hints(const AccessList& access_list);
+
+    //! Return the accounts and storage keys read so far, i.e. the state footprint of the executions
+    AccessList footprint() const;
+
+    //! Read the missing values remotely blocking the executing thread, e.g. as last resort after too many restarts
+    void set_blocking(bool blocking) { blocking_ = blocking; }
+
+    std::optional<silkworm::Account> read_account(const evmc::address& address) const noexcept override;
+
+    silkworm::ByteView read_code(const evmc::bytes32& code_hash) const noexcept override;
+
+    evmc::bytes32 read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const noexcept override;
+
+    uint64_t previous_incarnation(const evmc::address& address) const noexcept override { return 0; }
+
+    std::optional<silkworm::BlockHeader> read_header(uint64_t block_number, const evmc::bytes32& block_hash) const noexcept override {
+        return remote_state_.read_header(block_number, block_hash);
+    }
+
+    bool read_body(uint64_t block_number, const evmc::bytes32& block_hash, silkworm::BlockBody& out) const noexcept override {
+        return remote_state_.read_body(block_number, block_hash, out);
+    }
+
+    std::optional<intx::uint256> total_difficulty(uint64_t block_number, const evmc::bytes32& block_hash) const noexcept override {
+        return remote_state_.total_difficulty(block_number, block_hash);
+    }
+
+    evmc::bytes32 state_root_hash() const override { return evmc::bytes32{}; }
+
+    uint64_t current_canonical_block() const override { return 0; }
+
+    std::optional<evmc::bytes32> canonical_hash(uint64_t block_number) const override { return remote_state_.canonical_hash(block_number); }
+
+    void insert_block(const silkworm::Block& block, const evmc::bytes32& hash) override {}
+
+    void canonize_block(uint64_t block_number, const evmc::bytes32& block_hash) override {}
+
+    void decanonize_block(uint64_t block_number) override {}
+
+    void insert_receipts(uint64_t block_number, const std::vector<silkworm::Receipt>& receipts) override {}
+
+    void begin_block(uint64_t block_number) override {}
+
+    void update_account(
+        const evmc::address& address,
+        std::optional<silkworm::Account> initial,
+        std::optional<silkworm::Account> current) override {}
+
+    void update_account_code(
+        const evmc::address& address,
+        uint64_t incarnation,
+        const evmc::bytes32& code_hash,
+        silkworm::ByteView code) override {}
+
+    void update_storage(
+        const evmc::address& address,
+        uint64_t incarnation,
+        const evmc::bytes32& location,
+        const evmc::bytes32& initial,
+        const evmc::bytes32& current) override {}
+
+    void unwind_state_changes(uint64_t block_number) override {}
+
+private:
+    using StorageKey = std::tuple<evmc::address, uint64_t, evmc::bytes32>;
+
+    std::optional<std::optional<silkworm::Account>> cached_account(const evmc::address& address) const;
+    std::optional<silkworm::ByteView> cached_code(const evmc::bytes32& code_hash) const;
+    std::optional<evmc::bytes32> cached_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const;
+
+    //! Mark as missing the code and storage keys of the hinted accounts not yet cached, once the accounts have been read
+    void add_hinted_code_and_storage(const AccessList& hints);
+
+    //! Read one missing value into the snapshot, or into the overflow if the snapshot is full (keys by value, as reads run detached)
+    boost::asio::awaitable<bool> fetch_account(evmc::address address);
+    boost::asio::awaitable<bool> fetch_storage(evmc::address address, uint64_t incarnation, evmc::bytes32 location);
+    boost::asio::awaitable<bool> fetch_code(evmc::bytes32 code_hash);
+
+    std::shared_ptr<StateSnapshot> snapshot_;
+    //! The values fetched but not cached in the shared snapshot because it is full, private to this state
+    StateSnapshot overflow_;
+    AsyncRemoteState async_state_;
+    RemoteState remote_state_;
+    bool blocking_{false};
+
+    mutable std::set<evmc::address> missing_accounts_;
+    mutable std::set<StorageKey> missing_storage_;
+    mutable std::set<evmc::bytes32> missing_codes_;
+    AccessList hints_;
+
+    mutable std::map<evmc::address, std::set<evmc::bytes32>> touched_;
+};
+
+} // namespace silkrpc::state
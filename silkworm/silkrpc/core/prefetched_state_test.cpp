@@ -0,0 +1,247 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "prefetched_state.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <catch2/catch.hpp>
+#include <evmc/evmc.hpp>
+#include <silkworm/common/base.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/common/util.hpp>
+#include <silkworm/silkrpc/ethdb/tables.hpp>
+#include <silkworm/silkrpc/test/context_test_base.hpp>
+#include <silkworm/silkrpc/test/mock_database_reader.hpp>
+
+namespace silkrpc::state {
+
+using evmc::literals::operator""_address;
+using evmc::literals::operator""_bytes32;
+using testing::InvokeWithoutArgs;
+using testing::_;
+
+static const evmc::address kTestAddress{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+static const evmc::bytes32 kTestLocation{0x0000000000000000000000000000000000000000000000000000000000000001_bytes32};
+static const evmc::bytes32 kTestValue{0x0000000000000000000000000000000000000000000000000000000000000002_bytes32};
+static const silkworm::Bytes kBinaryCode{*silkworm::from_hex("0x60045e005c60016000555d")};
+static const evmc::bytes32 kCodeHash{0xef722d9baf50b9983c2fce6329c5a43a15b8d5ba79cd792e7199d615be88284d_bytes32};
+
+struct PrefetchedStateTest : public test::ContextTestBase {
+    test::MockDatabaseReader database_reader_;
+    std::shared_ptr<StateSnapshot> snapshot_{std::make_shared<StateSnapshot>(1'000'000)};
+    PrefetchedState state_{io_context_, database_reader_, snapshot_};
+};
+
+TEST_CASE_METHOD(PrefetchedStateTest, "PrefetchedState::read_code", "[silkrpc][core][prefetched_state]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    SECTION("empty hash is never missing") {
+        CHECK(state_.read_code(silkworm::kEmptyHash) == silkworm::ByteView{});
+        CHECK_FALSE(state_.has_missing());
+    }
+
+    SECTION("missing code is fetched into snapshot") {
+        EXPECT_CALL(database_reader_, get_one(db::table::kCode, full_view(kCodeHash))).WillOnce(InvokeWithoutArgs(
+            []() -> boost::asio::awaitable<silkworm::Bytes> { co_return kBinaryCode; }
+        ));
+        CHECK(state_.read_code(kCodeHash) == silkworm::ByteView{});
+        CHECK(state_.missing_count() == 1);
+
+        spawn_and_wait(state_.fetch_missing());
+        CHECK_FALSE(state_.has_missing());
+        CHECK(state_.read_code(kCodeHash) == kBinaryCode);
+        CHECK_FALSE(state_.has_missing());
+    }
+
+    SECTION("code not found is fetched as empty") {
+        EXPECT_CALL(database_reader_, get_one(db::table::kCode, full_view(kCodeHash))).WillOnce(InvokeWithoutArgs(
+            []() -> boost::asio::awaitable<silkworm::Bytes> { co_return silkworm::Bytes{}; }
+        ));
+        CHECK(state_.read_code(kCodeHash) == silkworm::ByteView{});
+        spawn_and_wait(state_.fetch_missing());
+        CHECK(state_.read_code(kCodeHash) == silkworm::ByteView{});
+        CHECK_FALSE(state_.has_missing());
+    }
+
+    SECTION("missing code read blocking") {
+        EXPECT_CALL(database_reader_, get_one(db::table::kCode, full_view(kCodeHash))).WillOnce(InvokeWithoutArgs(
+            []() -> boost::asio::awaitable<silkworm::Bytes> { co_return kBinaryCode; }
+        ));
+        state_.set_blocking(true);
+        CHECK(state_.read_code(kCodeHash) == kBinaryCode);
+        CHECK_FALSE(state_.has_missing());
+    }
+}
+
+TEST_CASE_METHOD(PrefetchedStateTest, "PrefetchedState::fetch_missing with full snapshot", "[silkrpc][core][prefetched_state]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    auto full_snapshot{std::make_shared<StateSnapshot>(1'000'000, /*max_memory_size=*/0)};
+    PrefetchedState state{io_context_, database_reader_, full_snapshot};
+    EXPECT_CALL(database_reader_, get_one(db::table::kCode, full_view(kCodeHash))).WillOnce(InvokeWithoutArgs(
+        []() -> boost::asio::awaitable<silkworm::Bytes> { co_return kBinaryCode; }
+    ));
+    CHECK(state.read_code(kCodeHash) == silkworm::ByteView{});
+    spawn_and_wait(state.fetch_missing());
+    CHECK_FALSE(full_snapshot->read_code(kCodeHash));
+    CHECK(state.read_code(kCodeHash) == kBinaryCode);
+    CHECK_FALSE(state.has_missing());
+}
+
+TEST_CASE_METHOD(PrefetchedStateTest, "PrefetchedState::fetch_missing concurrently", "[silkrpc][core][prefetched_state]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    constexpr std::size_t kCodeCount{kFetchWindowSize + 4};
+    std::size_t in_flight{0};
+    std::size_t max_in_flight{0};
+    EXPECT_CALL(database_reader_, get_one(db::table::kCode, _)).Times(kCodeCount).WillRepeatedly(InvokeWithoutArgs(
+        [&]() -> boost::asio::awaitable<silkworm::Bytes> {
+            max_in_flight = std::max(max_in_flight, ++in_flight);
+            boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor, std::chrono::milliseconds{1}};
+            co_await timer.async_wait(boost::asio::use_awaitable);
+            --in_flight;
+            co_return kBinaryCode;
+        }
+    ));
+    std::vector<evmc::bytes32> code_hashes(kCodeCount);
+    for (std::size_t i{0}; i < kCodeCount; ++i) {
+        code_hashes[i].bytes[0] = static_cast<uint8_t>(i + 1);
+        CHECK(state_.read_code(code_hashes[i]) == silkworm::ByteView{});
+    }
+    CHECK(state_.missing_count() == kCodeCount);
+
+    spawn_and_wait(state_.fetch_missing());
+    CHECK(max_in_flight == kFetchWindowSize);
+    for (const auto& code_hash : code_hashes) {
+        CHECK(state_.read_code(code_hash) == kBinaryCode);
+    }
+    CHECK_FALSE(state_.has_missing());
+}
+
+TEST_CASE_METHOD(PrefetchedStateTest, "PrefetchedState::read_account", "[silkrpc][core][prefetched_state]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    SECTION("account in snapshot") {
+        const silkworm::Account account{/*nonce=*/3, /*balance=*/1'000};
+        snapshot_->insert_account(kTestAddress, account);
+        const auto read_account{state_.read_account(kTestAddress)};
+        CHECK(read_account == account);
+        CHECK_FALSE(state_.has_missing());
+    }
+
+    SECTION("account not existing in snapshot") {
+        snapshot_->insert_account(kTestAddress, std::nullopt);
+        CHECK(state_.read_account(kTestAddress) == std::nullopt);
+        CHECK_FALSE(state_.has_missing());
+    }
+
+    SECTION("missing account") {
+        CHECK(state_.read_account(kTestAddress) == std::nullopt);
+        CHECK(state_.read_account(kTestAddress) == std::nullopt);
+        CHECK(state_.missing_count() == 1);
+    }
+}
+
+TEST_CASE_METHOD(PrefetchedStateTest, "PrefetchedState::read_storage", "[silkrpc][core][prefetched_state]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    SECTION("storage in snapshot") {
+        snapshot_->insert_storage(kTestAddress, 1, kTestLocation, kTestValue);
+        CHECK(state_.read_storage(kTestAddress, 1, kTestLocation) == kTestValue);
+        CHECK_FALSE(state_.has_missing());
+    }
+
+    SECTION("missing storage for each incarnation") {
+        snapshot_->insert_storage(kTestAddress, 1, kTestLocation, kTestValue);
+        CHECK(state_.read_storage(kTestAddress, 2, kTestLocation) == evmc::bytes32{});
+        CHECK(state_.read_storage(kTestAddress, 3, kTestLocation) == evmc::bytes32{});
+        CHECK(state_.missing_count() == 2);
+    }
+}
+
+TEST_CASE_METHOD(PrefetchedStateTest, "PrefetchedState::add_hints", "[silkrpc][core][prefetched_state]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    SECTION("hints are not missing") {
+        state_.add_hints(AccessList{{kTestAddress, {kTestLocation}}});
+        CHECK_FALSE(state_.has_missing());
+    }
+
+    SECTION("code of hinted account is fetched into snapshot with missing values") {
+        silkworm::Account account{/*nonce=*/1, /*balance=*/0};
+        account.code_hash = kCodeHash;
+        account.incarnation = 1;
+        snapshot_->insert_account(kTestAddress, account);
+        snapshot_->insert_storage(kTestAddress, 1, kTestLocation, kTestValue);
+        EXPECT_CALL(database_reader_, get_one(db::table::kCode, full_view(kCodeHash))).WillOnce(InvokeWithoutArgs(
+            []() -> boost::asio::awaitable<silkworm::Bytes> { co_return kBinaryCode; }
+        ));
+        state_.add_hints(AccessList{{kTestAddress, {kTestLocation}}});
+        spawn_and_wait(state_.fetch_missing());
+        CHECK(snapshot_->read_code(kCodeHash) == kBinaryCode);
+        CHECK(state_.read_code(kCodeHash) == kBinaryCode);
+        CHECK(state_.read_storage(kTestAddress, 1, kTestLocation) == kTestValue);
+        CHECK_FALSE(state_.has_missing());
+    }
+
+    SECTION("hints are fetched once") {
+        snapshot_->insert_account(kTestAddress, std::nullopt);
+        state_.add_hints(AccessList{{kTestAddress, {kTestLocation}}});
+        spawn_and_wait(state_.fetch_missing());
+        spawn_and_wait(state_.fetch_missing());
+        CHECK_FALSE(state_.has_missing());
+    }
+
+    SECTION("hinted keys are not part of footprint") {
+        snapshot_->insert_account(kTestAddress, std::nullopt);
+        state_.add_hints(AccessList{{kTestAddress, {kTestLocation}}});
+        spawn_and_wait(state_.fetch_missing());
+        CHECK(state_.footprint().empty());
+    }
+}
+
+TEST_CASE_METHOD(PrefetchedStateTest, "PrefetchedState::footprint", "[silkrpc][core][prefetched_state]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    SECTION("no read") {
+        CHECK(state_.footprint().empty());
+    }
+
+    SECTION("accounts and storage keys read") {
+        static const evmc::address kOtherAddress{0x0f572e5295c57f15886f9b263e2f6d2d6c7b5ec6_address};
+        snapshot_->insert_storage(kTestAddress, 1, kTestLocation, kTestValue);
+        state_.read_account(kOtherAddress);
+        state_.read_storage(kTestAddress, 1, kTestLocation);
+        state_.read_storage(kTestAddress, 1, kTestLocation);
+        const auto footprint{state_.footprint()};
+        REQUIRE(footprint.size() == 2);
+        CHECK(footprint[0].account == kTestAddress);
+        CHECK(footprint[0].storage_keys == std::vector<evmc::bytes32>{kTestLocation});
+        CHECK(footprint[1].account == kOtherAddress);
+        CHECK(footprint[1].storage_keys.empty());
+    }
+}
+
+} // namespace silkrpc::state
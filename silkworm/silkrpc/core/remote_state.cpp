@@ -17,6 +17,7 @@
 #include "remote_state.hpp"
 
 #include <future>
+#include <mutex>
 #include <unordered_map>
 #include <utility>
 
@@ -30,23 +31,54 @@
 
 namespace silkrpc::state {
 
-static std::unordered_map<evmc::bytes32, silkworm::Bytes> code;
-
 boost::asio::awaitable<std::optional<silkworm::Account>> AsyncRemoteState::read_account(const evmc::address& address) const noexcept {
-    co_return co_await state_reader_.read_account(address, block_number_ + 1);
+    if (snapshot_) {
+        const auto cached_account{snapshot_->read_account(address)};
+        if (cached_account) {
+            co_return *cached_account;
+        }
+    }
+    const auto account{co_await state_reader_.read_account(address, block_number_ + 1)};
+    if (snapshot_) {
+        snapshot_->insert_account(address, account);
+    }
+    co_return account;
 }
 
 boost::asio::awaitable<silkworm::ByteView> AsyncRemoteState::read_code(const evmc::bytes32& code_hash) const noexcept {
-    const auto optional_code{co_await state_reader_.read_code(code_hash)};
-    if (optional_code) {
-        code[code_hash] = std::move(*optional_code);
-        co_return code[code_hash]; // NOLINT(runtime/arrays)
+    if (snapshot_) {
+        const auto cached_code{snapshot_->read_code(code_hash)};
+        if (cached_code) {
+            co_return *cached_code;
+        }
+    }
+    auto optional_code{co_await state_reader_.read_code(code_hash)};
+    if (!optional_code) {
+        co_return silkworm::ByteView{};
+    }
+    if (snapshot_) {
+        const auto cached_code{snapshot_->insert_code(code_hash, *optional_code)};
+        if (cached_code) {
+            co_return *cached_code;
+        }
     }
-    co_return silkworm::ByteView{};
+    // Keep the code not cached in the snapshot (if any) as long as this state is alive
+    const auto it = codes_.try_emplace(code_hash, std::move(*optional_code)).first;
+    co_return silkworm::ByteView{it->second};
 }
 
 boost::asio::awaitable<evmc::bytes32> AsyncRemoteState::read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const noexcept {
-    co_return co_await state_reader_.read_storage(address, incarnation, location, block_number_ + 1);
+    if (snapshot_) {
+        const auto cached_value{snapshot_->read_storage(address, incarnation, location)};
+        if (cached_value) {
+            co_return *cached_value;
+        }
+    }
+    const auto value{co_await state_reader_.read_storage(address, incarnation, location, block_number_ + 1)};
+    if (snapshot_) {
+        snapshot_->insert_storage(address, incarnation, location, value);
+    }
+    co_return value;
 }
 
 boost::asio::awaitable<uint64_t> AsyncRemoteState::previous_incarnation(const evmc::address& address) const noexcept {
@@ -82,6 +114,15 @@ boost::asio::awaitable<std::optional<evmc::bytes32>> AsyncRemoteState::canonical
 
 std::optional<silkworm::Account> RemoteState::read_account(const evmc::address& address) const noexcept {
     SILKRPC_DEBUG << "RemoteState::read_account address=" << address << " start\n";
+    // The snapshot is thread-safe, so hits need neither the lock nor a round trip to the I/O context
+    const auto& snapshot{async_state_.snapshot()};
+    if (snapshot) {
+        const auto cached_account{snapshot->read_account(address)};
+        if (cached_account) {
+            return *cached_account;
+        }
+    }
+    std::scoped_lock lock{access_};
     try {
         std::future<std::optional<silkworm::Account>> result{boost::asio::co_spawn(io_context_, async_state_.read_account(address), boost::asio::use_future)};
         const auto optional_account{result.get()};
@@ -95,6 +136,14 @@ std::optional<silkworm::Account> RemoteState::read_account(const evmc::address&
 
 silkworm::ByteView RemoteState::read_code(const evmc::bytes32& code_hash) const noexcept {
     SILKRPC_DEBUG << "RemoteState::read_code code_hash=" << code_hash << " start\n";
+    const auto& snapshot{async_state_.snapshot()};
+    if (snapshot) {
+        const auto cached_code{snapshot->read_code(code_hash)};
+        if (cached_code) {
+            return *cached_code;
+        }
+    }
+    std::scoped_lock lock{access_};
     try {
         std::future<silkworm::ByteView> result{boost::asio::co_spawn(io_context_, async_state_.read_code(code_hash), boost::asio::use_future)};
         const auto code{result.get()};
@@ -107,6 +156,14 @@ silkworm::ByteView RemoteState::read_code(const evmc::bytes32& code_hash) const
 
 evmc::bytes32 RemoteState::read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const noexcept {
     SILKRPC_DEBUG << "RemoteState::read_storage address=" << address << " incarnation=" << incarnation << " location=" << location << " start\n";
+    const auto& snapshot{async_state_.snapshot()};
+    if (snapshot) {
+        const auto cached_value{snapshot->read_storage(address, incarnation, location)};
+        if (cached_value) {
+            return *cached_value;
+        }
+    }
+    std::scoped_lock lock{access_};
     try {
         std::future<evmc::bytes32> result{boost::asio::co_spawn(io_context_, async_state_.read_storage(address, incarnation, location), boost::asio::use_future)};
         const auto storage_value{result.get()};
@@ -125,6 +182,7 @@ uint64_t RemoteState::previous_incarnation(const evmc::address& address) const n
 
 std::optional<silkworm::BlockHeader> RemoteState::read_header(uint64_t block_number, const evmc::bytes32& block_hash) const noexcept {
     SILKRPC_DEBUG << "RemoteState::read_header block_number=" << block_number << " block_hash=" << block_hash << "\n";
+    std::scoped_lock lock{access_};
     try {
         std::future<std::optional<silkworm::BlockHeader>> result{boost::asio::co_spawn(io_context_, async_state_.read_header(block_number, block_hash), boost::asio::use_future)};
         const auto optional_header{result.get()};
@@ -138,6 +196,7 @@ std::optional<silkworm::BlockHeader> RemoteState::read_header(uint64_t block_num
 
 bool RemoteState::read_body(uint64_t block_number, const evmc::bytes32& block_hash, silkworm::BlockBody& filled_body) const noexcept {
     SILKRPC_DEBUG << "RemoteState::read_body block_number=" << block_number << " block_hash=" << block_hash << "\n";
+    std::scoped_lock lock{access_};
     try {
         auto result{boost::asio::co_spawn(io_context_, async_state_.read_body(block_number, block_hash, filled_body), boost::asio::use_future)};
         SILKRPC_DEBUG << "RemoteState::read_body block_number=" << block_number << " block_hash=" << block_hash << "\n";
@@ -150,6 +209,7 @@ bool RemoteState::read_body(uint64_t block_number, const evmc::bytes32& block_ha
 
 std::optional<intx::uint256> RemoteState::total_difficulty(uint64_t block_number, const evmc::bytes32& block_hash) const noexcept {
     SILKRPC_DEBUG << "RemoteState::total_difficulty block_number=" << block_number << " block_hash=" << block_hash << "\n";
+    std::scoped_lock lock{access_};
     try {
         std::future<std::optional<intx::uint256>> result{boost::asio::co_spawn(io_context_, async_state_.total_difficulty(block_number, block_hash), boost::asio::use_future)};
         const auto optional_total_difficulty{result.get()};
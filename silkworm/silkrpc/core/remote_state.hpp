@@ -17,8 +17,12 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <silkworm/silkrpc/config.hpp> // NOLINT(build/include_order)
@@ -30,14 +34,29 @@
 
 #include <silkworm/silkrpc/core/rawdb/accessors.hpp>
 #include <silkworm/silkrpc/core/state_reader.hpp>
+#include <silkworm/silkrpc/core/state_snapshot_cache.hpp>
+#include <silkworm/silkrpc/ethdb/history_cache.hpp>
 #include <silkworm/state/state.hpp>
 
 namespace silkrpc::state {
 
 class AsyncRemoteState {
 public:
-    explicit AsyncRemoteState(boost::asio::io_context& io_context, const core::rawdb::DatabaseReader& db_reader, uint64_t block_number)
-    : io_context_(io_context), db_reader_(db_reader), block_number_(block_number), state_reader_{db_reader} {}
+    explicit AsyncRemoteState(boost::asio::io_context& io_context, const core::rawdb::DatabaseReader& db_reader, uint64_t block_number,
+        ethdb::HistoryCache* history_cache = nullptr)
+    : io_context_(io_context), db_reader_(db_reader), block_number_(block_number), state_reader_{db_reader, history_cache} {}
+
+    //! Read the state at the end of the block \p block_number having \p block_hash, sharing its snapshot in \p snapshot_cache if any
+    explicit AsyncRemoteState(boost::asio::io_context& io_context, const core::rawdb::DatabaseReader& db_reader, uint64_t block_number,
+        const evmc::bytes32& block_hash, ethdb::HistoryCache* history_cache = nullptr, StateSnapshotCache* snapshot_cache = nullptr)
+    : io_context_(io_context), db_reader_(db_reader), block_number_(block_number), state_reader_{db_reader, history_cache},
+      snapshot_{snapshot_cache != nullptr ? snapshot_cache->get(block_number, block_hash) : nullptr} {}
+
+    //! Read the state at the block number of \p snapshot, looking up and filling such snapshot first
+    explicit AsyncRemoteState(boost::asio::io_context& io_context, const core::rawdb::DatabaseReader& db_reader, std::shared_ptr<StateSnapshot> snapshot,
+        ethdb::HistoryCache* history_cache = nullptr)
+    : io_context_(io_context), db_reader_(db_reader), block_number_(snapshot->block_number()), state_reader_{db_reader, history_cache},
+      snapshot_{std::move(snapshot)} {}
 
     boost::asio::awaitable<std::optional<silkworm::Account>> read_account(const evmc::address& address) const noexcept;
 
@@ -59,17 +78,40 @@ public:
 
     boost::asio::awaitable<std::optional<evmc::bytes32>> canonical_hash(uint64_t block_number) const;
 
+    //! The shared snapshot of the state at block number, if any
+    const std::shared_ptr<StateSnapshot>& snapshot() const noexcept { return snapshot_; }
+
 private:
     boost::asio::io_context& io_context_;
     const core::rawdb::DatabaseReader& db_reader_;
     uint64_t block_number_;
     StateReader state_reader_;
+    //! The shared snapshot of the state at block number, if any (kept alive by this state even if evicted from cache)
+    std::shared_ptr<StateSnapshot> snapshot_;
+    //! The code read but not cached in the snapshot, because there is no snapshot or it is full
+    mutable std::unordered_map<evmc::bytes32, silkworm::Bytes> codes_;
 };
 
+//! Synchronous adapter of \ref AsyncRemoteState for the EVM running on worker threads. Reads hitting the state snapshot
+//! are served on the calling thread without locking. Other reads are serialized, so that several executions (e.g. concurrent
+//! estimate gas probes) can share the same state without overlapping requests on the same database transaction. Several states
+//! on the same database transaction can serialize their reads together by sharing the same mutex.
 class RemoteState : public silkworm::State {
 public:
-    explicit RemoteState(boost::asio::io_context& io_context, const core::rawdb::DatabaseReader& db_reader, uint64_t block_number)
-    : io_context_(io_context), async_state_{io_context, db_reader, block_number} {}
+    explicit RemoteState(boost::asio::io_context& io_context, const core::rawdb::DatabaseReader& db_reader, uint64_t block_number,
+        ethdb::HistoryCache* history_cache = nullptr)
+    : io_context_(io_context), async_state_{io_context, db_reader, block_number, history_cache} {}
+
+    //! Read the state at the end of the block \p block_number having \p block_hash, sharing its snapshot in \p snapshot_cache if any
+    explicit RemoteState(boost::asio::io_context& io_context, const core::rawdb::DatabaseReader& db_reader, uint64_t block_number,
+        const evmc::bytes32& block_hash, ethdb::HistoryCache* history_cache = nullptr, StateSnapshotCache* snapshot_cache = nullptr)
+    : io_context_(io_context), async_state_{io_context, db_reader, block_number, block_hash, history_cache, snapshot_cache} {}
+
+    //! Read the state at the block number of \p snapshot, serializing the remote reads on \p shared_access if any
+    explicit RemoteState(boost::asio::io_context& io_context, const core::rawdb::DatabaseReader& db_reader, std::shared_ptr<StateSnapshot> snapshot,
+        ethdb::HistoryCache* history_cache = nullptr, std::mutex* shared_access = nullptr)
+    : io_context_(io_context), async_state_{io_context, db_reader, std::move(snapshot), history_cache},
+      access_{shared_access != nullptr ? *shared_access : own_access_} {}
 
     std::optional<silkworm::Account> read_account(const evmc::address& address) const noexcept override;
 
@@ -124,6 +166,8 @@ public:
 private:
     boost::asio::io_context& io_context_;
     AsyncRemoteState async_state_;
+    mutable std::mutex own_access_;
+    std::mutex& access_{own_access_};
 };
 
 std::ostream& operator<<(std::ostream& out, const RemoteState& s);
@@ -108,6 +108,33 @@ TEST_CASE("async remote buffer", "[silkrpc][core][remote_buffer]") {
         CHECK(future_code.get() == silkworm::ByteView{code});
     }
 
+    SECTION("read_code from state snapshot") {
+        boost::asio::io_context io_context;
+        silkworm::Bytes code{*silkworm::from_hex("0x0608")};
+        MockDatabaseReader db_reader{code};
+        MockDatabaseReader empty_db_reader;
+        const uint64_t block_number = 1'000'000;
+        StateSnapshotCache snapshot_cache;
+        const auto block_hash{0x439816753229fc0736bf86a5048de4bc9fcdede8c91dadf88c828c76b2281dff_bytes32};
+        const auto next_block_hash{0x5b6e3b5c0b4b9a5c4d5e6f708192a3b4c5d6e7f8091a2b3c4d5e6f708192a3b4_bytes32};
+        AsyncRemoteState state1{io_context, db_reader, block_number, block_hash, nullptr, &snapshot_cache};
+        AsyncRemoteState state2{io_context, empty_db_reader, block_number, block_hash, nullptr, &snapshot_cache};
+        AsyncRemoteState state3{io_context, empty_db_reader, block_number + 1, next_block_hash, nullptr, &snapshot_cache};
+        const auto code_hash{0x04491edcd115127caedbd478e2e7895ed80c7847e903431f94f9cfa579cad47f_bytes32};
+        auto future_code1{boost::asio::co_spawn(io_context, state1.read_code(code_hash), boost::asio::use_future)};
+        io_context.run();
+        CHECK(future_code1.get() == silkworm::ByteView{code});
+        io_context.restart();
+        auto future_code2{boost::asio::co_spawn(io_context, state2.read_code(code_hash), boost::asio::use_future)};
+        io_context.run();
+        CHECK(future_code2.get() == silkworm::ByteView{code});
+        io_context.restart();
+        auto future_code3{boost::asio::co_spawn(io_context, state3.read_code(code_hash), boost::asio::use_future)};
+        io_context.run();
+        CHECK(future_code3.get() == silkworm::ByteView{});
+        CHECK(snapshot_cache.size() == 2);
+    }
+
     SECTION("read_code with empty response from db") {
         boost::asio::io_context io_context;
         boost::asio::executor_work_guard<boost::asio::io_context::executor_type> work{io_context.get_executor()};
@@ -442,4 +469,28 @@ TEST_CASE_METHOD(RemoteStateTest, "RemoteState") {
     }
 }
 
+TEST_CASE("RemoteState serves snapshot hits on calling thread", "[silkrpc][core][remote_state]") {
+    // The I/O context never runs, so any read not served by the snapshot would block forever
+    boost::asio::io_context io_context;
+    test::MockDatabaseReader db_reader;
+    const uint64_t block_number = 1'000'000;
+    const auto address{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+    const auto location{0x0000000000000000000000000000000000000000000000000000000000000001_bytes32};
+    const auto value{0x00000000000000000000000000000000000000000000000000000000000000aa_bytes32};
+    const silkworm::Bytes code{*silkworm::from_hex("0x0608")};
+    const auto code_hash{0x04491edcd115127caedbd478e2e7895ed80c7847e903431f94f9cfa579cad47f_bytes32};
+    silkworm::Account account;
+    account.nonce = 7;
+
+    auto snapshot = std::make_shared<StateSnapshot>(block_number);
+    snapshot->insert_account(address, account);
+    snapshot->insert_storage(address, 1, location, value);
+    snapshot->insert_code(code_hash, code);
+    RemoteState remote_state{io_context, db_reader, snapshot};
+
+    CHECK(remote_state.read_account(address) == account);
+    CHECK(remote_state.read_storage(address, 1, location) == value);
+    CHECK(remote_state.read_code(code_hash) == silkworm::ByteView{code});
+}
+
 } // namespace silkrpc::state
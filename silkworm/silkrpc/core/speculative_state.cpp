@@ -0,0 +1,117 @@
+/*
+    Copyright 2022 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "speculative_state.hpp"
+
+#include <utility>
+
+namespace silkrpc::state {
+
+template <typename Key>
+static bool intersects(const std::set<Key>& lhs, const std::set<Key>& rhs) {
+    // Sorted sets: advance the iterator behind until both point to the same key or any end is reached
+    auto lhs_it = lhs.cbegin();
+    auto rhs_it = rhs.cbegin();
+    while (lhs_it != lhs.cend() && rhs_it != rhs.cend()) {
+        if (*lhs_it < *rhs_it) {
+            lhs_it = lhs.lower_bound(*rhs_it);
+        } else if (*rhs_it < *lhs_it) {
+            rhs_it = rhs.lower_bound(*lhs_it);
+        } else {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StateKeys::intersects(const StateKeys& other) const {
+    return state::intersects(accounts, other.accounts) || state::intersects(storage, other.storage);
+}
+
+void StateKeys::merge(const StateKeys& other) {
+    accounts.insert(other.accounts.cbegin(), other.accounts.cend());
+    storage.insert(other.storage.cbegin(), other.storage.cend());
+}
+
+void SpeculativeState::apply_changes(StateCheckpoint& changes) const {
+    for (const auto& [address, account_change] : accounts_) {
+        const auto& [initial, current] = account_change;
+        if (!fee_recipient_delta(address) || !current) {
+            changes.update_account(address, current);
+            continue;
+        }
+        // Fee payment only adds to the balance read before execution, so apply the same increment to the latest balance
+        const auto balance_delta{current->balance - (initial ? initial->balance : intx::uint256{0})};
+        const auto changed_account{changes.read_account(address)};
+        std::optional<silkworm::Account> account{changed_account ? *changed_account : initial};
+        if (!account) {
+            account = *current;
+            account->balance = 0;
+        }
+        account->balance += balance_delta;
+        changes.update_account(address, account);
+    }
+    for (const auto& [storage_key, value] : storage_) {
+        const auto& [address, incarnation, location] = storage_key;
+        changes.update_storage(address, incarnation, location, value);
+    }
+    for (const auto& [code_hash, code] : codes_) {
+        changes.update_code(code_hash, code);
+    }
+}
+
+std::optional<silkworm::Account> SpeculativeState::read_account(const evmc::address& address) const noexcept {
+    if (executing_ || !fee_recipient_ || *fee_recipient_ != address) {
+        read_keys_.accounts.insert(address);
+    }
+    return state_.read_account(address);
+}
+
+silkworm::ByteView SpeculativeState::read_code(const evmc::bytes32& code_hash) const noexcept {
+    // Code is immutable for a given hash, the account read gives the dependency
+    return state_.read_code(code_hash);
+}
+
+evmc::bytes32 SpeculativeState::read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const noexcept {
+    read_keys_.storage.emplace(address, incarnation, location);
+    return state_.read_storage(address, incarnation, location);
+}
+
+void SpeculativeState::update_account(const evmc::address& address, std::optional<silkworm::Account> initial,
+                                      std::optional<silkworm::Account> current) {
+    if (initial == current) {
+        return;
+    }
+    written_keys_.accounts.insert(address);
+    accounts_.insert_or_assign(address, std::make_pair(std::move(initial), std::move(current)));
+}
+
+void SpeculativeState::update_account_code(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& code_hash,
+                                           silkworm::ByteView code) {
+    codes_.try_emplace(code_hash, code);
+}
+
+void SpeculativeState::update_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location,
+                                      const evmc::bytes32& initial, const evmc::bytes32& current) {
+    if (initial == current) {
+        return;
+    }
+    StateKeys::StorageKey storage_key{address, incarnation, location};
+    written_keys_.storage.insert(storage_key);
+    storage_.insert_or_assign(std::move(storage_key), current);
+}
+
+} // namespace silkrpc::state
@@ -0,0 +1,183 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <map>
+#include <optional>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <silkworm/silkrpc/config.hpp> // NOLINT(build/include_order)
+
+#include <evmc/evmc.hpp>
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wattributes"
+#include <silkworm/core/silkworm/execution/evm.hpp>
+#pragma GCC diagnostic pop
+#include <silkworm/common/base.hpp>
+#include <silkworm/state/state.hpp>
+#include <silkworm/types/account.hpp>
+
+#include <silkworm/silkrpc/core/state_checkpoint_cache.hpp>
+
+namespace silkrpc::state {
+
+//! The keys of some state values, i.e. accounts and storage locations
+struct StateKeys {
+    using StorageKey = std::tuple<evmc::address, uint64_t, evmc::bytes32>;
+
+    std::set<evmc::address> accounts;
+    std::set<StorageKey> storage;
+
+    //! Check if any key is also in \p other
+    bool intersects(const StateKeys& other) const;
+
+    //! Add all the keys in \p other
+    void merge(const StateKeys& other);
+};
+
+//! State recording the keys read and the values written by one transaction executed on top of another state, so that the
+//! transactions of a block can be executed speculatively in parallel and then validated in order: an execution is valid
+//! if no previous transaction has written any key it has read. The fee payment to the fee recipient is tracked apart as
+//! balance delta, otherwise any transaction paying fees would conflict with all the previous ones.
+//! It must be used by one execution at a time.
+class SpeculativeState : public silkworm::State {
+public:
+    //! Changes of \p fee_recipient account (if any) made outside of EVM code execution are recorded as balance delta
+    explicit SpeculativeState(silkworm::State& state, std::optional<evmc::address> fee_recipient = std::nullopt)
+        : state_(state), fee_recipient_(std::move(fee_recipient)) {}
+
+    SpeculativeState(const SpeculativeState&) = delete;
+    SpeculativeState& operator=(const SpeculativeState&) = delete;
+
+    //! Mark when EVM code is executing, so that fee recipient reads by code can be told from the fee payment ones
+    void set_executing(bool executing) { executing_ = executing; }
+
+    const StateKeys& read_keys() const { return read_keys_; }
+    const StateKeys& written_keys() const { return written_keys_; }
+
+    //! Add the values written so far to \p changes, applying the fee recipient balance delta on top of its current value
+    void apply_changes(StateCheckpoint& changes) const;
+
+    std::optional<silkworm::Account> read_account(const evmc::address& address) const noexcept override;
+
+    silkworm::ByteView read_code(const evmc::bytes32& code_hash) const noexcept override;
+
+    evmc::bytes32 read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const noexcept override;
+
+    uint64_t previous_incarnation(const evmc::address& address) const noexcept override {
+        return state_.previous_incarnation(address);
+    }
+
+    std::optional<silkworm::BlockHeader> read_header(uint64_t block_number, const evmc::bytes32& block_hash) const noexcept override {
+        return state_.read_header(block_number, block_hash);
+    }
+
+    bool read_body(uint64_t block_number, const evmc::bytes32& block_hash, silkworm::BlockBody& out) const noexcept override {
+        return state_.read_body(block_number, block_hash, out);
+    }
+
+    std::optional<intx::uint256> total_difficulty(uint64_t block_number, const evmc::bytes32& block_hash) const noexcept override {
+        return state_.total_difficulty(block_number, block_hash);
+    }
+
+    evmc::bytes32 state_root_hash() const override { return state_.state_root_hash(); }
+
+    uint64_t current_canonical_block() const override { return state_.current_canonical_block(); }
+
+    std::optional<evmc::bytes32> canonical_hash(uint64_t block_number) const override { return state_.canonical_hash(block_number); }
+
+    void insert_block(const silkworm::Block& block, const evmc::bytes32& hash) override {}
+
+    void canonize_block(uint64_t block_number, const evmc::bytes32& block_hash) override {}
+
+    void decanonize_block(uint64_t block_number) override {}
+
+    void insert_receipts(uint64_t block_number, const std::vector<silkworm::Receipt>& receipts) override {}
+
+    void begin_block(uint64_t block_number) override {}
+
+    void update_account(
+        const evmc::address& address,
+        std::optional<silkworm::Account> initial,
+        std::optional<silkworm::Account> current) override;
+
+    void update_account_code(
+        const evmc::address& address,
+        uint64_t incarnation,
+        const evmc::bytes32& code_hash,
+        silkworm::ByteView code) override;
+
+    void update_storage(
+        const evmc::address& address,
+        uint64_t incarnation,
+        const evmc::bytes32& location,
+        const evmc::bytes32& initial,
+        const evmc::bytes32& current) override;
+
+    void unwind_state_changes(uint64_t block_number) override {}
+
+private:
+    //! Check if fee recipient changes must be applied as balance delta, i.e. its account has not been read by any code
+    bool fee_recipient_delta(const evmc::address& address) const {
+        return fee_recipient_ && *fee_recipient_ == address && !read_keys_.accounts.contains(address);
+    }
+
+    silkworm::State& state_;
+    std::optional<evmc::address> fee_recipient_;
+    bool executing_{false};
+
+    mutable StateKeys read_keys_;
+    StateKeys written_keys_;
+
+    std::map<evmc::address, std::pair<std::optional<silkworm::Account>, std::optional<silkworm::Account>>> accounts_;
+    std::map<StateKeys::StorageKey, evmc::bytes32> storage_;
+    std::map<evmc::bytes32, silkworm::Bytes> codes_;
+};
+
+//! Tracer signalling to \ref SpeculativeState when EVM code is executing
+class SpeculativeStateTracer : public silkworm::EvmTracer {
+public:
+    explicit SpeculativeStateTracer(SpeculativeState& state) : state_(state) {}
+
+    SpeculativeStateTracer(const SpeculativeStateTracer&) = delete;
+    SpeculativeStateTracer& operator=(const SpeculativeStateTracer&) = delete;
+
+    void on_execution_start(evmc_revision rev, const evmc_message& msg, evmone::bytes_view code) noexcept override {
+        if (depth_++ == 0) {
+            state_.set_executing(true);
+        }
+    }
+    void on_instruction_start(uint32_t pc , const intx::uint256 *stack_top, const int stack_height,
+            const evmone::ExecutionState& execution_state, const silkworm::IntraBlockState& intra_block_state) noexcept override {}
+    void on_execution_end(const evmc_result& result, const silkworm::IntraBlockState& intra_block_state) noexcept override {
+        if (--depth_ == 0) {
+            state_.set_executing(false);
+        }
+    }
+    void on_precompiled_run(const evmc_result& result, int64_t gas, const silkworm::IntraBlockState& intra_block_state) noexcept override {}
+    void on_reward_granted(const silkworm::CallResult& result, const silkworm::IntraBlockState& intra_block_state) noexcept override {}
+    void on_creation_completed(const evmc_result& result, const silkworm::IntraBlockState& intra_block_state) noexcept override {}
+
+private:
+    SpeculativeState& state_;
+    int depth_{0};
+};
+
+} // namespace silkrpc::state
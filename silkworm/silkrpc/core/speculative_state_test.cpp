@@ -0,0 +1,173 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "speculative_state.hpp"
+
+#include <optional>
+#include <set>
+
+#include <catch2/catch.hpp>
+#include <evmc/evmc.hpp>
+#include <silkworm/state/in_memory_state.hpp>
+
+namespace silkrpc::state {
+
+using evmc::literals::operator""_address;
+using evmc::literals::operator""_bytes32;
+
+static constexpr auto kTestAddress1{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+static constexpr auto kTestAddress2{0x0f572e5295c57f15886f9b263e2f6d2d6c7b5ec6_address};
+static constexpr auto kFeeRecipient{0x829bd824b016326a401d083b33d092293333a830_address};
+static constexpr auto kTestLocation1{0x0000000000000000000000000000000000000000000000000000000000000001_bytes32};
+static constexpr auto kTestLocation2{0x0000000000000000000000000000000000000000000000000000000000000002_bytes32};
+static constexpr auto kTestValue{0x00000000000000000000000000000000000000000000000000000000000000aa_bytes32};
+
+static silkworm::Account make_account(uint64_t nonce, uint64_t balance) {
+    silkworm::Account account;
+    account.nonce = nonce;
+    account.balance = balance;
+    return account;
+}
+
+TEST_CASE("StateKeys", "[silkrpc][core][speculative_state]") {
+    StateKeys keys1;
+    keys1.accounts.insert(kTestAddress1);
+    keys1.storage.emplace(kTestAddress1, 1, kTestLocation1);
+
+    SECTION("empty keys") {
+        CHECK_FALSE(keys1.intersects(StateKeys{}));
+        CHECK_FALSE(StateKeys{}.intersects(keys1));
+    }
+
+    SECTION("disjoint keys") {
+        StateKeys keys2;
+        keys2.accounts.insert(kTestAddress2);
+        keys2.storage.emplace(kTestAddress1, 1, kTestLocation2);
+        keys2.storage.emplace(kTestAddress1, 2, kTestLocation1);
+        CHECK_FALSE(keys1.intersects(keys2));
+        CHECK_FALSE(keys2.intersects(keys1));
+    }
+
+    SECTION("same account") {
+        StateKeys keys2;
+        keys2.accounts.insert(kTestAddress2);
+        keys2.accounts.insert(kTestAddress1);
+        CHECK(keys1.intersects(keys2));
+        CHECK(keys2.intersects(keys1));
+    }
+
+    SECTION("same storage location") {
+        StateKeys keys2;
+        keys2.storage.emplace(kTestAddress1, 1, kTestLocation1);
+        CHECK(keys1.intersects(keys2));
+    }
+
+    SECTION("merge") {
+        StateKeys keys2;
+        keys2.accounts.insert(kTestAddress2);
+        keys2.merge(keys1);
+        CHECK(keys2.accounts.size() == 2);
+        CHECK(keys2.storage.size() == 1);
+        CHECK(keys2.intersects(keys1));
+    }
+}
+
+TEST_CASE("SpeculativeState::read", "[silkrpc][core][speculative_state]") {
+    silkworm::InMemoryState parent_state;
+    parent_state.update_account(kTestAddress1, std::nullopt, make_account(1, 100));
+    SpeculativeState state{parent_state, kFeeRecipient};
+
+    SECTION("account") {
+        CHECK(state.read_account(kTestAddress1) == make_account(1, 100));
+        CHECK(state.read_account(kTestAddress2) == std::nullopt);
+        CHECK(state.read_keys().accounts == std::set<evmc::address>{kTestAddress1, kTestAddress2});
+    }
+
+    SECTION("storage") {
+        state.read_storage(kTestAddress1, 1, kTestLocation1);
+        CHECK(state.read_keys().storage.size() == 1);
+        CHECK(state.read_keys().storage.contains({kTestAddress1, 1, kTestLocation1}));
+    }
+
+    SECTION("fee recipient read by fee payment") {
+        state.read_account(kFeeRecipient);
+        CHECK(state.read_keys().accounts.empty());
+    }
+
+    SECTION("fee recipient read by code") {
+        state.set_executing(true);
+        state.read_account(kFeeRecipient);
+        state.set_executing(false);
+        CHECK(state.read_keys().accounts.contains(kFeeRecipient));
+    }
+}
+
+TEST_CASE("SpeculativeState::apply_changes", "[silkrpc][core][speculative_state]") {
+    silkworm::InMemoryState parent_state;
+    SpeculativeState state{parent_state, kFeeRecipient};
+    StateCheckpoint changes{0};
+
+    SECTION("unchanged values are skipped") {
+        state.update_account(kTestAddress1, make_account(1, 100), make_account(1, 100));
+        state.update_storage(kTestAddress1, 1, kTestLocation1, kTestValue, kTestValue);
+        CHECK(state.written_keys().accounts.empty());
+        CHECK(state.written_keys().storage.empty());
+        state.apply_changes(changes);
+        CHECK_FALSE(changes.read_account(kTestAddress1));
+        CHECK_FALSE(changes.read_storage(kTestAddress1, 1, kTestLocation1));
+    }
+
+    SECTION("changed values") {
+        state.update_account(kTestAddress1, make_account(1, 100), make_account(2, 90));
+        state.update_account(kTestAddress2, make_account(0, 10), std::nullopt);
+        state.update_storage(kTestAddress1, 1, kTestLocation1, evmc::bytes32{}, kTestValue);
+        CHECK(state.written_keys().accounts == std::set<evmc::address>{kTestAddress1, kTestAddress2});
+        CHECK(state.written_keys().storage.size() == 1);
+        state.apply_changes(changes);
+        CHECK(changes.read_account(kTestAddress1) == std::optional<silkworm::Account>{make_account(2, 90)});
+        const auto deleted_account{changes.read_account(kTestAddress2)};
+        CHECK(deleted_account);
+        CHECK(!*deleted_account);
+        CHECK(changes.read_storage(kTestAddress1, 1, kTestLocation1) == kTestValue);
+    }
+
+    SECTION("fee recipient balance delta") {
+        changes.update_account(kFeeRecipient, make_account(0, 500));
+        state.read_account(kFeeRecipient);
+        state.update_account(kFeeRecipient, make_account(0, 100), make_account(0, 110));
+        CHECK(state.written_keys().accounts.contains(kFeeRecipient));
+        state.apply_changes(changes);
+        CHECK(changes.read_account(kFeeRecipient) == std::optional<silkworm::Account>{make_account(0, 510)});
+    }
+
+    SECTION("fee recipient balance delta on not existing account") {
+        state.update_account(kFeeRecipient, std::nullopt, make_account(0, 10));
+        state.apply_changes(changes);
+        CHECK(changes.read_account(kFeeRecipient) == std::optional<silkworm::Account>{make_account(0, 10)});
+    }
+
+    SECTION("fee recipient read by code is changed as any other account") {
+        changes.update_account(kFeeRecipient, make_account(0, 500));
+        state.set_executing(true);
+        state.read_account(kFeeRecipient);
+        state.set_executing(false);
+        state.update_account(kFeeRecipient, make_account(0, 100), make_account(0, 110));
+        state.apply_changes(changes);
+        CHECK(changes.read_account(kFeeRecipient) == std::optional<silkworm::Account>{make_account(0, 110)});
+    }
+}
+
+} // namespace silkrpc::state
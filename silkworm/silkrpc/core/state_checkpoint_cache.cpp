@@ -0,0 +1,250 @@
+/*
+    Copyright 2022 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "state_checkpoint_cache.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+#include <silkworm/db/util.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/common/util.hpp>
+
+namespace silkrpc::state {
+
+//! Rough per-entry overhead of the node-based containers used to collect the changes
+constexpr std::size_t kEntryOverhead{64};
+
+static silkworm::Bytes storage_key(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) {
+    silkworm::Bytes key{silkworm::db::storage_prefix(full_view(address), incarnation)};
+    key.append(location.bytes, silkworm::kHashLength);
+    return key;
+}
+
+StateCheckpoint::StateCheckpoint(std::shared_ptr<const StateCheckpoint> base, std::size_t transaction_count)
+    : transaction_count_(transaction_count),
+      base_(std::move(base)),
+      base_memory_size_(base_ ? base_->total_memory_size() : 0) {}
+
+std::optional<std::optional<silkworm::Account>> StateCheckpoint::read_account(const evmc::address& address) const {
+    // Walk the chain of checkpoints from the latest one, so that the most recent change wins
+    for (const auto* checkpoint = this; checkpoint != nullptr; checkpoint = checkpoint->base_.get()) {
+        const auto it = checkpoint->accounts_.find(address);
+        if (it != checkpoint->accounts_.end()) {
+            return it->second;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<evmc::bytes32> StateCheckpoint::read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const {
+    const auto key{storage_key(address, incarnation, location)};
+    for (const auto* checkpoint = this; checkpoint != nullptr; checkpoint = checkpoint->base_.get()) {
+        const auto it = checkpoint->storage_.find(key);
+        if (it != checkpoint->storage_.end()) {
+            return it->second;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<silkworm::ByteView> StateCheckpoint::read_code(const evmc::bytes32& code_hash) const {
+    for (const auto* checkpoint = this; checkpoint != nullptr; checkpoint = checkpoint->base_.get()) {
+        const auto it = checkpoint->codes_.find(code_hash);
+        if (it != checkpoint->codes_.end()) {
+            return silkworm::ByteView{it->second};
+        }
+    }
+    return std::nullopt;
+}
+
+void StateCheckpoint::update_account(const evmc::address& address, const std::optional<silkworm::Account>& account) {
+    const auto [it, inserted] = accounts_.insert_or_assign(address, account);
+    if (inserted) {
+        memory_size_ += sizeof(evmc::address) + sizeof(std::optional<silkworm::Account>) + kEntryOverhead;
+    }
+}
+
+void StateCheckpoint::update_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location, const evmc::bytes32& value) {
+    auto key{storage_key(address, incarnation, location)};
+    const auto key_size{key.size()};
+    const auto [it, inserted] = storage_.insert_or_assign(std::move(key), value);
+    if (inserted) {
+        memory_size_ += key_size + sizeof(evmc::bytes32) + kEntryOverhead;
+    }
+}
+
+void StateCheckpoint::update_code(const evmc::bytes32& code_hash, silkworm::ByteView code) {
+    const auto [it, inserted] = codes_.try_emplace(code_hash, code);
+    if (inserted) {
+        memory_size_ += sizeof(evmc::bytes32) + code.size() + kEntryOverhead;
+    }
+}
+
+StateCheckpointCache::StateCheckpointCache(std::size_t memory_budget) : memory_budget_(memory_budget) {
+    if (memory_budget == 0) {
+        throw std::invalid_argument{"unexpected zero memory budget"};
+    }
+}
+
+std::shared_ptr<const StateCheckpoint> StateCheckpointCache::find(const evmc::bytes32& block_hash, std::size_t max_transaction_count) {
+    std::scoped_lock lock{access_};
+
+    // Search the last checkpoint of this block whose transaction count is not greater than the maximum one
+    auto it = checkpoints_.upper_bound({block_hash, max_transaction_count});
+    if (it == checkpoints_.begin() || (--it)->first.first != block_hash) {
+        miss_count_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    hit_count_.fetch_add(1, std::memory_order_relaxed);
+    const auto checkpoint = it->second.checkpoint;
+
+    // Refresh also the earlier checkpoints of this block, so that they are not evicted before the later ones built upon them
+    while (true) {
+        lru_keys_.splice(lru_keys_.begin(), lru_keys_, it->second.lru_position);
+        if (it == checkpoints_.begin() || std::prev(it)->first.first != block_hash) {
+            break;
+        }
+        --it;
+    }
+    return checkpoint;
+}
+
+void StateCheckpointCache::insert(const evmc::bytes32& block_hash, std::shared_ptr<const StateCheckpoint> checkpoint) {
+    if (!checkpoint) {
+        return;
+    }
+    const CheckpointKey key{block_hash, checkpoint->transaction_count()};
+
+    std::scoped_lock lock{access_};
+
+    // The base changes are already accounted for only if the base checkpoint itself is still cached
+    const auto& base = checkpoint->base();
+    const auto base_it = base ? checkpoints_.find({block_hash, base->transaction_count()}) : checkpoints_.end();
+    const bool base_cached{base_it != checkpoints_.end() && base_it->second.checkpoint == base};
+    const auto checkpoint_memory_size{base_cached ? checkpoint->memory_size() : checkpoint->total_memory_size()};
+    if (checkpoint_memory_size > memory_budget_) {
+        return;
+    }
+
+    auto it = checkpoints_.find(key);
+    if (it != checkpoints_.end()) {
+        erase(it);
+    }
+    memory_size_ += checkpoint_memory_size;
+    const auto lru_position = lru_keys_.insert(lru_keys_.begin(), key);
+    checkpoints_.emplace(key, Entry{std::move(checkpoint), checkpoint_memory_size, lru_position});
+
+    while (memory_size_ > memory_budget_) {
+        eviction_count_.fetch_add(erase(checkpoints_.find(lru_keys_.back())), std::memory_order_relaxed);
+    }
+    SILKRPC_DEBUG << "StateCheckpointCache::insert block_hash: " << block_hash << " transaction_count: " << key.second
+                  << " size: " << checkpoints_.size() << " memory_size: " << memory_size_ << "\n";
+}
+
+std::size_t StateCheckpointCache::size() const {
+    std::scoped_lock lock{access_};
+    return checkpoints_.size();
+}
+
+std::size_t StateCheckpointCache::memory_size() const {
+    std::scoped_lock lock{access_};
+    return memory_size_;
+}
+
+std::size_t StateCheckpointCache::erase(CheckpointMap::iterator it) {
+    // Later checkpoints of the same block built upon an erased one are charged just their own changes, so erase them as well
+    const auto block_hash{it->first.first};
+    std::vector<const StateCheckpoint*> erased_checkpoints;
+    do {
+        if (erased_checkpoints.empty() || std::find(erased_checkpoints.cbegin(), erased_checkpoints.cend(), it->second.checkpoint->base().get()) != erased_checkpoints.cend()) {
+            erased_checkpoints.push_back(it->second.checkpoint.get());
+            memory_size_ -= it->second.memory_size;
+            lru_keys_.erase(it->second.lru_position);
+            it = checkpoints_.erase(it);
+        } else {
+            ++it;
+        }
+    } while (it != checkpoints_.end() && it->first.first == block_hash);
+    return erased_checkpoints.size();
+}
+
+std::shared_ptr<StateCheckpoint> CheckpointState::start_recording(std::size_t transaction_count) {
+    recording_ = std::make_shared<StateCheckpoint>(latest_, transaction_count);
+    return recording_;
+}
+
+void CheckpointState::stop_recording() {
+    if (recording_) {
+        latest_ = std::move(recording_);
+    }
+}
+
+std::optional<silkworm::Account> CheckpointState::read_account(const evmc::address& address) const noexcept {
+    if (base_) {
+        const auto changed_account{base_->read_account(address)};
+        if (changed_account) {
+            return *changed_account;
+        }
+    }
+    return state_.read_account(address);
+}
+
+silkworm::ByteView CheckpointState::read_code(const evmc::bytes32& code_hash) const noexcept {
+    if (base_) {
+        const auto changed_code{base_->read_code(code_hash)};
+        if (changed_code) {
+            return *changed_code;
+        }
+    }
+    return state_.read_code(code_hash);
+}
+
+evmc::bytes32 CheckpointState::read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const noexcept {
+    if (base_) {
+        const auto changed_value{base_->read_storage(address, incarnation, location)};
+        if (changed_value) {
+            return *changed_value;
+        }
+    }
+    return state_.read_storage(address, incarnation, location);
+}
+
+void CheckpointState::update_account(const evmc::address& address, std::optional<silkworm::Account> initial,
+                                     std::optional<silkworm::Account> current) {
+    // The intra-block state flushes all the changes since the base checkpoint, record just the ones since the latest
+    if (recording_ && recording_->read_account(address) != std::optional<std::optional<silkworm::Account>>{current}) {
+        recording_->update_account(address, current);
+    }
+}
+
+void CheckpointState::update_account_code(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& code_hash,
+                                          silkworm::ByteView code) {
+    if (recording_ && !recording_->read_code(code_hash)) {
+        recording_->update_code(code_hash, code);
+    }
+}
+
+void CheckpointState::update_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location,
+                                     const evmc::bytes32& initial, const evmc::bytes32& current) {
+    if (recording_ && recording_->read_storage(address, incarnation, location) != current) {
+        recording_->update_storage(address, incarnation, location, current);
+    }
+}
+
+} // namespace silkrpc::state
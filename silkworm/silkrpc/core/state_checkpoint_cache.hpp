@@ -0,0 +1,216 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <silkworm/silkrpc/config.hpp>
+
+#include <evmc/evmc.hpp>
+#include <silkworm/common/base.hpp>
+#include <silkworm/state/state.hpp>
+#include <silkworm/types/account.hpp>
+
+namespace silkrpc::state {
+
+constexpr std::size_t kDefaultCheckpointMemoryBudget{256 * 1024 * 1024};
+
+//! Number of replayed transactions between two consecutive checkpoints of the same block
+constexpr std::size_t kCheckpointInterval{32};
+
+//! State changes applied by the first transactions of a block on top of the state at the end of the parent block.
+//! A checkpoint is immutable once completed, so it can be shared among concurrent executions of the same block.
+//! Each checkpoint collects just the changes on top of its base checkpoint (if any), so consecutive checkpoints
+//! of the same block share the earlier changes instead of copying them.
+class StateCheckpoint {
+public:
+    explicit StateCheckpoint(std::size_t transaction_count) : transaction_count_(transaction_count) {}
+
+    //! Create a new checkpoint collecting the changes on top of the ones collected by \p base
+    explicit StateCheckpoint(std::shared_ptr<const StateCheckpoint> base, std::size_t transaction_count);
+
+    StateCheckpoint& operator=(const StateCheckpoint&) = delete;
+
+    //! The number of transactions whose state changes are collected by this checkpoint
+    std::size_t transaction_count() const { return transaction_count_; }
+
+    //! The checkpoint whose changes this one is built upon, if any
+    const std::shared_ptr<const StateCheckpoint>& base() const { return base_; }
+
+    //! Return the changed account, if any: a changed empty value means that the account has been deleted
+    std::optional<std::optional<silkworm::Account>> read_account(const evmc::address& address) const;
+    std::optional<evmc::bytes32> read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const;
+    std::optional<silkworm::ByteView> read_code(const evmc::bytes32& code_hash) const;
+
+    void update_account(const evmc::address& address, const std::optional<silkworm::Account>& account);
+    void update_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location, const evmc::bytes32& value);
+    void update_code(const evmc::bytes32& code_hash, silkworm::ByteView code);
+
+    //! The approximate amount of memory used by the changes collected by this checkpoint, excluding the base ones
+    std::size_t memory_size() const { return memory_size_; }
+
+    //! The approximate amount of memory kept alive by this checkpoint, including the base ones
+    std::size_t total_memory_size() const { return memory_size_ + base_memory_size_; }
+
+private:
+    std::size_t transaction_count_;
+    std::shared_ptr<const StateCheckpoint> base_;
+    std::size_t base_memory_size_{0};
+    std::unordered_map<evmc::address, std::optional<silkworm::Account>> accounts_;
+    std::map<silkworm::Bytes, evmc::bytes32> storage_;
+    std::unordered_map<evmc::bytes32, silkworm::Bytes> codes_;
+    std::size_t memory_size_{0};
+};
+
+//! Cache of the checkpoints taken while replaying block transactions, evicted in LRU order to stay within a memory budget.
+//! Checkpoints are keyed by block hash, so any checkpoint of blocks removed by a reorg is just never used again.
+//! A checkpoint whose base is cached is charged just its own changes, so evicting a checkpoint evicts also the later
+//! ones built upon it and finding a checkpoint refreshes also the earlier ones of the same block.
+class StateCheckpointCache {
+public:
+    explicit StateCheckpointCache(std::size_t memory_budget = kDefaultCheckpointMemoryBudget);
+
+    StateCheckpointCache(const StateCheckpointCache&) = delete;
+    StateCheckpointCache& operator=(const StateCheckpointCache&) = delete;
+
+    //! Return the checkpoint of \p block_hash having the highest transaction count up to \p max_transaction_count, if any
+    std::shared_ptr<const StateCheckpoint> find(const evmc::bytes32& block_hash, std::size_t max_transaction_count);
+
+    //! Insert the \p checkpoint of \p block_hash, possibly evicting the least recently used ones
+    void insert(const evmc::bytes32& block_hash, std::shared_ptr<const StateCheckpoint> checkpoint);
+
+    std::size_t size() const;
+    std::size_t memory_size() const;
+
+    uint64_t hit_count() const { return hit_count_.load(std::memory_order_relaxed); }
+    uint64_t miss_count() const { return miss_count_.load(std::memory_order_relaxed); }
+    uint64_t eviction_count() const { return eviction_count_.load(std::memory_order_relaxed); }
+
+private:
+    using CheckpointKey = std::pair<evmc::bytes32, std::size_t>;
+
+    struct Entry {
+        std::shared_ptr<const StateCheckpoint> checkpoint;
+        std::size_t memory_size;
+        std::list<CheckpointKey>::iterator lru_position;
+    };
+
+    using CheckpointMap = std::map<CheckpointKey, Entry>;
+
+    //! Erase the checkpoint pointed by \p it along with the later ones built upon it, returning how many were erased
+    std::size_t erase(CheckpointMap::iterator it);
+
+    std::size_t memory_budget_;
+    mutable std::mutex access_;
+    CheckpointMap checkpoints_;
+    std::list<CheckpointKey> lru_keys_;
+    std::size_t memory_size_{0};
+
+    std::atomic_uint64_t hit_count_{0};
+    std::atomic_uint64_t miss_count_{0};
+    std::atomic_uint64_t eviction_count_{0};
+};
+
+//! State reading the changes collected by a base checkpoint (if any) on top of another state. Changes flushed by the
+//! intra-block state are collected into the current recording checkpoint (if any), so that a new checkpoint can be taken.
+//! Each recorded checkpoint is built upon the previous one and collects only the values changed since then.
+class CheckpointState : public silkworm::State {
+public:
+    explicit CheckpointState(silkworm::State& state, std::shared_ptr<const StateCheckpoint> base = nullptr)
+        : state_(state), base_(std::move(base)), latest_(base_) {}
+
+    //! Start collecting the flushed changes into a new checkpoint built upon the latest recorded (or base) checkpoint
+    std::shared_ptr<StateCheckpoint> start_recording(std::size_t transaction_count);
+
+    //! Stop collecting the flushed changes, so that the next recorded checkpoint is built upon the current one
+    void stop_recording();
+
+    std::optional<silkworm::Account> read_account(const evmc::address& address) const noexcept override;
+
+    silkworm::ByteView read_code(const evmc::bytes32& code_hash) const noexcept override;
+
+    evmc::bytes32 read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const noexcept override;
+
+    uint64_t previous_incarnation(const evmc::address& address) const noexcept override {
+        return state_.previous_incarnation(address);
+    }
+
+    std::optional<silkworm::BlockHeader> read_header(uint64_t block_number, const evmc::bytes32& block_hash) const noexcept override {
+        return state_.read_header(block_number, block_hash);
+    }
+
+    bool read_body(uint64_t block_number, const evmc::bytes32& block_hash, silkworm::BlockBody& out) const noexcept override {
+        return state_.read_body(block_number, block_hash, out);
+    }
+
+    std::optional<intx::uint256> total_difficulty(uint64_t block_number, const evmc::bytes32& block_hash) const noexcept override {
+        return state_.total_difficulty(block_number, block_hash);
+    }
+
+    evmc::bytes32 state_root_hash() const override { return state_.state_root_hash(); }
+
+    uint64_t current_canonical_block() const override { return state_.current_canonical_block(); }
+
+    std::optional<evmc::bytes32> canonical_hash(uint64_t block_number) const override { return state_.canonical_hash(block_number); }
+
+    void insert_block(const silkworm::Block& block, const evmc::bytes32& hash) override {}
+
+    void canonize_block(uint64_t block_number, const evmc::bytes32& block_hash) override {}
+
+    void decanonize_block(uint64_t block_number) override {}
+
+    void insert_receipts(uint64_t block_number, const std::vector<silkworm::Receipt>& receipts) override {}
+
+    void begin_block(uint64_t block_number) override {}
+
+    void update_account(
+        const evmc::address& address,
+        std::optional<silkworm::Account> initial,
+        std::optional<silkworm::Account> current) override;
+
+    void update_account_code(
+        const evmc::address& address,
+        uint64_t incarnation,
+        const evmc::bytes32& code_hash,
+        silkworm::ByteView code) override;
+
+    void update_storage(
+        const evmc::address& address,
+        uint64_t incarnation,
+        const evmc::bytes32& location,
+        const evmc::bytes32& initial,
+        const evmc::bytes32& current) override;
+
+    void unwind_state_changes(uint64_t block_number) override {}
+
+private:
+    silkworm::State& state_;
+    std::shared_ptr<const StateCheckpoint> base_;
+    std::shared_ptr<const StateCheckpoint> latest_;
+    std::shared_ptr<StateCheckpoint> recording_;
+};
+
+} // namespace silkrpc::state
@@ -0,0 +1,247 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "state_checkpoint_cache.hpp"
+
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+#include <evmc/evmc.hpp>
+#include <silkworm/common/util.hpp>
+#include <silkworm/state/in_memory_state.hpp>
+
+namespace silkrpc::state {
+
+using Catch::Matchers::Message;
+using evmc::literals::operator""_address;
+using evmc::literals::operator""_bytes32;
+
+static constexpr auto kTestAddress{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+static constexpr auto kTestLocation{0x0000000000000000000000000000000000000000000000000000000000000001_bytes32};
+static constexpr auto kTestValue1{0x00000000000000000000000000000000000000000000000000000000000000aa_bytes32};
+static constexpr auto kTestValue2{0x00000000000000000000000000000000000000000000000000000000000000bb_bytes32};
+static constexpr auto kTestBlockHash1{0x3ccc7d2e6c6ed0d0e4c1c1b5bbfe0a1a7b3a58e2fcd7a4b0c1b9d1fe62e13ee2_bytes32};
+static constexpr auto kTestBlockHash2{0x8e38b4dbf6b11fcc3b9dee84fb7986e29ca0a02cecd8977c161ff7333329681e_bytes32};
+
+TEST_CASE("StateCheckpoint", "[silkrpc][core][state_checkpoint_cache]") {
+    StateCheckpoint checkpoint{10};
+    CHECK(checkpoint.transaction_count() == 10);
+    CHECK(checkpoint.memory_size() == 0);
+
+    SECTION("account") {
+        CHECK(!checkpoint.read_account(kTestAddress));
+        silkworm::Account account;
+        account.nonce = 3;
+        checkpoint.update_account(kTestAddress, account);
+        CHECK(checkpoint.read_account(kTestAddress) == std::optional<silkworm::Account>{account});
+        checkpoint.update_account(kTestAddress, std::nullopt);
+        const auto deleted_account{checkpoint.read_account(kTestAddress)};
+        CHECK(deleted_account);
+        CHECK(!*deleted_account);
+        CHECK(checkpoint.memory_size() > 0);
+    }
+
+    SECTION("storage") {
+        CHECK(!checkpoint.read_storage(kTestAddress, 1, kTestLocation));
+        checkpoint.update_storage(kTestAddress, 1, kTestLocation, kTestValue1);
+        CHECK(checkpoint.read_storage(kTestAddress, 1, kTestLocation) == kTestValue1);
+        CHECK(!checkpoint.read_storage(kTestAddress, 2, kTestLocation));
+    }
+
+    SECTION("code") {
+        const silkworm::Bytes code{*silkworm::from_hex("0x0608")};
+        const auto code_hash{0x04491edcd115127caedbd478e2e7895ed80c7847e903431f94f9cfa579cad47f_bytes32};
+        CHECK(!checkpoint.read_code(code_hash));
+        checkpoint.update_code(code_hash, code);
+        CHECK(checkpoint.read_code(code_hash) == silkworm::ByteView{code});
+    }
+
+    SECTION("chain to base") {
+        auto base = std::make_shared<StateCheckpoint>(10);
+        base->update_storage(kTestAddress, 1, kTestLocation, kTestValue1);
+        base->update_storage(kTestAddress, 2, kTestLocation, kTestValue1);
+        StateCheckpoint next_checkpoint{base, 20};
+        CHECK(next_checkpoint.base() == base);
+        CHECK(next_checkpoint.memory_size() == 0);
+        CHECK(next_checkpoint.total_memory_size() == base->memory_size());
+        next_checkpoint.update_storage(kTestAddress, 1, kTestLocation, kTestValue2);
+        CHECK(next_checkpoint.transaction_count() == 20);
+        CHECK(next_checkpoint.memory_size() > 0);
+        CHECK(next_checkpoint.total_memory_size() == base->memory_size() + next_checkpoint.memory_size());
+        CHECK(next_checkpoint.read_storage(kTestAddress, 1, kTestLocation) == kTestValue2);
+        CHECK(next_checkpoint.read_storage(kTestAddress, 2, kTestLocation) == kTestValue1);
+        CHECK(base->read_storage(kTestAddress, 1, kTestLocation) == kTestValue1);
+    }
+}
+
+TEST_CASE("StateCheckpointCache", "[silkrpc][core][state_checkpoint_cache]") {
+    SECTION("reject zero memory budget") {
+        CHECK_THROWS_MATCHES(StateCheckpointCache{0}, std::invalid_argument, Message("unexpected zero memory budget"));
+    }
+
+    SECTION("find nearest checkpoint") {
+        StateCheckpointCache cache;
+        auto checkpoint1 = std::make_shared<StateCheckpoint>(32);
+        auto checkpoint2 = std::make_shared<StateCheckpoint>(64);
+        cache.insert(kTestBlockHash1, checkpoint1);
+        cache.insert(kTestBlockHash1, checkpoint2);
+        CHECK(cache.size() == 2);
+        CHECK(cache.find(kTestBlockHash1, 10) == nullptr);
+        CHECK(cache.find(kTestBlockHash1, 32) == checkpoint1);
+        CHECK(cache.find(kTestBlockHash1, 63) == checkpoint1);
+        CHECK(cache.find(kTestBlockHash1, 64) == checkpoint2);
+        CHECK(cache.find(kTestBlockHash1, 300) == checkpoint2);
+        CHECK(cache.find(kTestBlockHash2, 300) == nullptr);
+        CHECK(cache.hit_count() == 4);
+        CHECK(cache.miss_count() == 2);
+    }
+
+    SECTION("evict least recently used checkpoint") {
+        auto checkpoint1 = std::make_shared<StateCheckpoint>(32);
+        checkpoint1->update_storage(kTestAddress, 1, kTestLocation, kTestValue1);
+        auto checkpoint2 = std::make_shared<StateCheckpoint>(32);
+        checkpoint2->update_storage(kTestAddress, 1, kTestLocation, kTestValue2);
+        StateCheckpointCache cache{checkpoint1->memory_size() + checkpoint2->memory_size() - 1};
+        cache.insert(kTestBlockHash1, checkpoint1);
+        cache.insert(kTestBlockHash2, checkpoint2);
+        CHECK(cache.size() == 1);
+        CHECK(cache.eviction_count() == 1);
+        CHECK(cache.memory_size() == checkpoint2->memory_size());
+        CHECK(cache.find(kTestBlockHash1, 32) == nullptr);
+        CHECK(cache.find(kTestBlockHash2, 32) == checkpoint2);
+    }
+
+    SECTION("charge chained checkpoint its own changes if base is cached") {
+        auto checkpoint1 = std::make_shared<StateCheckpoint>(32);
+        checkpoint1->update_storage(kTestAddress, 1, kTestLocation, kTestValue1);
+        auto checkpoint2 = std::make_shared<StateCheckpoint>(checkpoint1, 64);
+        checkpoint2->update_storage(kTestAddress, 2, kTestLocation, kTestValue2);
+        StateCheckpointCache cache;
+        cache.insert(kTestBlockHash1, checkpoint2);
+        CHECK(cache.memory_size() == checkpoint2->total_memory_size());
+        cache.insert(kTestBlockHash1, checkpoint1);
+        cache.insert(kTestBlockHash1, checkpoint2);
+        CHECK(cache.size() == 2);
+        CHECK(cache.memory_size() == checkpoint1->memory_size() + checkpoint2->memory_size());
+    }
+
+    SECTION("evict later checkpoints built upon evicted one") {
+        auto checkpoint1 = std::make_shared<StateCheckpoint>(32);
+        checkpoint1->update_storage(kTestAddress, 1, kTestLocation, kTestValue1);
+        auto checkpoint2 = std::make_shared<StateCheckpoint>(checkpoint1, 64);
+        checkpoint2->update_storage(kTestAddress, 2, kTestLocation, kTestValue2);
+        auto checkpoint3 = std::make_shared<StateCheckpoint>(32);
+        checkpoint3->update_storage(kTestAddress, 3, kTestLocation, kTestValue2);
+        StateCheckpointCache cache{checkpoint1->memory_size() + checkpoint2->memory_size() + checkpoint3->memory_size() - 1};
+        cache.insert(kTestBlockHash1, checkpoint1);
+        cache.insert(kTestBlockHash1, checkpoint2);
+        cache.insert(kTestBlockHash2, checkpoint3);
+        CHECK(cache.size() == 1);
+        CHECK(cache.eviction_count() == 2);
+        CHECK(cache.memory_size() == checkpoint3->memory_size());
+        CHECK(cache.find(kTestBlockHash1, 64) == nullptr);
+    }
+
+    SECTION("refresh earlier checkpoints of same block on find") {
+        auto checkpoint1 = std::make_shared<StateCheckpoint>(32);
+        checkpoint1->update_storage(kTestAddress, 1, kTestLocation, kTestValue1);
+        auto checkpoint2 = std::make_shared<StateCheckpoint>(checkpoint1, 64);
+        checkpoint2->update_storage(kTestAddress, 2, kTestLocation, kTestValue2);
+        auto checkpoint3 = std::make_shared<StateCheckpoint>(32);
+        checkpoint3->update_storage(kTestAddress, 3, kTestLocation, kTestValue2);
+        auto checkpoint4 = std::make_shared<StateCheckpoint>(64);
+        checkpoint4->update_storage(kTestAddress, 4, kTestLocation, kTestValue2);
+        StateCheckpointCache cache{checkpoint1->memory_size() + checkpoint2->memory_size() + checkpoint3->memory_size()};
+        cache.insert(kTestBlockHash1, checkpoint1);
+        cache.insert(kTestBlockHash2, checkpoint3);
+        cache.insert(kTestBlockHash1, checkpoint2);
+        CHECK(cache.find(kTestBlockHash1, 64) == checkpoint2);
+        cache.insert(kTestBlockHash2, checkpoint4);
+        CHECK(cache.find(kTestBlockHash1, 64) == checkpoint2);
+        CHECK(cache.find(kTestBlockHash2, 32) == nullptr);
+        CHECK(cache.find(kTestBlockHash2, 64) == checkpoint4);
+    }
+
+    SECTION("skip checkpoint exceeding memory budget") {
+        auto checkpoint = std::make_shared<StateCheckpoint>(32);
+        checkpoint->update_storage(kTestAddress, 1, kTestLocation, kTestValue1);
+        StateCheckpointCache cache{checkpoint->memory_size() - 1};
+        cache.insert(kTestBlockHash1, checkpoint);
+        CHECK(cache.size() == 0);
+    }
+}
+
+TEST_CASE("CheckpointState", "[silkrpc][core][state_checkpoint_cache]") {
+    silkworm::InMemoryState state;
+    silkworm::Account account;
+    account.nonce = 1;
+    account.incarnation = 1;
+    state.update_account(kTestAddress, std::nullopt, account);
+    state.update_storage(kTestAddress, 1, kTestLocation, {}, kTestValue1);
+
+    SECTION("read through without base checkpoint") {
+        CheckpointState checkpoint_state{state};
+        CHECK(checkpoint_state.read_account(kTestAddress) == std::optional<silkworm::Account>{account});
+        CHECK(checkpoint_state.read_storage(kTestAddress, 1, kTestLocation) == kTestValue1);
+    }
+
+    SECTION("read base checkpoint first") {
+        auto base = std::make_shared<StateCheckpoint>(5);
+        silkworm::Account changed_account{account};
+        changed_account.nonce = 2;
+        base->update_account(kTestAddress, changed_account);
+        base->update_storage(kTestAddress, 1, kTestLocation, kTestValue2);
+        CheckpointState checkpoint_state{state, base};
+        CHECK(checkpoint_state.read_account(kTestAddress) == std::optional<silkworm::Account>{changed_account});
+        CHECK(checkpoint_state.read_storage(kTestAddress, 1, kTestLocation) == kTestValue2);
+    }
+
+    SECTION("record changes only while recording") {
+        auto base = std::make_shared<StateCheckpoint>(5);
+        base->update_storage(kTestAddress, 1, kTestLocation, kTestValue2);
+        CheckpointState checkpoint_state{state, base};
+        checkpoint_state.update_storage(kTestAddress, 1, kTestLocation, kTestValue2, kTestValue1);
+        auto checkpoint = checkpoint_state.start_recording(7);
+        CHECK(checkpoint->transaction_count() == 7);
+        CHECK(checkpoint->read_storage(kTestAddress, 1, kTestLocation) == kTestValue2);
+        silkworm::Account changed_account{account};
+        changed_account.nonce = 3;
+        checkpoint_state.update_account(kTestAddress, account, changed_account);
+        checkpoint_state.stop_recording();
+        checkpoint_state.update_account(kTestAddress, changed_account, std::nullopt);
+        CHECK(checkpoint->read_account(kTestAddress) == std::optional<silkworm::Account>{changed_account});
+        CHECK(!base->read_account(kTestAddress));
+    }
+
+    SECTION("record only changes since latest checkpoint") {
+        auto base = std::make_shared<StateCheckpoint>(5);
+        CheckpointState checkpoint_state{state, base};
+        auto checkpoint1 = checkpoint_state.start_recording(7);
+        checkpoint_state.update_storage(kTestAddress, 1, kTestLocation, kTestValue1, kTestValue2);
+        checkpoint_state.stop_recording();
+        CHECK(checkpoint1->base() == base);
+        CHECK(checkpoint1->memory_size() > 0);
+        auto checkpoint2 = checkpoint_state.start_recording(9);
+        checkpoint_state.update_storage(kTestAddress, 1, kTestLocation, kTestValue1, kTestValue2);
+        checkpoint_state.stop_recording();
+        CHECK(checkpoint2->base() == checkpoint1);
+        CHECK(checkpoint2->memory_size() == 0);
+        CHECK(checkpoint2->read_storage(kTestAddress, 1, kTestLocation) == kTestValue2);
+        CHECK(checkpoint_state.read_storage(kTestAddress, 1, kTestLocation) == kTestValue1);
+    }
+}
+
+} // namespace silkrpc::state
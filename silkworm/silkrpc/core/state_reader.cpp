@@ -82,29 +82,20 @@ boost::asio::awaitable<std::optional<silkworm::Bytes>> StateReader::read_code(co
 boost::asio::awaitable<std::optional<silkworm::Bytes>> StateReader::read_historical_account(const evmc::address& address, uint64_t block_number) const {
     const auto account_history_key{silkworm::db::account_history_key(address, block_number)};
     SILKRPC_DEBUG << "StateReader::read_historical_account account_history_key: " << account_history_key << "\n";
-    const auto kv_pair{co_await db_reader_.get(db::table::kAccountHistory, account_history_key)};
-
-    SILKRPC_DEBUG << "StateReader::read_historical_account kv_pair.key: " << silkworm::to_hex(kv_pair.key) << "\n";
-    const auto address_view{full_view(address)};
-    if (kv_pair.key.substr(0, silkworm::kAddressLength) != address_view) {
-        co_return std::nullopt;
-    }
-
-    SILKRPC_DEBUG << "StateReader::read_historical_account kv_pair.value: " << silkworm::to_hex(kv_pair.value) << "\n";
-    if (kv_pair.value.empty()) {
+    const auto bitmap{co_await read_history_chunk(db::table::kAccountHistory, account_history_key)};
+    if (!bitmap) {
         co_return std::nullopt;
     }
-    const auto bitmap{silkworm::db::bitmap::parse(kv_pair.value)};
-    SILKRPC_DEBUG << "StateReader::read_historical_account bitmap: " << bitmap.toString() << "\n";
+    SILKRPC_DEBUG << "StateReader::read_historical_account bitmap: " << bitmap->toString() << "\n";
 
-    const auto change_block{silkworm::db::bitmap::seek(bitmap, block_number)};
+    const auto change_block{silkworm::db::bitmap::seek(*bitmap, block_number)};
     if (!change_block) {
         co_return std::nullopt;
     }
 
     const auto block_key{silkworm::db::block_key(*change_block)};
     SILKRPC_DEBUG << "StateReader::read_historical_account block_key: " << block_key << "\n";
-    const auto address_subkey{address_view};
+    const auto address_subkey{full_view(address)};
     SILKRPC_DEBUG << "StateReader::read_historical_account address_subkey: " << address_subkey << "\n";
     const auto value{co_await db_reader_.get_both_range(db::table::kPlainAccountChangeSet, block_key, address_subkey)};
     SILKRPC_DEBUG << "StateReader::read_historical_account value: " << (value ? *value : silkworm::Bytes{}) << "\n";
@@ -116,29 +107,58 @@ boost::asio::awaitable<std::optional<silkworm::Bytes>> StateReader::read_histori
     const evmc::bytes32& location_hash, uint64_t block_number) const {
     const auto storage_history_key{silkworm::db::storage_history_key(address, location_hash, block_number)};
     SILKRPC_DEBUG << "StateReader::read_historical_storage storage_history_key: " << storage_history_key << "\n";
-    const auto kv_pair{co_await db_reader_.get(db::table::kStorageHistory, storage_history_key)};
-
-    const auto location_hash_view{full_view(location_hash)};
-    if (kv_pair.key.substr(0, silkworm::kAddressLength) != full_view(address) ||
-        kv_pair.key.substr(silkworm::kAddressLength, silkworm::kHashLength) != location_hash_view) {
+    const auto bitmap{co_await read_history_chunk(db::table::kStorageHistory, storage_history_key)};
+    if (!bitmap) {
         co_return std::nullopt;
     }
+    SILKRPC_DEBUG << "StateReader::read_historical_storage bitmap: " << bitmap->toString() << "\n";
 
-    const auto bitmap{silkworm::db::bitmap::parse(kv_pair.value)};
-    SILKRPC_DEBUG << "StateReader::read_historical_storage bitmap: " << bitmap.toString() << "\n";
-
-    const auto change_block{silkworm::db::bitmap::seek(bitmap, block_number)};
+    const auto change_block{silkworm::db::bitmap::seek(*bitmap, block_number)};
     if (!change_block) {
         co_return std::nullopt;
     }
 
     const auto storage_change_key{silkworm::db::storage_change_key(*change_block, address, incarnation)};
     SILKRPC_DEBUG << "StateReader::read_historical_storage storage_change_key: " << storage_change_key << "\n";
-    const auto location_subkey{location_hash_view};
+    const auto location_subkey{full_view(location_hash)};
     SILKRPC_DEBUG << "StateReader::read_historical_storage location_subkey: " << location_subkey << "\n";
     const auto value{co_await db_reader_.get_both_range(db::table::kPlainStorageChangeSet, storage_change_key, location_subkey)};
     SILKRPC_DEBUG << "StateReader::read_historical_storage value: " << (value ? *value : silkworm::Bytes{}) << "\n";
 
     co_return value;
 }
+
+boost::asio::awaitable<std::shared_ptr<const ethdb::HistoryCache::Bitmap>> StateReader::read_history_chunk(const std::string& table,
+    const silkworm::Bytes& history_key) const {
+    uint64_t read_generation{0};
+    if (history_cache_ != nullptr) {
+        auto cached_bitmap{history_cache_->find(history_key)};
+        if (cached_bitmap) {
+            co_return cached_bitmap;
+        }
+        read_generation = history_cache_->generation();
+    }
+
+    const auto kv_pair{co_await db_reader_.get(table, history_key)};
+    SILKRPC_DEBUG << "StateReader::read_history_chunk table: " << table << " kv_pair.key: " << silkworm::to_hex(kv_pair.key) << "\n";
+
+    // History key is made of address [+ location hash] plus block number: the chunk must share the same prefix
+    const auto prefix_length{history_key.size() - sizeof(uint64_t)};
+    if (kv_pair.key.substr(0, prefix_length) != history_key.substr(0, prefix_length)) {
+        co_return nullptr;
+    }
+
+    SILKRPC_DEBUG << "StateReader::read_history_chunk kv_pair.value: " << silkworm::to_hex(kv_pair.value) << "\n";
+    if (kv_pair.value.empty()) {
+        co_return nullptr;
+    }
+    auto bitmap{std::make_shared<const ethdb::HistoryCache::Bitmap>(silkworm::db::bitmap::parse(kv_pair.value))};
+
+    if (history_cache_ != nullptr && kv_pair.key.size() == history_key.size()) {
+        history_cache_->insert(kv_pair.key, bitmap, read_generation);
+    }
+
+    co_return bitmap;
+}
+
 } // namespace silkrpc
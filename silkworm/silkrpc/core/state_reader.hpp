@@ -16,7 +16,9 @@
 
 #pragma once
 
+#include <memory>
 #include <optional>
+#include <string>
 
 #include <silkworm/silkrpc/config.hpp>
 
@@ -27,12 +29,14 @@
 
 #include <silkworm/silkrpc/common/util.hpp>
 #include <silkworm/silkrpc/core/rawdb/accessors.hpp>
+#include <silkworm/silkrpc/ethdb/history_cache.hpp>
 
 namespace silkrpc {
 
 class StateReader {
 public:
-    explicit StateReader(const core::rawdb::DatabaseReader& db_reader) : db_reader_(db_reader) {}
+    explicit StateReader(const core::rawdb::DatabaseReader& db_reader, ethdb::HistoryCache* history_cache = nullptr)
+        : db_reader_(db_reader), history_cache_(history_cache) {}
 
     StateReader(const StateReader&) = delete;
     StateReader& operator=(const StateReader&) = delete;
@@ -50,7 +54,11 @@ public:
         const evmc::bytes32& location_hash, uint64_t block_number) const;
 
 private:
+    boost::asio::awaitable<std::shared_ptr<const ethdb::HistoryCache::Bitmap>> read_history_chunk(const std::string& table,
+        const silkworm::Bytes& history_key) const;
+
     const core::rawdb::DatabaseReader& db_reader_;
+    ethdb::HistoryCache* history_cache_;
 };
 
 } // namespace silkrpc
@@ -16,6 +16,8 @@
 
 #include "state_reader.hpp"
 
+#include <limits>
+
 #include <silkworm/silkrpc/config.hpp>
 #include <boost/asio/awaitable.hpp>
 #include <catch2/catch.hpp>
@@ -215,6 +217,65 @@ TEST_CASE_METHOD(StateReaderTest, "StateReader::read_storage") {
     }
 }
 
+TEST_CASE_METHOD(StateReaderTest, "StateReader::read_storage with history cache") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    ethdb::HistoryCache history_cache;
+    StateReader state_reader{database_reader_, &history_cache};
+    constexpr uint64_t kHistoricalBlockNumber{5'000'000};
+
+    SECTION("storage history chunk parsed just once") {
+        // Set the call expectations:
+        // 1. DatabaseReader::get call on kStorageHistory returns the open storage bitmap chunk just once
+        EXPECT_CALL(database_reader_, get(db::table::kStorageHistory, _)).WillOnce(InvokeWithoutArgs(
+            []() -> boost::asio::awaitable<KeyValue> {
+                co_return KeyValue{
+                    silkworm::db::storage_history_key(kZeroAddress, kLocationHash, std::numeric_limits<uint64_t>::max()),
+                    kEncodedStorageHistory
+                };
+            }
+        ));
+        // 2. DatabaseReader::get_both_range call on kPlainStorageChangeSet returns the storage location value each time
+        EXPECT_CALL(database_reader_, get_both_range(db::table::kPlainStorageChangeSet, _, _)).Times(2).WillRepeatedly(InvokeWithoutArgs(
+            []() -> boost::asio::awaitable<std::optional<silkworm::Bytes>> { co_return kStorageLocation; }
+        ));
+
+        // Execute the test: calling read_storage twice should return expected storage location using cached chunk
+        evmc::bytes32 location;
+        CHECK_NOTHROW(location = spawn_and_wait(state_reader.read_storage(kZeroAddress, 0, kLocationHash, kHistoricalBlockNumber)));
+        CHECK(location == silkworm::to_bytes32(kStorageLocation));
+        CHECK_NOTHROW(location = spawn_and_wait(state_reader.read_storage(kZeroAddress, 0, kLocationHash, kHistoricalBlockNumber)));
+        CHECK(location == silkworm::to_bytes32(kStorageLocation));
+        CHECK(history_cache.size() == 1);
+        CHECK(history_cache.hit_count() == 1);
+    }
+
+    SECTION("open storage history chunk read again after new block") {
+        // Set the call expectations:
+        // 1. DatabaseReader::get call on kStorageHistory returns the open storage bitmap chunk each time
+        EXPECT_CALL(database_reader_, get(db::table::kStorageHistory, _)).Times(2).WillRepeatedly(InvokeWithoutArgs(
+            []() -> boost::asio::awaitable<KeyValue> {
+                co_return KeyValue{
+                    silkworm::db::storage_history_key(kZeroAddress, kLocationHash, std::numeric_limits<uint64_t>::max()),
+                    kEncodedStorageHistory
+                };
+            }
+        ));
+        // 2. DatabaseReader::get_both_range call on kPlainStorageChangeSet returns the storage location value each time
+        EXPECT_CALL(database_reader_, get_both_range(db::table::kPlainStorageChangeSet, _, _)).Times(2).WillRepeatedly(InvokeWithoutArgs(
+            []() -> boost::asio::awaitable<std::optional<silkworm::Bytes>> { co_return kStorageLocation; }
+        ));
+
+        // Execute the test: calling read_storage after new block should fetch the open chunk again
+        evmc::bytes32 location;
+        CHECK_NOTHROW(location = spawn_and_wait(state_reader.read_storage(kZeroAddress, 0, kLocationHash, kHistoricalBlockNumber)));
+        history_cache.on_new_block();
+        CHECK_NOTHROW(location = spawn_and_wait(state_reader.read_storage(kZeroAddress, 0, kLocationHash, kHistoricalBlockNumber)));
+        CHECK(location == silkworm::to_bytes32(kStorageLocation));
+        CHECK(history_cache.hit_count() == 0);
+    }
+}
+
 TEST_CASE_METHOD(StateReaderTest, "StateReader::read_code") {
     SILKRPC_LOG_VERBOSITY(LogLevel::None);
 
@@ -0,0 +1,172 @@
+/*
+    Copyright 2022 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "state_snapshot_cache.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include <silkworm/db/util.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/common/util.hpp>
+
+namespace silkrpc::state {
+
+//! The approximate memory taken by each entry besides its key and value (i.e. container node and allocation overhead)
+static constexpr std::size_t kEntryOverhead{64};
+
+static silkworm::Bytes storage_key(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) {
+    silkworm::Bytes key{silkworm::db::storage_prefix(full_view(address), incarnation)};
+    key.append(location.bytes, silkworm::kHashLength);
+    return key;
+}
+
+std::optional<std::optional<silkworm::Account>> StateSnapshot::read_account(const evmc::address& address) const {
+    std::scoped_lock lock{access_};
+    const auto it = accounts_.find(address);
+    if (it == accounts_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void StateSnapshot::insert_account(const evmc::address& address, const std::optional<silkworm::Account>& account) {
+    std::scoped_lock lock{access_};
+    if (accounts_.contains(address) || !reserve(sizeof(evmc::address) + sizeof(std::optional<silkworm::Account>))) {
+        return;
+    }
+    accounts_.emplace(address, account);
+}
+
+std::optional<evmc::bytes32> StateSnapshot::read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const {
+    const auto key{storage_key(address, incarnation, location)};
+    std::scoped_lock lock{access_};
+    const auto it = storage_.find(key);
+    if (it == storage_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+void StateSnapshot::insert_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location, const evmc::bytes32& value) {
+    auto key{storage_key(address, incarnation, location)};
+    std::scoped_lock lock{access_};
+    if (storage_.contains(key) || !reserve(sizeof(silkworm::Bytes) + key.size() + sizeof(evmc::bytes32))) {
+        return;
+    }
+    storage_.emplace(std::move(key), value);
+}
+
+std::optional<silkworm::ByteView> StateSnapshot::read_code(const evmc::bytes32& code_hash) const {
+    std::scoped_lock lock{access_};
+    const auto it = codes_.find(code_hash);
+    if (it == codes_.end()) {
+        return std::nullopt;
+    }
+    return silkworm::ByteView{it->second};
+}
+
+std::optional<silkworm::ByteView> StateSnapshot::insert_code(const evmc::bytes32& code_hash, silkworm::Bytes code) {
+    std::scoped_lock lock{access_};
+    // Values are never replaced, so any view returned before stays valid
+    auto it = codes_.find(code_hash);
+    if (it == codes_.end()) {
+        if (!reserve(sizeof(evmc::bytes32) + sizeof(silkworm::Bytes) + code.size())) {
+            return std::nullopt;
+        }
+        it = codes_.emplace(code_hash, std::move(code)).first;
+    }
+    return silkworm::ByteView{it->second};
+}
+
+std::size_t StateSnapshot::size() const {
+    std::scoped_lock lock{access_};
+    return accounts_.size() + storage_.size() + codes_.size();
+}
+
+std::size_t StateSnapshot::memory_size() const {
+    std::scoped_lock lock{access_};
+    return memory_size_;
+}
+
+bool StateSnapshot::reserve(std::size_t entry_size) {
+    entry_size += kEntryOverhead;
+    if (memory_size_ + entry_size > max_memory_size_) {
+        return false;
+    }
+    memory_size_ += entry_size;
+    return true;
+}
+
+StateSnapshotCache::StateSnapshotCache(std::size_t max_snapshots, std::size_t memory_budget)
+    : max_snapshots_(max_snapshots), max_snapshot_memory_size_(max_snapshots > 0 ? memory_budget / max_snapshots : 0) {
+    if (max_snapshots == 0) {
+        throw std::invalid_argument{"unexpected zero max snapshots"};
+    }
+    if (max_snapshot_memory_size_ == 0) {
+        throw std::invalid_argument{"unexpected memory budget lower than max snapshots"};
+    }
+}
+
+std::shared_ptr<StateSnapshot> StateSnapshotCache::get(uint64_t block_number, const evmc::bytes32& block_hash) {
+    const BlockKey block_key{block_number, block_hash};
+    std::scoped_lock lock{access_};
+
+    auto it = snapshots_.find(block_key);
+    if (it != snapshots_.end()) {
+        lru_blocks_.splice(lru_blocks_.begin(), lru_blocks_, it->second.lru_position);
+        hit_count_.fetch_add(1, std::memory_order_relaxed);
+        return it->second.snapshot;
+    }
+    miss_count_.fetch_add(1, std::memory_order_relaxed);
+
+    auto snapshot = std::make_shared<StateSnapshot>(block_number, max_snapshot_memory_size_);
+    const auto lru_position = lru_blocks_.insert(lru_blocks_.begin(), block_key);
+    snapshots_.emplace(block_key, Entry{snapshot, lru_position});
+
+    while (snapshots_.size() > max_snapshots_) {
+        snapshots_.erase(lru_blocks_.back());
+        lru_blocks_.pop_back();
+    }
+    return snapshot;
+}
+
+void StateSnapshotCache::invalidate(uint64_t block_number) {
+    std::scoped_lock lock{access_};
+    auto it = snapshots_.lower_bound(BlockKey{block_number, evmc::bytes32{}});
+    while (it != snapshots_.end()) {
+        lru_blocks_.erase(it->second.lru_position);
+        it = snapshots_.erase(it);
+    }
+    SILKRPC_DEBUG << "StateSnapshotCache::invalidate block_number: " << block_number << " size: " << snapshots_.size() << "\n";
+}
+
+std::size_t StateSnapshotCache::size() const {
+    std::scoped_lock lock{access_};
+    return snapshots_.size();
+}
+
+std::size_t StateSnapshotCache::memory_size() const {
+    std::scoped_lock lock{access_};
+    std::size_t memory_size{0};
+    for (const auto& block_and_entry : snapshots_) {
+        memory_size += block_and_entry.second.snapshot->memory_size();
+    }
+    return memory_size;
+}
+
+} // namespace silkrpc::state
@@ -0,0 +1,129 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#include <silkworm/silkrpc/config.hpp>
+
+#include <evmc/evmc.hpp>
+#include <silkworm/common/base.hpp>
+#include <silkworm/types/account.hpp>
+
+namespace silkrpc::state {
+
+constexpr auto kDefaultMaxStateSnapshots{32u};
+constexpr std::size_t kDefaultStateSnapshotCacheMemoryBudget{256 * 1024 * 1024};
+constexpr std::size_t kDefaultMaxStateSnapshotMemorySize{kDefaultStateSnapshotCacheMemoryBudget / kDefaultMaxStateSnapshots};
+
+//! Read-through collection of the state values (accounts, storage and code) at the end of a given block. The state of any
+//! already executed block is immutable, so values can be safely shared among all the executions at the same block.
+//! The values beyond the memory limit are not inserted, so any reader must be able to go on without them.
+class StateSnapshot {
+public:
+    explicit StateSnapshot(uint64_t block_number, std::size_t max_memory_size = kDefaultMaxStateSnapshotMemorySize)
+        : block_number_(block_number), max_memory_size_(max_memory_size) {}
+
+    StateSnapshot(const StateSnapshot&) = delete;
+    StateSnapshot& operator=(const StateSnapshot&) = delete;
+
+    uint64_t block_number() const { return block_number_; }
+
+    //! Return the cached account, if any: a cached empty value means that the account does not exist
+    std::optional<std::optional<silkworm::Account>> read_account(const evmc::address& address) const;
+    void insert_account(const evmc::address& address, const std::optional<silkworm::Account>& account);
+
+    std::optional<evmc::bytes32> read_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location) const;
+    void insert_storage(const evmc::address& address, uint64_t incarnation, const evmc::bytes32& location, const evmc::bytes32& value);
+
+    //! Return the cached code, if any: the returned view is valid as long as this snapshot is alive
+    std::optional<silkworm::ByteView> read_code(const evmc::bytes32& code_hash) const;
+    //! Return the cached code as above, unless \p code has not been inserted because the memory limit has been reached
+    std::optional<silkworm::ByteView> insert_code(const evmc::bytes32& code_hash, silkworm::Bytes code);
+
+    std::size_t size() const;
+
+    //! The approximate memory taken by the cached values
+    std::size_t memory_size() const;
+
+private:
+    //! Account \p entry_size more bytes, if still within the memory limit
+    bool reserve(std::size_t entry_size);
+
+    uint64_t block_number_;
+    std::size_t max_memory_size_;
+    mutable std::mutex access_;
+    std::size_t memory_size_{0};
+    std::unordered_map<evmc::address, std::optional<silkworm::Account>> accounts_;
+    std::map<silkworm::Bytes, evmc::bytes32> storage_;
+    std::unordered_map<evmc::bytes32, silkworm::Bytes> codes_;
+};
+
+//! Cache of state snapshots shared among all the execution contexts, evicted in LRU order over blocks.
+//! Snapshots are keyed by block number and hash, so that an execution still seeing the state before a reorg never fills the
+//! snapshot read by executions on the new chain, even if it starts after \ref invalidate.
+//! Snapshots are reference-counted, so an evicted snapshot stays valid for any execution still using it.
+//! The memory budget is split evenly among the snapshots, so that the cached ones never take more than the budget in total.
+class StateSnapshotCache {
+public:
+    explicit StateSnapshotCache(std::size_t max_snapshots = kDefaultMaxStateSnapshots,
+        std::size_t memory_budget = kDefaultStateSnapshotCacheMemoryBudget);
+
+    StateSnapshotCache(const StateSnapshotCache&) = delete;
+    StateSnapshotCache& operator=(const StateSnapshotCache&) = delete;
+
+    //! Return the snapshot of the state at the end of the block \p block_number having \p block_hash, creating an empty one if missing
+    std::shared_ptr<StateSnapshot> get(uint64_t block_number, const evmc::bytes32& block_hash);
+
+    //! Drop all the snapshots from \p block_number onwards, because such blocks have been changed (e.g. unwind)
+    void invalidate(uint64_t block_number);
+
+    std::size_t size() const;
+
+    //! The approximate memory taken by the cached snapshots
+    std::size_t memory_size() const;
+
+    uint64_t hit_count() const { return hit_count_.load(std::memory_order_relaxed); }
+    uint64_t miss_count() const { return miss_count_.load(std::memory_order_relaxed); }
+
+private:
+    using BlockKey = std::pair<uint64_t, evmc::bytes32>;
+
+    struct Entry {
+        std::shared_ptr<StateSnapshot> snapshot;
+        std::list<BlockKey>::iterator lru_position;
+    };
+
+    std::size_t max_snapshots_;
+    std::size_t max_snapshot_memory_size_;
+    mutable std::mutex access_;
+    std::map<BlockKey, Entry> snapshots_;
+    std::list<BlockKey> lru_blocks_;
+
+    std::atomic_uint64_t hit_count_{0};
+    std::atomic_uint64_t miss_count_{0};
+};
+
+} // namespace silkrpc::state
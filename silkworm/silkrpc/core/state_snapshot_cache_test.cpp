@@ -0,0 +1,189 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "state_snapshot_cache.hpp"
+
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+#include <evmc/evmc.hpp>
+#include <silkworm/common/util.hpp>
+
+namespace silkrpc::state {
+
+using Catch::Matchers::Message;
+using evmc::literals::operator""_address;
+using evmc::literals::operator""_bytes32;
+
+static constexpr auto kTestAddress{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+static constexpr auto kTestLocation{0x0000000000000000000000000000000000000000000000000000000000000001_bytes32};
+static constexpr auto kTestValue{0x00000000000000000000000000000000000000000000000000000000000000ff_bytes32};
+static constexpr auto kTestCodeHash{0x04491edcd115127caedbd478e2e7895ed80c7847e903431f94f9cfa579cad47f_bytes32};
+static constexpr auto kBlockHash100{0x8e38b4dbf6b11fcc3b9dee84fb7986e29ca0a02cecd8977c161ff7333329681e_bytes32};
+static constexpr auto kBlockHash101{0x9d6ec5e0d1dfe1ed3e5b5dfd3d8d34a77a6ec4d6f4dbb3a0c8b19f5bde7dc6d5_bytes32};
+static constexpr auto kBlockHash102{0xbc8f7b1b57b2e7b2b4cf5ec5d2c0ee4e3a2de65eed9ee0f2ac3d8a6bb4f7cb8a_bytes32};
+static constexpr auto kReorgBlockHash100{0x3e4a1bb3f4c3f55f3e2d8c5b0e3a2c4d5a6b7c8d9e0f1a2b3c4d5e6f7a8b9c0d_bytes32};
+
+TEST_CASE("StateSnapshot", "[silkrpc][core][state_snapshot_cache]") {
+    StateSnapshot snapshot{1'000'000};
+    CHECK(snapshot.block_number() == 1'000'000);
+    CHECK(snapshot.size() == 0);
+
+    SECTION("account") {
+        CHECK(!snapshot.read_account(kTestAddress));
+        silkworm::Account account;
+        account.nonce = 2;
+        snapshot.insert_account(kTestAddress, account);
+        const auto cached_account{snapshot.read_account(kTestAddress)};
+        CHECK(cached_account);
+        CHECK(*cached_account == account);
+    }
+
+    SECTION("non-existent account") {
+        snapshot.insert_account(kTestAddress, std::nullopt);
+        const auto cached_account{snapshot.read_account(kTestAddress)};
+        CHECK(cached_account);
+        CHECK(!*cached_account);
+    }
+
+    SECTION("storage") {
+        CHECK(!snapshot.read_storage(kTestAddress, 1, kTestLocation));
+        snapshot.insert_storage(kTestAddress, 1, kTestLocation, kTestValue);
+        CHECK(snapshot.read_storage(kTestAddress, 1, kTestLocation) == kTestValue);
+        CHECK(!snapshot.read_storage(kTestAddress, 2, kTestLocation));
+    }
+
+    SECTION("code") {
+        CHECK(!snapshot.read_code(kTestCodeHash));
+        const silkworm::Bytes code{*silkworm::from_hex("0x0608")};
+        const auto code_view{snapshot.insert_code(kTestCodeHash, code)};
+        CHECK(code_view == code);
+        CHECK(snapshot.read_code(kTestCodeHash) == code_view);
+        CHECK(snapshot.insert_code(kTestCodeHash, silkworm::Bytes{})->data() == code_view->data());
+        CHECK(snapshot.size() == 1);
+    }
+}
+
+TEST_CASE("StateSnapshot memory limit", "[silkrpc][core][state_snapshot_cache]") {
+    StateSnapshot snapshot{1'000'000, 512};
+
+    SECTION("values beyond limit are not inserted") {
+        CHECK(snapshot.memory_size() == 0);
+        snapshot.insert_storage(kTestAddress, 1, kTestLocation, kTestValue);
+        const auto memory_size{snapshot.memory_size()};
+        CHECK(memory_size > 0);
+        CHECK(memory_size <= 512);
+        for (uint64_t incarnation{2}; snapshot.memory_size() + memory_size <= 512; ++incarnation) {
+            snapshot.insert_storage(kTestAddress, incarnation, kTestLocation, kTestValue);
+        }
+        const auto size{snapshot.size()};
+        snapshot.insert_storage(kTestAddress, 1'000, kTestLocation, kTestValue);
+        CHECK(!snapshot.read_storage(kTestAddress, 1'000, kTestLocation));
+        CHECK(snapshot.size() == size);
+        CHECK(snapshot.memory_size() <= 512);
+        CHECK(snapshot.read_storage(kTestAddress, 1, kTestLocation) == kTestValue);
+    }
+
+    SECTION("code beyond limit is not inserted") {
+        CHECK(!snapshot.insert_code(kTestCodeHash, silkworm::Bytes(1024, 0x60)));
+        CHECK(!snapshot.read_code(kTestCodeHash));
+        CHECK(snapshot.memory_size() == 0);
+    }
+
+    SECTION("same value is accounted once") {
+        snapshot.insert_account(kTestAddress, std::nullopt);
+        const auto memory_size{snapshot.memory_size()};
+        snapshot.insert_account(kTestAddress, std::nullopt);
+        CHECK(snapshot.memory_size() == memory_size);
+    }
+}
+
+TEST_CASE("StateSnapshotCache", "[silkrpc][core][state_snapshot_cache]") {
+    SECTION("reject zero max snapshots") {
+        CHECK_THROWS_MATCHES(StateSnapshotCache{0}, std::invalid_argument, Message("unexpected zero max snapshots"));
+    }
+
+    SECTION("reject memory budget lower than max snapshots") {
+        CHECK_THROWS_MATCHES((StateSnapshotCache{4, 3}), std::invalid_argument, Message("unexpected memory budget lower than max snapshots"));
+    }
+
+    SECTION("memory budget split among snapshots") {
+        StateSnapshotCache cache{2, 1024};
+        const auto snapshot1{cache.get(100, kBlockHash100)};
+        const auto snapshot2{cache.get(101, kBlockHash101)};
+        for (uint64_t incarnation{1}; incarnation <= 100; ++incarnation) {
+            snapshot1->insert_storage(kTestAddress, incarnation, kTestLocation, kTestValue);
+            snapshot2->insert_storage(kTestAddress, incarnation, kTestLocation, kTestValue);
+        }
+        CHECK(snapshot1->memory_size() <= 512);
+        CHECK(snapshot2->memory_size() <= 512);
+        CHECK(cache.memory_size() == snapshot1->memory_size() + snapshot2->memory_size());
+        CHECK(cache.memory_size() <= 1024);
+    }
+
+    SECTION("get same snapshot for same block") {
+        StateSnapshotCache cache;
+        const auto snapshot1{cache.get(100, kBlockHash100)};
+        const auto snapshot2{cache.get(100, kBlockHash100)};
+        CHECK(snapshot1 == snapshot2);
+        CHECK(snapshot1->block_number() == 100);
+        CHECK(cache.get(101, kBlockHash101) != snapshot1);
+        CHECK(cache.size() == 2);
+        CHECK(cache.hit_count() == 1);
+        CHECK(cache.miss_count() == 2);
+    }
+
+    SECTION("evict least recently used block") {
+        StateSnapshotCache cache{2};
+        const auto snapshot1{cache.get(100, kBlockHash100)};
+        const auto snapshot2{cache.get(101, kBlockHash101)};
+        CHECK(cache.get(100, kBlockHash100) == snapshot1);
+        const auto snapshot3{cache.get(102, kBlockHash102)};
+        CHECK(cache.size() == 2);
+        CHECK(cache.get(100, kBlockHash100) == snapshot1);
+        CHECK(cache.get(102, kBlockHash102) == snapshot3);
+        CHECK(cache.get(101, kBlockHash101) != snapshot2);
+        // Evicted snapshot is still valid for its owners
+        snapshot2->insert_storage(kTestAddress, 1, kTestLocation, kTestValue);
+        CHECK(snapshot2->read_storage(kTestAddress, 1, kTestLocation) == kTestValue);
+    }
+
+    SECTION("invalidate from block") {
+        StateSnapshotCache cache;
+        const auto snapshot1{cache.get(100, kBlockHash100)};
+        const auto snapshot2{cache.get(101, kBlockHash101)};
+        const auto snapshot3{cache.get(102, kBlockHash102)};
+        cache.invalidate(101);
+        CHECK(cache.size() == 1);
+        CHECK(cache.get(100, kBlockHash100) == snapshot1);
+        CHECK(cache.get(101, kBlockHash101) != snapshot2);
+        CHECK(cache.get(102, kBlockHash102) != snapshot3);
+    }
+
+    SECTION("get distinct snapshot for distinct block at same number") {
+        StateSnapshotCache cache;
+        const auto snapshot1{cache.get(100, kBlockHash100)};
+        const auto snapshot2{cache.get(100, kReorgBlockHash100)};
+        CHECK(snapshot1 != snapshot2);
+        CHECK(cache.get(100, kBlockHash100) == snapshot1);
+        CHECK(cache.get(100, kReorgBlockHash100) == snapshot2);
+        CHECK(cache.size() == 2);
+        cache.invalidate(100);
+        CHECK(cache.size() == 0);
+    }
+}
+
+} // namespace silkrpc::state
@@ -0,0 +1,95 @@
+/*
+    Copyright 2022 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "trace_cache.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/common/util.hpp>
+
+namespace silkrpc::trace {
+
+//! Rough per-entry overhead of the node-based containers used to index the traces
+constexpr std::size_t kEntryOverhead{128};
+
+TraceCache::TraceCache(std::size_t memory_budget) : memory_budget_(memory_budget) {
+    if (memory_budget == 0) {
+        throw std::invalid_argument{"unexpected zero memory budget"};
+    }
+}
+
+std::optional<nlohmann::json> TraceCache::find(const evmc::bytes32& block_hash, const std::string& tag) {
+    std::shared_ptr<const EncodedTraces> traces;
+    {
+        std::scoped_lock lock{access_};
+        auto it = entries_.find({block_hash, tag});
+        if (it == entries_.end()) {
+            miss_count_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        lru_keys_.splice(lru_keys_.begin(), lru_keys_, it->second.lru_position);
+        hit_count_.fetch_add(1, std::memory_order_relaxed);
+        traces = it->second.traces;
+    }
+    // Decoding happens outside the lock, the encoded traces are immutable
+    return nlohmann::json::from_cbor(*traces);
+}
+
+void TraceCache::insert(const evmc::bytes32& block_hash, const std::string& tag, const nlohmann::json& traces) {
+    auto encoded_traces = std::make_shared<const EncodedTraces>(nlohmann::json::to_cbor(traces));
+    const auto memory_size{encoded_traces->size() + tag.size() + sizeof(TracesKey) + kEntryOverhead};
+    if (memory_size > memory_budget_) {
+        return;
+    }
+    TracesKey key{block_hash, tag};
+
+    std::scoped_lock lock{access_};
+
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        erase(it);
+    }
+    memory_size_ += memory_size;
+    const auto lru_position = lru_keys_.insert(lru_keys_.begin(), key);
+    entries_.emplace(std::move(key), Entry{std::move(encoded_traces), memory_size, lru_position});
+
+    while (memory_size_ > memory_budget_) {
+        erase(entries_.find(lru_keys_.back()));
+        eviction_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    SILKRPC_DEBUG << "TraceCache::insert block_hash: " << block_hash << " tag: " << tag << " size: " << entries_.size()
+                  << " memory_size: " << memory_size_ << "\n";
+}
+
+std::size_t TraceCache::size() const {
+    std::scoped_lock lock{access_};
+    return entries_.size();
+}
+
+std::size_t TraceCache::memory_size() const {
+    std::scoped_lock lock{access_};
+    return memory_size_;
+}
+
+void TraceCache::erase(TracesMap::iterator it) {
+    memory_size_ -= it->second.memory_size;
+    lru_keys_.erase(it->second.lru_position);
+    entries_.erase(it);
+}
+
+} // namespace silkrpc::trace
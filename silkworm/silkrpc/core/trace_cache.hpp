@@ -0,0 +1,89 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <silkworm/silkrpc/config.hpp> // NOLINT(build/include_order)
+
+#include <evmc/evmc.hpp>
+#include <nlohmann/json.hpp>
+
+namespace silkrpc::trace {
+
+constexpr std::size_t kDefaultTraceCacheMemoryBudget{64 * 1024 * 1024};
+
+//! Cache of the traces computed for recently traced blocks, evicted in LRU order to stay within a memory budget.
+//! Traces are kept in compact binary form (i.e. CBOR encoding of their JSON representation) and decoded on demand.
+//! Traces are keyed by block hash plus a tag identifying method and trace configuration, so any traces of blocks
+//! removed by a reorg are just never used again because block numbers are resolved to the current canonical hash.
+class TraceCache {
+public:
+    explicit TraceCache(std::size_t memory_budget = kDefaultTraceCacheMemoryBudget);
+
+    TraceCache(const TraceCache&) = delete;
+    TraceCache& operator=(const TraceCache&) = delete;
+
+    //! Return the JSON traces of \p block_hash computed by \p tag method and configuration, if any
+    std::optional<nlohmann::json> find(const evmc::bytes32& block_hash, const std::string& tag);
+
+    //! Insert the JSON \p traces of \p block_hash computed by \p tag method and configuration, possibly evicting the least recently used ones
+    void insert(const evmc::bytes32& block_hash, const std::string& tag, const nlohmann::json& traces);
+
+    std::size_t size() const;
+    std::size_t memory_size() const;
+
+    uint64_t hit_count() const { return hit_count_.load(std::memory_order_relaxed); }
+    uint64_t miss_count() const { return miss_count_.load(std::memory_order_relaxed); }
+    uint64_t eviction_count() const { return eviction_count_.load(std::memory_order_relaxed); }
+
+private:
+    using TracesKey = std::pair<evmc::bytes32, std::string>;
+    using EncodedTraces = std::vector<std::uint8_t>;
+
+    struct Entry {
+        std::shared_ptr<const EncodedTraces> traces;
+        std::size_t memory_size{0};
+        std::list<TracesKey>::iterator lru_position;
+    };
+
+    using TracesMap = std::map<TracesKey, Entry>;
+
+    void erase(TracesMap::iterator it);
+
+    std::size_t memory_budget_;
+    mutable std::mutex access_;
+    TracesMap entries_;
+    std::list<TracesKey> lru_keys_;
+    std::size_t memory_size_{0};
+
+    std::atomic_uint64_t hit_count_{0};
+    std::atomic_uint64_t miss_count_{0};
+    std::atomic_uint64_t eviction_count_{0};
+};
+
+} // namespace silkrpc::trace
@@ -0,0 +1,132 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "trace_cache.hpp"
+
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+#include <evmc/evmc.hpp>
+#include <nlohmann/json.hpp>
+
+namespace silkrpc::trace {
+
+using Catch::Matchers::Message;
+using evmc::literals::operator""_bytes32;
+
+static constexpr auto kTestBlockHash1{0x3ccc7d2e6c6ed0d0e4c1c1b5bbfe0a1a7b3a58e2fcd7a4b0c1b9d1fe62e13ee2_bytes32};
+static constexpr auto kTestBlockHash2{0x8e38b4dbf6b11fcc3b9dee84fb7986e29ca0a02cecd8977c161ff7333329681e_bytes32};
+
+static const nlohmann::json kTestTraces = R"([
+    {
+        "action": {
+            "callType": "call",
+            "from": "0x0715a7794a1dc8e42615f059dd6e406a6594651a",
+            "gas": "0x1dcd12f8",
+            "input": "0x",
+            "to": "0x0f572e5295c57f15886f9b263e2f6d2d6c7b5ec6",
+            "value": "0x0"
+        },
+        "blockHash": "0x3ccc7d2e6c6ed0d0e4c1c1b5bbfe0a1a7b3a58e2fcd7a4b0c1b9d1fe62e13ee2",
+        "blockNumber": 1024165,
+        "result": {
+            "gasUsed": "0x0",
+            "output": "0x"
+        },
+        "subtraces": 0,
+        "traceAddress": [],
+        "transactionPosition": 0,
+        "type": "call"
+    }
+])"_json;
+
+TEST_CASE("TraceCache::TraceCache", "[silkrpc][core][trace_cache]") {
+    SECTION("reject zero memory budget") {
+        CHECK_THROWS_MATCHES(TraceCache{0}, std::invalid_argument, Message("unexpected zero memory budget"));
+    }
+
+    SECTION("empty cache") {
+        TraceCache cache;
+        CHECK(cache.size() == 0);
+        CHECK(cache.memory_size() == 0);
+        CHECK(cache.hit_count() == 0);
+        CHECK(cache.miss_count() == 0);
+        CHECK(cache.eviction_count() == 0);
+    }
+}
+
+TEST_CASE("TraceCache::find", "[silkrpc][core][trace_cache]") {
+    TraceCache cache;
+    cache.insert(kTestBlockHash1, "trace_block", kTestTraces);
+
+    SECTION("hit: traces are decoded as inserted") {
+        CHECK(cache.find(kTestBlockHash1, "trace_block") == kTestTraces);
+        CHECK(cache.hit_count() == 1);
+    }
+
+    SECTION("miss: different tag") {
+        CHECK(cache.find(kTestBlockHash1, "trace_replayBlockTransactions") == std::nullopt);
+        CHECK(cache.miss_count() == 1);
+    }
+
+    SECTION("miss: different block hash") {
+        CHECK(cache.find(kTestBlockHash2, "trace_block") == std::nullopt);
+        CHECK(cache.miss_count() == 1);
+    }
+}
+
+TEST_CASE("TraceCache::insert", "[silkrpc][core][trace_cache]") {
+    SECTION("insert traces") {
+        TraceCache cache;
+        cache.insert(kTestBlockHash1, "trace_block", kTestTraces);
+        CHECK(cache.size() == 1);
+        CHECK(cache.memory_size() > 0);
+    }
+
+    SECTION("replace existing traces") {
+        TraceCache cache;
+        cache.insert(kTestBlockHash1, "trace_block", kTestTraces);
+        cache.insert(kTestBlockHash1, "trace_block", nlohmann::json::array());
+        CHECK(cache.size() == 1);
+        CHECK(cache.find(kTestBlockHash1, "trace_block") == nlohmann::json::array());
+    }
+
+    SECTION("traces exceeding memory budget are skipped") {
+        TraceCache cache{16};
+        cache.insert(kTestBlockHash1, "trace_block", kTestTraces);
+        CHECK(cache.size() == 0);
+        CHECK(cache.memory_size() == 0);
+    }
+
+    SECTION("evict least recently used traces") {
+        TraceCache probe_cache;
+        probe_cache.insert(kTestBlockHash1, "trace_block", kTestTraces);
+        const auto entry_memory_size{probe_cache.memory_size()};
+
+        TraceCache cache{2 * entry_memory_size};
+        cache.insert(kTestBlockHash1, "trace_block", kTestTraces);
+        cache.insert(kTestBlockHash2, "trace_block", kTestTraces);
+        CHECK(cache.find(kTestBlockHash1, "trace_block"));
+        cache.insert(kTestBlockHash2, "trace_other", kTestTraces);
+        CHECK(cache.size() == 2);
+        CHECK(cache.eviction_count() == 1);
+        CHECK(cache.find(kTestBlockHash1, "trace_block"));
+        CHECK_FALSE(cache.find(kTestBlockHash2, "trace_block"));
+        CHECK(cache.find(kTestBlockHash2, "trace_other"));
+    }
+}
+
+} // namespace silkrpc::trace
@@ -21,12 +21,19 @@
 #endif
 
 #include <filesystem>
+#include <optional>
 #include <stdexcept>
+#include <string>
 
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
 #include <boost/asio/signal_set.hpp>
 #include <boost/process/environment.hpp>
 #include <grpcpp/grpcpp.h>
 #include <silkworm/silkrpc/http/jwt.hpp>
+#include <silkworm/silkrpc/metrics/event_loop_lag.hpp>
+#include <silkworm/silkrpc/metrics/metrics.hpp>
+#include <silkworm/silkrpc/metrics/request_profile.hpp>
 
 namespace silkrpc {
 
@@ -41,6 +48,72 @@ void DaemonChecklist::success_or_throw() const {
     }
 }
 
+static double hit_ratio(uint64_t hit_count, uint64_t miss_count) {
+    const auto lookup_count{hit_count + miss_count};
+    return lookup_count > 0 ? static_cast<double>(hit_count) / static_cast<double>(lookup_count) : 0.0;
+}
+
+static void write_block_cache_metrics(std::ostream& out, const BlockCache& block_cache) {
+    const auto hit_count{block_cache.hit_count()};
+    const auto miss_count{block_cache.miss_count()};
+    metrics::write_counter(out, "silkrpc_block_cache_hits_total", "Block cache hits", hit_count);
+    metrics::write_counter(out, "silkrpc_block_cache_misses_total", "Block cache misses", miss_count);
+    metrics::write_gauge(out, "silkrpc_block_cache_hit_ratio", "Block cache hit ratio since startup", hit_ratio(hit_count, miss_count));
+}
+
+static void write_state_cache_metrics(std::ostream& out, const ethdb::kv::StateCache& state_cache) {
+    const auto state_hit_count{state_cache.state_hit_count()};
+    const auto state_miss_count{state_cache.state_miss_count()};
+    metrics::write_counter(out, "silkrpc_state_cache_hits_total", "State cache hits", state_hit_count);
+    metrics::write_counter(out, "silkrpc_state_cache_misses_total", "State cache misses", state_miss_count);
+    metrics::write_counter(out, "silkrpc_state_cache_evictions_total", "State cache evictions", state_cache.state_eviction_count());
+    metrics::write_gauge(out, "silkrpc_state_cache_keys", "State cache keys", static_cast<double>(state_cache.state_key_count()));
+    metrics::write_gauge(out, "silkrpc_state_cache_hit_ratio", "State cache hit ratio since startup", hit_ratio(state_hit_count, state_miss_count));
+
+    const auto code_hit_count{state_cache.code_hit_count()};
+    const auto code_miss_count{state_cache.code_miss_count()};
+    metrics::write_counter(out, "silkrpc_code_cache_hits_total", "Code cache hits", code_hit_count);
+    metrics::write_counter(out, "silkrpc_code_cache_misses_total", "Code cache misses", code_miss_count);
+    metrics::write_counter(out, "silkrpc_code_cache_evictions_total", "Code cache evictions", state_cache.code_eviction_count());
+    metrics::write_gauge(out, "silkrpc_code_cache_keys", "Code cache keys", static_cast<double>(state_cache.code_key_count()));
+    metrics::write_gauge(out, "silkrpc_code_cache_hit_ratio", "Code cache hit ratio since startup", hit_ratio(code_hit_count, code_miss_count));
+}
+
+//! Write the hit and miss counters, the hit ratio and, if any, the eviction counter of one execution cache
+static void write_execution_cache_metrics(std::ostream& out, const std::string& name, const std::string& description,
+                                          uint64_t hit_count, uint64_t miss_count, std::optional<uint64_t> eviction_count = {}) {
+    const std::string prefix{"silkrpc_" + name + "_cache_"};
+    metrics::write_counter(out, prefix + "hits_total", description + " cache hits", hit_count);
+    metrics::write_counter(out, prefix + "misses_total", description + " cache misses", miss_count);
+    if (eviction_count) {
+        metrics::write_counter(out, prefix + "evictions_total", description + " cache evictions", *eviction_count);
+    }
+    metrics::write_gauge(out, prefix + "hit_ratio", description + " cache hit ratio since startup", hit_ratio(hit_count, miss_count));
+}
+
+static void write_execution_caches_metrics(std::ostream& out, const ExecutionCaches& caches) {
+    if (caches.history) {
+        const auto& cache{*caches.history};
+        write_execution_cache_metrics(out, "history", "History index", cache.hit_count(), cache.miss_count(), cache.eviction_count());
+    }
+    if (caches.snapshot) {
+        const auto& cache{*caches.snapshot};
+        write_execution_cache_metrics(out, "state_snapshot", "State snapshot", cache.hit_count(), cache.miss_count());
+    }
+    if (caches.checkpoint) {
+        const auto& cache{*caches.checkpoint};
+        write_execution_cache_metrics(out, "state_checkpoint", "State checkpoint", cache.hit_count(), cache.miss_count(), cache.eviction_count());
+    }
+    if (caches.footprint) {
+        const auto& cache{*caches.footprint};
+        write_execution_cache_metrics(out, "call_footprint", "Call footprint", cache.hit_count(), cache.miss_count(), cache.eviction_count());
+    }
+    if (caches.trace) {
+        const auto& cache{*caches.trace};
+        write_execution_cache_metrics(out, "trace", "Trace", cache.hit_count(), cache.miss_count(), cache.eviction_count());
+    }
+}
+
 const char* current_exception_name() {
 #ifdef WIN32
     return "<Exception name not supported on Windows>";
@@ -58,6 +131,12 @@ int Daemon::run(const DaemonSettings& settings, const DaemonInfo& info) {
 
     SILKRPC_LOG_VERBOSITY(settings.log_verbosity);
     SILKRPC_LOG_THREAD(true);
+    SILKRPC_LOG_FORMAT(settings.log_format);
+    SILKRPC_LOG_ASYNC(true);
+
+    metrics::set_slow_request_threshold(std::chrono::milliseconds{settings.slow_request_threshold});
+    metrics::set_slow_request_format(settings.slow_request_format);
+    set_request_deadlines(settings.request_deadlines);
 
     auto mdbx_ver{mdbx::get_version()};
     auto mdbx_bld{mdbx::get_build()};
@@ -89,6 +168,7 @@ int Daemon::run(const DaemonSettings& settings, const DaemonInfo& info) {
             SILKRPC_LOG << "Silkrpc launched with datadir " << *settings.datadir << " using " << settings.num_contexts
                         << " contexts, " << settings.num_workers << " workers\n";
         }
+        SILKRPC_LOG << "Silkrpc I/O backend: " << kIoBackend << " wait mode: " << AbslUnparseFlag(settings.wait_mode) << "\n";
 
         std::string jwt_secret;
         if (!load_jwt_token(settings.jwt_secret_filename, jwt_secret)) {
@@ -141,7 +221,8 @@ int Daemon::run(const DaemonSettings& settings, const DaemonInfo& info) {
         SILKRPC_CRIT << "Unexpected exception: " << current_exception_name() << "\n" << std::flush;
     }
 
-    SILKRPC_LOG << "Silkrpc exiting [pid=" << pid << ", main thread=" << tid << "]\n" << std::flush;
+    SILKRPC_LOG << "Silkrpc exiting [pid=" << pid << ", main thread=" << tid << "]\n";
+    SILKRPC_LOG_ASYNC(false);
 
     return 0;
 }
@@ -168,6 +249,13 @@ bool Daemon::validate_settings(const DaemonSettings& settings) {
         return false;
     }
 
+    const auto metrics_port = settings.metrics_port;
+    if (!metrics_port.empty() && metrics_port.find(silkrpc::kAddressPortSeparator) == std::string::npos) {
+        SILKRPC_ERROR << "Parameter metrics_port is invalid: [" << metrics_port << "]\n";
+        SILKRPC_ERROR << "Use --metrics_port flag to specify the local binding for Prometheus metrics service\n";
+        return false;
+    }
+
     const auto target = settings.target;
     if (!target.empty() && target.find(':') == std::string::npos) {
         SILKRPC_ERROR << "Parameter target is invalid: [" << target << "]\n";
@@ -188,6 +276,12 @@ bool Daemon::validate_settings(const DaemonSettings& settings) {
         return false;
     }
 
+    if (settings.context_cores.overlaps(settings.worker_cores)) {
+        SILKRPC_ERROR << "Parameters context_cores and worker_cores overlap: [" << settings.context_cores << "] [" << settings.worker_cores << "]\n";
+        SILKRPC_ERROR << "Use --context_cores and --worker_cores flags to specify disjoint core sets\n";
+        return false;
+    }
+
     return true;
 }
 
@@ -205,10 +299,23 @@ ChannelFactory Daemon::make_channel_factory(const DaemonSettings& settings) {
 Daemon::Daemon(const DaemonSettings& settings, const std::string& jwt_secret)
     : settings_(settings),
       create_channel_{make_channel_factory(settings_)},
-      context_pool_{settings_.num_contexts, create_channel_, settings.datadir, settings_.wait_mode},
+      context_pool_{settings_.num_contexts, create_channel_, settings.datadir, settings_.wait_mode, settings_.context_cores},
       worker_pool_{settings_.num_workers},
+      admission_control_{settings_.admission_limits},
       jwt_secret_{jwt_secret},
       kv_stub_{remote::KV::NewStub(create_channel_())} {
+    // Keep workers off the context cores, so that long-running tasks do not evict the hot data of execution loops
+    pin_thread_pool(worker_pool_, settings_.num_workers, settings_.worker_cores);
+
+    // Reserve a lane to Engine API requests, so that bursts of public requests cannot delay the consensus-critical ones
+    if (settings_.engine_workers > 0) {
+        engine_worker_pool_ = std::make_unique<boost::asio::thread_pool>(settings_.engine_workers);
+        pin_thread_pool(*engine_worker_pool_, settings_.engine_workers, settings_.worker_cores);
+        if (context_pool_.num_shared_contexts() > 1) {
+            engine_context_ = &context_pool_.reserve_context();
+        }
+    }
+
     // Create the unique KV state-changes stream feeding the state cache
     auto& context = context_pool_.next_context();
     state_changes_stream_ = std::make_unique<ethdb::kv::StateChangesStream>(context, kv_stub_.get());
@@ -236,18 +343,30 @@ DaemonChecklist Daemon::run_checklist() {
 }
 
 void Daemon::start() {
-    for (int i = 0; i < settings_.num_contexts; ++i) {
-        auto& context = context_pool_.next_context();
-        rpc_services_.emplace_back(
-            std::make_unique<http::Server>(settings_.http_port, settings_.api_spec, context, worker_pool_, std::nullopt /* no jwt_secret_file */));
+    auto& engine_workers = engine_worker_pool_ ? *engine_worker_pool_ : worker_pool_;
+    if (engine_context_) {
+        // Engine API connections never leave the reserved context, which public connections never enter
         rpc_services_.emplace_back(
-            std::make_unique<http::Server>(settings_.engine_port, kDefaultEth2ApiSpec, context, worker_pool_, jwt_secret_));
+            std::make_unique<http::Server>(settings_.engine_port, kDefaultEth2ApiSpec, *engine_context_, engine_workers, jwt_secret_));
+    }
+    for (std::size_t i{0}; i < context_pool_.num_shared_contexts(); ++i) {
+        auto& context = context_pool_.next_context();
+        rpc_services_.emplace_back(std::make_unique<http::Server>(
+            settings_.http_port, settings_.api_spec, context, worker_pool_, std::nullopt /* no jwt_secret_file */, &context_pool_, &admission_control_));
+        if (!engine_context_) {
+            rpc_services_.emplace_back(
+                std::make_unique<http::Server>(settings_.engine_port, kDefaultEth2ApiSpec, context, engine_workers, jwt_secret_, &context_pool_));
+        }
     }
 
     for (auto& service : rpc_services_) {
         service->start();
     }
 
+    if (!settings_.metrics_port.empty()) {
+        start_metrics();
+    }
+
     // Open the KV state-changes stream feeding the state cache
     state_changes_stream_->open();
 
@@ -263,6 +382,36 @@ void Daemon::stop() {
     for (auto& service : rpc_services_) {
         service->stop();
     }
+    if (metrics_service_) {
+        metrics_service_->stop();
+    }
+}
+
+void Daemon::start_metrics() {
+    // Sample the statistics of the caches shared by all contexts at scrape time
+    auto& context = context_pool_.context(0);
+    metrics::registry().add_collector([block_cache = context.block_cache(), state_cache = context.state_cache(),
+                                       caches = context.caches(), &admission_control = admission_control_](std::ostream& out) {
+        write_block_cache_metrics(out, *block_cache);
+        write_state_cache_metrics(out, *state_cache);
+        write_execution_caches_metrics(out, caches);
+        metrics::write_counter(out, "silkrpc_requests_shed_total", "Requests shed by admission control", admission_control.shed_count());
+    });
+
+    // Measure the event loop lag of each context
+    const auto num_shared_contexts = context_pool_.num_shared_contexts();
+    for (std::size_t i{0}; i < num_shared_contexts; ++i) {
+        auto& io_context = *context_pool_.context(i).io_context();
+        boost::asio::co_spawn(io_context, metrics::probe_event_loop_lag(metrics::registry().event_loop_lag(i)), boost::asio::detached);
+    }
+    if (engine_context_) {
+        auto& io_context = *engine_context_->io_context();
+        boost::asio::co_spawn(io_context, metrics::probe_event_loop_lag(metrics::registry().event_loop_lag(num_shared_contexts)), boost::asio::detached);
+    }
+
+    metrics_service_ = std::make_unique<metrics::Server>(settings_.metrics_port, *context.io_context());
+    metrics_service_->start();
+    SILKRPC_LOG << "Starting Prometheus metrics at " << settings_.metrics_port << metrics::kMetricsPath << "\n";
 }
 
 void Daemon::join() {
@@ -24,9 +24,14 @@
 
 #include <silkworm/silkrpc/common/constants.hpp>
 #include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/concurrency/admission_control.hpp>
+#include <silkworm/silkrpc/concurrency/cancellation.hpp>
 #include <silkworm/silkrpc/concurrency/context_pool.hpp>
+#include <silkworm/silkrpc/concurrency/cpu_affinity.hpp>
 #include <silkworm/silkrpc/ethdb/kv/state_changes_stream.hpp>
 #include <silkworm/silkrpc/http/server.hpp>
+#include <silkworm/silkrpc/metrics/request_profile.hpp>
+#include <silkworm/silkrpc/metrics/server.hpp>
 #include <silkworm/silkrpc/protocol/version.hpp>
 
 namespace silkrpc {
@@ -42,6 +47,15 @@ struct DaemonSettings {
     LogLevel log_verbosity;
     WaitMode wait_mode;
     std::string jwt_secret_filename;
+    std::string metrics_port; // metrics_end_point (empty means disabled)
+    LogFormat log_format;
+    uint32_t slow_request_threshold; // milliseconds (zero means disabled)
+    metrics::SlowRequestFormat slow_request_format;
+    CoreSet context_cores; // cores for context threads (empty means unpinned)
+    CoreSet worker_cores; // cores for worker threads (empty means unpinned)
+    AdmissionLimits admission_limits; // limits on public requests by namespace
+    uint32_t engine_workers; // workers reserved to Engine API (zero means no reserved lane)
+    RequestDeadlines request_deadlines; // max request duration by method or namespace
 };
 
 struct DaemonInfo {
@@ -75,6 +89,9 @@ class Daemon {
     static bool validate_settings(const DaemonSettings& settings);
     static ChannelFactory make_channel_factory(const DaemonSettings& settings);
 
+    //! Start the Prometheus metrics end-point and the samplers feeding it.
+    void start_metrics();
+
     //! The RPC daemon configuration settings.
     const DaemonSettings& settings_;
 
@@ -87,8 +104,20 @@ class Daemon {
     //! The pool of workers for long-running tasks.
     boost::asio::thread_pool worker_pool_;
 
+    //! The optional pool of workers reserved to Engine API requests.
+    std::unique_ptr<boost::asio::thread_pool> engine_worker_pool_;
+
+    //! The optional context reserved to Engine API requests.
+    Context* engine_context_{nullptr};
+
+    //! The limits on public requests, so that heavy namespaces are shed instead of queued without bound.
+    AdmissionControl admission_control_;
+
     std::vector<std::unique_ptr<http::Server>> rpc_services_;
 
+    //! The optional Prometheus metrics end-point.
+    std::unique_ptr<metrics::Server> metrics_service_;
+
     //! The gRPC KV interface client stub.
     std::unique_ptr<remote::KV::StubInterface> kv_stub_;
 
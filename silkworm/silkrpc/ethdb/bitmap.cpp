@@ -50,7 +50,7 @@ static Roaring fast_or(size_t n, const std::vector<std::unique_ptr<Roaring>>& in
     return ans;
 }
 
-boost::asio::awaitable<Roaring> get(core::rawdb::DatabaseReader& db_reader, const std::string& table, silkworm::Bytes& key, uint32_t from_block, uint32_t to_block) {
+boost::asio::awaitable<Roaring> get(const core::rawdb::DatabaseReader& db_reader, const std::string& table, silkworm::Bytes& key, uint32_t from_block, uint32_t to_block) {
     std::vector<std::unique_ptr<Roaring>> chuncks;
 
     silkworm::Bytes from_key{key.begin(), key.end()};
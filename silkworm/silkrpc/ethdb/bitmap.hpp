@@ -29,7 +29,7 @@
 
 namespace silkrpc::ethdb::bitmap {
 
-boost::asio::awaitable<roaring::Roaring> get(core::rawdb::DatabaseReader& db_reader, const std::string& table, silkworm::Bytes& key, uint32_t from_block, uint32_t to_block);
+boost::asio::awaitable<roaring::Roaring> get(const core::rawdb::DatabaseReader& db_reader, const std::string& table, silkworm::Bytes& key, uint32_t from_block, uint32_t to_block);
 
 } // silkrpc::ethdb::bitmap
 
@@ -0,0 +1,107 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "bitmap.hpp"
+
+#include <climits>
+#include <map>
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/endian/conversion.hpp>
+
+namespace silkrpc::ethdb::bitmap {
+
+//! In-memory reader holding the history index chunks of one single key
+class ChunkDatabaseReader : public core::rawdb::DatabaseReader {
+public:
+    void add_chunk(const silkworm::Bytes& key, const roaring::Roaring& chunk) {
+        silkworm::Bytes chunk_key{key};
+        chunk_key.resize(key.size() + sizeof(uint32_t));
+        boost::endian::store_big_u32(&chunk_key[key.size()], chunk.maximum());
+        silkworm::Bytes chunk_value(chunk.getSizeInBytes(), 0);
+        chunk.write(reinterpret_cast<char*>(chunk_value.data()));
+        chunks_.emplace(chunk_key, chunk_value);
+    }
+
+    boost::asio::awaitable<KeyValue> get(const std::string& /*table*/, const silkworm::ByteView& /*key*/) const override { co_return KeyValue{}; }
+
+    boost::asio::awaitable<silkworm::Bytes> get_one(const std::string& /*table*/, const silkworm::ByteView& /*key*/) const override { co_return silkworm::Bytes{}; }
+
+    boost::asio::awaitable<std::optional<silkworm::Bytes>> get_both_range(const std::string& /*table*/, const silkworm::ByteView& /*key*/,
+                                                                          const silkworm::ByteView& /*subkey*/) const override {
+        co_return std::nullopt;
+    }
+
+    boost::asio::awaitable<void> walk(const std::string& /*table*/, const silkworm::ByteView& start_key, uint32_t fixed_bits,
+                                      core::rawdb::Walker w) const override {
+        const auto fixed_bytes{fixed_bits / CHAR_BIT};
+        for (auto it = chunks_.lower_bound(silkworm::Bytes{start_key}); it != chunks_.end(); ++it) {
+            if (it->first.compare(0, fixed_bytes, start_key.data(), fixed_bytes) != 0) {
+                break;
+            }
+            auto key{it->first};
+            auto value{it->second};
+            if (!w(key, value)) {
+                break;
+            }
+        }
+        co_return;
+    }
+
+    boost::asio::awaitable<void> for_prefix(const std::string& /*table*/, const silkworm::ByteView& /*prefix*/, core::rawdb::Walker /*w*/) const override {
+        co_return;
+    }
+
+private:
+    std::map<silkworm::Bytes, silkworm::Bytes> chunks_;
+};
+
+static void benchmark_bitmap_get(benchmark::State& state) {
+    const auto num_chunks{static_cast<uint32_t>(state.range(0))};
+    constexpr uint32_t kBlocksPerChunk{2'000};
+    constexpr uint32_t kBlockStep{7};
+
+    silkworm::Bytes key(20, 0x0f);
+    ChunkDatabaseReader db_reader;
+    for (uint32_t c{0}; c < num_chunks; ++c) {
+        roaring::Roaring chunk;
+        for (uint32_t b{0}; b < kBlocksPerChunk; ++b) {
+            chunk.add((c * kBlocksPerChunk + b) * kBlockStep);
+        }
+        chunk.runOptimize();
+        db_reader.add_chunk(key, chunk);
+    }
+    const uint32_t to_block{num_chunks * kBlocksPerChunk * kBlockStep};
+
+    boost::asio::io_context io_context;
+    boost::asio::co_spawn(io_context, [&]() -> boost::asio::awaitable<void> {
+        for (auto _ : state) {
+            const auto bitmap = co_await get(db_reader, "AccountHistory", key, 0, to_block);
+            benchmark::DoNotOptimize(bitmap.cardinality());
+        }
+    }, boost::asio::detached);
+    io_context.run();
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(benchmark_bitmap_get)->Arg(1)->Arg(16)->Arg(256);
+
+} // namespace silkrpc::ethdb::bitmap
@@ -0,0 +1,58 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "cbor.hpp"
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+namespace silkrpc {
+
+//! Encode \p num_logs synthetic logs in the same CBOR layout used by Erigon for the log table, i.e. [address, [topics], data]
+static silkworm::Bytes make_cbor_logs(std::size_t num_logs, std::size_t num_topics, std::size_t data_size) {
+    nlohmann::json logs = nlohmann::json::array();
+    for (std::size_t i{0}; i < num_logs; ++i) {
+        nlohmann::json topics = nlohmann::json::array();
+        for (std::size_t t{0}; t < num_topics; ++t) {
+            topics.push_back(nlohmann::json::binary(std::vector<std::uint8_t>(32, static_cast<std::uint8_t>(t))));
+        }
+        logs.push_back({
+            nlohmann::json::binary(std::vector<std::uint8_t>(20, static_cast<std::uint8_t>(i))),
+            std::move(topics),
+            nlohmann::json::binary(std::vector<std::uint8_t>(data_size, 0xaa))
+        });
+    }
+    const auto cbor = nlohmann::json::to_cbor(logs);
+    return silkworm::Bytes{cbor.cbegin(), cbor.cend()};
+}
+
+static void benchmark_cbor_decode_logs(benchmark::State& state) {
+    const auto bytes{make_cbor_logs(static_cast<std::size_t>(state.range(0)), 3, 64)};
+    for (auto _ : state) {
+        std::vector<Log> logs;
+        const bool ok = cbor_decode(bytes, logs);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(logs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+}
+
+BENCHMARK(benchmark_cbor_decode_logs)->Arg(1)->Arg(16)->Arg(256);
+
+} // namespace silkrpc
@@ -0,0 +1,126 @@
+/*
+    Copyright 2022 The Silkrpc Authors
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "history_cache.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <boost/endian/conversion.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+
+namespace silkrpc::ethdb {
+
+//! The upper bound of the last chunk of any history index
+constexpr uint64_t kOpenChunkUpperBound{std::numeric_limits<uint64_t>::max()};
+
+HistoryCache::HistoryCache(std::size_t capacity) : capacity_(capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument{"unexpected zero capacity"};
+    }
+}
+
+std::shared_ptr<const HistoryCache::Bitmap> HistoryCache::find(silkworm::ByteView history_key) {
+    if (history_key.size() < sizeof(uint64_t)) {
+        return nullptr;
+    }
+    const auto prefix_length{history_key.size() - sizeof(uint64_t)};
+    const auto block_number{boost::endian::load_big_u64(&history_key[prefix_length])};
+    const silkworm::Bytes seek_key{history_key};
+
+    std::scoped_lock lock{access_};
+
+    // Same semantics as database seek: first chunk whose upper bound is greater than or equal to the searched block...
+    auto it = entries_.lower_bound(seek_key);
+    if (it == entries_.end() || it->first.size() != seek_key.size() || it->first.compare(0, prefix_length, seek_key, 0, prefix_length) != 0) {
+        miss_count_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    // ...but the previous chunk could be missing in cache, so the cached one is valid only if its own range includes the block
+    auto& entry = it->second;
+    if (block_number < entry.min_block) {
+        miss_count_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    if (entry.open && entry.generation != generation_) {
+        erase(it);
+        miss_count_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    lru_keys_.splice(lru_keys_.begin(), lru_keys_, entry.lru_position);
+    hit_count_.fetch_add(1, std::memory_order_relaxed);
+    return entry.bitmap;
+}
+
+uint64_t HistoryCache::generation() const {
+    std::scoped_lock lock{access_};
+    return generation_;
+}
+
+void HistoryCache::insert(silkworm::ByteView chunk_key, std::shared_ptr<const Bitmap> bitmap, uint64_t read_generation) {
+    if (chunk_key.size() < sizeof(uint64_t) || !bitmap || bitmap->isEmpty()) {
+        return;
+    }
+    const auto upper_bound{boost::endian::load_big_u64(&chunk_key[chunk_key.size() - sizeof(uint64_t)])};
+    const auto min_block{bitmap->minimum()};
+
+    const bool open{upper_bound == kOpenChunkUpperBound};
+
+    std::scoped_lock lock{access_};
+
+    // The open chunk read before a new block would be taken as fresh if stamped with the current generation
+    if (open && read_generation != generation_) {
+        return;
+    }
+
+    auto [it, inserted] = entries_.try_emplace(silkworm::Bytes{chunk_key});
+    auto& entry = it->second;
+    entry.bitmap = std::move(bitmap);
+    entry.min_block = min_block;
+    entry.open = open;
+    entry.generation = generation_;
+    if (inserted) {
+        entry.lru_position = lru_keys_.insert(lru_keys_.begin(), it->first);
+    } else {
+        lru_keys_.splice(lru_keys_.begin(), lru_keys_, entry.lru_position);
+    }
+
+    while (entries_.size() > capacity_) {
+        erase(entries_.find(lru_keys_.back()));
+        eviction_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void HistoryCache::on_new_block() {
+    std::scoped_lock lock{access_};
+    // Open chunks are lazily dropped when looked up again
+    ++generation_;
+    SILKRPC_DEBUG << "HistoryCache::on_new_block generation: " << generation_ << " size: " << entries_.size() << "\n";
+}
+
+std::size_t HistoryCache::size() const {
+    std::scoped_lock lock{access_};
+    return entries_.size();
+}
+
+void HistoryCache::erase(EntryMap::iterator it) {
+    lru_keys_.erase(it->second.lru_position);
+    entries_.erase(it);
+}
+
+} // namespace silkrpc::ethdb
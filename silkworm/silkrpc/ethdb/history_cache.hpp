@@ -0,0 +1,99 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <silkworm/silkrpc/config.hpp>
+
+#include <silkworm/common/base.hpp>
+#include <silkworm/db/bitmap.hpp>
+
+namespace silkrpc::ethdb {
+
+constexpr auto kDefaultHistoryCacheCapacity{100'000u};
+
+//! Bounded cache of parsed history index chunks (i.e. AccountHistory and StorageHistory bitmaps) shared by all contexts.
+//! Each chunk is keyed by its database key, i.e. address [+ location hash] + big-endian chunk upper bound block number.
+//! All chunks but the last one are immutable: the last open chunk (whose upper bound is the max block number) is rewritten
+//! at each new block, so it is the only one invalidated by \ref on_new_block.
+class HistoryCache {
+public:
+    using Bitmap = roaring::Roaring64Map;
+
+    explicit HistoryCache(std::size_t capacity = kDefaultHistoryCacheCapacity);
+
+    HistoryCache(const HistoryCache&) = delete;
+    HistoryCache& operator=(const HistoryCache&) = delete;
+
+    //! Return the cached chunk that a database seek using \p history_key would find, if any and if it covers the searched block
+    std::shared_ptr<const Bitmap> find(silkworm::ByteView history_key);
+
+    //! The current generation, to be taken before reading from database any chunk to insert
+    uint64_t generation() const;
+
+    //! Insert the chunk found in database at \p chunk_key, possibly evicting the least recently used one. The chunk is dropped
+    //! if open and read at a \p read_generation older than the current one, because it may miss the changes of the new blocks
+    void insert(silkworm::ByteView chunk_key, std::shared_ptr<const Bitmap> bitmap, uint64_t read_generation);
+
+    //! Invalidate all the open chunks, because they change at each new block
+    void on_new_block();
+
+    std::size_t size() const;
+
+    uint64_t hit_count() const { return hit_count_.load(std::memory_order_relaxed); }
+    uint64_t miss_count() const { return miss_count_.load(std::memory_order_relaxed); }
+    uint64_t eviction_count() const { return eviction_count_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        std::shared_ptr<const Bitmap> bitmap;
+        uint64_t min_block{0};
+        bool open{false};
+        uint64_t generation{0};
+        std::list<silkworm::Bytes>::iterator lru_position;
+    };
+
+    //! Order keys by length first, so that account and storage chunks never interleave
+    struct KeyLess {
+        bool operator()(const silkworm::Bytes& lhs, const silkworm::Bytes& rhs) const {
+            return lhs.size() != rhs.size() ? lhs.size() < rhs.size() : lhs < rhs;
+        }
+    };
+
+    using EntryMap = std::map<silkworm::Bytes, Entry, KeyLess>;
+
+    void erase(EntryMap::iterator it);
+
+    std::size_t capacity_;
+    mutable std::mutex access_;
+    EntryMap entries_;
+    std::list<silkworm::Bytes> lru_keys_;
+    uint64_t generation_{0};
+
+    std::atomic_uint64_t hit_count_{0};
+    std::atomic_uint64_t miss_count_{0};
+    std::atomic_uint64_t eviction_count_{0};
+};
+
+} // namespace silkrpc::ethdb
+
@@ -0,0 +1,182 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "history_cache.hpp"
+
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+#include <evmc/evmc.hpp>
+#include <silkworm/db/util.hpp>
+
+namespace silkrpc::ethdb {
+
+using namespace evmc::literals;  // NOLINT(build/namespaces_literals)
+
+using Catch::Matchers::Message;
+
+static constexpr auto kTestAddress1{0x0f572e5295c57f15886f9b263e2f6d2d6c7b5ec6_address};
+static constexpr auto kTestAddress2{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+static constexpr auto kTestLocation{0x0000000000000000000000000000000000000000000000000000000000000001_bytes32};
+static constexpr auto kOpenChunk{std::numeric_limits<uint64_t>::max()};
+
+static std::shared_ptr<const HistoryCache::Bitmap> make_bitmap(std::initializer_list<uint64_t> blocks) {
+    auto bitmap = std::make_shared<HistoryCache::Bitmap>();
+    for (const auto block : blocks) {
+        bitmap->add(block);
+    }
+    return bitmap;
+}
+
+TEST_CASE("HistoryCache::HistoryCache", "[silkrpc][ethdb][history_cache]") {
+    SECTION("reject zero capacity") {
+        CHECK_THROWS_MATCHES(HistoryCache{0}, std::invalid_argument, Message("unexpected zero capacity"));
+    }
+
+    SECTION("empty cache") {
+        HistoryCache cache;
+        CHECK(cache.size() == 0);
+        CHECK(cache.hit_count() == 0);
+        CHECK(cache.miss_count() == 0);
+        CHECK(cache.eviction_count() == 0);
+    }
+}
+
+TEST_CASE("HistoryCache::find", "[silkrpc][ethdb][history_cache]") {
+    HistoryCache cache;
+    const auto chunk1 = make_bitmap({10, 20, 30});
+    const auto chunk2 = make_bitmap({40, 50});
+    cache.insert(silkworm::db::account_history_key(kTestAddress1, 30), chunk1, cache.generation());
+    cache.insert(silkworm::db::account_history_key(kTestAddress1, kOpenChunk), chunk2, cache.generation());
+    CHECK(cache.size() == 2);
+
+    SECTION("hit: block within closed chunk") {
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 10)) == chunk1);
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 25)) == chunk1);
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 30)) == chunk1);
+        CHECK(cache.hit_count() == 3);
+    }
+
+    SECTION("hit: block within open chunk") {
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 40)) == chunk2);
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 1'000)) == chunk2);
+        CHECK(cache.hit_count() == 2);
+    }
+
+    SECTION("miss: block before the first block of chunk") {
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 5)) == nullptr);
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 35)) == nullptr);
+        CHECK(cache.miss_count() == 2);
+    }
+
+    SECTION("miss: different address") {
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress2, 20)) == nullptr);
+        CHECK(cache.miss_count() == 1);
+    }
+
+    SECTION("miss: storage key for same address") {
+        CHECK(cache.find(silkworm::db::storage_history_key(kTestAddress1, kTestLocation, 20)) == nullptr);
+        CHECK(cache.miss_count() == 1);
+    }
+
+    SECTION("miss: key too short") {
+        CHECK(cache.find(silkworm::ByteView{}) == nullptr);
+    }
+}
+
+TEST_CASE("HistoryCache::insert", "[silkrpc][ethdb][history_cache]") {
+    SECTION("storage chunk") {
+        HistoryCache cache;
+        const auto chunk = make_bitmap({100, 200});
+        cache.insert(silkworm::db::storage_history_key(kTestAddress1, kTestLocation, kOpenChunk), chunk, cache.generation());
+        CHECK(cache.find(silkworm::db::storage_history_key(kTestAddress1, kTestLocation, 150)) == chunk);
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 150)) == nullptr);
+    }
+
+    SECTION("empty chunk is skipped") {
+        HistoryCache cache;
+        cache.insert(silkworm::db::account_history_key(kTestAddress1, 30), make_bitmap({}), cache.generation());
+        cache.insert(silkworm::db::account_history_key(kTestAddress1, 30), nullptr, cache.generation());
+        CHECK(cache.size() == 0);
+    }
+
+    SECTION("replace existing chunk") {
+        HistoryCache cache;
+        const auto chunk1 = make_bitmap({10, 20});
+        const auto chunk2 = make_bitmap({15, 20});
+        cache.insert(silkworm::db::account_history_key(kTestAddress1, kOpenChunk), chunk1, cache.generation());
+        cache.insert(silkworm::db::account_history_key(kTestAddress1, kOpenChunk), chunk2, cache.generation());
+        CHECK(cache.size() == 1);
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 10)) == nullptr);
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 15)) == chunk2);
+    }
+
+    SECTION("evict least recently used chunk") {
+        HistoryCache cache{2};
+        const auto chunk1 = make_bitmap({10});
+        const auto chunk2 = make_bitmap({20});
+        const auto chunk3 = make_bitmap({30});
+        cache.insert(silkworm::db::account_history_key(kTestAddress1, kOpenChunk), chunk1, cache.generation());
+        cache.insert(silkworm::db::account_history_key(kTestAddress2, kOpenChunk), chunk2, cache.generation());
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 10)) == chunk1);
+        cache.insert(silkworm::db::storage_history_key(kTestAddress1, kTestLocation, kOpenChunk), chunk3, cache.generation());
+        CHECK(cache.size() == 2);
+        CHECK(cache.eviction_count() == 1);
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 10)) == chunk1);
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress2, 20)) == nullptr);
+        CHECK(cache.find(silkworm::db::storage_history_key(kTestAddress1, kTestLocation, 30)) == chunk3);
+    }
+}
+
+TEST_CASE("HistoryCache::on_new_block", "[silkrpc][ethdb][history_cache]") {
+    HistoryCache cache;
+    const auto closed_chunk = make_bitmap({10, 20, 30});
+    const auto open_chunk = make_bitmap({40, 50});
+    cache.insert(silkworm::db::account_history_key(kTestAddress1, 30), closed_chunk, cache.generation());
+    cache.insert(silkworm::db::account_history_key(kTestAddress1, kOpenChunk), open_chunk, cache.generation());
+
+    cache.on_new_block();
+
+    SECTION("closed chunk still valid") {
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 20)) == closed_chunk);
+        CHECK(cache.size() == 2);
+    }
+
+    SECTION("open chunk invalidated") {
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 45)) == nullptr);
+        CHECK(cache.size() == 1);
+    }
+
+    SECTION("open chunk read before new block is dropped") {
+        const auto read_generation{cache.generation()};
+        cache.on_new_block();
+        cache.insert(silkworm::db::account_history_key(kTestAddress1, kOpenChunk), open_chunk, read_generation);
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 45)) == nullptr);
+        cache.insert(silkworm::db::account_history_key(kTestAddress1, 60), make_bitmap({40, 50, 60}), read_generation);
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 60)) != nullptr);
+    }
+
+    SECTION("open chunk inserted again") {
+        const auto new_open_chunk = make_bitmap({40, 50, 60});
+        cache.insert(silkworm::db::account_history_key(kTestAddress1, kOpenChunk), new_open_chunk, cache.generation());
+        CHECK(cache.find(silkworm::db::account_history_key(kTestAddress1, 60)) == new_open_chunk);
+    }
+}
+
+} // namespace silkrpc::ethdb
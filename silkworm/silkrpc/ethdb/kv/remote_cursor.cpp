@@ -22,6 +22,7 @@ namespace silkrpc::ethdb::kv {
 
 boost::asio::awaitable<void> RemoteCursor::open_cursor(const std::string& table_name, bool is_dup_sorted) {
     const auto start_time = clock_time::now();
+    table_name_ = table_name;
     if (cursor_id_ == 0) {
         SILKRPC_DEBUG << "RemoteCursor::open_cursor opening new cursor for table: " << table_name << "\n";
         auto open_message = remote::Cursor{};
@@ -31,8 +32,9 @@ boost::asio::awaitable<void> RemoteCursor::open_cursor(const std::string& table_
            open_message.set_op(remote::Op::OPEN);
         }
         open_message.set_bucketname(table_name);
-        cursor_id_ = (co_await tx_rpc_.write_and_read(open_message)).cursorid();
+        cursor_id_ = (co_await write_and_read(open_message)).cursorid();
         SILKRPC_DEBUG << "RemoteCursor::open_cursor cursor: " << cursor_id_ << " for table: " << table_name << "\n";
+        record("open", start_time);
     }
     SILKRPC_DEBUG << "RemoteCursor::open_cursor [" << table_name << "] c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
     co_return;
@@ -45,7 +47,8 @@ boost::asio::awaitable<KeyValue> RemoteCursor::seek(silkworm::ByteView key) {
     seek_message.set_op(remote::Op::SEEK);
     seek_message.set_cursor(cursor_id_);
     seek_message.set_k(key.data(), key.length());
-    auto seek_pair = co_await tx_rpc_.write_and_read(seek_message);
+    auto seek_pair = co_await write_and_read(seek_message);
+    record("seek", start_time);
     const auto k = silkworm::bytes_of_string(seek_pair.k());
     const auto v = silkworm::bytes_of_string(seek_pair.v());
     SILKRPC_DEBUG << "RemoteCursor::seek k: " << k << " v: " << v << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
@@ -59,7 +62,8 @@ boost::asio::awaitable<KeyValue> RemoteCursor::seek_exact(silkworm::ByteView key
     seek_message.set_op(remote::Op::SEEK_EXACT);
     seek_message.set_cursor(cursor_id_);
     seek_message.set_k(key.data(), key.length());
-    auto seek_pair = co_await tx_rpc_.write_and_read(seek_message);
+    auto seek_pair = co_await write_and_read(seek_message);
+    record("seek_exact", start_time);
     const auto k = silkworm::bytes_of_string(seek_pair.k());
     const auto v = silkworm::bytes_of_string(seek_pair.v());
     SILKRPC_DEBUG << "RemoteCursor::seek_exact k: " << k << " v: " << v << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
@@ -71,7 +75,8 @@ boost::asio::awaitable<KeyValue> RemoteCursor::next() {
     auto next_message = remote::Cursor{};
     next_message.set_op(remote::Op::NEXT);
     next_message.set_cursor(cursor_id_);
-    auto next_pair = co_await tx_rpc_.write_and_read(next_message);
+    auto next_pair = co_await write_and_read(next_message);
+    record("next", start_time);
     const auto k = silkworm::bytes_of_string(next_pair.k());
     const auto v = silkworm::bytes_of_string(next_pair.v());
     SILKRPC_DEBUG << "RemoteCursor::next k: " << k << " v: " << v << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
@@ -83,7 +88,8 @@ boost::asio::awaitable<KeyValue> RemoteCursor::next_dup() {
     auto next_message = remote::Cursor{};
     next_message.set_op(remote::Op::NEXT_DUP);
     next_message.set_cursor(cursor_id_);
-    auto next_pair = co_await tx_rpc_.write_and_read(next_message);
+    auto next_pair = co_await write_and_read(next_message);
+    record("next_dup", start_time);
     const auto k = silkworm::bytes_of_string(next_pair.k());
     const auto v = silkworm::bytes_of_string(next_pair.v());
     SILKRPC_DEBUG << "RemoteCursor::next k: " << k << " v: " << v << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
@@ -98,7 +104,8 @@ boost::asio::awaitable<silkworm::Bytes> RemoteCursor::seek_both(silkworm::ByteVi
     seek_message.set_cursor(cursor_id_);
     seek_message.set_k(key.data(), key.length());
     seek_message.set_v(value.data(), value.length());
-    auto seek_pair = co_await tx_rpc_.write_and_read(seek_message);
+    auto seek_pair = co_await write_and_read(seek_message);
+    record("seek_both", start_time);
     const auto k = silkworm::bytes_of_string(seek_pair.k());
     const auto v = silkworm::bytes_of_string(seek_pair.v());
     SILKRPC_DEBUG << "RemoteCursor::seek_both k: " << k << " v: " << v << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
@@ -113,7 +120,8 @@ boost::asio::awaitable<KeyValue> RemoteCursor::seek_both_exact(silkworm::ByteVie
     seek_message.set_cursor(cursor_id_);
     seek_message.set_k(key.data(), key.length());
     seek_message.set_v(value.data(), value.length());
-    auto seek_pair = co_await tx_rpc_.write_and_read(seek_message);
+    auto seek_pair = co_await write_and_read(seek_message);
+    record("seek_both_exact", start_time);
     const auto k = silkworm::bytes_of_string(seek_pair.k());
     const auto v = silkworm::bytes_of_string(seek_pair.v());
     SILKRPC_DEBUG << "RemoteCursor::seek_both_exact k: " << k << " v: " << v << " c=" << cursor_id_ << " t=" << clock_time::since(start_time) << "\n";
@@ -129,6 +137,7 @@ boost::asio::awaitable<void> RemoteCursor::close_cursor() {
         close_message.set_op(remote::Op::CLOSE);
         close_message.set_cursor(cursor_id_);
         co_await tx_rpc_.write_and_read(close_message);
+        record("close", start_time);
         SILKRPC_DEBUG << "RemoteCursor::close_cursor cursor: " << cursor_id_ << "\n";
         cursor_id_ = 0;
     }
@@ -136,4 +145,29 @@ boost::asio::awaitable<void> RemoteCursor::close_cursor() {
     co_return;
 }
 
+boost::asio::awaitable<remote::Pair> RemoteCursor::write_and_read(const remote::Cursor& request) {
+    throw_if_cancelled(cancellation_);
+    if (tx_access_ == nullptr) {
+        co_return co_await tx_rpc_.write_and_read(request);
+    }
+    // The stream allows just one exchange at a time, so concurrent requests on the same transaction wait for their turn
+    co_await tx_access_->lock();
+    remote::Pair reply;
+    try {
+        throw_if_cancelled(cancellation_);
+        reply = co_await tx_rpc_.write_and_read(request);
+    } catch (...) {
+        tx_access_->unlock();
+        throw;
+    }
+    tx_access_->unlock();
+    co_return reply;
+}
+
+void RemoteCursor::record(const char* op, uint64_t start_time) {
+    if (profile_) {
+        profile_->add_kv_op(table_name_, op, start_time, clock_time::now());
+    }
+}
+
 } // namespace silkrpc::ethdb::kv
@@ -28,15 +28,21 @@
 
 #include <silkworm/silkrpc/common/log.hpp>
 #include <silkworm/silkrpc/common/util.hpp>
+#include <silkworm/silkrpc/concurrency/async_mutex.hpp>
+#include <silkworm/silkrpc/concurrency/cancellation.hpp>
 #include <silkworm/silkrpc/ethdb/cursor.hpp>
 #include <silkworm/silkrpc/ethdb/kv/rpc.hpp>
+#include <silkworm/silkrpc/metrics/request_profile.hpp>
 #include <silkworm/common/util.hpp>
 
 namespace silkrpc::ethdb::kv {
 
 class RemoteCursor : public CursorDupSort {
 public:
-    explicit RemoteCursor(TxRpc& tx_rpc) : tx_rpc_(tx_rpc), cursor_id_{0} {}
+    //! Any round trip is serialized on \p tx_access if provided, so that cursors of the same transaction can be used concurrently
+    explicit RemoteCursor(TxRpc& tx_rpc, metrics::RequestProfile* profile = nullptr, const Cancellation* cancellation = nullptr,
+        AsyncMutex* tx_access = nullptr)
+        : tx_rpc_(tx_rpc), cursor_id_{0}, profile_{profile}, cancellation_{cancellation}, tx_access_{tx_access} {}
 
     uint32_t cursor_id() const override { return cursor_id_; };
 
@@ -57,8 +63,18 @@ public:
     boost::asio::awaitable<KeyValue> seek_both_exact(silkworm::ByteView key, silkworm::ByteView value) override;
 
 private:
+    //! Send \p request and read its reply, unless the request is cancelled: checking before writing keeps the stream usable (e.g. to close it)
+    boost::asio::awaitable<remote::Pair> write_and_read(const remote::Cursor& request);
+
+    //! Record the round-trip of \p op started at \p start_time into the request profile, if any
+    void record(const char* op, uint64_t start_time);
+
     TxRpc& tx_rpc_;
     uint32_t cursor_id_;
+    metrics::RequestProfile* profile_;
+    const Cancellation* cancellation_;
+    AsyncMutex* tx_access_;
+    std::string table_name_;
 };
 
 } // namespace silkrpc::ethdb::kv
@@ -23,6 +23,7 @@
 #include <grpcpp/grpcpp.h>
 
 #include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/metrics/metrics.hpp>
 
 namespace silkrpc::ethdb::kv {
 
@@ -46,6 +47,7 @@ boost::asio::awaitable<std::shared_ptr<CursorDupSort>> RemoteTransaction::cursor
 }
 
 boost::asio::awaitable<void> RemoteTransaction::close() {
+    metrics::registry().kv_round_trips().observe(tx_rpc_.round_trips());
     co_await tx_rpc_.writes_done_and_finish();
     cursors_.clear();
     tx_id_ = 0;
@@ -63,7 +65,7 @@ boost::asio::awaitable<std::shared_ptr<CursorDupSort>> RemoteTransaction::get_cu
            co_return cursor_it->second;
        }
     }
-    auto cursor = std::make_shared<RemoteCursor>(tx_rpc_);
+    auto cursor = std::make_shared<RemoteCursor>(tx_rpc_, profile_, cancellation_, &tx_access_);
     co_await cursor->open_cursor(table, is_cursor_sorted);
     if (is_cursor_sorted) {
        dup_cursors_[table] = cursor;
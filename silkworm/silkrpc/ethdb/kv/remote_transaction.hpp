@@ -28,6 +28,7 @@
 #include <grpcpp/grpcpp.h>
 
 #include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/concurrency/async_mutex.hpp>
 #include <silkworm/silkrpc/ethdb/cursor.hpp>
 #include <silkworm/silkrpc/ethdb/kv/remote_cursor.hpp>
 #include <silkworm/silkrpc/ethdb/kv/rpc.hpp>
@@ -57,6 +58,8 @@ private:
     std::map<std::string, std::shared_ptr<CursorDupSort>> cursors_;
     std::map<std::string, std::shared_ptr<CursorDupSort>> dup_cursors_;
     TxRpc tx_rpc_;
+    //! Serialize the round trips of all the cursors, so that several reads can be in flight on this transaction (e.g. prefetching)
+    AsyncMutex tx_access_;
     uint64_t tx_id_;
 };
 
@@ -113,8 +113,8 @@ void CoherentStateCache::on_new_block(const remote::StateChangeBatch& state_chan
         }
     }
 
-    state_key_count_ = latest_state_view_->cache.size();
-    code_key_count_ = latest_state_view_->code_cache.size();
+    state_key_count_.store(latest_state_view_->cache.size(), std::memory_order_relaxed);
+    code_key_count_.store(latest_state_view_->code_cache.size(), std::memory_order_relaxed);
 
     root->ready = true;
 }
@@ -230,7 +230,7 @@ boost::asio::awaitable<std::optional<silkworm::Bytes>> CoherentStateCache::get(c
     auto& cache = root_it->second->cache;
     const auto kv_it = cache.find(kv);
     if (kv_it != cache.end()) {
-        ++state_hit_count_;
+        state_hit_count_.fetch_add(1, std::memory_order_relaxed);
 
         SILKRPC_DEBUG << "Hit in state cache key=" << key << " value=" << kv_it->value << "\n";
 
@@ -242,7 +242,7 @@ boost::asio::awaitable<std::optional<silkworm::Bytes>> CoherentStateCache::get(c
         co_return kv_it->value;
     }
 
-    ++state_miss_count_;
+    state_miss_count_.fetch_add(1, std::memory_order_relaxed);
 
     TransactionDatabase tx_database{txn};
     const auto value = co_await tx_database.get_one(db::table::kPlainState, key);
@@ -272,7 +272,7 @@ boost::asio::awaitable<std::optional<silkworm::Bytes>> CoherentStateCache::get_c
     auto& code_cache = root_it->second->code_cache;
     const auto kv_it = code_cache.find(kv);
     if (kv_it != code_cache.end()) {
-        ++code_hit_count_;
+        code_hit_count_.fetch_add(1, std::memory_order_relaxed);
 
         SILKRPC_DEBUG << "Hit in code cache key=" << key << " value=" << kv_it->value << "\n";
 
@@ -284,7 +284,7 @@ boost::asio::awaitable<std::optional<silkworm::Bytes>> CoherentStateCache::get_c
         co_return kv_it->value;
     }
 
-    ++code_miss_count_;
+    code_miss_count_.fetch_add(1, std::memory_order_relaxed);
 
     TransactionDatabase tx_database{txn};
     const auto value = co_await tx_database.get_one(db::table::kCode, key);
@@ -338,8 +338,8 @@ CoherentStateRoot* CoherentStateCache::advance_root(StateViewId view_id) {
     latest_state_view_id_ = view_id;
     latest_state_view_ = root;
 
-    state_eviction_count_ = state_evictions_.size();
-    code_eviction_count_ = code_evictions_.size();
+    state_eviction_count_.store(state_evictions_.size(), std::memory_order_relaxed);
+    code_eviction_count_.store(code_evictions_.size(), std::memory_order_relaxed);
 
     return root;
 }
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <list>
 #include <map>
@@ -115,14 +116,14 @@ public:
     std::size_t latest_data_size() override;
     std::size_t latest_code_size() override;
 
-    uint64_t state_hit_count() const override { return state_hit_count_; }
-    uint64_t state_miss_count() const override { return state_miss_count_; }
-    uint64_t state_key_count() const override { return state_key_count_; }
-    uint64_t state_eviction_count() const override { return state_eviction_count_; }
-    uint64_t code_hit_count() const override { return code_hit_count_; }
-    uint64_t code_miss_count() const override { return code_miss_count_; }
-    uint64_t code_key_count() const override { return code_key_count_; }
-    uint64_t code_eviction_count() const override { return code_eviction_count_; }
+    uint64_t state_hit_count() const override { return state_hit_count_.load(std::memory_order_relaxed); }
+    uint64_t state_miss_count() const override { return state_miss_count_.load(std::memory_order_relaxed); }
+    uint64_t state_key_count() const override { return state_key_count_.load(std::memory_order_relaxed); }
+    uint64_t state_eviction_count() const override { return state_eviction_count_.load(std::memory_order_relaxed); }
+    uint64_t code_hit_count() const override { return code_hit_count_.load(std::memory_order_relaxed); }
+    uint64_t code_miss_count() const override { return code_miss_count_.load(std::memory_order_relaxed); }
+    uint64_t code_key_count() const override { return code_key_count_.load(std::memory_order_relaxed); }
+    uint64_t code_eviction_count() const override { return code_eviction_count_.load(std::memory_order_relaxed); }
 
 private:
     friend class CoherentStateView;
@@ -148,14 +149,14 @@ private:
     std::list<KeyValue> code_evictions_;
     std::shared_mutex rw_mutex_;
 
-    uint64_t state_hit_count_{0};
-    uint64_t state_miss_count_{0};
-    uint64_t state_key_count_{0};
-    uint64_t state_eviction_count_{0};
-    uint64_t code_hit_count_{0};
-    uint64_t code_miss_count_{0};
-    uint64_t code_key_count_{0};
-    uint64_t code_eviction_count_{0};
+    std::atomic_uint64_t state_hit_count_{0};
+    std::atomic_uint64_t state_miss_count_{0};
+    std::atomic_uint64_t state_key_count_{0};
+    std::atomic_uint64_t state_eviction_count_{0};
+    std::atomic_uint64_t code_hit_count_{0};
+    std::atomic_uint64_t code_miss_count_{0};
+    std::atomic_uint64_t code_key_count_{0};
+    std::atomic_uint64_t code_eviction_count_{0};
 };
 
 }  // namespace silkrpc::ethdb::kv
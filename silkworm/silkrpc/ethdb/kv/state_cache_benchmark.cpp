@@ -0,0 +1,110 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "state_cache.hpp"
+
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/endian/conversion.hpp>
+#include <evmc/evmc.hpp>
+
+#include <silkworm/silkrpc/test/dummy_transaction.hpp>
+#include <silkworm/common/util.hpp>
+#include <silkworm/rpc/common/conversion.hpp>
+
+namespace silkrpc::ethdb::kv {
+
+static constexpr uint64_t kBenchViewId{3'000'000};
+static constexpr uint64_t kBenchIncarnation{3};
+static const silkworm::Bytes kBenchAccountData{*silkworm::from_hex("0f01020203e8010520f1885eda54b7a053318cd41e2093220dab15d65381b1157a3633a83bfd5c9239")};
+
+static evmc::address make_address(uint64_t index) {
+    evmc::address address;
+    boost::endian::store_big_u64(address.bytes + silkworm::kAddressLength - sizeof(uint64_t), index);
+    return address;
+}
+
+//! Build a state change batch upserting \p num_keys accounts starting from \p first_key
+static remote::StateChangeBatch make_upsert_batch(uint64_t view_id, uint64_t first_key, uint64_t num_keys) {
+    remote::StateChangeBatch state_changes;
+    state_changes.set_databaseviewid(view_id);
+    remote::StateChange* latest_change = state_changes.add_changebatch();
+    latest_change->set_blockheight(view_id);
+    latest_change->set_direction(remote::Direction::FORWARD);
+    for (uint64_t i{first_key}; i < first_key + num_keys; ++i) {
+        remote::AccountChange* account_change = latest_change->add_changes();
+        account_change->set_allocated_address(silkworm::rpc::H160_from_address(make_address(i)).release());
+        account_change->set_action(remote::Action::UPSERT);
+        account_change->set_incarnation(kBenchIncarnation);
+        account_change->set_data(kBenchAccountData.data(), kBenchAccountData.size());
+    }
+    return state_changes;
+}
+
+//! Measure block processing, i.e. add of \p range(0) keys per block, on top of a cache already holding the default max keys
+static void benchmark_state_cache_add(benchmark::State& state) {
+    CoherentStateCache cache;
+    cache.on_new_block(make_upsert_batch(kBenchViewId, 0, kDefaultMaxStateKeys));
+
+    const auto keys_per_block{static_cast<uint64_t>(state.range(0))};
+    auto batch{make_upsert_batch(kBenchViewId + 1, kDefaultMaxStateKeys, keys_per_block)};
+    uint64_t view_id{kBenchViewId};
+    for (auto _ : state) {
+        batch.set_databaseviewid(++view_id);
+        cache.on_new_block(batch);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * keys_per_block));
+}
+
+BENCHMARK(benchmark_state_cache_add)->Arg(100)->Arg(1'000)->Unit(benchmark::kMillisecond);
+
+//! Measure cache hits on the latest view of a cache holding \p range(0) keys
+static void benchmark_state_cache_get(benchmark::State& state) {
+    const auto num_keys{static_cast<uint64_t>(state.range(0))};
+    CoherentStateCache cache{CoherentCacheConfig{kDefaultMaxViews, true, static_cast<uint32_t>(num_keys), kDefaultMaxCodeKeys}};
+    cache.on_new_block(make_upsert_batch(kBenchViewId, 0, num_keys));
+
+    std::vector<silkworm::Bytes> keys;
+    keys.reserve(num_keys);
+    for (uint64_t i{0}; i < num_keys; ++i) {
+        keys.emplace_back(make_address(i).bytes, silkworm::kAddressLength);
+    }
+
+    test::DummyTransaction txn{kBenchViewId, nullptr};
+    const auto view = cache.get_view(txn);
+
+    boost::asio::io_context io_context;
+    boost::asio::co_spawn(io_context, [&]() -> boost::asio::awaitable<void> {
+        std::size_t index{0};
+        for (auto _ : state) {
+            const auto value = co_await view->get(keys[index]);
+            benchmark::DoNotOptimize(value);
+            index = (index + 7'919) % keys.size();
+        }
+    }, boost::asio::detached);
+    io_context.run();
+
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(benchmark_state_cache_get)->Arg(10'000)->Arg(1'000'000);
+
+} // namespace silkrpc::ethdb::kv
@@ -16,6 +16,7 @@
 
 #include "state_changes_stream.hpp"
 
+#include <algorithm>
 #include <ostream>
 
 #include <boost/asio/experimental/as_tuple.hpp>
@@ -42,6 +43,9 @@ StateChangesStream::StateChangesStream(Context& context, remote::KV::StubInterfa
     : scheduler_(*context.io_context()),
       grpc_context_(*context.grpc_context()),
       cache_(context.state_cache().get()),
+      history_cache_(context.history_cache().get()),
+      snapshot_cache_(context.snapshot_cache().get()),
+      chain_config_cache_(context.chain_config_cache().get()),
       stub_(stub),
       retry_timer_{scheduler_} {}
 
@@ -90,6 +94,9 @@ boost::asio::awaitable<void> StateChangesStream::run() {
             continue;
         }
         SILKRPC_INFO << "State changes stream opened\n";
+        if (chain_config_cache_ != nullptr) {
+            chain_config_cache_->invalidate();
+        }
 
         std::error_code read_ec;
         remote::StateChangeBatch reply;
@@ -98,6 +105,17 @@ boost::asio::awaitable<void> StateChangesStream::run() {
             if (!read_ec) {
                 SILKRPC_INFO << "State changes batch received: " << reply << "\n";
                 cache_->on_new_block(reply);
+                if (history_cache_ != nullptr) {
+                    history_cache_->on_new_block();
+                }
+                if (snapshot_cache_ != nullptr && reply.changebatch_size() > 0) {
+                    // Any state snapshot from the lowest changed block onwards (e.g. unwind) is not valid anymore
+                    uint64_t lowest_block_height{reply.changebatch(0).blockheight()};
+                    for (const auto& state_change : reply.changebatch()) {
+                        lowest_block_height = std::min<uint64_t>(lowest_block_height, state_change.blockheight());
+                    }
+                    snapshot_cache_->invalidate(lowest_block_height);
+                }
             } else {
                 if (read_ec.value() == grpc::StatusCode::CANCELLED) {
                     cancelled = true;
@@ -32,6 +32,9 @@
 #include <boost/asio/io_context.hpp>
 
 #include <silkworm/silkrpc/concurrency/context_pool.hpp>
+#include <silkworm/silkrpc/core/chain_config_cache.hpp>
+#include <silkworm/silkrpc/core/state_snapshot_cache.hpp>
+#include <silkworm/silkrpc/ethdb/history_cache.hpp>
 #include <silkworm/silkrpc/ethdb/kv/rpc.hpp>
 #include <silkworm/silkrpc/ethdb/kv/state_cache.hpp>
 #include <silkworm/interfaces/remote/kv.grpc.pb.h>
@@ -88,6 +91,15 @@ private:
     //! The local state cache where the received state changes will be applied
     StateCache* cache_;
 
+    //! The local history cache whose open chunks must be invalidated at each new block
+    HistoryCache* history_cache_;
+
+    //! The shared state snapshot cache whose snapshots must be invalidated for any changed block
+    state::StateSnapshotCache* snapshot_cache_;
+
+    //! The chain config cache invalidated at each (re)opening, because the remote node could have been restarted
+    core::ChainConfigCache* chain_config_cache_;
+
     //! The signal used to cancel the register-and-receive stream loop
     boost::asio::cancellation_signal cancellation_signal_;
 
@@ -25,7 +25,9 @@
 
 #include <silkworm/common/util.hpp>
 #include <silkworm/silkrpc/common/util.hpp>
+#include <silkworm/silkrpc/concurrency/cancellation.hpp>
 #include <silkworm/silkrpc/ethdb/cursor.hpp>
+#include <silkworm/silkrpc/metrics/request_profile.hpp>
 
 namespace silkrpc::ethdb {
 
@@ -47,6 +49,17 @@ public:
     virtual boost::asio::awaitable<std::shared_ptr<CursorDupSort>> cursor_dup_sort(const std::string& table) = 0;
 
     virtual boost::asio::awaitable<void> close() = 0;
+
+    //! Record the cursor ops of cursors opened from now on into \p profile (optional, no recording if null)
+    void set_profile(metrics::RequestProfile* profile) { profile_ = profile; }
+
+    //! Stop the cursor ops of cursors opened from now on when \p cancellation is cancelled (optional, never stopped if null)
+    void set_cancellation(const Cancellation* cancellation) { cancellation_ = cancellation; }
+    const Cancellation* cancellation() const { return cancellation_; }
+
+protected:
+    metrics::RequestProfile* profile_{nullptr};
+    const Cancellation* cancellation_{nullptr};
 };
 
 } // namespace silkrpc::ethdb
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <optional>
 #include <system_error>
@@ -180,11 +181,13 @@ public:
 
     template<typename CompletionToken = agrpc::DefaultCompletionToken>
     auto request_and_read(CompletionToken&& token = {}) {
+        ++round_trips_;
         return boost::asio::async_compose<CompletionToken, void(boost::system::error_code, Reply&)>(RequestAndRead{*this}, token);
     }
 
     template<typename CompletionToken = agrpc::DefaultCompletionToken>
     auto write_and_read(const Request& request, CompletionToken&& token = {}) {
+        ++round_trips_;
         return boost::asio::async_compose<CompletionToken, void(boost::system::error_code, Reply&)>(WriteAndRead{*this, request}, token);
     }
 
@@ -197,6 +200,9 @@ public:
         return grpc_context_.get_executor();
     }
 
+    //! The number of request/reply exchanges started on this stream
+    std::size_t round_trips() const noexcept { return round_trips_; }
+
 private:
     template<typename CompletionToken = agrpc::DefaultCompletionToken>
     auto finish(CompletionToken&& token = {}) {
@@ -209,6 +215,7 @@ private:
     std::unique_ptr<Responder<Request, Reply>> reader_writer_;
     Reply reply_;
     std::optional<grpc::Status> status_;
+    std::size_t round_trips_{0};
 };
 
 } // namespace silkrpc
@@ -24,11 +24,13 @@
 
 #include <exception>
 #include <fstream>
+#include <memory>
 #include <system_error>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include <boost/asio/co_spawn.hpp>
 #include <boost/asio/write.hpp>
 #include <boost/asio/use_awaitable.hpp>
 #include <boost/system/error_code.hpp>
@@ -39,8 +41,11 @@
 
 namespace silkrpc::http {
 
-Connection::Connection(Context& context, boost::asio::thread_pool& workers, commands::RpcApiTable& handler_table, std::optional<std::string> jwt_secret)
-        : socket_{*context.io_context()}, request_handler_{context, workers, socket_, handler_table, jwt_secret} {
+Connection::Connection(Context& context, boost::asio::thread_pool& workers, commands::RpcApiTable& handler_table, std::optional<std::string> jwt_secret,
+    ContextPool* context_pool, AdmissionControl* admission_control)
+        : context_{context}, context_pool_{context_pool}, workers_{workers}, handler_table_{handler_table}, jwt_secret_{jwt_secret},
+          admission_control_{admission_control}, connection_load_{context.load().connections},
+          socket_{*context.io_context()}, request_handler_{context, workers, socket_, handler_table, jwt_secret, admission_control} {
     request_.content.reserve(kRequestContentInitialCapacity);
     request_.headers.reserve(kRequestHeadersInitialCapacity);
     request_.method.reserve(kRequestMethodInitialCapacity);
@@ -67,8 +72,18 @@ boost::asio::awaitable<void> Connection::do_read() {
         RequestParser::ResultType result = request_parser_.parse(request_, buffer_.data(), buffer_.data() + bytes_read);
 
         if (result == RequestParser::good) {
-            co_await request_handler_.handle_request(request_);
+            {
+                ContextLoadScope request_load{context_.load().requests};
+                co_await request_handler_.handle_request(request_);
+            }
             clean();
+
+            // Between requests the connection has no pending operation, so it can move to a less loaded context
+            const auto target = migration_target();
+            if (target) {
+                migrate(*target);
+                co_return;
+            }
         } else if (result == RequestParser::bad) {
             reply_ = Reply::stock_reply(StatusType::bad_request);
             co_await do_write();
@@ -102,6 +117,32 @@ boost::asio::awaitable<void> Connection::do_write() {
     SILKRPC_TRACE << "Connection::do_write bytes_transferred: " << bytes_transferred << "\n" << std::flush;
 }
 
+Context* Connection::migration_target() const {
+    if (!context_pool_) {
+        return nullptr;
+    }
+    auto& least_loaded = context_pool_->least_loaded_context();
+    if (&least_loaded == &context_) {
+        return nullptr;
+    }
+    const auto requests = context_.load().requests.load(std::memory_order_relaxed);
+    const auto least_loaded_requests = least_loaded.load().requests.load(std::memory_order_relaxed);
+    return requests - least_loaded_requests >= kConnectionMigrationLoadGap ? &least_loaded : nullptr;
+}
+
+void Connection::migrate(Context& target) {
+    const auto protocol = socket_.local_endpoint().protocol();
+    auto new_connection = std::make_shared<Connection>(target, workers_, handler_table_, jwt_secret_, context_pool_, admission_control_);
+    // Release the native socket to the new connection: the KV streams and backends used by requests follow its context
+    new_connection->socket().assign(protocol, socket_.release());
+    SILKRPC_DEBUG << "Connection::migrate socket " << &socket_ << " to " << &new_connection->socket() << " io_context: " << target.io_context() << "\n";
+
+    auto new_connection_starter = [=]() -> boost::asio::awaitable<void> { co_await new_connection->start(); };
+    boost::asio::co_spawn(*target.io_context(), new_connection_starter, [](std::exception_ptr eptr) {
+        if (eptr) std::rethrow_exception(eptr);
+    });
+}
+
 void Connection::clean() {
     request_.reset();
     request_parser_.reset();
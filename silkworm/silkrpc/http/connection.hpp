@@ -33,6 +33,7 @@
 
 #include <silkworm/silkrpc/commands/rpc_api_table.hpp>
 #include <silkworm/silkrpc/common/constants.hpp>
+#include <silkworm/silkrpc/concurrency/admission_control.hpp>
 #include <silkworm/silkrpc/concurrency/context_pool.hpp>
 #include <silkworm/silkrpc/http/reply.hpp>
 #include <silkworm/silkrpc/http/request.hpp>
@@ -47,8 +48,9 @@ public:
     Connection(const Connection&) = delete;
     Connection& operator=(const Connection&) = delete;
 
-    /// Construct a connection running within the given execution context.
-    Connection(Context& context, boost::asio::thread_pool& workers, commands::RpcApiTable& handler_table, std::optional<std::string> jwt_secret);
+    /// Construct a connection running within the given execution context, which may migrate to other contexts in the pool (if any).
+    Connection(Context& context, boost::asio::thread_pool& workers, commands::RpcApiTable& handler_table, std::optional<std::string> jwt_secret,
+        ContextPool* context_pool = nullptr, AdmissionControl* admission_control = nullptr);
 
     ~Connection();
 
@@ -67,6 +69,27 @@ private:
     /// Perform an asynchronous write operation.
     boost::asio::awaitable<void> do_write();
 
+    /// Return the context where to move this connection because it is less loaded than the current one, if any.
+    Context* migration_target() const;
+
+    /// Hand over the socket to a new connection running within the \p target context.
+    void migrate(Context& target);
+
+    /// The execution context the connection is bound to.
+    Context& context_;
+
+    /// The pool of contexts where the connection can migrate, if any.
+    ContextPool* context_pool_;
+
+    /// The settings to create the connection continuing this one when migrating.
+    boost::asio::thread_pool& workers_;
+    commands::RpcApiTable& handler_table_;
+    std::optional<std::string> jwt_secret_;
+    AdmissionControl* admission_control_;
+
+    /// Keep the context load updated for the connection lifetime.
+    ContextLoadScope connection_load_;
+
     /// Socket for the connection.
     boost::asio::ip::tcp::socket socket_;
 
@@ -16,16 +16,37 @@
 
 #include "connection.hpp"
 
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_future.hpp>
+#include <boost/asio/write.hpp>
 #include <catch2/catch.hpp>
 #include <grpcpp/grpcpp.h>
 
 #include <silkworm/silkrpc/commands/rpc_api_table.hpp>
+#include <silkworm/silkrpc/common/constants.hpp>
+#include <silkworm/silkrpc/http/response_reader.hpp>
 
 namespace silkrpc::http {
 
 using Catch::Matchers::Message;
 
+//! Send one JSON-RPC request with \p id on \p client and return its reply content
+static std::string send_request(boost::asio::ip::tcp::socket& client, boost::asio::streambuf& buffer, int id) {
+    const std::string content{R"({"jsonrpc":"2.0","id":)" + std::to_string(id) + R"(,"method":"unknown_method","params":[]})"};
+    const std::string request{"POST / HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\nContent-Length: " +
+                              std::to_string(content.size()) + "\r\n\r\n" + content};
+    boost::asio::write(client, boost::asio::buffer(request));
+    return read_response(client, buffer).content;
+}
+
 TEST_CASE("connection creation", "[silkrpc][http][connection]") {
     SILKRPC_LOG_VERBOSITY(LogLevel::None);
 
@@ -46,4 +67,59 @@ TEST_CASE("connection creation", "[silkrpc][http][connection]") {
     }
 }
 
+TEST_CASE("connection migration", "[silkrpc][http][connection]") {
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    ChannelFactory create_channel = []() { return grpc::CreateChannel("localhost", grpc::InsecureChannelCredentials()); };
+    ContextPool context_pool{2, create_channel};
+    context_pool.start();
+    boost::asio::thread_pool workers{1};
+    commands::RpcApiTable handler_table{""};
+    auto& source_context = context_pool.context(0);
+    auto& target_context = context_pool.context(1);
+
+    // Connect one client to a connection running within the source context
+    boost::asio::io_context client_context;
+    boost::asio::ip::tcp::acceptor acceptor{client_context, boost::asio::ip::tcp::endpoint{boost::asio::ip::address_v4::loopback(), 0}};
+    boost::asio::ip::tcp::socket client{client_context};
+    client.connect(acceptor.local_endpoint());
+    auto connection = std::make_unique<Connection>(source_context, workers, handler_table, std::nullopt, &context_pool);
+    acceptor.accept(connection->socket());
+    boost::asio::streambuf buffer;
+
+    // Simulate other requests in flight within the source context until the end of the test, then handle one request
+    std::vector<std::unique_ptr<ContextLoadScope>> source_load;
+    const auto start_with_source_requests = [&](int64_t source_requests) {
+        for (int64_t i{0}; i < source_requests; ++i) {
+            source_load.push_back(std::make_unique<ContextLoadScope>(source_context.load().requests));
+        }
+        auto started = boost::asio::co_spawn(*source_context.io_context(), connection->start(), boost::asio::use_future);
+        CHECK(send_request(client, buffer, 1).find(R"("id":1)") != std::string::npos);
+        return started;
+    };
+
+    SECTION("socket handed over to the less loaded context") {
+        auto started = start_with_source_requests(kConnectionMigrationLoadGap);
+        // The source connection completes as soon as the socket is handed over, the new one lives within the target context
+        CHECK_NOTHROW(started.get());
+        CHECK(!connection->socket().is_open());
+        CHECK(target_context.load().connections.load() == 1);
+        // The next request on the same client connection is served within the target context
+        CHECK(send_request(client, buffer, 2).find(R"("id":2)") != std::string::npos);
+        client.close();
+    }
+
+    SECTION("no migration below the load gap") {
+        auto started = start_with_source_requests(kConnectionMigrationLoadGap - 1);
+        CHECK(send_request(client, buffer, 2).find(R"("id":2)") != std::string::npos);
+        client.close();
+        CHECK_NOTHROW(started.get());
+        CHECK(connection->socket().is_open());
+        CHECK(target_context.load().connections.load() == 0);
+    }
+
+    context_pool.stop();
+    context_pool.join();
+}
+
 } // namespace silkrpc::http
@@ -22,7 +22,10 @@
 
 #include "request_handler.hpp"
 
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -33,13 +36,52 @@
 #include <silkworm/silkrpc/common/clock_time.hpp>
 #include <silkworm/silkrpc/common/log.hpp>
 #include <silkworm/silkrpc/http/header.hpp>
+#include <silkworm/silkrpc/metrics/metrics.hpp>
+#include <silkworm/silkrpc/metrics/request_profile.hpp>
 #include <silkworm/silkrpc/types/writer.hpp>
 
 namespace silkrpc::http {
 
+//! Watch the socket for readability while one request is handled: the client is not supposed to send anything until the reply,
+//! so readable with nothing to read means that the client has closed the connection (pipelined requests are just left to the
+//! next read). Any completion after the end of the request is ignored, because the socket may already belong to someone else.
+class DisconnectionWatch {
+  public:
+    DisconnectionWatch(boost::asio::ip::tcp::socket& socket, std::shared_ptr<Cancellation> cancellation)
+        : socket_(socket), finished_(std::make_shared<bool>(false)) {
+        socket_.async_wait(boost::asio::ip::tcp::socket::wait_read,
+            [&socket, finished = finished_, cancellation = std::move(cancellation)](const boost::system::error_code& ec) {
+                if (*finished || ec == boost::asio::error::operation_aborted) {
+                    return;
+                }
+                boost::system::error_code available_ec;
+                if (ec || socket.available(available_ec) == 0 || available_ec) {
+                    SILKRPC_DEBUG << "DisconnectionWatch: client disconnected from socket " << &socket << "\n";
+                    cancellation->cancel(CancellationReason::client_disconnected);
+                }
+            });
+    }
+
+    ~DisconnectionWatch() {
+        *finished_ = true;
+        boost::system::error_code ec;
+        socket_.cancel(ec);
+    }
+
+    DisconnectionWatch(const DisconnectionWatch&) = delete;
+    DisconnectionWatch& operator=(const DisconnectionWatch&) = delete;
+
+  private:
+    boost::asio::ip::tcp::socket& socket_;
+    std::shared_ptr<bool> finished_;
+};
+
 boost::asio::awaitable<void> RequestHandler::handle_request(const http::Request& request) {
     auto start = clock_time::now();
 
+    cancellation_ = std::make_shared<Cancellation>();
+    DisconnectionWatch disconnection_watch{socket_, cancellation_};
+
     http::Reply reply;
     if (request.content.empty()) {
         reply.content = "";
@@ -117,7 +159,38 @@ boost::asio::awaitable<void> RequestHandler::handle_request(const nlohmann::json
     if (json_handler_opt) {
         const auto json_handler = json_handler_opt.value();
 
-        co_await handle_request(json_handler, request_json, reply);
+        // Only methods available in the API table are measured, so that the set of metrics labels is bounded
+        auto& method_metrics = metrics::registry().method(method);
+        const auto start = clock_time::now();
+        // Watch cancellation while queued too, so that no slot is granted to requests whose client is gone or deadline expired
+        watch_cancellation(method, start);
+        const auto ticket = co_await admit(method);
+        if (!ticket) {
+            make_not_admitted_reply(request_id, method, reply);
+            unwatch_cancellation();
+            method_metrics.errors.add();
+            co_return;
+        }
+        metrics::InFlightScope in_flight{method_metrics.in_flight};
+
+        // Requests are profiled only when the slow request log is enabled
+        std::optional<metrics::RequestProfile> profile;
+        if (metrics::slow_request_threshold().count() > 0) {
+            profile.emplace(start);
+            rpc_api_.profile_ = &*profile;
+        }
+        const auto error_reply = co_await handle_request(json_handler, request_json, reply);
+        rpc_api_.profile_ = nullptr;
+        unwatch_cancellation();
+
+        const auto duration = clock_time::since(start);
+        method_metrics.latency.observe(duration / 1'000);
+        if (error_reply) {
+            method_metrics.errors.add();
+        }
+        if (profile) {
+            metrics::log_if_slow_request(*profile, method, request_json["id"], duration);
+        }
 
         co_return;
     }
@@ -126,7 +199,23 @@ boost::asio::awaitable<void> RequestHandler::handle_request(const nlohmann::json
     if (stream_handler_opt) {
         const auto stream_handler = stream_handler_opt.value();
 
-        co_await handle_request(stream_handler, request_json);
+        auto& method_metrics = metrics::registry().method(method);
+        const auto start = clock_time::now();
+        watch_cancellation(method, start);
+        const auto ticket = co_await admit(method);
+        if (!ticket) {
+            make_not_admitted_reply(request_id, method, reply);
+            unwatch_cancellation();
+            method_metrics.errors.add();
+            co_return;
+        }
+        metrics::InFlightScope in_flight{method_metrics.in_flight};
+        const auto error_reply = co_await handle_request(stream_handler, request_json);
+        unwatch_cancellation();
+        method_metrics.latency.observe(clock_time::since(start) / 1'000);
+        if (error_reply) {
+            method_metrics.errors.add();
+        }
 
         co_return;
     }
@@ -137,15 +226,56 @@ boost::asio::awaitable<void> RequestHandler::handle_request(const nlohmann::json
     co_return;
 }
 
-boost::asio::awaitable<void> RequestHandler::handle_request(silkrpc::commands::RpcApiTable::HandleMethod handler, const nlohmann::json& request_json, http::Reply& reply) {
+boost::asio::awaitable<std::optional<AdmissionControl::Ticket>> RequestHandler::admit(const std::string& method) {
+    if (!admission_control_) {
+        co_return AdmissionControl::Ticket{};
+    }
+    co_return co_await admission_control_->admit(method, cancellation_.get());
+}
+
+void RequestHandler::make_not_admitted_reply(uint32_t request_id, const std::string& method, http::Reply& reply) {
+    if (cancellation_->cancelled()) {
+        // Same reply as for requests cancelled while running
+        reply.content = make_json_error(request_id, 100, RequestCancelled{cancellation_->reason()}.what()).dump();
+        reply.status = http::StatusType::internal_server_error;
+        return;
+    }
+    // Same code as the "limit exceeded" error in EIP-1474, so that clients can back off and retry
+    reply.content = make_json_error(request_id, -32005, "server busy: too many " + method + " requests").dump();
+    reply.status = http::StatusType::service_unavailable;
+}
+
+void RequestHandler::watch_cancellation(const std::string& method, uint64_t start) {
+    const auto timeout = request_deadlines().timeout(method);
+    cancellation_->set_deadline(timeout.count() > 0 ? start + static_cast<uint64_t>(std::chrono::nanoseconds{timeout}.count()) : 0);
+    rpc_api_.EthereumRpcApi::cancellation_ = cancellation_.get();
+    rpc_api_.DebugRpcApi::cancellation_ = cancellation_.get();
+    rpc_api_.TraceRpcApi::cancellation_ = cancellation_.get();
+}
+
+void RequestHandler::unwatch_cancellation() {
+    rpc_api_.EthereumRpcApi::cancellation_ = nullptr;
+    rpc_api_.DebugRpcApi::cancellation_ = nullptr;
+    rpc_api_.TraceRpcApi::cancellation_ = nullptr;
+    if (cancellation_->cancelled()) {
+        metrics::registry().requests_cancelled().add();
+    }
+}
+
+boost::asio::awaitable<bool> RequestHandler::handle_request(silkrpc::commands::RpcApiTable::HandleMethod handler, const nlohmann::json& request_json, http::Reply& reply) {
     auto request_id = request_json["id"].get<uint32_t>();
     try {
         nlohmann::json reply_json;
         co_await (rpc_api_.*handler)(request_json, reply_json);
 
+        const auto serialization_start = clock_time::now();
         reply.content = reply_json.dump(
             /*indent=*/-1, /*indent_char=*/' ', /*ensure_ascii=*/false, nlohmann::json::error_handler_t::replace);
+        if (rpc_api_.profile_) {
+            rpc_api_.profile_->add_serialization(serialization_start, clock_time::now());
+        }
         reply.status = http::StatusType::ok;
+        co_return reply_json.contains("error");
     } catch (const std::exception& e) {
         SILKRPC_ERROR << "exception: " << e.what() << "\n";
         reply.content = make_json_error(request_id, 100, e.what()).dump();
@@ -156,10 +286,10 @@ boost::asio::awaitable<void> RequestHandler::handle_request(silkrpc::commands::R
         reply.status = http::StatusType::internal_server_error;
     }
 
-    co_return;
+    co_return true;
 }
 
-boost::asio::awaitable<void> RequestHandler::handle_request(silkrpc::commands::RpcApiTable::HandleStream handler, const nlohmann::json& request_json) {
+boost::asio::awaitable<bool> RequestHandler::handle_request(silkrpc::commands::RpcApiTable::HandleStream handler, const nlohmann::json& request_json) {
     try {
         SocketWriter socket_writer(socket_);
         ChunksWriter chunks_writer(socket_writer);
@@ -169,13 +299,15 @@ boost::asio::awaitable<void> RequestHandler::handle_request(silkrpc::commands::R
         co_await (rpc_api_.*handler)(request_json, stream);
 
         stream.close();
+        co_return stream.error_written();
     } catch (const std::exception& e) {
         SILKRPC_ERROR << "exception: " << e.what() << "\n";
     } catch (...) {
         SILKRPC_ERROR << "unexpected exception\n";
     }
 
-    co_return;
+    // The reply is truncated after the headers have been sent, so the client gets no valid JSON-RPC reply
+    co_return true;
 }
 
 boost::asio::awaitable<std::optional<std::string>> RequestHandler::is_request_authorized(uint32_t request_id, const http::Request& request) {
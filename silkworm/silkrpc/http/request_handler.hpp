@@ -26,6 +26,8 @@
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/thread_pool.hpp>
 
+#include <silkworm/silkrpc/concurrency/admission_control.hpp>
+#include <silkworm/silkrpc/concurrency/cancellation.hpp>
 #include <silkworm/silkrpc/concurrency/context_pool.hpp>
 #include <silkworm/silkrpc/commands/rpc_api.hpp>
 #include <silkworm/silkrpc/commands/rpc_api_table.hpp>
@@ -38,8 +40,9 @@ class RequestHandler {
 public:
     RequestHandler(Context& context, boost::asio::thread_pool& workers,
         boost::asio::ip::tcp::socket& socket, const commands::RpcApiTable& rpc_api_table,
-        std::optional<std::string> jwt_secret)
-        : rpc_api_{context, workers}, io_context_{*context.io_context()}, socket_{socket}, rpc_api_table_(rpc_api_table), jwt_secret_(jwt_secret)  {}
+        std::optional<std::string> jwt_secret, AdmissionControl* admission_control = nullptr)
+        : rpc_api_{context, workers}, io_context_{*context.io_context()}, socket_{socket}, rpc_api_table_(rpc_api_table), jwt_secret_(jwt_secret),
+          admission_control_(admission_control) {}
 
     RequestHandler(const RequestHandler&) = delete;
     RequestHandler& operator=(const RequestHandler&) = delete;
@@ -49,9 +52,21 @@ public:
 private:
     boost::asio::awaitable<std::optional<std::string>> is_request_authorized(uint32_t request_id, const http::Request& request);
 
+    //! Wait for the admission of one request of \p method, return no ticket if it must be shed
+    boost::asio::awaitable<std::optional<AdmissionControl::Ticket>> admit(const std::string& method);
+    //! Reply to one request of \p method not admitted, either because shed or because cancelled while queued
+    void make_not_admitted_reply(uint32_t request_id, const std::string& method, http::Reply& reply);
+
+    //! Make the APIs stop the work of one request of \p method started at \p start when the client disconnects or its deadline expires
+    void watch_cancellation(const std::string& method, uint64_t start);
+    //! Detach the APIs from the cancellation of the request just handled
+    void unwatch_cancellation();
+
     boost::asio::awaitable<void> handle_request(const nlohmann::json& request_json, http::Reply& reply);
-    boost::asio::awaitable<void> handle_request(silkrpc::commands::RpcApiTable::HandleMethod handler, const nlohmann::json& request_json, http::Reply& reply);
-    boost::asio::awaitable<void> handle_request(silkrpc::commands::RpcApiTable::HandleStream handler, const nlohmann::json& request_json);
+    //! Return true if the reply is a JSON-RPC error, either thrown or returned by \p handler
+    boost::asio::awaitable<bool> handle_request(silkrpc::commands::RpcApiTable::HandleMethod handler, const nlohmann::json& request_json, http::Reply& reply);
+    //! Return true if the streamed reply is a JSON-RPC error or has been truncated by an exception thrown by \p handler
+    boost::asio::awaitable<bool> handle_request(silkrpc::commands::RpcApiTable::HandleStream handler, const nlohmann::json& request_json);
 
     boost::asio::awaitable<void> do_write(http::Reply& reply);
     boost::asio::awaitable<void> write_headers();
@@ -61,6 +76,10 @@ private:
     boost::asio::ip::tcp::socket& socket_;
     const commands::RpcApiTable& rpc_api_table_;
     const std::optional<std::string> jwt_secret_;
+    //! The limits on concurrent requests by namespace, if any
+    AdmissionControl* admission_control_;
+    //! The cancellation of the HTTP request being handled, shared with the watch of the socket for client disconnection
+    std::shared_ptr<Cancellation> cancellation_;
 };
 
 } // namespace silkrpc::http
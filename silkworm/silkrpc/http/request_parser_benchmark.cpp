@@ -0,0 +1,52 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "request_parser.hpp"
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+namespace silkrpc::http {
+
+static std::string make_request(std::size_t data_size) {
+    const std::string content{R"({"jsonrpc":"2.0","id":1,"method":"eth_call","params":[{"to":"0x0715a7794a1dc8e42615f059dd6e406a6594651a","data":"0x)" +
+        std::string(data_size, 'a') + R"("},"latest"]})"};
+    return "POST / HTTP/1.1\r\n"
+        "Host: localhost:8545\r\n"
+        "User-Agent: silkrpc_bench\r\n"
+        "Accept: */*\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: " + std::to_string(content.size()) + "\r\n"
+        "\r\n" + content;
+}
+
+static void benchmark_request_parser_parse(benchmark::State& state) {
+    const auto request_data{make_request(static_cast<std::size_t>(state.range(0)))};
+    RequestParser parser;
+    Request request;
+    for (auto _ : state) {
+        parser.reset();
+        request.reset();
+        const auto result = parser.parse(request, request_data.cbegin(), request_data.cend());
+        benchmark::DoNotOptimize(result);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * request_data.size()));
+}
+
+BENCHMARK(benchmark_request_parser_parse)->Arg(64)->Arg(4'096)->Arg(131'072);
+
+} // namespace silkrpc::http
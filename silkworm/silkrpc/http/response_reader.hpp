@@ -0,0 +1,91 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <string>
+
+#include <boost/asio/buffers_iterator.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+
+namespace silkrpc::http {
+
+//! HTTP/1.1 response read by a client
+struct Response {
+    std::string headers;  // status line and headers in lower case
+    std::string content;  // body decoded from either Content-Length or chunked Transfer-Encoding
+};
+
+namespace detail {
+
+//! Move the first \p size bytes of \p buffer into a string
+inline std::string take(boost::asio::streambuf& buffer, std::size_t size) {
+    std::string bytes{boost::asio::buffers_begin(buffer.data()), boost::asio::buffers_begin(buffer.data()) + static_cast<std::ptrdiff_t>(size)};
+    buffer.consume(size);
+    return bytes;
+}
+
+//! Make sure that \p buffer holds at least \p size bytes
+template <typename SyncReadStream>
+void fill(SyncReadStream& stream, boost::asio::streambuf& buffer, std::size_t size) {
+    if (buffer.size() < size) {
+        boost::asio::read(stream, buffer, boost::asio::transfer_exactly(size - buffer.size()));
+    }
+}
+
+} // namespace detail
+
+//! Read one HTTP/1.1 response from \p stream. Bytes read past the end of the response are left in \p buffer for the next one
+template <typename SyncReadStream>
+Response read_response(SyncReadStream& stream, boost::asio::streambuf& buffer) {
+    Response response;
+    response.headers = detail::take(buffer, boost::asio::read_until(stream, buffer, "\r\n\r\n"));
+    auto& headers = response.headers;
+    std::transform(headers.begin(), headers.end(), headers.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if (headers.find("transfer-encoding: chunked") != std::string::npos) {
+        // Each chunk is its hex size (plus optional extensions) and CRLF, then the data and CRLF. The last chunk has zero size
+        // and is followed by optional trailers and an empty line
+        while (true) {
+            const auto chunk_size = std::stoul(detail::take(buffer, boost::asio::read_until(stream, buffer, "\r\n")), nullptr, 16);
+            if (chunk_size == 0) {
+                while (detail::take(buffer, boost::asio::read_until(stream, buffer, "\r\n")) != "\r\n") {}
+                break;
+            }
+            detail::fill(stream, buffer, chunk_size + 2);
+            response.content.append(detail::take(buffer, chunk_size));
+            buffer.consume(2);
+        }
+        return response;
+    }
+
+    std::size_t content_length{0};
+    const auto content_length_position = headers.find("content-length:");
+    if (content_length_position != std::string::npos) {
+        content_length = std::stoul(headers.substr(content_length_position + std::char_traits<char>::length("content-length:")));
+    }
+    detail::fill(stream, buffer, content_length);
+    response.content = detail::take(buffer, content_length);
+    return response;
+}
+
+} // namespace silkrpc::http
+
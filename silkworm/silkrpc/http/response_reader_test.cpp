@@ -0,0 +1,114 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "response_reader.hpp"
+
+#include <string>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/connect_pair.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/write.hpp>
+#include <catch2/catch.hpp>
+#include <nlohmann/json.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/http/header.hpp>
+#include <silkworm/silkrpc/http/reply.hpp>
+#include <silkworm/silkrpc/json/stream.hpp>
+#include <silkworm/silkrpc/types/writer.hpp>
+
+namespace silkrpc::http {
+
+//! Serialize the status line and headers exactly as the server does
+static std::string make_headers(const std::vector<Header>& headers) {
+    std::string serialized;
+    for (const auto& buffer : to_buffers(StatusType::ok, headers)) {
+        serialized.append(static_cast<const char*>(buffer.data()), buffer.size());
+    }
+    return serialized;
+}
+
+TEST_CASE("read_response", "[silkrpc][http][response_reader]") {
+    SILKRPC_LOG_STREAMS(null_stream(), null_stream());
+    SILKRPC_LOG_VERBOSITY(LogLevel::None);
+
+    boost::asio::io_context io_context;
+    boost::asio::local::stream_protocol::socket server{io_context};
+    boost::asio::local::stream_protocol::socket client{io_context};
+    boost::asio::local::connect_pair(server, client);
+    boost::asio::streambuf buffer;
+
+    const std::string reply_content{R"({"jsonrpc":"2.0","id":1,"result":"0x1"})"};
+    const std::string content_length_response{
+        make_headers({{"Content-Length", std::to_string(reply_content.size())}, {"Content-Type", "application/json"}}) + reply_content};
+
+    SECTION("Content-Length") {
+        boost::asio::write(server, boost::asio::buffer(content_length_response));
+        const auto response{read_response(client, buffer)};
+        CHECK(response.headers.starts_with("http/1.1 200"));
+        CHECK(response.content == reply_content);
+        CHECK(buffer.size() == 0);
+    }
+
+    SECTION("chunked Transfer-Encoding from a stream method") {
+        // Produce the body as the server does for the methods writing on json::Stream, using tiny chunks to get many of them
+        StringWriter string_writer;
+        ChunksWriter chunks_writer{string_writer, 16};
+        json::Stream stream{chunks_writer};
+        stream.open_object();
+        stream.write_field("jsonrpc", "2.0");
+        stream.write_field("id", 1);
+        stream.write_field("result");
+        stream.open_array();
+        for (int i{0}; i < 10; ++i) {
+            stream.write_json(nlohmann::json{{"index", i}});
+        }
+        stream.close_array();
+        stream.close_object();
+        stream.close();
+
+        const auto chunked_response{make_headers({{"Content-Type", "application/json"}, {"Transfer-Encoding", "chunked"}}) + string_writer.get_content()};
+        boost::asio::write(server, boost::asio::buffer(chunked_response));
+        const auto response{read_response(client, buffer)};
+        CHECK(response.headers.starts_with("http/1.1 200"));
+        const auto json = nlohmann::json::parse(response.content);
+        CHECK(json["id"] == 1);
+        REQUIRE(json["result"].size() == 10);
+        CHECK(json["result"][9]["index"] == 9);
+        CHECK(buffer.size() == 0);
+    }
+
+    SECTION("chunked with extensions and trailers") {
+        const std::string chunked_response{make_headers({{"Transfer-Encoding", "chunked"}}) + "4;ext=1\r\n{\"a\"\r\n3\r\n:1}\r\n0\r\nX-Trailer: t\r\n\r\n"};
+        boost::asio::write(server, boost::asio::buffer(chunked_response));
+        const auto response{read_response(client, buffer)};
+        CHECK(response.content == R"({"a":1})");
+        CHECK(buffer.size() == 0);
+    }
+
+    SECTION("pipelined responses") {
+        const std::string chunked_response{make_headers({{"Transfer-Encoding", "chunked"}}) + "2\r\n{}\r\n0\r\n\r\n"};
+        boost::asio::write(server, boost::asio::buffer(chunked_response + content_length_response));
+        CHECK(read_response(client, buffer).content == "{}");
+        CHECK(read_response(client, buffer).content == reply_content);
+        CHECK(buffer.size() == 0);
+    }
+}
+
+} // namespace silkrpc::http
+
@@ -50,8 +50,9 @@ std::tuple<std::string, std::string> Server::parse_endpoint(const std::string& t
     return {host, port};
 }
 
-Server::Server(const std::string& end_point, const std::string& api_spec, Context& context, boost::asio::thread_pool& workers, std::optional<std::string> jwt_secret)
-: context_(context), workers_(workers), acceptor_{*context.io_context()}, handler_table_{api_spec}, jwt_secret_(jwt_secret) {
+Server::Server(const std::string& end_point, const std::string& api_spec, Context& context, boost::asio::thread_pool& workers, std::optional<std::string> jwt_secret,
+    ContextPool* context_pool, AdmissionControl* admission_control)
+: context_(context), context_pool_(context_pool), admission_control_(admission_control), workers_(workers), acceptor_{*context.io_context()}, handler_table_{api_spec}, jwt_secret_(jwt_secret) {
     const auto [host, port] = parse_endpoint(end_point);
 
     // Open the acceptor with the option to reuse the address (i.e. SO_REUSEADDR).
@@ -74,11 +75,13 @@ boost::asio::awaitable<void> Server::run() {
 
     try {
         while (acceptor_.is_open()) {
-            auto io_context = context_.io_context();
+            // New connections go to the least loaded context, not necessarily the accepting one
+            auto& context = context_pool_ ? context_pool_->least_loaded_context() : context_;
+            auto io_context = context.io_context();
 
             SILKRPC_DEBUG << "Server::run accepting using io_context " << io_context << "...\n" << std::flush;
 
-            auto new_connection = std::make_shared<Connection>(context_, workers_, handler_table_, jwt_secret_);
+            auto new_connection = std::make_shared<Connection>(context, workers_, handler_table_, jwt_secret_, context_pool_, admission_control_);
             co_await acceptor_.async_accept(new_connection->socket(), boost::asio::use_awaitable);
             if (!acceptor_.is_open()) {
                 SILKRPC_TRACE << "Server::run returning...\n";
@@ -32,6 +32,7 @@
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/thread_pool.hpp>
 
+#include <silkworm/silkrpc/concurrency/admission_control.hpp>
 #include <silkworm/silkrpc/concurrency/context_pool.hpp>
 #include <silkworm/silkrpc/http/request_handler.hpp>
 
@@ -45,8 +46,10 @@ public:
     Server(const Server&) = delete;
     Server& operator=(const Server&) = delete;
 
-    // Construct the server to listen on the specified local TCP end-point
-    explicit Server(const std::string& end_point, const std::string& api_spec, Context& context, boost::asio::thread_pool& workers, std::optional<std::string> jwt_secret);
+    // Construct the server to listen on the specified local TCP end-point, balancing connections on the pool contexts (if any)
+    // and admitting requests under the given limits (if any)
+    explicit Server(const std::string& end_point, const std::string& api_spec, Context& context, boost::asio::thread_pool& workers, std::optional<std::string> jwt_secret,
+        ContextPool* context_pool = nullptr, AdmissionControl* admission_control = nullptr);
 
     void start();
 
@@ -63,6 +66,12 @@ private:
     // The context used to perform asynchronous operations
     Context& context_;
 
+    // The pool of contexts where connections are balanced, if any
+    ContextPool* context_pool_;
+
+    // The limits on concurrent requests by namespace, if any
+    AdmissionControl* admission_control_;
+
     // The acceptor used to listen for incoming TCP connections
     boost::asio::ip::tcp::acceptor acceptor_;
 
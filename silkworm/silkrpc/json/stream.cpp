@@ -92,6 +92,10 @@ void Stream::write_field(const std::string& name) {
 
 void Stream::write_field(const std::string& name, const nlohmann::json& value) {
     ensure_separator();
+    // The outermost object has just its own open marker and the field marker on the stack
+    if (stack_.size() == 2 && name == "error") {
+        error_written_ = true;
+    }
 
     const auto content = value.dump(/*indent=*/-1, /*indent_char=*/' ', /*ensure_ascii=*/false, nlohmann::json::error_handler_t::replace);
 
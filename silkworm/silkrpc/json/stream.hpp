@@ -47,12 +47,16 @@ public:
     void write_field(const std::string& name);
     void write_field(const std::string& name, const nlohmann::json& value);
 
+    //! Return true if the "error" field has been written in the outermost object, i.e. the JSON-RPC reply is an error
+    bool error_written() const { return error_written_; }
+
 private:
     void write_string(const std::string& str);
     void ensure_separator();
 
     silkrpc::Writer& writer_;
     std::stack<std::uint8_t> stack_;
+    bool error_written_{false};
 };
 
 } // namespace json
@@ -0,0 +1,80 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "stream.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <silkworm/silkrpc/types/writer.hpp>
+
+namespace json {
+
+//! Write an array of entries shaped like the debug_traceTransaction struct logs, i.e. the main streaming use case
+static void write_struct_logs(Stream& stream, int64_t num_entries) {
+    stream.open_object();
+    stream.write_field("jsonrpc", "2.0");
+    stream.write_field("id", 1);
+    stream.write_field("result");
+    stream.open_object();
+    stream.write_field("structLogs");
+    stream.open_array();
+    for (int64_t i{0}; i < num_entries; ++i) {
+        stream.open_object();
+        stream.write_field("depth", 1);
+        stream.write_field("gas", 29'000'000 - i * 3);
+        stream.write_field("gasCost", 3);
+        stream.write_field("op", "PUSH1");
+        stream.write_field("pc", i);
+        stream.write_field("stack");
+        stream.open_array();
+        stream.write_json("0x0");
+        stream.write_json("0x60");
+        stream.write_json("0xddf252ad1be2c89b69c2b068fc378daa952ba7f163c4a11628f55a4df523b3ef");
+        stream.close_array();
+        stream.close_object();
+    }
+    stream.close_array();
+    stream.close_object();
+    stream.close_object();
+}
+
+static void benchmark_stream_string_writer(benchmark::State& state) {
+    for (auto _ : state) {
+        silkrpc::StringWriter writer;
+        Stream stream{writer};
+        write_struct_logs(stream, state.range(0));
+        benchmark::DoNotOptimize(writer.get_content().size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(benchmark_stream_string_writer)->Arg(1'000)->Arg(100'000);
+
+static void benchmark_stream_chunks_writer(benchmark::State& state) {
+    for (auto _ : state) {
+        silkrpc::StringWriter writer;
+        silkrpc::ChunksWriter chunks_writer{writer};
+        Stream stream{chunks_writer};
+        write_struct_logs(stream, state.range(0));
+        stream.close();
+        benchmark::DoNotOptimize(writer.get_content().size());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(benchmark_stream_chunks_writer)->Arg(1'000)->Arg(100'000);
+
+} // namespace json
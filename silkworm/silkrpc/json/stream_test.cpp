@@ -145,6 +145,27 @@ TEST_CASE("JsonStream calls") {
 
         CHECK(string_writer.get_content() == "{\"name1\":\"value1\",\"name2\":\"value2\"}");
     }
+    SECTION("error field in outermost object") {
+        stream.open_object();
+        stream.write_field("id", 1);
+        CHECK(!stream.error_written());
+        stream.write_field("error", EMPTY_OBJECT);
+        stream.close_object();
+        stream.close();
+
+        CHECK(stream.error_written());
+    }
+    SECTION("error field in nested object") {
+        stream.open_object();
+        stream.write_field("result");
+        stream.open_object();
+        stream.write_field("error", EMPTY_OBJECT);
+        stream.close_object();
+        stream.close_object();
+        stream.close();
+
+        CHECK(!stream.error_written());
+    }
     SECTION("complex object 1") {
         nlohmann::json json = R"({
             "test": "test"
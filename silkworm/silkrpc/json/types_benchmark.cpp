@@ -0,0 +1,100 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "types.hpp"
+
+#include <benchmark/benchmark.h>
+#include <evmc/evmc.hpp>
+#include <silkworm/common/util.hpp>
+
+namespace silkrpc {
+
+using namespace evmc::literals;  // NOLINT(build/namespaces_literals)
+
+static constexpr auto kBenchAddress{0x0715a7794a1dc8e42615f059dd6e406a6594651a_address};
+static constexpr auto kBenchHash{0x8e38b4dbf6b11fcc3b9dee84fb7986e29ca0a02cecd8977c161ff7333329681e_bytes32};
+static constexpr auto kBenchTopic{0xddf252ad1be2c89b69c2b068fc378daa952ba7f163c4a11628f55a4df523b3ef_bytes32};
+
+static Block make_block(std::size_t num_transactions) {
+    Block block;
+    block.hash = kBenchHash;
+    block.full_tx = true;
+    auto& header = block.block.header;
+    header.number = 15'000'000;
+    header.parent_hash = kBenchHash;
+    header.beneficiary = kBenchAddress;
+    header.gas_limit = 30'000'000;
+    header.gas_used = 15'000'000;
+    header.base_fee_per_gas = 10'000'000'000;
+    header.extra_data = *silkworm::from_hex("d883010a17846765746888676f312e31382e35856c696e7578");
+    block.block.transactions.resize(num_transactions);
+    for (std::size_t i{0}; i < num_transactions; ++i) {
+        auto& txn = block.block.transactions[i];
+        txn.type = silkworm::Transaction::Type::kEip1559;
+        txn.nonce = i;
+        txn.chain_id = 1;
+        txn.max_priority_fee_per_gas = 1'000'000'000;
+        txn.max_fee_per_gas = 20'000'000'000;
+        txn.gas_limit = 21'000;
+        txn.to = kBenchAddress;
+        txn.value = 1'000'000'000'000'000'000;
+        txn.data = silkworm::Bytes(68, 0x11);
+        txn.r = intx::be::load<intx::uint256>(kBenchHash);
+        txn.s = intx::be::load<intx::uint256>(kBenchTopic);
+        txn.from = kBenchAddress;  // avoid sender recovery, we measure serialization only
+    }
+    return block;
+}
+
+static Logs make_logs(std::size_t num_logs) {
+    Logs logs(num_logs);
+    for (std::size_t i{0}; i < num_logs; ++i) {
+        auto& log = logs[i];
+        log.address = kBenchAddress;
+        log.topics = {kBenchTopic, kBenchHash, kBenchHash};
+        log.data = silkworm::Bytes(32, 0x22);
+        log.block_number = 15'000'000;
+        log.tx_hash = kBenchHash;
+        log.tx_index = static_cast<uint32_t>(i / 4);
+        log.block_hash = kBenchHash;
+        log.index = static_cast<uint32_t>(i);
+    }
+    return logs;
+}
+
+static void benchmark_to_json_block(benchmark::State& state) {
+    const auto block{make_block(static_cast<std::size_t>(state.range(0)))};
+    for (auto _ : state) {
+        const nlohmann::json json = block;
+        benchmark::DoNotOptimize(json.dump());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * block.block.transactions.size()));
+}
+
+BENCHMARK(benchmark_to_json_block)->Arg(0)->Arg(200)->Arg(1'000);
+
+static void benchmark_to_json_logs(benchmark::State& state) {
+    const auto logs{make_logs(static_cast<std::size_t>(state.range(0)))};
+    for (auto _ : state) {
+        const nlohmann::json json = logs;
+        benchmark::DoNotOptimize(json.dump());
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * logs.size()));
+}
+
+BENCHMARK(benchmark_to_json_logs)->Arg(100)->Arg(10'000);
+
+} // namespace silkrpc
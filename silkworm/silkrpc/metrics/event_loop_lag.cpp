@@ -0,0 +1,44 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "event_loop_lag.hpp"
+
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/system/system_error.hpp>
+
+namespace silkrpc::metrics {
+
+boost::asio::awaitable<void> probe_event_loop_lag(Histogram& lag, std::chrono::milliseconds period) {
+    boost::asio::steady_timer timer{co_await boost::asio::this_coro::executor};
+    try {
+        while (true) {
+            const auto expected_expiry = std::chrono::steady_clock::now() + period;
+            timer.expires_at(expected_expiry);
+            co_await timer.async_wait(boost::asio::use_awaitable);
+            const auto delay = std::chrono::steady_clock::now() - expected_expiry;
+            lag.observe(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(delay).count()));
+        }
+    } catch (const boost::system::system_error& se) {
+        if (se.code() != boost::asio::error::operation_aborted) {
+            throw;
+        }
+    }
+}
+
+} // namespace silkrpc::metrics
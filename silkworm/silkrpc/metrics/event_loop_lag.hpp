@@ -0,0 +1,35 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#pragma once
+
+#include <chrono>
+
+#include <silkworm/silkrpc/config.hpp>
+
+#include <boost/asio/awaitable.hpp>
+
+#include <silkworm/silkrpc/metrics/metrics.hpp>
+
+namespace silkrpc::metrics {
+
+constexpr std::chrono::milliseconds kEventLoopLagPeriod{100};
+
+//! Arm a timer every \p period on the executing event loop and record into \p lag how late it fires, until cancelled
+boost::asio::awaitable<void> probe_event_loop_lag(Histogram& lag, std::chrono::milliseconds period = kEventLoopLagPeriod);
+
+} // namespace silkrpc::metrics
@@ -0,0 +1,198 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace silkrpc::metrics {
+
+//! Scale applied to microsecond observations to expose them in seconds, as per Prometheus conventions
+constexpr double kMicrosToSeconds{1e-6};
+
+const std::vector<uint64_t> kLatencyBuckets{
+    50, 100, 250, 500, 1'000, 2'500, 5'000, 10'000, 25'000, 50'000, 100'000, 250'000, 500'000, 1'000'000, 2'500'000, 5'000'000, 10'000'000
+};
+
+const std::vector<uint64_t> kRoundTripBuckets{1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1'024, 2'048, 4'096};
+
+std::size_t this_thread_shard() noexcept {
+    static std::atomic_size_t next_shard{0};
+    thread_local const std::size_t shard{next_shard.fetch_add(1, std::memory_order_relaxed) % kMaxShards};
+    return shard;
+}
+
+uint64_t Counter::value() const noexcept {
+    uint64_t total{0};
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+int64_t Gauge::value() const noexcept {
+    int64_t total{0};
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+uint64_t HistogramSnapshot::count() const noexcept {
+    uint64_t total{0};
+    for (const auto bucket : buckets) {
+        total += bucket;
+    }
+    return total;
+}
+
+Histogram::Histogram(std::vector<uint64_t> bounds) : bounds_(std::move(bounds)), shards_{std::make_unique<Shard[]>(kMaxShards)} {
+    if (bounds_.empty() || bounds_.size() > kMaxBuckets) {
+        throw std::invalid_argument{"invalid histogram bucket count: " + std::to_string(bounds_.size())};
+    }
+    if (!std::is_sorted(bounds_.cbegin(), bounds_.cend())) {
+        throw std::invalid_argument{"unsorted histogram bucket bounds"};
+    }
+}
+
+void Histogram::observe(uint64_t value) noexcept {
+    const auto bucket = std::lower_bound(bounds_.cbegin(), bounds_.cend(), value) - bounds_.cbegin();
+    auto& shard = shards_[this_thread_shard()];
+    shard.buckets[static_cast<std::size_t>(bucket)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot snapshot{bounds_, std::vector<uint64_t>(bounds_.size() + 1, 0), 0};
+    for (std::size_t s{0}; s < kMaxShards; ++s) {
+        const auto& shard = shards_[s];
+        for (std::size_t i{0}; i < snapshot.buckets.size(); ++i) {
+            snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+//! Each registry gets a unique identifier, so that per-thread lookup caches never outlive nor mix up registries
+static std::atomic_uint64_t next_registry_id{0};
+
+Registry::Registry() : id_{next_registry_id.fetch_add(1, std::memory_order_relaxed)} {}
+
+MethodMetrics& Registry::method(std::string_view method) {
+    thread_local absl::flat_hash_map<uint64_t, absl::flat_hash_map<std::string, MethodMetrics*>> thread_cache;
+    auto& cache = thread_cache[id_];
+    const auto cached = cache.find(absl::string_view{method.data(), method.size()});
+    if (cached != cache.end()) {
+        return *cached->second;
+    }
+
+    std::scoped_lock lock{access_};
+    auto it = methods_.find(method);
+    if (it == methods_.end()) {
+        it = methods_.emplace(std::string{method}, std::make_unique<MethodMetrics>()).first;
+    }
+    cache.emplace(std::string{method}, it->second.get());
+    return *it->second;
+}
+
+Histogram& Registry::event_loop_lag(std::size_t context_index) {
+    std::scoped_lock lock{access_};
+    auto& lag = event_loop_lags_[context_index];
+    if (!lag) {
+        lag = std::make_unique<Histogram>(kLatencyBuckets);
+    }
+    return *lag;
+}
+
+void Registry::add_collector(Collector collector) {
+    std::scoped_lock lock{access_};
+    collectors_.push_back(std::move(collector));
+}
+
+static void write_header(std::ostream& out, std::string_view name, std::string_view help, std::string_view type) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+static void write_histogram(std::ostream& out, std::string_view name, const std::string& labels, const HistogramSnapshot& snapshot, double scale) {
+    const auto separator = labels.empty() ? "" : ",";
+    uint64_t cumulative{0};
+    for (std::size_t i{0}; i < snapshot.bounds.size(); ++i) {
+        cumulative += snapshot.buckets[i];
+        out << name << "_bucket{" << labels << separator << "le=\"" << static_cast<double>(snapshot.bounds[i]) * scale << "\"} " << cumulative << "\n";
+    }
+    cumulative += snapshot.buckets.back();
+    out << name << "_bucket{" << labels << separator << "le=\"+Inf\"} " << cumulative << "\n";
+    const auto braced_labels = labels.empty() ? std::string{} : "{" + labels + "}";
+    out << name << "_sum" << braced_labels << " " << static_cast<double>(snapshot.sum) * scale << "\n";
+    out << name << "_count" << braced_labels << " " << cumulative << "\n";
+}
+
+void write_counter(std::ostream& out, std::string_view name, std::string_view help, uint64_t value) {
+    write_header(out, name, help, "counter");
+    out << name << " " << value << "\n";
+}
+
+void write_gauge(std::ostream& out, std::string_view name, std::string_view help, double value) {
+    write_header(out, name, help, "gauge");
+    out << name << " " << value << "\n";
+}
+
+void Registry::write_text(std::ostream& out) const {
+    std::scoped_lock lock{access_};
+
+    write_header(out, "silkrpc_request_duration_seconds", "JSON-RPC request latency by method", "histogram");
+    for (const auto& [method, metrics] : methods_) {
+        write_histogram(out, "silkrpc_request_duration_seconds", "method=\"" + method + "\"", metrics->latency.snapshot(), kMicrosToSeconds);
+    }
+    write_header(out, "silkrpc_requests_in_flight", "JSON-RPC requests currently being handled by method", "gauge");
+    for (const auto& [method, metrics] : methods_) {
+        out << "silkrpc_requests_in_flight{method=\"" << method << "\"} " << metrics->in_flight.value() << "\n";
+    }
+    write_header(out, "silkrpc_request_errors_total", "JSON-RPC requests failed by method", "counter");
+    for (const auto& [method, metrics] : methods_) {
+        out << "silkrpc_request_errors_total{method=\"" << method << "\"} " << metrics->errors.value() << "\n";
+    }
+
+    write_header(out, "silkrpc_kv_round_trips", "KV round-trips performed by each remote transaction", "histogram");
+    write_histogram(out, "silkrpc_kv_round_trips", {}, kv_round_trips_.snapshot(), 1.0);
+
+    write_gauge(out, "silkrpc_worker_queue_depth", "Tasks posted to the worker pool and not yet started", static_cast<double>(worker_queue_depth_.value()));
+
+    write_counter(out, "silkrpc_requests_cancelled_total", "Requests cancelled because the client disconnected or the deadline expired", requests_cancelled_.value());
+
+    write_header(out, "silkrpc_event_loop_lag_seconds", "Delay of periodic timers on the event loop by context", "histogram");
+    for (const auto& [context_index, lag] : event_loop_lags_) {
+        write_histogram(out, "silkrpc_event_loop_lag_seconds", "context=\"" + std::to_string(context_index) + "\"", lag->snapshot(), kMicrosToSeconds);
+    }
+
+    for (const auto& collector : collectors_) {
+        collector(out);
+    }
+}
+
+Registry& registry() {
+    static Registry process_registry;
+    return process_registry;
+}
+
+} // namespace silkrpc::metrics
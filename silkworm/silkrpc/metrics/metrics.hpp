@@ -0,0 +1,185 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace silkrpc::metrics {
+
+//! Max number of per-thread shards in each metric, threads beyond this number share shards (still correct, just contended)
+constexpr std::size_t kMaxShards{32};
+
+//! Max number of finite buckets in each histogram
+constexpr std::size_t kMaxBuckets{24};
+
+//! Size of the cache line used to keep shards written by different threads apart
+constexpr std::size_t kCacheLineSize{64};
+
+//! Index of the shard owned by the calling thread, assigned round-robin at first use
+std::size_t this_thread_shard() noexcept;
+
+//! Monotonic counter split into per-thread shards: \ref add is one uncontended relaxed atomic increment
+class Counter {
+public:
+    void add(uint64_t value = 1) noexcept { shards_[this_thread_shard()].value.fetch_add(value, std::memory_order_relaxed); }
+
+    uint64_t value() const noexcept;
+
+private:
+    struct alignas(kCacheLineSize) Shard {
+        std::atomic_uint64_t value{0};
+    };
+    std::array<Shard, kMaxShards> shards_;
+};
+
+//! Up/down gauge split into per-thread shards: increment and decrement may happen on different threads, only the sum matters
+class Gauge {
+public:
+    void add(int64_t value) noexcept { shards_[this_thread_shard()].value.fetch_add(value, std::memory_order_relaxed); }
+    void increment() noexcept { add(1); }
+    void decrement() noexcept { add(-1); }
+
+    int64_t value() const noexcept;
+
+private:
+    struct alignas(kCacheLineSize) Shard {
+        std::atomic_int64_t value{0};
+    };
+    std::array<Shard, kMaxShards> shards_;
+};
+
+//! Scrape-time view of a Histogram: per-bucket (not cumulative) counts, the last one counting values above all bounds
+struct HistogramSnapshot {
+    std::vector<uint64_t> bounds;
+    std::vector<uint64_t> buckets;
+    uint64_t sum{0};
+
+    uint64_t count() const noexcept;
+};
+
+//! Histogram of integer observations (e.g. microseconds) over fixed upper bounds, split into per-thread shards
+class Histogram {
+public:
+    explicit Histogram(std::vector<uint64_t> bounds);
+
+    Histogram(const Histogram&) = delete;
+    Histogram& operator=(const Histogram&) = delete;
+
+    void observe(uint64_t value) noexcept;
+
+    HistogramSnapshot snapshot() const;
+
+private:
+    struct alignas(kCacheLineSize) Shard {
+        std::array<std::atomic_uint64_t, kMaxBuckets + 1> buckets{};
+        std::atomic_uint64_t sum{0};
+    };
+
+    std::vector<uint64_t> bounds_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+//! Latency buckets in microseconds, from 50us up to 10s
+extern const std::vector<uint64_t> kLatencyBuckets;
+
+//! Buckets counting KV round-trips, from 1 up to 4096
+extern const std::vector<uint64_t> kRoundTripBuckets;
+
+//! Metrics collected for each JSON-RPC method
+struct MethodMetrics {
+    Histogram latency{kLatencyBuckets};
+    Gauge in_flight;
+    Counter errors;
+};
+
+//! Keep the in-flight gauge of one method incremented for the lifetime of this object
+class InFlightScope {
+public:
+    explicit InFlightScope(Gauge& in_flight) : in_flight_(in_flight) { in_flight_.increment(); }
+    ~InFlightScope() { in_flight_.decrement(); }
+
+    InFlightScope(const InFlightScope&) = delete;
+    InFlightScope& operator=(const InFlightScope&) = delete;
+
+private:
+    Gauge& in_flight_;
+};
+
+//! Collection of all the metrics exposed in Prometheus text format. Metrics are created once and never destroyed, so
+//! hot paths may keep references to them. Scraping just sums the shards: it never blocks nor slows down recording threads.
+class Registry {
+public:
+    using Collector = std::function<void(std::ostream&)>;
+
+    Registry();
+
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    //! The metrics of \p method, created at first use: lookups are cached per thread, so steady state takes no lock
+    MethodMetrics& method(std::string_view method);
+
+    //! KV round-trips performed by each remote transaction (i.e. by each request for almost all methods)
+    Histogram& kv_round_trips() noexcept { return kv_round_trips_; }
+
+    //! Tasks posted to the worker pool and not yet started
+    Gauge& worker_queue_depth() noexcept { return worker_queue_depth_; }
+
+    //! Requests cancelled because the client disconnected or the deadline expired
+    Counter& requests_cancelled() noexcept { return requests_cancelled_; }
+
+    //! Delay between the expected and the actual execution of a periodic timer on the event loop of \p context_index
+    Histogram& event_loop_lag(std::size_t context_index);
+
+    //! Add \p collector writing metrics sampled at scrape time (e.g. cache statistics)
+    void add_collector(Collector collector);
+
+    //! Write all the metrics in Prometheus text exposition format
+    void write_text(std::ostream& out) const;
+
+private:
+    const uint64_t id_;
+
+    mutable std::mutex access_;
+    std::map<std::string, std::unique_ptr<MethodMetrics>, std::less<>> methods_;
+    std::map<std::size_t, std::unique_ptr<Histogram>> event_loop_lags_;
+    std::vector<Collector> collectors_;
+
+    Histogram kv_round_trips_{kRoundTripBuckets};
+    Gauge worker_queue_depth_;
+    Counter requests_cancelled_;
+};
+
+//! The process-wide registry
+Registry& registry();
+
+void write_counter(std::ostream& out, std::string_view name, std::string_view help, uint64_t value);
+void write_gauge(std::ostream& out, std::string_view name, std::string_view help, double value);
+
+} // namespace silkrpc::metrics
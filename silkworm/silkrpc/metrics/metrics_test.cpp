@@ -0,0 +1,169 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "metrics.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace silkrpc::metrics {
+
+using Catch::Matchers::Contains;
+using Catch::Matchers::Message;
+
+TEST_CASE("Counter", "[silkrpc][metrics]") {
+    Counter counter;
+    CHECK(counter.value() == 0);
+
+    SECTION("single thread") {
+        counter.add();
+        counter.add(10);
+        CHECK(counter.value() == 11);
+    }
+
+    SECTION("multiple threads") {
+        std::vector<std::thread> threads;
+        for (auto i{0}; i < 8; ++i) {
+            threads.emplace_back([&]() {
+                for (auto j{0}; j < 1'000; ++j) {
+                    counter.add();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        CHECK(counter.value() == 8'000);
+    }
+}
+
+TEST_CASE("Gauge", "[silkrpc][metrics]") {
+    Gauge gauge;
+    CHECK(gauge.value() == 0);
+
+    SECTION("increment and decrement") {
+        gauge.increment();
+        gauge.increment();
+        gauge.decrement();
+        CHECK(gauge.value() == 1);
+    }
+
+    SECTION("decrement on another thread") {
+        gauge.increment();
+        std::thread{[&]() { gauge.decrement(); }}.join();
+        CHECK(gauge.value() == 0);
+    }
+
+    SECTION("in-flight scope") {
+        {
+            InFlightScope in_flight{gauge};
+            CHECK(gauge.value() == 1);
+        }
+        CHECK(gauge.value() == 0);
+    }
+}
+
+TEST_CASE("Histogram", "[silkrpc][metrics]") {
+    SECTION("invalid bounds") {
+        CHECK_THROWS_MATCHES(Histogram{{}}, std::invalid_argument, Message("invalid histogram bucket count: 0"));
+        CHECK_THROWS_MATCHES(Histogram({10, 5}), std::invalid_argument, Message("unsorted histogram bucket bounds"));
+    }
+
+    SECTION("observe") {
+        Histogram histogram{{10, 100}};
+        histogram.observe(0);
+        histogram.observe(10);
+        histogram.observe(11);
+        histogram.observe(1'000);
+        const auto snapshot{histogram.snapshot()};
+        CHECK(snapshot.bounds == std::vector<uint64_t>{10, 100});
+        CHECK(snapshot.buckets == std::vector<uint64_t>{2, 1, 1});
+        CHECK(snapshot.sum == 1'021);
+        CHECK(snapshot.count() == 4);
+    }
+}
+
+TEST_CASE("Registry::method", "[silkrpc][metrics]") {
+    Registry registry;
+    auto& metrics1 = registry.method("eth_call");
+    auto& metrics2 = registry.method("eth_getBalance");
+    CHECK(&metrics1 != &metrics2);
+    CHECK(&registry.method("eth_call") == &metrics1);
+
+    SECTION("same metrics from another thread") {
+        MethodMetrics* other_thread_metrics{nullptr};
+        std::thread{[&]() { other_thread_metrics = &registry.method("eth_call"); }}.join();
+        CHECK(other_thread_metrics == &metrics1);
+    }
+
+    SECTION("different registries") {
+        Registry other_registry;
+        CHECK(&other_registry.method("eth_call") != &metrics1);
+    }
+}
+
+TEST_CASE("Registry::write_text", "[silkrpc][metrics]") {
+    Registry registry;
+
+    SECTION("method metrics") {
+        auto& method_metrics = registry.method("eth_call");
+        method_metrics.latency.observe(75);
+        method_metrics.in_flight.increment();
+        method_metrics.errors.add();
+        std::ostringstream out;
+        registry.write_text(out);
+        const auto text{out.str()};
+        CHECK_THAT(text, Contains("# TYPE silkrpc_request_duration_seconds histogram\n"));
+        CHECK_THAT(text, Contains("silkrpc_request_duration_seconds_bucket{method=\"eth_call\",le=\"5e-05\"} 0\n"));
+        CHECK_THAT(text, Contains("silkrpc_request_duration_seconds_bucket{method=\"eth_call\",le=\"0.0001\"} 1\n"));
+        CHECK_THAT(text, Contains("silkrpc_request_duration_seconds_bucket{method=\"eth_call\",le=\"+Inf\"} 1\n"));
+        CHECK_THAT(text, Contains("silkrpc_request_duration_seconds_sum{method=\"eth_call\"} 7.5e-05\n"));
+        CHECK_THAT(text, Contains("silkrpc_request_duration_seconds_count{method=\"eth_call\"} 1\n"));
+        CHECK_THAT(text, Contains("silkrpc_requests_in_flight{method=\"eth_call\"} 1\n"));
+        CHECK_THAT(text, Contains("silkrpc_request_errors_total{method=\"eth_call\"} 1\n"));
+    }
+
+    SECTION("global metrics") {
+        registry.kv_round_trips().observe(3);
+        registry.worker_queue_depth().increment();
+        registry.requests_cancelled().add();
+        registry.event_loop_lag(2).observe(20);
+        std::ostringstream out;
+        registry.write_text(out);
+        const auto text{out.str()};
+        CHECK_THAT(text, Contains("silkrpc_kv_round_trips_bucket{le=\"4\"} 1\n"));
+        CHECK_THAT(text, Contains("silkrpc_kv_round_trips_sum 3\n"));
+        CHECK_THAT(text, Contains("silkrpc_worker_queue_depth 1\n"));
+        CHECK_THAT(text, Contains("silkrpc_requests_cancelled_total 1\n"));
+        CHECK_THAT(text, Contains("silkrpc_event_loop_lag_seconds_count{context=\"2\"} 1\n"));
+    }
+
+    SECTION("collector") {
+        registry.add_collector([](std::ostream& out) { write_counter(out, "silkrpc_test_total", "Test counter", 42); });
+        std::ostringstream out;
+        registry.write_text(out);
+        const auto text{out.str()};
+        CHECK_THAT(text, Contains("# HELP silkrpc_test_total Test counter\n# TYPE silkrpc_test_total counter\nsilkrpc_test_total 42\n"));
+    }
+}
+
+} // namespace silkrpc::metrics
@@ -0,0 +1,175 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "request_profile.hpp"
+
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+#include <silkworm/silkrpc/common/log.hpp>
+
+namespace silkrpc::metrics {
+
+//! Scale applied to nanosecond durations to print them in milliseconds
+constexpr double kNanosToMillis{1e-6};
+
+//! Scale applied to nanosecond timestamps to express them in microseconds, as per trace-event format
+constexpr uint64_t kNanosPerMicro{1'000};
+
+static std::atomic<int64_t> slow_request_threshold_ms_{0};
+static std::atomic<SlowRequestFormat> slow_request_format_{SlowRequestFormat::Line};
+
+RequestProfile::RequestProfile(uint64_t start_time) : start_time_(start_time) {}
+
+void RequestProfile::add_kv_op(const std::string& table, const char* op, uint64_t start, uint64_t end) {
+    std::scoped_lock lock{access_};
+    auto it = kv_stats_by_table_.find(table);
+    if (it == kv_stats_by_table_.end()) {
+        it = kv_stats_by_table_.emplace(table, Stats{}).first;
+    }
+    ++it->second.count;
+    it->second.duration += end - start;
+    ++kv_stats_.count;
+    kv_stats_.duration += end - start;
+    add_span("kv", op, table, start, end);
+}
+
+void RequestProfile::add_worker_wait(uint64_t start, uint64_t end) {
+    std::scoped_lock lock{access_};
+    ++worker_wait_stats_.count;
+    worker_wait_stats_.duration += end - start;
+    add_span("workers", "queue_wait", {}, start, end);
+}
+
+void RequestProfile::add_evm(uint64_t start, uint64_t end) {
+    std::scoped_lock lock{access_};
+    ++evm_stats_.count;
+    evm_stats_.duration += end - start;
+    add_span("evm", "execute", {}, start, end);
+}
+
+void RequestProfile::add_serialization(uint64_t start, uint64_t end) {
+    std::scoped_lock lock{access_};
+    ++serialization_stats_.count;
+    serialization_stats_.duration += end - start;
+    add_span("json", "serialize", {}, start, end);
+}
+
+void RequestProfile::add_span(const char* category, const char* name, const std::string& table, uint64_t start, uint64_t end) {
+    if (spans_.size() < kMaxSpans) {
+        spans_.push_back(Span{category, name, table, start, end - start});
+    }
+}
+
+std::string RequestProfile::to_line(std::string_view method, const nlohmann::json& id, uint64_t duration) const {
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(3);
+    line << "slow request method=" << method << " id=" << id.dump() << " total_ms=" << duration * kNanosToMillis
+         << " kv_ops=" << kv_stats_.count << " kv_ms=" << kv_stats_.duration * kNanosToMillis
+         << " worker_wait_ms=" << worker_wait_stats_.duration * kNanosToMillis
+         << " evm_ms=" << evm_stats_.duration * kNanosToMillis
+         << " serialization_ms=" << serialization_stats_.duration * kNanosToMillis;
+    if (!kv_stats_by_table_.empty()) {
+        line << " kv_tables=";
+        bool first{true};
+        for (const auto& [table, stats] : kv_stats_by_table_) {
+            line << (first ? "" : ",") << table << ":" << stats.count << "/" << stats.duration * kNanosToMillis << "ms";
+            first = false;
+        }
+    }
+    if (spans_.size() == kMaxSpans) {
+        line << " truncated_spans=true";
+    }
+    return line.str();
+}
+
+nlohmann::json RequestProfile::to_trace_events(std::string_view method, const nlohmann::json& id, uint64_t duration) const {
+    // Complete events ("ph":"X") on three tracks: request and its async steps, worker pool queueing and EVM execution
+    auto make_event = [](const std::string& name, const char* category, uint64_t start, uint64_t duration, int track) {
+        return nlohmann::json{
+            {"name", name}, {"cat", category}, {"ph", "X"}, {"ts", start / kNanosPerMicro},
+            {"dur", duration / kNanosPerMicro}, {"pid", 1}, {"tid", track}
+        };
+    };
+    auto events = nlohmann::json::array();
+    auto request_event = make_event(std::string{method}, "request", start_time_, duration, 1);
+    request_event["args"] = {{"id", id}};
+    events.push_back(std::move(request_event));
+    for (const auto& span : spans_) {
+        const bool on_worker = std::string_view{span.category} == "workers" || std::string_view{span.category} == "evm";
+        auto event = make_event(span.name, span.category, span.start, span.duration, on_worker ? 2 : 1);
+        if (!span.table.empty()) {
+            event["name"] = span.table + "." + span.name;
+            event["args"] = {{"table", span.table}};
+        }
+        events.push_back(std::move(event));
+    }
+    return nlohmann::json{{"traceEvents", std::move(events)}, {"displayTimeUnit", "ms"}};
+}
+
+void set_slow_request_threshold(std::chrono::milliseconds threshold) {
+    slow_request_threshold_ms_.store(threshold.count(), std::memory_order_relaxed);
+}
+
+std::chrono::milliseconds slow_request_threshold() {
+    return std::chrono::milliseconds{slow_request_threshold_ms_.load(std::memory_order_relaxed)};
+}
+
+void set_slow_request_format(SlowRequestFormat format) {
+    slow_request_format_.store(format, std::memory_order_relaxed);
+}
+
+SlowRequestFormat slow_request_format() {
+    return slow_request_format_.load(std::memory_order_relaxed);
+}
+
+void log_if_slow_request(const RequestProfile& profile, std::string_view method, const nlohmann::json& id, uint64_t duration) {
+    const auto threshold = slow_request_threshold();
+    if (threshold.count() == 0 || duration < static_cast<uint64_t>(std::chrono::nanoseconds{threshold}.count())) {
+        return;
+    }
+    if (slow_request_format() == SlowRequestFormat::Trace) {
+        SILKRPC_LOG << "slow request trace: " << profile.to_trace_events(method, id, duration).dump() << "\n";
+    } else {
+        SILKRPC_LOG << profile.to_line(method, id, duration) << "\n";
+    }
+}
+
+bool AbslParseFlag(absl::string_view text, SlowRequestFormat* format, std::string* error) {
+    if (text == "line") {
+        *format = SlowRequestFormat::Line;
+        return true;
+    }
+    if (text == "trace") {
+        *format = SlowRequestFormat::Trace;
+        return true;
+    }
+    *error = "unknown value for SlowRequestFormat";
+    return false;
+}
+
+std::string AbslUnparseFlag(SlowRequestFormat format) {
+    switch (format) {
+        case SlowRequestFormat::Line: return "line";
+        case SlowRequestFormat::Trace: return "trace";
+        default: return std::to_string(static_cast<int>(format));
+    }
+}
+
+} // namespace silkrpc::metrics
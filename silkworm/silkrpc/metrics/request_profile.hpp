@@ -0,0 +1,112 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/strings/string_view.h>
+#include <nlohmann/json.hpp>
+
+namespace silkrpc::metrics {
+
+//! Output of the slow request log: one key=value line or one Chrome trace-event JSON (loadable in Perfetto) per request
+enum class SlowRequestFormat { Line, Trace };
+
+//! Lightweight recorder of where the time of one request goes: remote cursor ops by table, queueing on the worker pool,
+//! EVM execution and reply serialization. It is owned by the request and written both by the I/O context (e.g. remote cursor
+//! ops) and by the workers running EVM executions, possibly several at once (e.g. eth_callMany windows), so writes are locked.
+//! Reads need no lock: they happen on the I/O context after the request has been handled, i.e. after each worker posted its
+//! completion back to the I/O context, which orders all the writes before them.
+class RequestProfile {
+public:
+    //! Max number of spans kept for trace events, beyond this number only the aggregated stats are updated
+    static constexpr std::size_t kMaxSpans{1'024};
+
+    struct Stats {
+        uint64_t count{0};
+        uint64_t duration{0}; // ns
+    };
+
+    struct Span {
+        const char* category;
+        const char* name;
+        std::string table;
+        uint64_t start; // ns
+        uint64_t duration; // ns
+    };
+
+    explicit RequestProfile(uint64_t start_time);
+
+    RequestProfile(const RequestProfile&) = delete;
+    RequestProfile& operator=(const RequestProfile&) = delete;
+
+    uint64_t start_time() const { return start_time_; }
+
+    void add_kv_op(const std::string& table, const char* op, uint64_t start, uint64_t end);
+    void add_worker_wait(uint64_t start, uint64_t end);
+    void add_evm(uint64_t start, uint64_t end);
+    void add_serialization(uint64_t start, uint64_t end);
+
+    const std::map<std::string, Stats, std::less<>>& kv_stats_by_table() const { return kv_stats_by_table_; }
+    const Stats& kv_stats() const { return kv_stats_; }
+    const Stats& worker_wait_stats() const { return worker_wait_stats_; }
+    const Stats& evm_stats() const { return evm_stats_; }
+    const Stats& serialization_stats() const { return serialization_stats_; }
+    const std::vector<Span>& spans() const { return spans_; }
+
+    //! Single structured line summarizing the request lasted \p duration ns
+    std::string to_line(std::string_view method, const nlohmann::json& id, uint64_t duration) const;
+
+    //! Chrome trace-event JSON object with one complete event for the request and one for each recorded span
+    nlohmann::json to_trace_events(std::string_view method, const nlohmann::json& id, uint64_t duration) const;
+
+private:
+    void add_span(const char* category, const char* name, const std::string& table, uint64_t start, uint64_t end);
+
+    uint64_t start_time_;
+    std::mutex access_;
+    std::map<std::string, Stats, std::less<>> kv_stats_by_table_;
+    Stats kv_stats_;
+    Stats worker_wait_stats_;
+    Stats evm_stats_;
+    Stats serialization_stats_;
+    std::vector<Span> spans_;
+};
+
+//! Set the duration above which requests are logged (zero disables both profiling and logging)
+void set_slow_request_threshold(std::chrono::milliseconds threshold);
+std::chrono::milliseconds slow_request_threshold();
+
+void set_slow_request_format(SlowRequestFormat format);
+SlowRequestFormat slow_request_format();
+
+//! Log \p profile of the request if it lasted \p duration ns, i.e. more than the slow request threshold
+void log_if_slow_request(const RequestProfile& profile, std::string_view method, const nlohmann::json& id, uint64_t duration);
+
+bool AbslParseFlag(absl::string_view text, SlowRequestFormat* format, std::string* error);
+std::string AbslUnparseFlag(SlowRequestFormat format);
+
+} // namespace silkrpc::metrics
@@ -0,0 +1,139 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "request_profile.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <silkworm/silkrpc/common/log.hpp>
+
+namespace silkrpc::metrics {
+
+TEST_CASE("RequestProfile::add_kv_op", "[silkrpc][metrics][request_profile]") {
+    RequestProfile profile{1'000};
+    profile.add_kv_op("PlainState", "seek", 1'000, 3'000);
+    profile.add_kv_op("PlainState", "next", 3'000, 4'000);
+    profile.add_kv_op("AccountHistory", "seek", 4'000, 8'000);
+    CHECK(profile.kv_stats().count == 3);
+    CHECK(profile.kv_stats().duration == 7'000);
+    CHECK(profile.kv_stats_by_table().size() == 2);
+    CHECK(profile.kv_stats_by_table().at("PlainState").count == 2);
+    CHECK(profile.kv_stats_by_table().at("PlainState").duration == 3'000);
+    CHECK(profile.kv_stats_by_table().at("AccountHistory").count == 1);
+    CHECK(profile.spans().size() == 3);
+}
+
+TEST_CASE("RequestProfile spans are capped", "[silkrpc][metrics][request_profile]") {
+    RequestProfile profile{0};
+    for (uint64_t i{0}; i < RequestProfile::kMaxSpans + 10; ++i) {
+        profile.add_kv_op("PlainState", "next", i, i + 1);
+    }
+    CHECK(profile.spans().size() == RequestProfile::kMaxSpans);
+    CHECK(profile.kv_stats().count == RequestProfile::kMaxSpans + 10);
+    CHECK(profile.to_line("eth_getLogs", 1, 2'000).find("truncated_spans=true") != std::string::npos);
+}
+
+TEST_CASE("RequestProfile concurrent writes", "[silkrpc][metrics][request_profile]") {
+    RequestProfile profile{0};
+    constexpr uint64_t kNumWorkers{4};
+    constexpr uint64_t kNumExecutionsPerWorker{100};
+    std::vector<std::thread> workers;
+    for (uint64_t i{0}; i < kNumWorkers; ++i) {
+        workers.emplace_back([&]() {
+            for (uint64_t j{0}; j < kNumExecutionsPerWorker; ++j) {
+                profile.add_worker_wait(j, j + 1);
+                profile.add_evm(j + 1, j + 3);
+            }
+        });
+    }
+    for (uint64_t j{0}; j < kNumExecutionsPerWorker; ++j) {
+        profile.add_kv_op("PlainState", "seek", j, j + 1);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    CHECK(profile.worker_wait_stats().count == kNumWorkers * kNumExecutionsPerWorker);
+    CHECK(profile.evm_stats().count == kNumWorkers * kNumExecutionsPerWorker);
+    CHECK(profile.evm_stats().duration == 2 * kNumWorkers * kNumExecutionsPerWorker);
+    CHECK(profile.kv_stats().count == kNumExecutionsPerWorker);
+    CHECK(profile.spans().size() == (2 * kNumWorkers + 1) * kNumExecutionsPerWorker);
+}
+
+TEST_CASE("RequestProfile::to_line", "[silkrpc][metrics][request_profile]") {
+    RequestProfile profile{0};
+    profile.add_kv_op("PlainState", "seek", 0, 2'000'000);
+    profile.add_worker_wait(2'000'000, 2'500'000);
+    profile.add_evm(2'500'000, 7'500'000);
+    profile.add_serialization(7'500'000, 7'600'000);
+    const auto line = profile.to_line("eth_call", 3, 8'000'000);
+    CHECK(line == "slow request method=eth_call id=3 total_ms=8.000 kv_ops=1 kv_ms=2.000 worker_wait_ms=0.500 evm_ms=5.000 "
+                  "serialization_ms=0.100 kv_tables=PlainState:1/2.000ms");
+}
+
+TEST_CASE("RequestProfile::to_trace_events", "[silkrpc][metrics][request_profile]") {
+    RequestProfile profile{1'000'000};
+    profile.add_kv_op("PlainState", "seek", 1'000'000, 3'000'000);
+    profile.add_evm(3'000'000, 5'000'000);
+    const auto trace = profile.to_trace_events("eth_call", 3, 6'000'000);
+    const auto& events = trace["traceEvents"];
+    REQUIRE(events.size() == 3);
+    CHECK(events[0] == R"({"name":"eth_call","cat":"request","ph":"X","ts":1000,"dur":6000,"pid":1,"tid":1,"args":{"id":3}})"_json);
+    CHECK(events[1] == R"({"name":"PlainState.seek","cat":"kv","ph":"X","ts":1000,"dur":2000,"pid":1,"tid":1,"args":{"table":"PlainState"}})"_json);
+    CHECK(events[2] == R"({"name":"execute","cat":"evm","ph":"X","ts":3000,"dur":2000,"pid":1,"tid":2})"_json);
+}
+
+TEST_CASE("log_if_slow_request", "[silkrpc][metrics][request_profile]") {
+    std::stringstream ss;
+    SILKRPC_LOG_STREAMS(ss, null_stream());
+    RequestProfile profile{0};
+
+    SECTION("disabled") {
+        set_slow_request_threshold(std::chrono::milliseconds{0});
+        log_if_slow_request(profile, "eth_call", 1, 1'000'000'000);
+        CHECK(ss.str().empty());
+    }
+
+    SECTION("below threshold") {
+        set_slow_request_threshold(std::chrono::milliseconds{100});
+        log_if_slow_request(profile, "eth_call", 1, 99'000'000);
+        CHECK(ss.str().empty());
+    }
+
+    SECTION("above threshold as line") {
+        set_slow_request_threshold(std::chrono::milliseconds{100});
+        log_if_slow_request(profile, "eth_call", 1, 100'000'000);
+        CHECK(ss.str().find("slow request method=eth_call id=1 total_ms=100.000") != std::string::npos);
+    }
+
+    SECTION("above threshold as trace") {
+        set_slow_request_threshold(std::chrono::milliseconds{100});
+        set_slow_request_format(SlowRequestFormat::Trace);
+        log_if_slow_request(profile, "eth_call", 1, 100'000'000);
+        CHECK(ss.str().find(R"(slow request trace: {"displayTimeUnit":"ms","traceEvents":[)") != std::string::npos);
+        set_slow_request_format(SlowRequestFormat::Line);
+    }
+
+    set_slow_request_threshold(std::chrono::milliseconds{0});
+    SILKRPC_LOG_STREAMS(std::cerr, null_stream());
+}
+
+} // namespace silkrpc::metrics
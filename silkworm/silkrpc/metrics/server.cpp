@@ -0,0 +1,107 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "server.hpp"
+
+#include <sstream>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+
+#include <silkworm/silkrpc/common/constants.hpp>
+#include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/http/reply.hpp>
+
+namespace silkrpc::metrics {
+
+Server::Server(const std::string& end_point, boost::asio::io_context& io_context, Registry& registry)
+    : acceptor_{io_context}, registry_(registry) {
+    const auto host = end_point.substr(0, end_point.find(kAddressPortSeparator));
+    const auto port = end_point.substr(end_point.find(kAddressPortSeparator) + 1, std::string::npos);
+
+    boost::asio::ip::tcp::resolver resolver{acceptor_.get_executor()};
+    boost::asio::ip::tcp::endpoint endpoint = *resolver.resolve(host, port).begin();
+    acceptor_.open(endpoint.protocol());
+    acceptor_.set_option(boost::asio::ip::tcp::acceptor::reuse_address(true));
+    acceptor_.bind(endpoint);
+}
+
+void Server::start() {
+    boost::asio::co_spawn(acceptor_.get_executor(), run(), [&](std::exception_ptr eptr) {
+        if (eptr) std::rethrow_exception(eptr);
+    });
+}
+
+void Server::stop() {
+    acceptor_.close();
+}
+
+boost::asio::awaitable<void> Server::run() {
+    acceptor_.listen();
+
+    try {
+        while (acceptor_.is_open()) {
+            auto socket = co_await acceptor_.async_accept(boost::asio::use_awaitable);
+            boost::asio::co_spawn(acceptor_.get_executor(), handle_connection(std::move(socket)), boost::asio::detached);
+        }
+    } catch (const boost::system::system_error& se) {
+        if (se.code() != boost::asio::error::operation_aborted) {
+            SILKRPC_ERROR << "metrics::Server::run system_error: " << se.what() << "\n" << std::flush;
+            throw;
+        }
+    }
+    SILKRPC_DEBUG << "metrics::Server::run exiting...\n" << std::flush;
+}
+
+boost::asio::awaitable<void> Server::handle_connection(boost::asio::ip::tcp::socket socket) {
+    try {
+        // Scrapes are tiny GET requests without content, so just the request line matters: one request per connection
+        boost::asio::streambuf buffer;
+        co_await boost::asio::async_read_until(socket, buffer, "\r\n\r\n", boost::asio::use_awaitable);
+        std::istream request_stream{&buffer};
+        std::string method, uri;
+        request_stream >> method >> uri;
+
+        http::Reply reply;
+        if (method == "GET" && (uri == kMetricsPath || uri.starts_with(std::string{kMetricsPath} + "?"))) {
+            std::ostringstream content;
+            registry_.write_text(content);
+            reply.status = http::StatusType::ok;
+            reply.content = content.str();
+            reply.headers.reserve(3);
+            reply.headers.emplace_back(http::Header{"Content-Length", std::to_string(reply.content.size())});
+            reply.headers.emplace_back(http::Header{"Content-Type", "text/plain; version=0.0.4"});
+            reply.headers.emplace_back(http::Header{"Connection", "close"});
+        } else {
+            reply = http::Reply::stock_reply(http::StatusType::not_found);
+        }
+        co_await boost::asio::async_write(socket, reply.to_buffers(), boost::asio::use_awaitable);
+    } catch (const boost::system::system_error& se) {
+        SILKRPC_DEBUG << "metrics::Server::handle_connection system_error: " << se.what() << "\n" << std::flush;
+    }
+    boost::system::error_code ignored_ec;
+    socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored_ec);
+}
+
+} // namespace silkrpc::metrics
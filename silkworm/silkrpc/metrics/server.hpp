@@ -0,0 +1,57 @@
+/*
+   Copyright 2022 The Silkrpc Authors
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#pragma once
+
+#include <string>
+#include <tuple>
+
+#include <silkworm/silkrpc/config.hpp>
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include <silkworm/silkrpc/metrics/metrics.hpp>
+
+namespace silkrpc::metrics {
+
+constexpr const char* kMetricsPath{"/metrics"};
+
+//! Minimal HTTP server answering GET /metrics with the content of one Registry in Prometheus text format.
+//! It runs on its own end-point, so that scraping never competes with JSON-RPC connections nor needs JWT authentication.
+class Server {
+public:
+    Server(const std::string& end_point, boost::asio::io_context& io_context, Registry& registry = metrics::registry());
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    void start();
+
+    void stop();
+
+private:
+    boost::asio::awaitable<void> run();
+
+    boost::asio::awaitable<void> handle_connection(boost::asio::ip::tcp::socket socket);
+
+    boost::asio::ip::tcp::acceptor acceptor_;
+    Registry& registry_;
+};
+
+} // namespace silkrpc::metrics
@@ -18,6 +18,7 @@
 
 #include <silkworm/silkrpc/common/block_cache.hpp>
 #include <silkworm/silkrpc/common/log.hpp>
+#include <silkworm/silkrpc/core/execution_caches.hpp>
 #include <silkworm/silkrpc/ethdb/kv/state_cache.hpp>
 
 namespace silkrpc::test {
@@ -28,7 +29,7 @@ ContextTestBase::ContextTestBase()
           return true;
       }()},
       context_{[]() { return grpc::CreateChannel("localhost:12345", grpc::InsecureChannelCredentials()); },
-               std::make_shared<BlockCache>(), std::make_shared<ethdb::kv::CoherentStateCache>()},
+               std::make_shared<BlockCache>(), std::make_shared<ethdb::kv::CoherentStateCache>(), make_execution_caches()},
       io_context_{*context_.io_context()},
       grpc_context_{*context_.grpc_context()},
       context_thread_{[&]() { context_.execute_loop(); }} {